@@ -0,0 +1,230 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal self-contained benchmark harness for the bench_* targets
+ *
+ * Each case is a callable run `iterations` times per repetition. The
+ * iteration count doubles until one repetition lasts at least --min-time
+ * milliseconds, then --repetitions runs are timed and the median is kept.
+ *
+ *     BenchRunner runner("queues", argc, argv);
+ *     runner.run("safequeue/push_pop", [&](uint64_t n) { ... }, bytes_per_op);
+ *     return runner.finish();
+ *
+ * Options:
+ *     --json <path>         écrit les résultats en JSON (suivi des régressions)
+ *     --filter <substring>  ne lance que les cas dont le nom contient la chaîne
+ *     --min-time <ms>       durée minimale d'une répétition (défaut 200)
+ *     --repetitions <n>     répétitions mesurées (défaut 5)
+ */
+
+namespace bench {
+
+// Empêche le compilateur d'éliminer un calcul dont le résultat est ignoré
+template<class T>
+inline void doNotOptimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;
+    double ns_per_op = 0.0;     // médiane des répétitions
+    double min_ns_per_op = 0.0;
+    double max_ns_per_op = 0.0;
+    uint64_t bytes_per_op = 0;
+
+    double bytesPerSecond() const {
+        return ns_per_op > 0.0 ? static_cast<double>(bytes_per_op) * 1e9 / ns_per_op : 0.0;
+    }
+};
+
+class BenchRunner {
+public:
+    // fn(n) exécute n itérations
+    using Body = std::function<void(uint64_t)>;
+
+    BenchRunner(const std::string& suite, int argc, char** argv)
+        : suite_(suite), min_time_ms_(200), repetitions_(5) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "--json" && has_value) {
+                json_path_ = argv[++i];
+            } else if (arg == "--filter" && has_value) {
+                filter_ = argv[++i];
+            } else if (arg == "--min-time" && has_value) {
+                min_time_ms_ = std::max(1, std::atoi(argv[++i]));
+            } else if (arg == "--repetitions" && has_value) {
+                repetitions_ = std::max(1, std::atoi(argv[++i]));
+            } else {
+                std::cerr << "Unknown option: " << arg << "\n"
+                          << "Usage: " << argv[0]
+                          << " [--json <path>] [--filter <substring>] [--min-time <ms>] [--repetitions <n>]\n";
+            }
+        }
+        std::printf("=== Bench %s ===\n\n", suite_.c_str());
+        std::printf("%-40s %14s %12s %12s\n", "Benchmark", "ns/op", "MB/s", "iterations");
+    }
+
+    void run(const std::string& name, const Body& body, uint64_t bytes_per_op = 0) {
+        if (!filter_.empty() && name.find(filter_) == std::string::npos) {
+            return;
+        }
+
+        // Calibrage: doubler jusqu'à dépasser la durée minimale
+        const double min_ns = min_time_ms_ * 1e6;
+        uint64_t iterations = 1;
+        double elapsed = timeOnce(body, iterations);
+        while (elapsed < min_ns && iterations < (uint64_t(1) << 40)) {
+            double scale = elapsed > 0.0 ? std::min(10.0, std::max(2.0, 1.2 * min_ns / elapsed)) : 10.0;
+            iterations = static_cast<uint64_t>(static_cast<double>(iterations) * scale);
+            elapsed = timeOnce(body, iterations);
+        }
+
+        std::vector<double> samples;
+        for (int r = 0; r < repetitions_; ++r) {
+            samples.push_back(timeOnce(body, iterations) / static_cast<double>(iterations));
+        }
+        std::sort(samples.begin(), samples.end());
+
+        Result result;
+        result.name = name;
+        result.iterations = iterations;
+        result.ns_per_op = samples[samples.size() / 2];
+        result.min_ns_per_op = samples.front();
+        result.max_ns_per_op = samples.back();
+        result.bytes_per_op = bytes_per_op;
+        addResult(result);
+    }
+
+    // Mesure faite ailleurs (ex: histogramme interne au code mesuré)
+    void report(const std::string& name, double ns_per_op, uint64_t iterations, uint64_t bytes_per_op = 0) {
+        if (!filter_.empty() && name.find(filter_) == std::string::npos) {
+            return;
+        }
+        Result result;
+        result.name = name;
+        result.iterations = iterations;
+        result.ns_per_op = ns_per_op;
+        result.min_ns_per_op = ns_per_op;
+        result.max_ns_per_op = ns_per_op;
+        result.bytes_per_op = bytes_per_op;
+        addResult(result);
+    }
+
+    const std::vector<Result>& results() const { return results_; }
+
+    // Écrit le JSON si demandé; code de sortie du programme
+    int finish() const {
+        if (json_path_.empty()) {
+            return 0;
+        }
+        std::ofstream out(json_path_);
+        if (!out) {
+            std::cerr << "Cannot write " << json_path_ << "\n";
+            return 1;
+        }
+        out << toJson();
+        std::printf("\nResults written to %s\n", json_path_.c_str());
+        return 0;
+    }
+
+    std::string toJson() const {
+        std::string json = "{\n  \"suite\": \"" + suite_ + "\",\n";
+        json += "  \"context\": {\"date\": \"" + isoDate() + "\", \"compiler\": \"" + compiler()
+              + "\", \"build_type\": \"" + buildType() + "\"},\n";
+        json += "  \"benchmarks\": [";
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const Result& r = results_[i];
+            char line[512];
+            std::snprintf(line, sizeof(line),
+                "%s\n    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.2f, "
+                "\"min_ns_per_op\": %.2f, \"max_ns_per_op\": %.2f, \"bytes_per_op\": %llu, "
+                "\"bytes_per_second\": %.0f}",
+                i ? "," : "", r.name.c_str(), static_cast<unsigned long long>(r.iterations),
+                r.ns_per_op, r.min_ns_per_op, r.max_ns_per_op,
+                static_cast<unsigned long long>(r.bytes_per_op), r.bytesPerSecond());
+            json += line;
+        }
+        json += "\n  ]\n}\n";
+        return json;
+    }
+
+private:
+    void addResult(const Result& result) {
+        results_.push_back(result);
+        if (result.bytes_per_op) {
+            std::printf("%-40s %14.1f %12.1f %12llu\n", result.name.c_str(), result.ns_per_op,
+                        result.bytesPerSecond() / (1024.0 * 1024.0),
+                        static_cast<unsigned long long>(result.iterations));
+        } else {
+            std::printf("%-40s %14.1f %12s %12llu\n", result.name.c_str(), result.ns_per_op, "-",
+                        static_cast<unsigned long long>(result.iterations));
+        }
+        std::fflush(stdout);
+    }
+
+    static double timeOnce(const Body& body, uint64_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        body(iterations);
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+
+    static std::string isoDate() {
+        std::time_t now = std::time(nullptr);
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        return buffer;
+    }
+
+    static std::string compiler() {
+#if defined(__clang__)
+        return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+        return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+        return "msvc " + std::to_string(_MSC_VER);
+#else
+        return "unknown";
+#endif
+    }
+
+    static std::string buildType() {
+#ifdef NDEBUG
+        return "release";
+#else
+        return "debug";
+#endif
+    }
+
+    std::string suite_;
+    std::string json_path_;
+    std::string filter_;
+    int min_time_ms_;
+    int repetitions_;
+    std::vector<Result> results_;
+};
+
+} // namespace bench
+
+#endif // BENCH_H
@@ -0,0 +1,90 @@
+#include "Bench.h"
+#include "../src/capture/SyntheticFrameSource.h"
+#include "../src/capture/FileReplaySource.h"
+#include "../src/network/FrameDelta.h"
+#include "../src/utils/Logger.h"
+#include <cstdio>
+
+// Coût de production d'une frame par les sources hors écran, pour vérifier
+// qu'elles ne faussent pas les mesures d'encodage et de réseau, et coût des
+// FRAME_UPDATE (FrameDelta::compute) entre deux frames consécutives
+
+namespace {
+    struct Resolution {
+        const char* name;
+        int width;
+        int height;
+    };
+
+    const Resolution kResolutions[] = {
+        {"720p", 1280, 720},
+        {"1080p", 1920, 1080},
+    };
+
+    const SyntheticFrameSource::Pattern kPatterns[] = {
+        SyntheticFrameSource::Pattern::STATIC_DESKTOP,
+        SyntheticFrameSource::Pattern::SCROLLING_TEXT,
+        SyntheticFrameSource::Pattern::VIDEO_NOISE,
+    };
+}
+
+int main(int argc, char** argv) {
+    bench::BenchRunner runner("frame_sources", argc, argv);
+    Logger::init("bench_frame_sources.log", Logger::LogLevel::WARN);
+
+    for (const Resolution& res : kResolutions) {
+        uint64_t frame_bytes = static_cast<uint64_t>(res.width) * res.height * 4;
+
+        for (SyntheticFrameSource::Pattern pattern : kPatterns) {
+            SyntheticFrameSource source(pattern, res.width, res.height);
+            if (!source.init()) {
+                continue;
+            }
+            runner.run(std::string("synthetic/") + SyntheticFrameSource::patternName(pattern) + "/" + res.name,
+                       [&](uint64_t n) {
+                int width = 0;
+                int height = 0;
+                for (uint64_t i = 0; i < n; ++i) {
+                    bench::doNotOptimize(source.captureFrame(width, height));
+                }
+            }, frame_bytes);
+
+            // Défilement détecté (scroll), rien (static) ou tout (noise) à envoyer
+            int width = 0;
+            int height = 0;
+            std::vector<uint8_t> previous = source.captureFrame(width, height);
+            std::vector<uint8_t> current = source.captureFrame(width, height);
+            runner.run(std::string("delta/") + SyntheticFrameSource::patternName(pattern) + "/" + res.name,
+                       [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    bench::doNotOptimize(FrameDelta::compute(previous.data(), current.data(), width, height));
+                }
+            }, frame_bytes);
+        }
+
+        // Relecture de 8 frames (cache disque chaud)
+        std::string path = std::string("bench_replay_") + res.name + ".raw";
+        std::remove(path.c_str());
+        SyntheticFrameSource generator(SyntheticFrameSource::Pattern::VIDEO_NOISE, res.width, res.height);
+        generator.init();
+        int width = 0;
+        int height = 0;
+        for (int i = 0; i < 8; ++i) {
+            FileReplaySource::appendFrame(path, generator.captureFrame(width, height));
+        }
+        {
+            FileReplaySource replay(path, res.width, res.height);
+            if (replay.init()) {
+                runner.run(std::string("replay/") + res.name, [&](uint64_t n) {
+                    for (uint64_t i = 0; i < n; ++i) {
+                        bench::doNotOptimize(replay.captureFrame(width, height));
+                    }
+                }, frame_bytes);
+            }
+        }
+        std::remove(path.c_str());
+    }
+
+    Logger::shutdown();
+    return runner.finish();
+}
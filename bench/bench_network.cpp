@@ -0,0 +1,112 @@
+#include "Bench.h"
+#include "../src/network/StreamServer.h"
+#include "../src/network/StreamClient.h"
+#include "../src/capture/SyntheticFrameSource.h"
+#include "../src/utils/Logger.h"
+#include "../src/utils/Metrics.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Diffusion d'une frame sur la boucle locale: sérialisation, sendPacket
+// et réception complète par un StreamClient
+
+namespace {
+    const int kPort = 19287;
+
+    struct FrameSize {
+        const char* name;
+        uint16_t width;
+        uint16_t height;
+        size_t bytes;
+    };
+
+    const FrameSize kSizes[] = {
+        {"64KiB", 128, 128, 64 * 1024},
+        {"720p_argb", 1280, 720, 1280 * 720 * 4},
+        {"1080p_argb", 1920, 1080, 1920 * 1080 * 4},
+    };
+
+    bool waitFor(const std::function<bool()>& condition, std::chrono::seconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    bench::BenchRunner runner("network", argc, argv);
+    Logger::init("bench_network.log", Logger::LogLevel::WARN);
+
+    StreamServer server("127.0.0.1", kPort);
+    if (!server.start()) {
+        std::cerr << "Cannot start server on port " << kPort << "\n";
+        Logger::shutdown();
+        return 1;
+    }
+    StreamClient client("127.0.0.1", kPort);
+    if (!client.connect() || !waitFor([&] { return server.getClientCount() == 1; }, std::chrono::seconds(5))) {
+        std::cerr << "Client could not connect\n";
+        server.stop();
+        Logger::shutdown();
+        return 1;
+    }
+
+    std::atomic<uint64_t> received(0);
+    client.setVideoFrameCallback([&](const VideoFrame&, const std::vector<uint8_t>&) {
+        received.fetch_add(1, std::memory_order_release);
+    });
+
+    Histogram& serialize_time = Metrics::histogram("frame_serialize_us");
+    uint32_t frame_number = 0;
+    int status = 0;
+
+    for (const FrameSize& size : kSizes) {
+        // Contenu de bureau reproductible, sans serveur X
+        SyntheticFrameSource source(SyntheticFrameSource::Pattern::STATIC_DESKTOP, size.width, size.height);
+        int width = 0;
+        int height = 0;
+        VideoFrame frame;
+        frame.data = source.init() ? source.captureFrame(width, height) : std::vector<uint8_t>();
+        if (frame.data.size() != size.bytes) {
+            frame.data.assign(size.bytes, 0x5A);
+        }
+        frame.width = size.width;
+        frame.height = size.height;
+        frame.quality = 80;
+        std::string suffix = std::string("/") + size.name;
+        HistogramSnapshot serialize_before = serialize_time.snapshot();
+
+        // Une itération = une frame reçue en entier par le client
+        runner.run("broadcast_loopback" + suffix, [&](uint64_t n) {
+            uint64_t target = received.load(std::memory_order_acquire) + n;
+            for (uint64_t i = 0; i < n; ++i) {
+                frame.frame_number = frame_number++;
+                frame.timestamp = get_monotonic_us();
+                server.broadcastVideoFrame(frame);
+            }
+            if (!waitFor([&] { return received.load(std::memory_order_acquire) >= target; },
+                         std::chrono::seconds(30))) {
+                status = 1;
+            }
+        }, sizeof(PacketHeader) + size.bytes);
+
+        // Part de la sérialisation (copie en-tête + pixels), mesurée par le serveur
+        HistogramSnapshot serialize = serialize_time.snapshot().since(serialize_before);
+        runner.report("serialize" + suffix, serialize.mean() * 1000.0, serialize.count, size.bytes);
+    }
+
+    client.disconnect();
+    server.stop();
+    Logger::shutdown();
+    if (status != 0) {
+        std::cerr << "Client stopped receiving frames\n";
+        return status;
+    }
+    return runner.finish();
+}
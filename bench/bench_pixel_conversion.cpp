@@ -0,0 +1,167 @@
+#include "Bench.h"
+#include "../src/capture/PixelConverter.h"
+#include "../src/network/PixelPacker.h"
+#include <cstring>
+#include <vector>
+
+#ifdef __linux__
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#endif
+
+// Conversion des pixels capturés (BGRX 32 bits) vers l'ARGB8888 diffusé,
+// puis les convertisseurs spécialisés de PixelConverter pour chaque format,
+// et les formats de transport réduits (PixelPacker, côté serveur et client)
+
+namespace {
+    struct Resolution {
+        const char* name;
+        int width;
+        int height;
+    };
+
+    struct Conversion {
+        SourceFormat source;
+        int source_bytes;
+        DestFormat dest;
+    };
+
+    const Conversion kConversions[] = {
+        {SourceFormat::XRGB8888, 4, DestFormat::ARGB8888},
+        {SourceFormat::XBGR8888, 4, DestFormat::ARGB8888},
+        {SourceFormat::RGB888, 3, DestFormat::ARGB8888},
+        {SourceFormat::RGB565, 2, DestFormat::ARGB8888},
+        {SourceFormat::XRGB8888, 4, DestFormat::BGRA8888},
+        {SourceFormat::XRGB8888, 4, DestFormat::RGB24},
+        {SourceFormat::XRGB8888, 4, DestFormat::I420},
+    };
+
+    const Resolution kResolutions[] = {
+        {"720p", 1280, 720},
+        {"1080p", 1920, 1080},
+        {"1440p", 2560, 1440},
+    };
+
+    std::vector<uint8_t> makeSource(int width, int height) {
+        std::vector<uint8_t> source(static_cast<size_t>(width) * height * 4);
+        for (size_t i = 0; i < source.size(); ++i) {
+            source[i] = static_cast<uint8_t>(i * 31 + 7);
+        }
+        return source;
+    }
+
+    // Lecture directe du mot 32 bits, sans passer par Xlib
+    void convertDirect(const uint8_t* src, uint8_t* dst, int width, int height, int stride) {
+        for (int row = 0; row < height; ++row) {
+            const uint8_t* line = src + static_cast<size_t>(row) * stride;
+            for (int col = 0; col < width; ++col) {
+                uint32_t pixel;
+                std::memcpy(&pixel, line + col * 4, sizeof(pixel));
+                size_t idx = (static_cast<size_t>(row) * width + col) * 4;
+                dst[idx + 0] = 0xFF;
+                dst[idx + 1] = (pixel >> 16) & 0xFF;
+                dst[idx + 2] = (pixel >> 8) & 0xFF;
+                dst[idx + 3] = pixel & 0xFF;
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    bench::BenchRunner runner("pixel_conversion", argc, argv);
+
+    for (const Resolution& res : kResolutions) {
+        std::vector<uint8_t> source = makeSource(res.width, res.height);
+        std::vector<uint8_t> output(source.size());
+        uint64_t bytes = output.size();
+        std::string suffix = std::string("/") + res.name;
+
+#ifdef __linux__
+        // Même boucle que ScreenCapture::captureRegion: XGetPixel par pixel.
+        // L'XImage est construite à la main (XInitImage), sans serveur X.
+        XImage image;
+        std::memset(&image, 0, sizeof(image));
+        image.width = res.width;
+        image.height = res.height;
+        image.format = ZPixmap;
+        image.data = reinterpret_cast<char*>(source.data());
+        image.byte_order = LSBFirst;
+        image.bitmap_unit = 32;
+        image.bitmap_bit_order = LSBFirst;
+        image.bitmap_pad = 32;
+        image.depth = 24;
+        image.bytes_per_line = res.width * 4;
+        image.bits_per_pixel = 32;
+        image.red_mask = 0xFF0000;
+        image.green_mask = 0x00FF00;
+        image.blue_mask = 0x0000FF;
+        XInitImage(&image);
+
+        runner.run("xgetpixel" + suffix, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                for (int row = 0; row < res.height; ++row) {
+                    for (int col = 0; col < res.width; ++col) {
+                        unsigned long pixel = XGetPixel(&image, col, row);
+                        size_t idx = (static_cast<size_t>(row) * res.width + col) * 4;
+                        output[idx + 0] = 0xFF;
+                        output[idx + 1] = (pixel >> 16) & 0xFF;
+                        output[idx + 2] = (pixel >> 8) & 0xFF;
+                        output[idx + 3] = pixel & 0xFF;
+                    }
+                }
+                bench::doNotOptimize(output.data());
+            }
+        }, bytes);
+#endif
+
+        runner.run("direct" + suffix, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                convertDirect(source.data(), output.data(), res.width, res.height, res.width * 4);
+                bench::doNotOptimize(output.data());
+            }
+        }, bytes);
+
+        // Choix fait une fois, comme ScreenCapture::selectConverter
+        for (const Conversion& conversion : kConversions) {
+            PixelConvertFn convert = PixelConverter::select(conversion.source, conversion.dest);
+            size_t stride = static_cast<size_t>(res.width) * conversion.source_bytes;
+            std::string name = std::string(PixelConverter::name(conversion.source)) + "-" +
+                               PixelConverter::name(conversion.dest) + suffix;
+            runner.run(name, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    convert(source.data(), stride, res.width, res.height, output.data());
+                    bench::doNotOptimize(output.data());
+                }
+            }, PixelConverter::destinationSize(conversion.dest, res.width, res.height));
+        }
+
+        // Octets par frame ARGB traitée, pour comparer au memcpy
+        size_t pixel_count = static_cast<size_t>(res.width) * res.height;
+        std::vector<uint8_t> packed(pixel_count * 4);
+        for (PixelFormat format : {PixelFormat::RGB24, PixelFormat::RGB565}) {
+            std::string name = PixelPacker::name(format);
+            runner.run("pack-" + name + suffix, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    PixelPacker::pack(format, source.data(), pixel_count, packed.data());
+                    bench::doNotOptimize(packed.data());
+                }
+            }, bytes);
+            runner.run("unpack-" + name + suffix, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    PixelPacker::unpack(format, packed.data(), res.width, res.height, output.data(), res.width * 4);
+                    bench::doNotOptimize(output.data());
+                }
+            }, bytes);
+        }
+
+        // Borne haute: simple copie mémoire de la même taille
+        runner.run("memcpy" + suffix, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                std::memcpy(output.data(), source.data(), output.size());
+                bench::doNotOptimize(output.data());
+            }
+        }, bytes);
+    }
+
+    return runner.finish();
+}
@@ -0,0 +1,118 @@
+#include "Bench.h"
+#include "../src/threading/SafeQueue.h"
+#include "../src/threading/BoundedQueue.h"
+#include "../src/threading/ThreadPool.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Débit des files et du pool utilisés entre capture, encodage et envoi
+
+int main(int argc, char** argv) {
+    bench::BenchRunner runner("queues", argc, argv);
+
+    // Coût d'un aller-retour sans contention
+    {
+        SafeQueue<int> queue;
+        runner.run("safequeue/push_pop_single_thread", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                queue.push(static_cast<int>(i));
+                bench::doNotOptimize(queue.try_pop());
+            }
+        });
+    }
+    {
+        BoundedQueue<int> queue(1024);
+        runner.run("boundedqueue/push_pop_single_thread", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                queue.try_push(static_cast<int>(i));
+                bench::doNotOptimize(queue.try_pop());
+            }
+        });
+    }
+
+    // Un producteur, un consommateur (capture -> envoi)
+    runner.run("safequeue/spsc", [](uint64_t n) {
+        SafeQueue<uint64_t> queue;
+        std::thread consumer([&] {
+            for (uint64_t i = 0; i < n; ++i) {
+                queue.pop();
+            }
+        });
+        for (uint64_t i = 0; i < n; ++i) {
+            queue.push(i);
+        }
+        consumer.join();
+    });
+    runner.run("boundedqueue/spsc", [](uint64_t n) {
+        BoundedQueue<uint64_t> queue(1024);
+        std::thread consumer([&] {
+            for (uint64_t i = 0; i < n; ++i) {
+                queue.pop();
+            }
+        });
+        for (uint64_t i = 0; i < n; ++i) {
+            queue.push(i);
+        }
+        consumer.join();
+    });
+
+    // 4 producteurs, 4 consommateurs
+    runner.run("boundedqueue/mpmc_4x4", [](uint64_t n) {
+        const unsigned kThreads = 4;
+        BoundedQueue<uint64_t> queue(1024);
+        uint64_t per_thread = n / kThreads + 1;
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&] {
+                for (uint64_t i = 0; i < per_thread; ++i) {
+                    queue.push(i);
+                }
+            });
+            threads.emplace_back([&] {
+                for (uint64_t i = 0; i < per_thread; ++i) {
+                    queue.pop();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    });
+
+    // Tâches minuscules: mesure le coût d'ordonnancement du pool
+    {
+        ThreadPool pool(4);
+        runner.run("threadpool/enqueue_tiny_tasks", [&](uint64_t n) {
+            std::atomic<uint64_t> done(0);
+            for (uint64_t i = 0; i < n; ++i) {
+                pool.enqueue([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+            }
+            while (done.load(std::memory_order_acquire) < n) {
+                std::this_thread::yield();
+            }
+        });
+        runner.run("threadpool/submit_future", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                bench::doNotOptimize(pool.submit([i] { return i * 2; }).get());
+            }
+        });
+
+        // Découpage d'une frame 1080p ligne par ligne
+        std::vector<uint32_t> frame(1920 * 1080, 0x00ff8040);
+        runner.run("threadpool/parallel_for_1080p_rows", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                pool.parallel_for(0, 1080, [&](size_t begin, size_t end) {
+                    for (size_t row = begin; row < end; ++row) {
+                        uint32_t* line = frame.data() + row * 1920;
+                        for (size_t col = 0; col < 1920; ++col) {
+                            line[col] ^= 0x00010101;
+                        }
+                    }
+                });
+            }
+        }, frame.size() * sizeof(uint32_t));
+    }
+
+    return runner.finish();
+}
@@ -34,6 +34,13 @@
     #define closesocket close
 #endif
 
+// send() sur un pair déjà parti: erreur EPIPE plutôt que SIGPIPE (qui tue le processus)
+#ifdef MSG_NOSIGNAL
+    #define SEND_FLAGS MSG_NOSIGNAL
+#else
+    #define SEND_FLAGS 0
+#endif
+
 // SDL2 optionnel (seulement pour le client)
 #ifdef USE_SDL
 #include <SDL2/SDL.h>
@@ -53,6 +60,10 @@ namespace Config {
     constexpr uint16_t DEFAULT_PORT = 9999;
     constexpr int DEFAULT_FPS = 30;
     constexpr int DEFAULT_JPEG_QUALITY = 80;
+    // Qualité nominale d'une tuile LOSSY_RECT (RGB565), sur l'échelle de jpeg_quality
+    constexpr int LOSSY_TILE_QUALITY = 50;
+    // Plancher hors zone d'intérêt: par défaut le texte n'est jamais dégradé
+    constexpr int DEFAULT_ROI_MIN_QUALITY = 100;
     constexpr int DEFAULT_AUDIO_SAMPLE_RATE = 44100;
     constexpr int MAX_CLIENTS = 10;
     constexpr size_t MAX_PACKET_SIZE = 65536;
@@ -67,7 +78,15 @@ enum class PacketType : uint8_t {
     DISCONNECT = 0x04,
     CONFIG = 0x05,
     HEARTBEAT = 0x06,
-    ACK = 0x07
+    ACK = 0x07,
+    LATENCY_REPORT = 0x08,
+    STREAM_LIST = 0x09,             // serveur -> client: flux vidéo disponibles
+    SUBSCRIBE = 0x0A,               // client -> serveur: flux vidéo voulus
+    CURSOR = 0x0B,                  // serveur -> client: position du pointeur
+    CURSOR_SHAPE = 0x0C,            // serveur -> client: image d'un curseur
+    FRAME_UPDATE = 0x0D,            // serveur -> client: frame relative à la précédente
+    REFRESH = 0x0E,                 // client -> serveur: prochaine frame complète (resynchronisation)
+    FRAME_REPEAT = 0x0F             // serveur -> client: frame identique à la précédente
 };
 
 // En-tête de paquet
@@ -86,6 +105,17 @@ struct PacketHeader {
 constexpr uint32_t MAGIC_NUMBER = 0x5343524E;
 constexpr uint8_t PROTOCOL_VERSION = 1;
 
+// Format des pixels d'une VIDEO_FRAME brute, dans les bits 0-1 de
+// PacketHeader::flags. Choisi par chaque client (StreamConfig::pixel_format,
+// paquet CONFIG): RGB24 et RGB565 ne transmettent pas l'alpha, toujours opaque.
+enum class PixelFormat : uint8_t {
+    ARGB8888 = 0,                   // octets A, R, G, B
+    RGB24 = 1,                      // octets R, G, B
+    RGB565 = 2                      // uint16_t little-endian, rouge en poids fort
+};
+
+constexpr uint16_t FRAME_FLAG_FORMAT_MASK = 0x0003;
+
 // Structure pour une frame vidéo
 struct VideoFrame {
     uint32_t frame_number;
@@ -93,9 +123,147 @@ struct VideoFrame {
     uint16_t height;
     uint8_t quality;
     std::vector<uint8_t> data;
+    uint64_t timestamp;             // début de capture, get_monotonic_us()
+    uint8_t stream_id = 0;          // un flux par moniteur, 0 = principal
+    PixelFormat format = PixelFormat::ARGB8888;  // data telle que reçue; ARGB8888 à la capture
+};
+
+// En-tête d'un paquet VIDEO_FRAME, suivi des pixels. Alignement naturel
+// (24 octets): stream_id occupe l'ancien octet de bourrage, donc 0 pour
+// les serveurs qui ne connaissent qu'un flux.
+struct VideoFrameHeader {
+    uint32_t frame_number;
+    uint16_t width;
+    uint16_t height;
+    uint8_t quality;
+    uint8_t stream_id;
     uint64_t timestamp;
 };
 
+// Mise à jour incrémentale (FRAME_UPDATE): FrameUpdateHeader puis
+// command_count commandes, appliquées dans l'ordre au framebuffer du client.
+// Celui-ci doit contenir la frame base_frame_number du flux, dans le format
+// des flags (PixelFormat, comme VIDEO_FRAME); sinon la mise à jour est
+// ignorée. COPY_RECT déplace une zone du framebuffer (défilement détecté par
+// le serveur), RAW_RECT est suivi de width * height pixels. Seulement pour
+// les clients annonçant CAPABILITY_FRAME_UPDATE.
+//
+// Avec CAPABILITY_TILE_CACHE, les tuiles de la grille TileCache::kTileSize
+// sont suivies d'un hachage uint64_t de leur contenu: CACHE_TILE porte aussi
+// les pixels, que le client garde dans son cache; CACHED_TILE réutilise une
+// tuile de ce cache. Une VIDEO_FRAME vide le cache des deux côtés.
+//
+// Avec CAPABILITY_LOSSY_TILES, les tuiles classées image naturelle ou
+// mouvement (TileClassifier) arrivent en LOSSY_RECT: pixels RGB565 quel que
+// soit le format du flux, à convertir dans celui du framebuffer. Le texte et
+// l'interface restent exacts, sauf hors de la zone d'intérêt quand
+// StreamConfig::roi_min_quality le permet: ces tuiles arrivent en
+// CACHE_LOSSY_TILE, gardées en cache sous TileCache::lossyKey() (une
+// CACHED_TILE peut donc reprendre leur version RGB565).
+enum class UpdateCommandType : uint8_t {
+    COPY_RECT = 1,                  // (src_x, src_y) -> (x, y), taille width x height
+    RAW_RECT = 2,                   // pixels de (x, y, width, height), ligne par ligne
+    CACHED_TILE = 3,                // hachage: tuile déjà dans le cache du client
+    CACHE_TILE = 4,                 // hachage puis pixels, à garder dans le cache
+    LOSSY_RECT = 5,                 // pixels RGB565, jamais mis en cache
+    CACHE_LOSSY_TILE = 6            // hachage puis pixels RGB565, à garder dans le cache
+};
+
+#pragma pack(push, 1)
+struct FrameUpdateHeader {
+    uint32_t frame_number;
+    uint32_t base_frame_number;     // frame à laquelle s'appliquent les commandes
+    uint16_t width;
+    uint16_t height;
+    uint8_t quality;
+    uint8_t stream_id;
+    uint16_t command_count;
+    uint64_t timestamp;             // début de capture, get_monotonic_us()
+};
+
+struct UpdateCommand {
+    uint8_t type;                   // UpdateCommandType
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint16_t src_x;                 // COPY_RECT seulement
+    uint16_t src_y;
+};
+#pragma pack(pop)
+
+// Frame capturée identique à la précédente (FRAME_REPEAT): aucun pixel, le
+// client réaffiche son framebuffer sous le nouveau numéro et horodatage,
+// pour que sa latence capture -> affichage reste mesurée. La frame de base
+// ne change pas: les FRAME_UPDATE suivants s'appliquent toujours à
+// base_frame_number. Seulement pour les clients annonçant
+// CAPABILITY_FRAME_REPEAT et qui ont déjà cette frame.
+#pragma pack(push, 1)
+struct FrameRepeat {
+    uint32_t frame_number;
+    uint32_t base_frame_number;     // frame affichée par le client
+    uint64_t timestamp;             // début de capture, get_monotonic_us()
+    uint8_t quality;
+    uint8_t stream_id;
+};
+#pragma pack(pop)
+
+// Flux vidéo proposés par le serveur (paquet STREAM_LIST: uint8_t count
+// puis count StreamInfo). Un client qui ne s'abonne pas reçoit le flux 0.
+constexpr size_t MAX_VIDEO_STREAMS = 32;
+
+#pragma pack(push, 1)
+struct StreamInfo {
+    uint8_t stream_id;
+    uint8_t primary;
+    int16_t x;                      // position dans l'écran X
+    int16_t y;
+    uint16_t width;
+    uint16_t height;
+    char name[32];                  // nom de la sortie RandR ("DP-1", ...)
+};
+
+struct SubscribeRequest {
+    uint32_t stream_mask;           // bit i = flux i
+};
+#pragma pack(pop)
+
+// Curseur hors des frames vidéo (XFixes): un déplacement du pointeur ne
+// produit plus de frame. La forme n'est envoyée qu'une fois par numéro de
+// série (CURSOR_SHAPE: CursorShapeHeader puis width * height ARGB8888,
+// alpha prémultiplié); CURSOR ne porte que la position et le numéro de la
+// forme courante. Coordonnées dans l'écran X (StreamInfo::x/y pour un
+// moniteur). Seulement pour les clients annonçant CAPABILITY_CURSOR.
+#pragma pack(push, 1)
+struct CursorPosition {
+    int16_t x;                      // pointeur (point chaud)
+    int16_t y;
+    uint32_t shape_serial;
+    uint8_t visible;                // 0: pointeur hors de l'écran capturé
+    uint64_t timestamp;             // get_monotonic_us()
+};
+
+struct CursorShapeHeader {
+    uint32_t serial;
+    uint16_t width;
+    uint16_t height;
+    uint16_t xhot;
+    uint16_t yhot;
+};
+#pragma pack(pop)
+
+constexpr uint16_t MAX_CURSOR_SIZE = 256;
+
+// Forme de curseur décodée
+struct CursorImage {
+    uint32_t serial = 0;
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint16_t xhot = 0;
+    uint16_t yhot = 0;
+    std::vector<uint8_t> pixels;    // ARGB8888 prémultiplié
+};
+
 // Structure pour une frame audio
 struct AudioFrame {
     uint32_t frame_number;
@@ -106,29 +274,79 @@ struct AudioFrame {
 };
 
 // Structure pour handshake
+constexpr uint8_t CAPABILITY_VIDEO = 0x01;
+constexpr uint8_t CAPABILITY_AUDIO = 0x02;
+constexpr uint8_t CAPABILITY_CURSOR = 0x04;    // CURSOR / CURSOR_SHAPE compris
+constexpr uint8_t CAPABILITY_FRAME_UPDATE = 0x08;  // FRAME_UPDATE compris
+constexpr uint8_t CAPABILITY_TILE_CACHE = 0x10;    // CACHED_TILE / CACHE_TILE compris
+constexpr uint8_t CAPABILITY_LOSSY_TILES = 0x20;   // LOSSY_RECT accepté
+constexpr uint8_t CAPABILITY_FRAME_REPEAT = 0x40;  // FRAME_REPEAT compris
+
+// tile_cache_blocks occupe l'ancien octet de bourrage de chaque structure:
+// taille du cache de tuiles en blocs de TileCache::kBlockTiles, demandée
+// par le client (avec CAPABILITY_TILE_CACHE) puis accordée par le serveur
 struct HandshakeRequest {
     char client_name[64];
     uint8_t capabilities;
+    uint8_t tile_cache_blocks;
     uint16_t max_width;
     uint16_t max_height;
 };
 
 struct HandshakeResponse {
     uint8_t accepted;
+    uint8_t tile_cache_blocks;
     uint16_t assigned_id;
     char server_info[128];
 };
 
+static_assert(sizeof(HandshakeRequest) == 70, "HandshakeRequest layout is part of the HANDSHAKE packet");
+static_assert(sizeof(HandshakeResponse) == 132, "HandshakeResponse layout is part of the HANDSHAKE packet");
+
+// Synchronisation d'horloge (NTP simplifié) sur l'échange HEARTBEAT/ACK.
+// Horloges monotones (get_monotonic_us) de chaque côté. Un HEARTBEAT ou un
+// ACK sans payload reste valide (anciens pairs).
+#pragma pack(push, 1)
+struct ClockSyncRequest {
+    uint64_t client_send_us;        // t0
+};
+
+struct ClockSyncResponse {
+    uint64_t client_send_us;        // t0, renvoyé tel quel
+    uint64_t server_receive_us;     // t1
+    uint64_t server_send_us;        // t2
+};
+
+// Latence capture -> affichage mesurée par le client sur la dernière période
+struct LatencyReport {
+    uint32_t sample_count;
+    uint32_t p50_us;
+    uint32_t p90_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+    int64_t clock_offset_us;        // horloge serveur - horloge client
+    uint32_t rtt_us;
+};
+#pragma pack(pop)
+
 // Structure pour configuration
 struct StreamConfig {
     uint16_t fps;
     uint8_t jpeg_quality;
+    // Qualité minimale des tuiles hors zone d'intérêt (pointeur, fenêtre
+    // active): à Config::LOSSY_TILE_QUALITY ou moins, le texte y passe aussi
+    // en LOSSY_RECT (avec CAPABILITY_LOSSY_TILES)
+    uint8_t roi_min_quality;
     uint16_t audio_sample_rate;
     uint8_t audio_channels;
     uint8_t enable_audio;
     uint8_t enable_video;
+    uint8_t pixel_format;           // PixelFormat des frames pour ce client
 };
 
+// pixel_format et roi_min_quality occupent les anciens octets de bourrage
+static_assert(sizeof(StreamConfig) == 10, "StreamConfig layout is part of the CONFIG packet");
+
 // Utilitaires de temps
 inline uint64_t get_timestamp_us() {
     using namespace std::chrono;
@@ -137,6 +355,14 @@ inline uint64_t get_timestamp_us() {
     ).count();
 }
 
+// Horloge monotone: pour les durées et les horodatages de capture des frames
+inline uint64_t get_monotonic_us() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(
+        steady_clock::now().time_since_epoch()
+    ).count();
+}
+
 // Initialisation des sockets (Windows)
 class SocketInitializer {
 public:
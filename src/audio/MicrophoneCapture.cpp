@@ -9,19 +9,18 @@ MicrophoneCapture::MicrophoneCapture()
     // Initialize SDL Audio subsystem if not already done
     if (SDL_WasInit(SDL_INIT_AUDIO) == 0) {
         if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
-            std::string msg = "Failed to initialize SDL Audio: " + std::string(SDL_GetError());
-            Logger::log(Logger::LogLevel::WARN, msg);
+            LOG_WARN("Failed to initialize SDL Audio: {}", SDL_GetError());
         }
     }
     
-    Logger::log(Logger::LogLevel::INFO, "MicrophoneCapture created");
+    LOG_INFO("MicrophoneCapture created");
 }
 
 MicrophoneCapture::~MicrophoneCapture() {
     if (isCapturing) {
         stopCapture();
     }
-    Logger::log(Logger::LogLevel::INFO, "MicrophoneCapture destroyed");
+    LOG_INFO("MicrophoneCapture destroyed");
 }
 
 void MicrophoneCapture::audioCallbackWrapper(void* userdata, Uint8* stream, int len) {
@@ -41,7 +40,7 @@ void MicrophoneCapture::processAudioData(const Uint8* stream, int len) {
 
 bool MicrophoneCapture::startCapture(const std::function<void(const void*, size_t)>& audioCallback) {
     if (isCapturing) {
-        Logger::log(Logger::LogLevel::WARN, "Microphone capture already started");
+        LOG_WARN("Microphone capture already started");
         return false;
     }
 
@@ -66,38 +65,34 @@ bool MicrophoneCapture::startCapture(const std::function<void(const void*, size_
     );
 
     if (deviceID == 0) {
-        std::string msg = "Failed to open audio device: " + std::string(SDL_GetError());
-        Logger::log(Logger::LogLevel::WARN, msg);
+        LOG_WARN("Failed to open audio device: {}", SDL_GetError());
         return false;
     }
 
     // Log obtained audio specs
-    std::string msg = "Audio device opened - Freq: " + std::to_string(obtainedSpec.freq) +
-                     " Hz, Channels: " + std::to_string(obtainedSpec.channels) +
-                     ", Format: " + std::to_string(obtainedSpec.format) +
-                     ", Samples: " + std::to_string(obtainedSpec.samples);
-    Logger::log(Logger::LogLevel::INFO, msg);
+    LOG_INFO("Audio device opened - Freq: {} Hz, Channels: {}, Format: {}, Samples: {}",
+             obtainedSpec.freq, (int)obtainedSpec.channels, obtainedSpec.format, obtainedSpec.samples);
 
     // Check if we need to request microphone permission (platform specific)
 #ifdef __ANDROID__
     // On Android, you would need to request RECORD_AUDIO permission
-    Logger::log(Logger::LogLevel::INFO, "Note: Microphone permission should be requested on Android");
+    LOG_INFO("Note: Microphone permission should be requested on Android");
 #elif defined(__APPLE__)
     // On macOS/iOS, system will automatically prompt for microphone access
-    Logger::log(Logger::LogLevel::INFO, "System will prompt for microphone access");
+    LOG_INFO("System will prompt for microphone access");
 #endif
 
     // Start audio capture
     SDL_PauseAudioDevice(deviceID, 0);  // 0 = unpause (start)
     isCapturing = true;
 
-    Logger::log(Logger::LogLevel::INFO, "Microphone capture started successfully");
+    LOG_INFO("Microphone capture started successfully");
     return true;
 }
 
 void MicrophoneCapture::stopCapture() {
     if (!isCapturing) {
-        Logger::log(Logger::LogLevel::WARN, "Microphone capture not running");
+        LOG_WARN("Microphone capture not running");
         return;
     }
 
@@ -114,5 +109,5 @@ void MicrophoneCapture::stopCapture() {
         userCallback = nullptr;
     }
 
-    Logger::log(Logger::LogLevel::INFO, "Microphone capture stopped");
+    LOG_INFO("Microphone capture stopped");
 }
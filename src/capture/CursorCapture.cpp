@@ -0,0 +1,172 @@
+#include "CursorCapture.h"
+#include "../utils/Logger.h"
+#include "X11ErrorTrap.h"
+#include <algorithm>
+
+#if defined(__linux__) && defined(HAVE_XFIXES)
+#include <X11/extensions/Xfixes.h>
+#endif
+
+CursorCapture::CursorCapture()
+    : initialized_(false)
+    , last_error_("Not initialized")
+#ifdef __linux__
+    , display_(nullptr)
+    , root_window_(0)
+    , origin_window_(0)
+    , xfixes_event_base_(0)
+    , shape_changed_(true)
+    , shape_serial_(0)
+#endif
+{
+}
+
+CursorCapture::~CursorCapture() {
+#ifdef __linux__
+    if (display_) {
+        XCloseDisplay(display_);
+        display_ = nullptr;
+    }
+#endif
+}
+
+bool CursorCapture::init() {
+#if defined(__linux__) && defined(HAVE_XFIXES)
+    display_ = XOpenDisplay(nullptr);
+    if (!display_) {
+        last_error_ = "Failed to open X display";
+        LOG_ERROR(last_error_);
+        return false;
+    }
+    root_window_ = DefaultRootWindow(display_);
+    X11ErrorTrap::install();
+    if (!origin_window_) {
+        origin_window_ = root_window_;
+    }
+
+    int error_base = 0;
+    int major = 0;
+    int minor = 0;
+    if (!XFixesQueryExtension(display_, &xfixes_event_base_, &error_base) ||
+        !XFixesQueryVersion(display_, &major, &minor) || major < 2) {
+        last_error_ = "XFixes 2.0 not available";
+        LOG_WARN(last_error_);
+        XCloseDisplay(display_);
+        display_ = nullptr;
+        return false;
+    }
+
+    // Un événement à chaque changement de forme, plutôt que relire l'image
+    XFixesSelectCursorInput(display_, root_window_, XFixesDisplayCursorNotifyMask);
+    shape_changed_ = true;
+
+    LOG_INFO("XFixes cursor capture initialized (XFixes {}.{})", major, minor);
+    initialized_ = true;
+    return true;
+
+#elif defined(__linux__)
+    last_error_ = "Built without XFixes, cursor not captured";
+    LOG_WARN(last_error_);
+    return false;
+
+#else
+    last_error_ = "Cursor capture not implemented for this platform";
+    LOG_WARN(last_error_);
+    return false;
+#endif
+}
+
+void CursorCapture::setWindow(unsigned long xid) {
+#ifdef __linux__
+    origin_window_ = static_cast<Window>(xid);
+#else
+    (void)xid;
+#endif
+}
+
+bool CursorCapture::poll(CursorPosition& position, std::shared_ptr<const CursorImage>& shape) {
+    shape.reset();
+    if (!initialized_) {
+        last_error_ = "Cursor capture not initialized";
+        return false;
+    }
+
+#if defined(__linux__) && defined(HAVE_XFIXES)
+    // Seuls les événements déjà reçus: pas d'aller-retour
+    while (XEventsQueued(display_, QueuedAfterReading) > 0) {
+        XEvent event;
+        XNextEvent(display_, &event);
+        if (event.type == xfixes_event_base_ + XFixesCursorNotify) {
+            shape_changed_ = true;
+        }
+    }
+
+    position.timestamp = get_monotonic_us();
+
+    // Fenêtre capturée détruite: BadWindow ne doit pas terminer le processus
+    X11ErrorTrap::begin(display_);
+
+    if (shape_changed_) {
+        XFixesCursorImage* image = XFixesGetCursorImage(display_);
+        if (!image) {
+            X11ErrorTrap::end();
+            last_error_ = "XFixesGetCursorImage failed";
+            return false;
+        }
+        shape_changed_ = false;
+
+        uint32_t serial = static_cast<uint32_t>(image->cursor_serial);
+        if (serial != shape_serial_) {
+            auto cursor = std::make_shared<CursorImage>();
+            cursor->serial = serial;
+            cursor->width = std::min<uint16_t>(image->width, MAX_CURSOR_SIZE);
+            cursor->height = std::min<uint16_t>(image->height, MAX_CURSOR_SIZE);
+            cursor->xhot = std::min<uint16_t>(image->xhot, cursor->width);
+            cursor->yhot = std::min<uint16_t>(image->yhot, cursor->height);
+            cursor->pixels.resize(static_cast<size_t>(cursor->width) * cursor->height * 4);
+
+            // XFixes: un unsigned long par pixel (ARGB prémultiplié sur 32 bits)
+            uint8_t* out = cursor->pixels.data();
+            for (int row = 0; row < cursor->height; ++row) {
+                const unsigned long* in = image->pixels + static_cast<size_t>(row) * image->width;
+                for (int col = 0; col < cursor->width; ++col, out += 4) {
+                    uint32_t pixel = static_cast<uint32_t>(in[col]);
+                    out[0] = static_cast<uint8_t>(pixel >> 24);
+                    out[1] = static_cast<uint8_t>(pixel >> 16);
+                    out[2] = static_cast<uint8_t>(pixel >> 8);
+                    out[3] = static_cast<uint8_t>(pixel);
+                }
+            }
+            shape_serial_ = serial;
+            shape = cursor;
+        }
+        XFree(image);
+    }
+
+    // Position dans le repère de origin_window_ (win_x / win_y)
+    Window root_return = 0;
+    Window child_return = 0;
+    int root_x = 0;
+    int root_y = 0;
+    int window_x = 0;
+    int window_y = 0;
+    unsigned int mask = 0;
+    // False: pointeur sur un autre écran X
+    Bool same_screen = XQueryPointer(display_, origin_window_, &root_return, &child_return,
+                                     &root_x, &root_y, &window_x, &window_y, &mask);
+    if (!X11ErrorTrap::end()) {
+        last_error_ = std::string("XQueryPointer failed: ") + X11ErrorTrap::errorMessage();
+        return false;
+    }
+    position.x = static_cast<int16_t>(window_x);
+    position.y = static_cast<int16_t>(window_y);
+    position.visible = same_screen ? 1 : 0;
+    position.shape_serial = shape_serial_;
+    return true;
+
+#else
+    (void)position;
+    last_error_ = "Cursor capture not available";
+    return false;
+#endif
+}
@@ -0,0 +1,61 @@
+#ifndef CURSORCAPTURE_H
+#define CURSORCAPTURE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "common.h"
+
+#ifdef __linux__
+#include <X11/Xlib.h>
+#endif
+
+/**
+ * Pointer position and shape through XFixes, for the CURSOR stream
+ *
+ * XGetImage never includes the cursor; instead of drawing it into frames
+ * (and sending a frame on every mouse move), the position is polled and
+ * the shape read only after an XFixesCursorNotify. Uses its own X
+ * connection, so it can run on its own thread. Requires HAVE_XFIXES.
+ */
+class CursorCapture {
+public:
+    CursorCapture();
+    ~CursorCapture();
+
+    bool init();
+
+    /**
+     * Report positions relative to this window (window capture) instead of
+     * the root window
+     */
+    void setWindow(unsigned long xid);
+
+    /**
+     * Read the current pointer state (one round trip, two after a shape change)
+     * @param position Output: coordinates (root, or setWindow()'s window),
+     *        visibility, current shape serial
+     * @param shape Output: the new image if the shape changed since the
+     *        previous call, nullptr otherwise
+     * @return false on error
+     */
+    bool poll(CursorPosition& position, std::shared_ptr<const CursorImage>& shape);
+
+    bool isInitialized() const { return initialized_; }
+    std::string getLastError() const { return last_error_; }
+
+private:
+    bool initialized_;
+    std::string last_error_;
+
+#ifdef __linux__
+    Display* display_;
+    Window root_window_;
+    Window origin_window_;     // repère des positions: racine ou fenêtre capturée
+    int xfixes_event_base_;
+    bool shape_changed_;       // XFixesCursorNotify reçu, forme à relire
+    uint32_t shape_serial_;
+#endif
+};
+
+#endif // CURSORCAPTURE_H
@@ -0,0 +1,94 @@
+#include "FileReplaySource.h"
+#include "../utils/Logger.h"
+
+FileReplaySource::FileReplaySource(const std::string& path, int width, int height, bool loop)
+    : path_(path)
+    , width_(width)
+    , height_(height)
+    , loop_(loop)
+    , frame_bytes_(0)
+    , frame_count_(0)
+    , next_frame_(0)
+    , initialized_(false)
+    , last_error_("Not initialized") {
+}
+
+bool FileReplaySource::init() {
+    if (width_ <= 0 || height_ <= 0) {
+        last_error_ = "Invalid replay frame size: " + std::to_string(width_) + "x" + std::to_string(height_);
+        LOG_ERROR(last_error_);
+        return false;
+    }
+    frame_bytes_ = static_cast<size_t>(width_) * height_ * 4;
+
+    file_.open(path_, std::ios::binary | std::ios::ate);
+    if (!file_) {
+        last_error_ = "Cannot open replay file " + path_;
+        LOG_ERROR(last_error_);
+        return false;
+    }
+
+    std::streamoff size = file_.tellg();
+    if (size <= 0 || static_cast<uint64_t>(size) % frame_bytes_ != 0) {
+        last_error_ = "Replay file " + path_ + " (" + std::to_string(size) + " bytes) is not a whole number of "
+                      + std::to_string(width_) + "x" + std::to_string(height_) + " ARGB frames";
+        LOG_ERROR(last_error_);
+        file_.close();
+        return false;
+    }
+
+    frame_count_ = static_cast<uint64_t>(size) / frame_bytes_;
+    rewind();
+
+    LOG_INFO("Replay source initialized: {} ({} frames of {}x{})", path_, frame_count_, width_, height_);
+    initialized_ = true;
+    return true;
+}
+
+std::vector<uint8_t> FileReplaySource::captureFrame(int& width, int& height) {
+    if (!initialized_) {
+        last_error_ = "Replay source not initialized";
+        return std::vector<uint8_t>();
+    }
+
+    if (next_frame_ >= frame_count_) {
+        if (!loop_) {
+            last_error_ = "End of replay file";
+            return std::vector<uint8_t>();
+        }
+        rewind();
+    }
+
+    std::vector<uint8_t> pixels(frame_bytes_);
+    if (!file_.read(reinterpret_cast<char*>(pixels.data()), static_cast<std::streamsize>(frame_bytes_))) {
+        last_error_ = "Failed to read frame " + std::to_string(next_frame_) + " from " + path_;
+        LOG_WARN(last_error_);
+        return std::vector<uint8_t>();
+    }
+    ++next_frame_;
+
+    width = width_;
+    height = height_;
+    return pixels;
+}
+
+bool FileReplaySource::getScreenDimensions(int& width, int& height) {
+    width = width_;
+    height = height_;
+    return true;
+}
+
+void FileReplaySource::rewind() {
+    file_.clear();
+    file_.seekg(0, std::ios::beg);
+    next_frame_ = 0;
+}
+
+bool FileReplaySource::appendFrame(const std::string& path, const std::vector<uint8_t>& pixels) {
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    if (!out) {
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+    return static_cast<bool>(out);
+}
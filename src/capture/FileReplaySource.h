@@ -0,0 +1,51 @@
+#ifndef FILEREPLAYSOURCE_H
+#define FILEREPLAYSOURCE_H
+
+#include "FrameSource.h"
+#include <fstream>
+
+/**
+ * Replays raw ARGB8888 frames stored back to back in a file
+ *
+ * No header: the frame size is given by the caller and the file length
+ * must be a multiple of width * height * 4. Such a file can be produced
+ * from any video with
+ *     ffmpeg -i input.mp4 -s 1280x720 -pix_fmt argb -f rawvideo out.raw
+ * or by appending captured frames with appendFrame().
+ */
+class FileReplaySource : public FrameSource {
+public:
+    FileReplaySource(const std::string& path, int width, int height, bool loop = true);
+
+    bool init() override;
+    std::vector<uint8_t> captureFrame(int& width, int& height) override;
+    bool getScreenDimensions(int& width, int& height) override;
+    bool isInitialized() const override { return initialized_; }
+    std::string getLastError() const override { return last_error_; }
+    std::string name() const override { return "replay"; }
+
+    uint64_t frameCount() const { return frame_count_; }
+
+    // Revient à la première frame
+    void rewind();
+
+    /**
+     * Append one ARGB8888 frame to a replay file
+     * @return false if the file cannot be written
+     */
+    static bool appendFrame(const std::string& path, const std::vector<uint8_t>& pixels);
+
+private:
+    std::string path_;
+    int width_;
+    int height_;
+    bool loop_;
+    size_t frame_bytes_;
+    uint64_t frame_count_;
+    uint64_t next_frame_;
+    std::ifstream file_;
+    bool initialized_;
+    std::string last_error_;
+};
+
+#endif // FILEREPLAYSOURCE_H
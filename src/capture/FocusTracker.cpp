@@ -0,0 +1,120 @@
+#include "FocusTracker.h"
+#include "../utils/Logger.h"
+#include "X11ErrorTrap.h"
+
+#ifdef __linux__
+#include <X11/Xatom.h>
+#endif
+
+FocusTracker::FocusTracker()
+    : initialized_(false)
+    , last_error_("Not initialized")
+#ifdef __linux__
+    , display_(nullptr)
+    , root_window_(0)
+    , origin_window_(0)
+    , active_window_atom_(None)
+#endif
+{
+}
+
+FocusTracker::~FocusTracker() {
+#ifdef __linux__
+    if (display_) {
+        XCloseDisplay(display_);
+        display_ = nullptr;
+    }
+#endif
+}
+
+bool FocusTracker::init() {
+#ifdef __linux__
+    display_ = XOpenDisplay(nullptr);
+    if (!display_) {
+        last_error_ = "Failed to open X display";
+        LOG_ERROR(last_error_);
+        return false;
+    }
+    root_window_ = DefaultRootWindow(display_);
+    X11ErrorTrap::install();
+    if (!origin_window_) {
+        origin_window_ = root_window_;
+    }
+
+    // Sans gestionnaire de fenêtres EWMH, l'atome n'existe pas
+    active_window_atom_ = XInternAtom(display_, "_NET_ACTIVE_WINDOW", True);
+    if (active_window_atom_ == None) {
+        last_error_ = "No EWMH window manager (_NET_ACTIVE_WINDOW missing)";
+        LOG_WARN(last_error_);
+        XCloseDisplay(display_);
+        display_ = nullptr;
+        return false;
+    }
+
+    LOG_INFO("Focused window tracking initialized");
+    initialized_ = true;
+    return true;
+
+#else
+    last_error_ = "Focus tracking not implemented for this platform";
+    LOG_WARN(last_error_);
+    return false;
+#endif
+}
+
+void FocusTracker::setWindow(unsigned long xid) {
+#ifdef __linux__
+    origin_window_ = static_cast<Window>(xid);
+#else
+    (void)xid;
+#endif
+}
+
+bool FocusTracker::poll(int& x, int& y, int& width, int& height) {
+    if (!initialized_) {
+        last_error_ = "Focus tracker not initialized";
+        return false;
+    }
+
+#ifdef __linux__
+    Atom type = None;
+    int format = 0;
+    unsigned long count = 0;
+    unsigned long remaining = 0;
+    unsigned char* data = nullptr;
+    Window active = 0;
+    if (XGetWindowProperty(display_, root_window_, active_window_atom_, 0, 1, False, XA_WINDOW,
+                           &type, &format, &count, &remaining, &data) == Success && data) {
+        if (type == XA_WINDOW && format == 32 && count == 1) {
+            active = static_cast<Window>(*reinterpret_cast<unsigned long*>(data));
+        }
+        XFree(data);
+    }
+    if (!active) {
+        last_error_ = "No focused window";
+        return false;
+    }
+
+    // Fenêtre fermée entre les deux requêtes: BadWindow piégée
+    X11ErrorTrap::begin(display_);
+    XWindowAttributes attributes;
+    Status status = XGetWindowAttributes(display_, active, &attributes);
+    Window child = 0;
+    Bool translated = status && XTranslateCoordinates(display_, active, origin_window_, 0, 0, &x, &y, &child);
+    if (!X11ErrorTrap::end() || !translated || attributes.map_state != IsViewable) {
+        last_error_ = "Focused window not viewable";
+        return false;
+    }
+    width = attributes.width;
+    height = attributes.height;
+    return true;
+
+#else
+    (void)x;
+    (void)y;
+    (void)width;
+    (void)height;
+    last_error_ = "Focus tracking not available";
+    return false;
+#endif
+}
@@ -0,0 +1,50 @@
+#ifndef FOCUSTRACKER_H
+#define FOCUSTRACKER_H
+
+#include <string>
+
+#ifdef __linux__
+#include <X11/Xlib.h>
+#endif
+
+/**
+ * Rectangle of the focused window, for the stream's region of interest
+ *
+ * Reads _NET_ACTIVE_WINDOW, which EWMH window managers keep on the root
+ * window, then the window's size and position in the same coordinates as
+ * CursorCapture (root, or the captured window). Without an EWMH window
+ * manager there is no focused window. Uses its own X connection, so it can
+ * run on the cursor thread.
+ */
+class FocusTracker {
+public:
+    FocusTracker();
+    ~FocusTracker();
+
+    bool init();
+
+    // Positions relatives à cette fenêtre (capture de fenêtre), comme CursorCapture
+    void setWindow(unsigned long xid);
+
+    /**
+     * Read the focused window (three round trips)
+     * @return false on error or when no window has the focus
+     */
+    bool poll(int& x, int& y, int& width, int& height);
+
+    bool isInitialized() const { return initialized_; }
+    std::string getLastError() const { return last_error_; }
+
+private:
+    bool initialized_;
+    std::string last_error_;
+
+#ifdef __linux__
+    Display* display_;
+    Window root_window_;
+    Window origin_window_;     // repère des positions: racine ou fenêtre capturée
+    Atom active_window_atom_;
+#endif
+};
+
+#endif // FOCUSTRACKER_H
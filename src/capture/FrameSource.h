@@ -0,0 +1,47 @@
+#ifndef FRAMESOURCE_H
+#define FRAMESOURCE_H
+
+#include <vector>
+#include <cstdint>
+#include <string>
+
+/**
+ * Producer of ARGB8888 frames for the capture-to-wire pipeline
+ *
+ * ScreenCapture grabs the live display; SyntheticFrameSource and
+ * FileReplaySource produce deterministic content so that encoder and
+ * network benchmarks run without an X display, at any resolution.
+ */
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    /**
+     * Prepare the source (open the display, the file, ...)
+     * @return true if successful, false otherwise (see getLastError())
+     */
+    virtual bool init() = 0;
+
+    /**
+     * Produce the next frame
+     * @param width Output parameter for frame width
+     * @param height Output parameter for frame height
+     * @return Vector containing ARGB8888 pixel data (4 bytes per pixel)
+     *         Empty vector on failure
+     */
+    virtual std::vector<uint8_t> captureFrame(int& width, int& height) = 0;
+
+    /**
+     * Get the dimensions of the frames produced by captureFrame()
+     * @return true if successful, false otherwise
+     */
+    virtual bool getScreenDimensions(int& width, int& height) = 0;
+
+    virtual bool isInitialized() const = 0;
+    virtual std::string getLastError() const = 0;
+
+    // Nom court pour les logs ("x11", "synthetic:scroll", "replay", ...)
+    virtual std::string name() const = 0;
+};
+
+#endif // FRAMESOURCE_H
@@ -0,0 +1,83 @@
+#include "PixelConverter.h"
+
+namespace {
+    template <SourceFormat S>
+    PixelConvertFn selectFor(DestFormat dest) {
+        switch (dest) {
+            case DestFormat::ARGB8888: return &pixel::convertPacked<S, DestFormat::ARGB8888>;
+            case DestFormat::BGRA8888: return &pixel::convertPacked<S, DestFormat::BGRA8888>;
+            case DestFormat::RGB24:    return &pixel::convertPacked<S, DestFormat::RGB24>;
+            case DestFormat::I420:     return &pixel::convertI420<S>;
+        }
+        return nullptr;
+    }
+}
+
+SourceFormat PixelConverter::detect(int bits_per_pixel, unsigned long red_mask, unsigned long green_mask,
+                                    unsigned long blue_mask, bool lsb_first) {
+    if (!lsb_first) {
+        return SourceFormat::UNKNOWN;
+    }
+
+    bool rgb = red_mask == 0xFF0000 && green_mask == 0x00FF00 && blue_mask == 0x0000FF;
+    bool bgr = red_mask == 0x0000FF && green_mask == 0x00FF00 && blue_mask == 0xFF0000;
+    switch (bits_per_pixel) {
+        case 32:
+            return rgb ? SourceFormat::XRGB8888 : bgr ? SourceFormat::XBGR8888 : SourceFormat::UNKNOWN;
+        case 24:
+            return rgb ? SourceFormat::RGB888 : bgr ? SourceFormat::BGR888 : SourceFormat::UNKNOWN;
+        case 16:
+            return red_mask == 0xF800 && green_mask == 0x07E0 && blue_mask == 0x001F
+                ? SourceFormat::RGB565 : SourceFormat::UNKNOWN;
+        default:
+            return SourceFormat::UNKNOWN;
+    }
+}
+
+PixelConvertFn PixelConverter::select(SourceFormat source, DestFormat dest) {
+    switch (source) {
+        case SourceFormat::XRGB8888: return selectFor<SourceFormat::XRGB8888>(dest);
+        case SourceFormat::XBGR8888: return selectFor<SourceFormat::XBGR8888>(dest);
+        case SourceFormat::RGB888:   return selectFor<SourceFormat::RGB888>(dest);
+        case SourceFormat::BGR888:   return selectFor<SourceFormat::BGR888>(dest);
+        case SourceFormat::RGB565:   return selectFor<SourceFormat::RGB565>(dest);
+        case SourceFormat::UNKNOWN:  break;
+    }
+    return nullptr;
+}
+
+size_t PixelConverter::destinationSize(DestFormat dest, int width, int height) {
+    size_t pixels = static_cast<size_t>(width) * height;
+    switch (dest) {
+        case DestFormat::ARGB8888:
+        case DestFormat::BGRA8888:
+            return pixels * 4;
+        case DestFormat::RGB24:
+            return pixels * 3;
+        case DestFormat::I420:
+            return pixels + 2 * static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+    }
+    return 0;
+}
+
+const char* PixelConverter::name(SourceFormat source) {
+    switch (source) {
+        case SourceFormat::XRGB8888: return "xrgb8888";
+        case SourceFormat::XBGR8888: return "xbgr8888";
+        case SourceFormat::RGB888:   return "rgb888";
+        case SourceFormat::BGR888:   return "bgr888";
+        case SourceFormat::RGB565:   return "rgb565";
+        case SourceFormat::UNKNOWN:  break;
+    }
+    return "unknown";
+}
+
+const char* PixelConverter::name(DestFormat dest) {
+    switch (dest) {
+        case DestFormat::ARGB8888: return "argb8888";
+        case DestFormat::BGRA8888: return "bgra8888";
+        case DestFormat::RGB24:    return "rgb24";
+        case DestFormat::I420:     return "i420";
+    }
+    return "unknown";
+}
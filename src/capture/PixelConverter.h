@@ -0,0 +1,186 @@
+#ifndef PIXELCONVERTER_H
+#define PIXELCONVERTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Pixel format converters specialized at compile time
+ *
+ * Each (source, destination) pair is its own instantiation of a plain row
+ * loop, so the per-pixel code has fixed offsets and no branches; the
+ * function is chosen once (at capture init, from the X visual) with
+ * PixelConverter::select().
+ *
+ * Source formats follow X11 naming (pixel value masks, least significant
+ * byte first in memory):
+ *   XRGB8888  32 bpp, red 0xFF0000  (memory B, G, R, x)
+ *   XBGR8888  32 bpp, red 0x0000FF  (memory R, G, B, x)
+ *   RGB888    24 bpp, red 0xFF0000  (memory B, G, R)
+ *   BGR888    24 bpp, red 0x0000FF  (memory R, G, B)
+ *   RGB565    16 bpp, red 0xF800
+ * Destination formats are named by memory byte order:
+ *   ARGB8888  A, R, G, B (VideoFrame data on the wire)
+ *   BGRA8888  B, G, R, A
+ *   RGB24     R, G, B
+ *   I420      Y plane, then U and V at half resolution (BT.601, limited range)
+ */
+enum class SourceFormat {
+    UNKNOWN,
+    XRGB8888,
+    XBGR8888,
+    RGB888,
+    BGR888,
+    RGB565
+};
+
+enum class DestFormat {
+    ARGB8888,
+    BGRA8888,
+    RGB24,
+    I420
+};
+
+// src_stride en octets; dst sans bourrage (plans contigus pour I420).
+// Conversion sur place possible entre formats 4 octets si src_stride == width * 4
+using PixelConvertFn = void (*)(const uint8_t* src, size_t src_stride, int width, int height, uint8_t* dst);
+
+namespace pixel {
+
+template <SourceFormat S> struct Source;
+
+template <> struct Source<SourceFormat::XRGB8888> {
+    static constexpr int kBytes = 4;
+    static void read(const uint8_t* p, uint8_t& r, uint8_t& g, uint8_t& b) { b = p[0]; g = p[1]; r = p[2]; }
+};
+
+template <> struct Source<SourceFormat::XBGR8888> {
+    static constexpr int kBytes = 4;
+    static void read(const uint8_t* p, uint8_t& r, uint8_t& g, uint8_t& b) { r = p[0]; g = p[1]; b = p[2]; }
+};
+
+template <> struct Source<SourceFormat::RGB888> {
+    static constexpr int kBytes = 3;
+    static void read(const uint8_t* p, uint8_t& r, uint8_t& g, uint8_t& b) { b = p[0]; g = p[1]; r = p[2]; }
+};
+
+template <> struct Source<SourceFormat::BGR888> {
+    static constexpr int kBytes = 3;
+    static void read(const uint8_t* p, uint8_t& r, uint8_t& g, uint8_t& b) { r = p[0]; g = p[1]; b = p[2]; }
+};
+
+template <> struct Source<SourceFormat::RGB565> {
+    static constexpr int kBytes = 2;
+    static void read(const uint8_t* p, uint8_t& r, uint8_t& g, uint8_t& b) {
+        uint32_t v = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8);
+        uint32_t r5 = v >> 11;
+        uint32_t g6 = (v >> 5) & 0x3F;
+        uint32_t b5 = v & 0x1F;
+        // Réplication des bits de poids fort: 0x1F -> 0xFF
+        r = static_cast<uint8_t>((r5 << 3) | (r5 >> 2));
+        g = static_cast<uint8_t>((g6 << 2) | (g6 >> 4));
+        b = static_cast<uint8_t>((b5 << 3) | (b5 >> 2));
+    }
+};
+
+template <DestFormat D> struct Dest;
+
+template <> struct Dest<DestFormat::ARGB8888> {
+    static constexpr int kBytes = 4;
+    static void write(uint8_t* p, uint8_t r, uint8_t g, uint8_t b) { p[0] = 0xFF; p[1] = r; p[2] = g; p[3] = b; }
+};
+
+template <> struct Dest<DestFormat::BGRA8888> {
+    static constexpr int kBytes = 4;
+    static void write(uint8_t* p, uint8_t r, uint8_t g, uint8_t b) { p[0] = b; p[1] = g; p[2] = r; p[3] = 0xFF; }
+};
+
+template <> struct Dest<DestFormat::RGB24> {
+    static constexpr int kBytes = 3;
+    static void write(uint8_t* p, uint8_t r, uint8_t g, uint8_t b) { p[0] = r; p[1] = g; p[2] = b; }
+};
+
+template <SourceFormat S, DestFormat D>
+void convertPacked(const uint8_t* src, size_t src_stride, int width, int height, uint8_t* dst) {
+    for (int row = 0; row < height; ++row) {
+        const uint8_t* in = src + static_cast<size_t>(row) * src_stride;
+        uint8_t* out = dst + static_cast<size_t>(row) * width * Dest<D>::kBytes;
+        for (int col = 0; col < width; ++col) {
+            uint8_t r, g, b;
+            Source<S>::read(in, r, g, b);
+            Dest<D>::write(out, r, g, b);
+            in += Source<S>::kBytes;
+            out += Dest<D>::kBytes;
+        }
+    }
+}
+
+inline uint8_t lumaBT601(int r, int g, int b) {
+    return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+// Chroma d'un bloc 2x2 (sommes de 4 pixels)
+template <SourceFormat S>
+void convertI420(const uint8_t* src, size_t src_stride, int width, int height, uint8_t* dst) {
+    const int chroma_width = (width + 1) / 2;
+    const int chroma_height = (height + 1) / 2;
+    uint8_t* y_plane = dst;
+    uint8_t* u_plane = dst + static_cast<size_t>(width) * height;
+    uint8_t* v_plane = u_plane + static_cast<size_t>(chroma_width) * chroma_height;
+
+    for (int cy = 0; cy < chroma_height; ++cy) {
+        // Dernière ligne impaire: la ligne est répétée
+        int row0 = cy * 2;
+        int row1 = row0 + 1 < height ? row0 + 1 : row0;
+        const uint8_t* in0 = src + static_cast<size_t>(row0) * src_stride;
+        const uint8_t* in1 = src + static_cast<size_t>(row1) * src_stride;
+        uint8_t* y0 = y_plane + static_cast<size_t>(row0) * width;
+        uint8_t* y1 = y_plane + static_cast<size_t>(row1) * width;
+
+        for (int cx = 0; cx < chroma_width; ++cx) {
+            int col0 = cx * 2;
+            int col1 = col0 + 1 < width ? col0 + 1 : col0;
+            uint8_t r[4], g[4], b[4];
+            Source<S>::read(in0 + col0 * Source<S>::kBytes, r[0], g[0], b[0]);
+            Source<S>::read(in0 + col1 * Source<S>::kBytes, r[1], g[1], b[1]);
+            Source<S>::read(in1 + col0 * Source<S>::kBytes, r[2], g[2], b[2]);
+            Source<S>::read(in1 + col1 * Source<S>::kBytes, r[3], g[3], b[3]);
+
+            y0[col0] = lumaBT601(r[0], g[0], b[0]);
+            y0[col1] = lumaBT601(r[1], g[1], b[1]);
+            y1[col0] = lumaBT601(r[2], g[2], b[2]);
+            y1[col1] = lumaBT601(r[3], g[3], b[3]);
+
+            int rs = r[0] + r[1] + r[2] + r[3];
+            int gs = g[0] + g[1] + g[2] + g[3];
+            int bs = b[0] + b[1] + b[2] + b[3];
+            size_t c = static_cast<size_t>(cy) * chroma_width + cx;
+            u_plane[c] = static_cast<uint8_t>(((-38 * rs - 74 * gs + 112 * bs + 512) >> 10) + 128);
+            v_plane[c] = static_cast<uint8_t>(((112 * rs - 94 * gs - 18 * bs + 512) >> 10) + 128);
+        }
+    }
+}
+
+} // namespace pixel
+
+class PixelConverter {
+public:
+    /**
+     * Identify the source format of an image
+     * @param lsb_first Image byte order is LSBFirst
+     * @return UNKNOWN for anything else (palette visuals, 30-bit, MSBFirst...)
+     */
+    static SourceFormat detect(int bits_per_pixel, unsigned long red_mask, unsigned long green_mask,
+                               unsigned long blue_mask, bool lsb_first);
+
+    // Converter for the pair, nullptr if source is UNKNOWN
+    static PixelConvertFn select(SourceFormat source, DestFormat dest);
+
+    // Taille de la sortie de select() pour width x height
+    static size_t destinationSize(DestFormat dest, int width, int height);
+
+    static const char* name(SourceFormat source);
+    static const char* name(DestFormat dest);
+};
+
+#endif // PIXELCONVERTER_H
@@ -1,37 +1,63 @@
 #include "ScreenCapture.h"
 #include "../utils/Logger.h"
+#include "../utils/Metrics.h"
+#include "../utils/FrameTracer.h"
+#include "../utils/Probes.h"
+#include "X11ErrorTrap.h"
+#include <algorithm>
 #include <cstring>
 
-#ifdef __linux__
 namespace {
-    struct X11ErrorState {
-        bool triggered = false;
-        int code = 0;
-        char message[256] = {0};
-    };
-
-    thread_local X11ErrorState g_x11_error_state;
-
-    int ScreenCaptureXErrorHandler(Display* display, XErrorEvent* error_event) {
-        g_x11_error_state.triggered = true;
-        g_x11_error_state.code = error_event->error_code;
-        if (display) {
-            XGetErrorText(display, error_event->error_code, g_x11_error_state.message, sizeof(g_x11_error_state.message));
-        }
-        return 0;
+    uint64_t elapsedMicros(std::chrono::steady_clock::time_point start) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+
+    // Identifiants de fenêtre en hexadécimal, comme xwininfo / xdotool
+    std::string formatXid(unsigned long xid) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "0x%lx", xid);
+        return buffer;
     }
 }
+
+#ifdef __linux__
+#ifdef HAVE_XRANDR
+#include <X11/extensions/Xrandr.h>
+#endif
+#ifdef HAVE_XCOMPOSITE
+#include <X11/extensions/Xcomposite.h>
+#endif
 #elif defined(_WIN32)
     #include <windows.h>
 #endif
 
 ScreenCapture::ScreenCapture() 
     : initialized_(false),
-    last_error_("Not initialized")
+    last_error_("Not initialized"),
+    has_monitor_(false),
+    monitor_lost_(false),
+    has_window_(false),
+    window_id_(0)
 #ifdef __linux__
     , display_(nullptr)
     , root_window_(0)
     , screen_number_(0)
+    , screen_width_(0)
+    , screen_height_(0)
+    , randr_event_base_(-1)
+    , window_width_(0)
+    , window_height_(0)
+    , window_border_(0)
+    , window_destroyed_(false)
+    , window_redirected_(false)
+    , window_pixmap_(0)
+    , frame_round_trips_(0)
+    , convert_fn_(nullptr)
+    , convert_bpp_(0)
+    , red_mask_(0)
+    , green_mask_(0)
+    , blue_mask_(0)
 #elif defined(_WIN32)
     , hdc_screen_(nullptr)
     , hdc_mem_(nullptr)
@@ -69,23 +95,64 @@ bool ScreenCapture::init() {
     display_ = XOpenDisplay(nullptr);
     if (!display_) {
         last_error_ = "Failed to open X display";
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, last_error_);
+        LOG_ERROR(last_error_);
         return false;
     }
 
     screen_number_ = DefaultScreen(display_);
     root_window_ = RootWindow(display_, screen_number_);
 
-    Logger::log(Logger::LogLevel::INFO, "X11 screen capture initialized");
+    X11ErrorTrap::install();
+
+    // Géométrie lue une fois; les changements (RandR, résolution) arrivent
+    // ensuite en ConfigureNotify sur la racine
+    XWindowAttributes attrs;
+    if (!XGetWindowAttributes(display_, root_window_, &attrs)) {
+        last_error_ = "Failed to get root window attributes";
+        LOG_ERROR(last_error_);
+        XCloseDisplay(display_);
+        display_ = nullptr;
+        return false;
+    }
+    screen_width_ = attrs.width;
+    screen_height_ = attrs.height;
+    XSelectInput(display_, root_window_, StructureNotifyMask);
+    selectConverter(attrs.visual, attrs.depth);
+
+#ifdef HAVE_XRANDR
+    // Un moniteur peut changer de mode ou de position sans que la taille de
+    // la racine change (pas de ConfigureNotify): suivre aussi RandR
+    int randr_error_base = 0;
+    if (has_monitor_ && XRRQueryExtension(display_, &randr_event_base_, &randr_error_base)) {
+        XRRSelectInput(display_, root_window_, RRScreenChangeNotifyMask);
+    } else {
+        randr_event_base_ = -1;
+    }
+#endif
+
+    if (has_window_ && !initWindow()) {
+        XCloseDisplay(display_);
+        display_ = nullptr;
+        return false;
+    }
+
+    LOG_INFO("X11 screen capture initialized ({}x{}, depth {})", screen_width_, screen_height_, attrs.depth);
+    frame_round_trips_ = 0;  // ceux de l'initialisation ne comptent pas pour la première frame
     initialized_ = true;
     return true;
 
 #elif defined(_WIN32)
+    if (has_window_) {
+        last_error_ = "Window capture is only implemented for X11";
+        LOG_ERROR(last_error_);
+        return false;
+    }
+
     // Get screen DC
     hdc_screen_ = GetDC(nullptr);
     if (!hdc_screen_) {
         last_error_ = "Failed to get screen DC";
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, last_error_);
+        LOG_ERROR(last_error_);
         return false;
     }
 
@@ -93,33 +160,53 @@ bool ScreenCapture::init() {
     hdc_mem_ = CreateCompatibleDC(static_cast<HDC>(hdc_screen_));
     if (!hdc_mem_) {
         last_error_ = "Failed to create compatible DC";
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, last_error_);
+        LOG_ERROR(last_error_);
         ReleaseDC(nullptr, static_cast<HDC>(hdc_screen_));
         hdc_screen_ = nullptr;
         return false;
     }
 
-    Logger::log(Logger::LogLevel::INFO, "Windows GDI screen capture initialized");
+    LOG_INFO("Windows GDI screen capture initialized");
     initialized_ = true;
     return true;
 
 #else
     last_error_ = "Screen capture not implemented for this platform";
-    Logger::log(Logger::LogLevel::ERROR_LEVEL, last_error_);
+    LOG_ERROR(last_error_);
     return false;
 #endif
 }
 
 bool ScreenCapture::getScreenDimensions(int& width, int& height) {
+#ifdef __linux__
+    if (has_window_ && initialized_) {
+        processWindowEvents();
+        width = window_width_;
+        height = window_height_;
+        return true;
+    }
+#endif
+    if (has_monitor_ && initialized_) {
+#ifdef __linux__
+        processPendingEvents();
+#endif
+        width = monitor_.width;
+        height = monitor_.height;
+        return true;
+    }
+    return getRootDimensions(width, height);
+}
+
+bool ScreenCapture::getRootDimensions(int& width, int& height) {
     if (!initialized_) {
         last_error_ = "Screen capture not initialized";
         return false;
     }
 
 #ifdef __linux__
-    Screen* screen = ScreenOfDisplay(display_, screen_number_);
-    width = WidthOfScreen(screen);
-    height = HeightOfScreen(screen);
+    processPendingEvents();
+    width = screen_width_;
+    height = screen_height_;
     return true;
 
 #elif defined(_WIN32)
@@ -132,27 +219,227 @@ bool ScreenCapture::getScreenDimensions(int& width, int& height) {
 #endif
 }
 
+#ifdef __linux__
+void ScreenCapture::processPendingEvents() {
+    // XCheckTypedWindowEvent ne lit que ce qui est déjà arrivé
+    XEvent event;
+    bool layout_changed = false;
+    while (XCheckTypedWindowEvent(display_, root_window_, ConfigureNotify, &event)) {
+        if (event.xconfigure.width != screen_width_ || event.xconfigure.height != screen_height_) {
+            LOG_INFO("Screen geometry changed: {}x{} -> {}x{}", screen_width_, screen_height_,
+                     event.xconfigure.width, event.xconfigure.height);
+            screen_width_ = event.xconfigure.width;
+            screen_height_ = event.xconfigure.height;
+        }
+        layout_changed = true;
+    }
+#ifdef HAVE_XRANDR
+    if (randr_event_base_ >= 0) {
+        while (XCheckTypedEvent(display_, randr_event_base_ + RRScreenChangeNotify, &event)) {
+            XRRUpdateConfiguration(&event);
+            layout_changed = true;
+        }
+    }
+#endif
+
+    // Requête RandR seulement sur changement, pas à chaque frame
+    if (layout_changed && has_monitor_) {
+        refreshMonitor();
+    }
+}
+
+void ScreenCapture::refreshMonitor() {
+    std::vector<MonitorInfo> monitors;
+    if (!queryRandrMonitors(monitors)) {
+        return;
+    }
+
+    auto it = std::find_if(monitors.begin(), monitors.end(),
+                           [this](const MonitorInfo& m) { return m.name == monitor_.name; });
+    if (it == monitors.end()) {
+        if (!monitor_lost_) {
+            LOG_WARN("Monitor {} is no longer connected, stream stopped", monitor_.name);
+        }
+        monitor_lost_ = true;
+        return;
+    }
+
+    if (monitor_lost_) {
+        LOG_INFO("Monitor {} is connected again", monitor_.name);
+    }
+    monitor_lost_ = false;
+    if (it->x != monitor_.x || it->y != monitor_.y || it->width != monitor_.width || it->height != monitor_.height) {
+        LOG_INFO("Monitor {} changed: {}x{}+{}+{} -> {}x{}+{}+{}", monitor_.name,
+                 monitor_.width, monitor_.height, monitor_.x, monitor_.y,
+                 it->width, it->height, it->x, it->y);
+        monitor_.x = it->x;
+        monitor_.y = it->y;
+        monitor_.width = it->width;
+        monitor_.height = it->height;
+    }
+}
+#endif
+
 std::vector<uint8_t> ScreenCapture::captureScreen(int& width, int& height) {
-    if (!getScreenDimensions(width, height)) {
+    if (!getRootDimensions(width, height)) {
         return std::vector<uint8_t>();
     }
 
     return captureRegion(0, 0, width, height);
 }
 
+std::vector<uint8_t> ScreenCapture::captureFrame(int& width, int& height) {
+#ifdef __linux__
+    if (has_window_) {
+        return captureWindow(width, height);
+    }
+#endif
+    if (!has_monitor_) {
+        return captureScreen(width, height);
+    }
+#ifdef __linux__
+    if (initialized_) {
+        processPendingEvents();
+    }
+#endif
+    if (monitor_lost_) {
+        last_error_ = "Monitor " + monitor_.name + " is no longer connected";
+        return std::vector<uint8_t>();
+    }
+    width = monitor_.width;
+    height = monitor_.height;
+    return captureRegion(monitor_.x, monitor_.y, monitor_.width, monitor_.height);
+}
+
+void ScreenCapture::setMonitor(const MonitorInfo& monitor) {
+    monitor_ = monitor;
+    has_monitor_ = true;
+}
+
+void ScreenCapture::setWindow(unsigned long xid) {
+    window_id_ = xid;
+    window_title_.clear();
+    has_window_ = true;
+}
+
+void ScreenCapture::setWindowTitle(const std::string& title) {
+    window_id_ = 0;
+    window_title_ = title;
+    has_window_ = true;
+}
+
+std::string ScreenCapture::name() const {
+    if (has_window_) {
+        return "window:" + (window_id_ ? formatXid(window_id_) : window_title_);
+    }
+    return has_monitor_ ? "screen:" + monitor_.name : "screen";
+}
+
+std::vector<MonitorInfo> ScreenCapture::getMonitors() {
+    std::vector<MonitorInfo> monitors;
+    int width = 0;
+    int height = 0;
+    if (!getRootDimensions(width, height)) {
+        return monitors;
+    }
+
+#if defined(__linux__) && defined(HAVE_XRANDR)
+    if (!queryRandrMonitors(monitors)) {
+        LOG_WARN("RandR 1.5 not available, treating the screen as one monitor");
+    }
+#endif
+
+    if (monitors.empty()) {
+        MonitorInfo whole;
+        whole.name = "screen";
+        whole.width = width;
+        whole.height = height;
+        whole.primary = true;
+        monitors.push_back(whole);
+    }
+
+    // Le principal d'abord: il devient le flux 0 des clients sans abonnement
+    std::stable_partition(monitors.begin(), monitors.end(),
+                          [](const MonitorInfo& m) { return m.primary; });
+    return monitors;
+}
+
+#ifdef __linux__
+bool ScreenCapture::queryRandrMonitors(std::vector<MonitorInfo>& monitors) {
+#ifdef HAVE_XRANDR
+    // RandR 1.5: moniteurs logiques actifs (une sortie, ou plusieurs
+    // sorties regroupées par l'utilisateur)
+    int event_base = 0;
+    int error_base = 0;
+    int major = 0;
+    int minor = 0;
+    if (!XRRQueryExtension(display_, &event_base, &error_base) ||
+        !XRRQueryVersion(display_, &major, &minor) || !(major > 1 || (major == 1 && minor >= 5))) {
+        return false;
+    }
+    int count = 0;
+    XRRMonitorInfo* info = XRRGetMonitors(display_, root_window_, True, &count);
+    // XRRQueryVersion, XRRGetMonitors et un XGetAtomName par moniteur
+    frame_round_trips_ += 2 + count;
+    for (int i = 0; info && i < count; ++i) {
+        MonitorInfo monitor;
+        char* name = XGetAtomName(display_, info[i].name);
+        monitor.name = name ? name : "monitor-" + std::to_string(i);
+        if (name) {
+            XFree(name);
+        }
+        monitor.x = info[i].x;
+        monitor.y = info[i].y;
+        monitor.width = info[i].width;
+        monitor.height = info[i].height;
+        monitor.primary = info[i].primary != 0;
+        monitors.push_back(monitor);
+    }
+    if (info) {
+        XRRFreeMonitors(info);
+    }
+    return true;
+#else
+    (void)monitors;
+    return false;
+#endif
+}
+#endif
+
 std::vector<uint8_t> ScreenCapture::captureRegion(int x, int y, int width, int height) {
+#ifdef __linux__
+    // Allers-retours X11 effectivement émis par frame, y compris ceux des
+    // mises à jour de géométrie depuis la frame précédente
+    static Histogram& round_trips = Metrics::histogram("capture_x11_round_trips");
+#endif
+    PROBE4(capture__start, x, y, width, height);
+    std::vector<uint8_t> pixels = captureRegionImpl(x, y, width, height);
+    PROBE3(capture__end, width, height, pixels.size());
+#ifdef __linux__
+    round_trips.record(static_cast<uint64_t>(frame_round_trips_));
+    frame_round_trips_ = 0;
+#endif
+    return pixels;
+}
+
+std::vector<uint8_t> ScreenCapture::captureRegionImpl(int x, int y, int width, int height) {
+#ifndef __linux__
+    static Histogram& grab_time = Metrics::histogram("capture_grab_us");
+    static Histogram& convert_time = Metrics::histogram("capture_convert_us");
+    static Counter& failures = Metrics::counter("capture_failures_total");
+#endif
+
     if (!initialized_) {
         last_error_ = "Screen capture not initialized";
         return std::vector<uint8_t>();
     }
 
 #ifdef __linux__
-    Display* display = display_;
     Window root = root_window_;
 
     // Validate and clamp capture region to screen bounds
     int screen_width, screen_height;
-    if (!getScreenDimensions(screen_width, screen_height)) {
+    if (!getRootDimensions(screen_width, screen_height)) {
         last_error_ = "Failed to get screen dimensions";
         return std::vector<uint8_t>();
     }
@@ -160,11 +447,8 @@ std::vector<uint8_t> ScreenCapture::captureRegion(int x, int y, int width, int h
     // Debug log
     static bool first_capture = true;
     if (first_capture) {
-        std::string msg = "Screen dimensions: " + std::to_string(screen_width) + "x" + std::to_string(screen_height);
-        Logger::log(Logger::LogLevel::INFO, msg);
-        msg = "Capture request: x=" + std::to_string(x) + " y=" + std::to_string(y) + 
-              " w=" + std::to_string(width) + " h=" + std::to_string(height);
-        Logger::log(Logger::LogLevel::INFO, msg);
+        LOG_INFO("Screen dimensions: {}x{}", screen_width, screen_height);
+        LOG_INFO("Capture request: x={} y={} w={} h={}", x, y, width, height);
         first_capture = false;
     }
 
@@ -178,103 +462,28 @@ std::vector<uint8_t> ScreenCapture::captureRegion(int x, int y, int width, int h
     
     if (width <= 0 || height <= 0) {
         last_error_ = "Invalid capture dimensions after clamping: " + std::to_string(width) + "x" + std::to_string(height);
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, last_error_);
+        LOG_ERROR(last_error_);
         return std::vector<uint8_t>();
     }
 
-    // Get root window attributes to verify
-    XWindowAttributes attrs;
-    if (!XGetWindowAttributes(display, root, &attrs)) {
-        last_error_ = "Failed to get window attributes";
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, last_error_);
+    XImage* image = grabImage(root, x, y, width, height);
+    if (!image) {
         return std::vector<uint8_t>();
     }
-
-    // Debug: Log window attributes
-    static bool logged_attrs = false;
-    if (!logged_attrs) {
-        std::string msg = "Window attributes - width: " + std::to_string(attrs.width) + 
-                         " height: " + std::to_string(attrs.height) +
-                         " depth: " + std::to_string(attrs.depth) +
-                         " visual: " + std::to_string(reinterpret_cast<unsigned long>(attrs.visual));
-        Logger::log(Logger::LogLevel::INFO, msg);
-        logged_attrs = true;
-    }
-
-    // Make sure we don't exceed the actual window size
-    if (x + width > attrs.width) width = attrs.width - x;
-    if (y + height > attrs.height) height = attrs.height - y;
-
-    // Synchronize with X server to ensure all pending operations are complete
-    XSync(display, False);
-
-    // Capture the screen using XGetImage with error trapping to avoid fatal X errors
-    g_x11_error_state = X11ErrorState{};
-    auto previous_handler = XSetErrorHandler(ScreenCaptureXErrorHandler);
-
-    unsigned long plane_mask = AllPlanes;
-    XImage* image = XGetImage(display, root, x, y, static_cast<unsigned int>(width), static_cast<unsigned int>(height), plane_mask, ZPixmap);
-
-    // Force synchronization so that any X errors are delivered now
-    XSync(display, False);
-
-    // Restore original handler
-    XSetErrorHandler(previous_handler);
-
-    if (!image || g_x11_error_state.triggered) {
-        if (image) {
-            XDestroyImage(image);
-        }
-
-        if (g_x11_error_state.triggered) {
-            last_error_ = std::string("XGetImage failed: ") + g_x11_error_state.message;
-            if (g_x11_error_state.code == BadMatch) {
-                last_error_ += " (BadMatch indicates the compositor denied direct screen capture. On Wayland sessions, X11 capture is not permitted.)";
-            }
-        } else {
-            last_error_ = "XGetImage returned null image";
-        }
-
-        Logger::log(Logger::LogLevel::WARN, last_error_);
-        return std::vector<uint8_t>();
-    }
-
-    // Allocate buffer for ARGB8888 format
-    std::vector<uint8_t> pixels(width * height * 4);
-
-    // Convert XImage data to ARGB8888
-    for (int row = 0; row < height; ++row) {
-        for (int col = 0; col < width; ++col) {
-            unsigned long pixel = XGetPixel(image, col, row);
-            
-            // Extract RGB components (X11 typically uses BGR or RGB depending on display)
-            // We'll assume 24-bit or 32-bit color depth
-            uint8_t r = (pixel >> 16) & 0xFF;
-            uint8_t g = (pixel >> 8) & 0xFF;
-            uint8_t b = pixel & 0xFF;
-            uint8_t a = 0xFF; // Fully opaque
-
-            // Store as ARGB8888
-            int idx = (row * width + col) * 4;
-            pixels[idx + 0] = a;  // A
-            pixels[idx + 1] = r;  // R
-            pixels[idx + 2] = g;  // G
-            pixels[idx + 3] = b;  // B
-        }
-    }
-
-    XDestroyImage(image);
-    return pixels;
+    return convertImage(image, width, height);
 
 #elif defined(_WIN32)
     HDC hdc_screen = static_cast<HDC>(hdc_screen_);
     HDC hdc_mem = static_cast<HDC>(hdc_mem_);
 
+    auto grab_start = std::chrono::steady_clock::now();
+    FrameSpan grab_span("grab");
+
     // Create bitmap
     HBITMAP hbitmap = CreateCompatibleBitmap(hdc_screen, width, height);
     if (!hbitmap) {
         last_error_ = "Failed to create compatible bitmap";
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, last_error_);
+        LOG_ERROR(last_error_);
         return std::vector<uint8_t>();
     }
 
@@ -284,7 +493,8 @@ std::vector<uint8_t> ScreenCapture::captureRegion(int x, int y, int width, int h
     // Copy screen to memory DC
     if (!BitBlt(hdc_mem, 0, 0, width, height, hdc_screen, x, y, SRCCOPY)) {
         last_error_ = "BitBlt failed";
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, last_error_);
+        LOG_ERROR(last_error_);
+        failures.inc();
         SelectObject(hdc_mem, old_bitmap);
         DeleteObject(hbitmap);
         return std::vector<uint8_t>();
@@ -309,32 +519,406 @@ std::vector<uint8_t> ScreenCapture::captureRegion(int x, int y, int width, int h
     if (!GetDIBits(hdc_mem, hbitmap, 0, height, pixels.data(), 
                    reinterpret_cast<BITMAPINFO*>(&bi), DIB_RGB_COLORS)) {
         last_error_ = "GetDIBits failed";
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, last_error_);
+        LOG_ERROR(last_error_);
+        failures.inc();
         SelectObject(hdc_mem, old_bitmap);
         DeleteObject(hbitmap);
         return std::vector<uint8_t>();
     }
 
-    // Windows gives us BGRA, convert to ARGB
-    for (int i = 0; i < width * height; ++i) {
-        int idx = i * 4;
-        uint8_t b = pixels[idx + 0];
-        uint8_t g = pixels[idx + 1];
-        uint8_t r = pixels[idx + 2];
-        uint8_t a = pixels[idx + 3];
-        
-        pixels[idx + 0] = a;
-        pixels[idx + 1] = r;
-        pixels[idx + 2] = g;
-        pixels[idx + 3] = b;
-    }
+    grab_time.record(elapsedMicros(grab_start));
+    grab_span.end();
+
+    // Windows gives us BGRA (XRGB8888 in X11 terms), convert to ARGB in place
+    ScopedTimer convert_timer(convert_time);
+    FrameSpan convert_span("convert");
+    static const PixelConvertFn convert = PixelConverter::select(SourceFormat::XRGB8888, DestFormat::ARGB8888);
+    convert(pixels.data(), static_cast<size_t>(width) * 4, width, height, pixels.data());
 
     SelectObject(hdc_mem, old_bitmap);
     DeleteObject(hbitmap);
     return pixels;
 
 #else
+    (void)grab_time;
+    (void)convert_time;
+    (void)failures;
     last_error_ = "Screen capture not implemented for this platform";
     return std::vector<uint8_t>();
 #endif
 }
+
+#ifdef __linux__
+XImage* ScreenCapture::grabImage(Drawable drawable, int x, int y, int width, int height) {
+    static Histogram& grab_time = Metrics::histogram("capture_grab_us");
+    static Counter& failures = Metrics::counter("capture_failures_total");
+
+    auto grab_start = std::chrono::steady_clock::now();
+    FrameSpan grab_span("grab");
+
+    // Pas de XSync avant/après: XGetImage est le seul aller-retour, et une
+    // erreur (BadMatch...) est reçue avant son retour
+    X11ErrorTrap::begin(display_);
+    unsigned long plane_mask = AllPlanes;
+    XImage* image = XGetImage(display_, drawable, x, y, static_cast<unsigned int>(width), static_cast<unsigned int>(height), plane_mask, ZPixmap);
+    frame_round_trips_++;
+    bool trapped = !X11ErrorTrap::end();
+    grab_time.record(elapsedMicros(grab_start));
+    grab_span.end();
+
+    if (!image || trapped) {
+        if (image) {
+            XDestroyImage(image);
+        }
+
+        if (trapped) {
+            last_error_ = std::string("XGetImage failed: ") + X11ErrorTrap::errorMessage();
+            if (X11ErrorTrap::errorCode() == BadMatch) {
+                last_error_ += " (BadMatch indicates the compositor denied direct screen capture. On Wayland sessions, X11 capture is not permitted.)";
+            }
+        } else {
+            last_error_ = "XGetImage returned null image";
+        }
+
+        LOG_WARN(last_error_);
+        failures.inc();
+        Logger::trace(TraceEvent::CAPTURE_FAILED, 0, 0, static_cast<uint64_t>(trapped ? X11ErrorTrap::errorCode() : 0));
+        return nullptr;
+    }
+
+    return image;
+}
+
+void ScreenCapture::selectConverter(Visual* visual, int depth) {
+    // Taille des pixels en mémoire pour cette profondeur (24 bits -> 32 bpp en général)
+    convert_bpp_ = 0;
+    int count = 0;
+    XPixmapFormatValues* formats = XListPixmapFormats(display_, &count);
+    if (formats) {
+        for (int i = 0; i < count; ++i) {
+            if (formats[i].depth == depth) {
+                convert_bpp_ = formats[i].bits_per_pixel;
+                break;
+            }
+        }
+        XFree(formats);
+    }
+
+    // Les masques n'ont de sens que pour TrueColor / DirectColor
+    bool has_masks = visual && (visual->c_class == TrueColor || visual->c_class == DirectColor);
+    red_mask_ = has_masks ? visual->red_mask : 0xFF0000;
+    green_mask_ = has_masks ? visual->green_mask : 0x00FF00;
+    blue_mask_ = has_masks ? visual->blue_mask : 0x0000FF;
+
+    SourceFormat format = has_masks
+        ? PixelConverter::detect(convert_bpp_, red_mask_, green_mask_, blue_mask_,
+                                 ImageByteOrder(display_) == LSBFirst)
+        : SourceFormat::UNKNOWN;
+    convert_fn_ = PixelConverter::select(format, DestFormat::ARGB8888);
+
+    if (convert_fn_) {
+        LOG_INFO("Pixel conversion: {} -> {}", PixelConverter::name(format), PixelConverter::name(DestFormat::ARGB8888));
+    } else {
+        LOG_WARN("No specialized converter for depth {} ({} bpp), using XGetPixel", depth, convert_bpp_);
+    }
+}
+
+std::vector<uint8_t> ScreenCapture::convertImage(XImage* image, int width, int height) {
+    static Histogram& convert_time = Metrics::histogram("capture_convert_us");
+
+    ScopedTimer convert_timer(convert_time);
+    FrameSpan convert_span("convert");
+
+    // Format vérifié une fois par image, jamais par pixel
+    if (!convert_fn_ || image->bits_per_pixel != convert_bpp_ || image->byte_order != LSBFirst) {
+        return convertImageGeneric(image, width, height);
+    }
+
+    std::vector<uint8_t> pixels(PixelConverter::destinationSize(DestFormat::ARGB8888, width, height));
+    convert_fn_(reinterpret_cast<const uint8_t*>(image->data), static_cast<size_t>(image->bytes_per_line),
+                width, height, pixels.data());
+
+    XDestroyImage(image);
+    return pixels;
+}
+
+namespace {
+    // Position et largeur d'un masque de canal (0x07E0 -> 5, 6)
+    void maskLayout(unsigned long mask, int& shift, int& bits) {
+        shift = 0;
+        bits = 0;
+        if (!mask) {
+            return;
+        }
+        while (!(mask & 1UL)) {
+            mask >>= 1;
+            ++shift;
+        }
+        while (mask & 1UL) {
+            mask >>= 1;
+            ++bits;
+        }
+    }
+
+    uint8_t scaleChannel(unsigned long value, int bits) {
+        if (bits >= 8) {
+            return static_cast<uint8_t>(value >> (bits - 8));
+        }
+        return bits > 0 ? static_cast<uint8_t>(value * 255 / ((1UL << bits) - 1)) : 0;
+    }
+}
+
+std::vector<uint8_t> ScreenCapture::convertImageGeneric(XImage* image, int width, int height) {
+    int red_shift, red_bits, green_shift, green_bits, blue_shift, blue_bits;
+    maskLayout(red_mask_, red_shift, red_bits);
+    maskLayout(green_mask_, green_shift, green_bits);
+    maskLayout(blue_mask_, blue_shift, blue_bits);
+
+    std::vector<uint8_t> pixels(PixelConverter::destinationSize(DestFormat::ARGB8888, width, height));
+    uint8_t* out = pixels.data();
+    for (int row = 0; row < height; ++row) {
+        for (int col = 0; col < width; ++col, out += 4) {
+            unsigned long pixel = XGetPixel(image, col, row);
+            out[0] = 0xFF;
+            out[1] = scaleChannel((pixel & red_mask_) >> red_shift, red_bits);
+            out[2] = scaleChannel((pixel & green_mask_) >> green_shift, green_bits);
+            out[3] = scaleChannel((pixel & blue_mask_) >> blue_shift, blue_bits);
+        }
+    }
+
+    XDestroyImage(image);
+    return pixels;
+}
+
+bool ScreenCapture::initWindow() {
+    // Fenêtres détruites pendant la recherche ou XID invalide: erreurs
+    // notées, pas de sortie du processus par le gestionnaire par défaut
+    if (window_id_ == 0) {
+        if (window_title_.empty()) {
+            last_error_ = "Empty window title";
+            LOG_ERROR(last_error_);
+            return false;
+        }
+        X11ErrorTrap::begin(display_);
+        Window found = findWindowByTitle(root_window_, window_title_);
+        X11ErrorTrap::end();
+        if (!found) {
+            last_error_ = "No viewable window with a title containing '" + window_title_ + "'";
+            LOG_ERROR(last_error_);
+            return false;
+        }
+        window_id_ = found;
+        LOG_INFO("Window '{}' matches '{}'", getWindowTitle(found), window_title_);
+    }
+
+    Window window = static_cast<Window>(window_id_);
+    XWindowAttributes attrs;
+    X11ErrorTrap::begin(display_);
+    Status status = XGetWindowAttributes(display_, window, &attrs);
+    if (!X11ErrorTrap::end() || !status) {
+        last_error_ = "Invalid window " + formatXid(window_id_);
+        LOG_ERROR(last_error_);
+        return false;
+    }
+    if (attrs.c_class == InputOnly) {
+        last_error_ = "Window " + formatXid(window_id_) + " is InputOnly and has no content";
+        LOG_ERROR(last_error_);
+        return false;
+    }
+    window_width_ = attrs.width;
+    window_height_ = attrs.height;
+    window_border_ = attrs.border_width;
+    window_destroyed_ = false;
+    // Fenêtre ARGB (profondeur 32) ou visual différent de la racine
+    selectConverter(attrs.visual, attrs.depth);
+    XSelectInput(display_, window, StructureNotifyMask);
+
+#ifdef HAVE_XCOMPOSITE
+    int event_base = 0;
+    int error_base = 0;
+    int major = 0;
+    int minor = 0;
+    if (XCompositeQueryExtension(display_, &event_base, &error_base) &&
+        XCompositeQueryVersion(display_, &major, &minor) && (major > 0 || minor >= 2)) {
+        // Redirection automatique: le serveur affiche toujours la fenêtre,
+        // mais son contenu est rendu hors écran et reste lisible même
+        // masquée. Annulée à la fermeture de la connexion.
+        X11ErrorTrap::begin(display_);
+        XCompositeRedirectWindow(display_, window, CompositeRedirectAutomatic);
+        XSync(display_, False);
+        window_redirected_ = X11ErrorTrap::end();
+        if (!window_redirected_) {
+            LOG_WARN("XCompositeRedirectWindow failed: {}", X11ErrorTrap::errorMessage());
+        }
+    } else {
+        LOG_WARN("Composite 0.2 not available, covered parts of the window will not be captured");
+    }
+#else
+    LOG_WARN("Built without Xcomposite, covered parts of the window will not be captured");
+#endif
+
+    LOG_INFO("Window capture initialized: {} ({}x{}, {})", formatXid(window_id_), window_width_, window_height_,
+             window_redirected_ ? "redirected" : "direct");
+    return true;
+}
+
+Window ScreenCapture::findWindowByTitle(Window parent, const std::string& title) {
+    Window root_return = 0;
+    Window parent_return = 0;
+    Window* children = nullptr;
+    unsigned int count = 0;
+    if (!XQueryTree(display_, parent, &root_return, &parent_return, &children, &count)) {
+        return 0;
+    }
+
+    // Du haut de la pile vers le bas: la fenêtre au premier plan l'emporte.
+    // Sous un gestionnaire de fenêtres, le client est l'enfant de son cadre.
+    Window found = 0;
+    for (unsigned int i = count; i-- > 0 && !found;) {
+        XWindowAttributes attrs;
+        if (!XGetWindowAttributes(display_, children[i], &attrs) || attrs.map_state != IsViewable) {
+            continue;
+        }
+        if (attrs.c_class == InputOutput && getWindowTitle(children[i]).find(title) != std::string::npos) {
+            found = children[i];
+        } else {
+            found = findWindowByTitle(children[i], title);
+        }
+    }
+    if (children) {
+        XFree(children);
+    }
+    return found;
+}
+
+std::string ScreenCapture::getWindowTitle(Window window) {
+    // _NET_WM_NAME (UTF-8, EWMH) d'abord, WM_NAME sinon
+    Atom net_wm_name = XInternAtom(display_, "_NET_WM_NAME", False);
+    Atom utf8_string = XInternAtom(display_, "UTF8_STRING", False);
+    std::string title;
+
+    Atom type = None;
+    int format = 0;
+    unsigned long count = 0;
+    unsigned long remaining = 0;
+    unsigned char* data = nullptr;
+    if (XGetWindowProperty(display_, window, net_wm_name, 0, 1024, False, utf8_string,
+                           &type, &format, &count, &remaining, &data) == Success && data) {
+        if (type == utf8_string && format == 8) {
+            title.assign(reinterpret_cast<const char*>(data), count);
+        }
+        XFree(data);
+    }
+
+    if (title.empty()) {
+        char* name = nullptr;
+        if (XFetchName(display_, window, &name) && name) {
+            title = name;
+            XFree(name);
+        }
+    }
+    return title;
+}
+
+void ScreenCapture::processWindowEvents() {
+    XEvent event;
+    Window window = static_cast<Window>(window_id_);
+    while (XCheckWindowEvent(display_, window, StructureNotifyMask, &event)) {
+        switch (event.type) {
+        case ConfigureNotify:
+            if (event.xconfigure.width != window_width_ || event.xconfigure.height != window_height_ ||
+                event.xconfigure.border_width != window_border_) {
+                LOG_INFO("Captured window resized: {}x{} -> {}x{}", window_width_, window_height_,
+                         event.xconfigure.width, event.xconfigure.height);
+                window_width_ = event.xconfigure.width;
+                window_height_ = event.xconfigure.height;
+                window_border_ = event.xconfigure.border_width;
+                releaseWindowPixmap();
+            }
+            break;
+        case MapNotify:
+        case UnmapNotify:
+            // Nouvelle pixmap à chaque mappage
+            releaseWindowPixmap();
+            break;
+        case DestroyNotify:
+            LOG_WARN("Captured window {} was destroyed", formatXid(window_id_));
+            window_destroyed_ = true;
+            releaseWindowPixmap();
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void ScreenCapture::releaseWindowPixmap() {
+    // La pixmap nommée reste valide après redimensionnement ou destruction
+    // de la fenêtre, jusqu'à XFreePixmap
+    if (window_pixmap_) {
+        XFreePixmap(display_, window_pixmap_);
+        window_pixmap_ = 0;
+    }
+}
+
+bool ScreenCapture::ensureWindowPixmap() {
+#ifdef HAVE_XCOMPOSITE
+    if (!window_redirected_ || window_pixmap_) {
+        return true;
+    }
+
+    // Seulement à la première frame et après un redimensionnement: le XSync
+    // reste hors du régime établi
+    X11ErrorTrap::begin(display_);
+    Pixmap pixmap = XCompositeNameWindowPixmap(display_, static_cast<Window>(window_id_));
+    XSync(display_, False);
+    frame_round_trips_++;
+    if (!X11ErrorTrap::end()) {
+        // Pixmap non créée: rien à libérer
+        last_error_ = std::string("XCompositeNameWindowPixmap failed: ") + X11ErrorTrap::errorMessage() +
+                      " (window not mapped?)";
+        return false;
+    }
+    window_pixmap_ = pixmap;
+#endif
+    return true;
+}
+
+std::vector<uint8_t> ScreenCapture::captureWindow(int& width, int& height) {
+    static Histogram& round_trips = Metrics::histogram("capture_x11_round_trips");
+
+    if (!initialized_) {
+        last_error_ = "Screen capture not initialized";
+        return std::vector<uint8_t>();
+    }
+
+    // Les ConfigureNotify déjà reçus suffisent: pas d'aller-retour pour la géométrie
+    processWindowEvents();
+    if (window_destroyed_) {
+        last_error_ = "Captured window " + formatXid(window_id_) + " was destroyed";
+        return std::vector<uint8_t>();
+    }
+    if (!ensureWindowPixmap()) {
+        // Fenêtre non mappée: le XSync est payé à chaque tentative
+        round_trips.record(static_cast<uint64_t>(frame_round_trips_));
+        frame_round_trips_ = 0;
+        return std::vector<uint8_t>();
+    }
+
+    width = window_width_;
+    height = window_height_;
+    PROBE4(capture__start, 0, 0, width, height);
+
+    // Seuls les pixels de la fenêtre sont lus; la pixmap Composite inclut
+    // la bordure, pas la fenêtre elle-même
+    XImage* image = window_pixmap_
+        ? grabImage(window_pixmap_, window_border_, window_border_, width, height)
+        : grabImage(static_cast<Window>(window_id_), 0, 0, width, height);
+    std::vector<uint8_t> pixels = image ? convertImage(image, width, height) : std::vector<uint8_t>();
+    round_trips.record(static_cast<uint64_t>(frame_round_trips_));
+    frame_round_trips_ = 0;
+
+    PROBE3(capture__end, width, height, pixels.size());
+    return pixels;
+}
+#endif
@@ -1,6 +1,8 @@
 #ifndef SCREENCAPTURE_H
 #define SCREENCAPTURE_H
 
+#include "FrameSource.h"
+#include "PixelConverter.h"
 #include <vector>
 #include <cstdint>
 #include <string>
@@ -10,20 +12,30 @@
 #include <X11/Xutil.h>
 #endif
 
+// Un moniteur (sortie RandR) dans les coordonnées de l'écran X
+struct MonitorInfo {
+    std::string name;
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    bool primary = false;
+};
+
 /**
  * Cross-platform screen capture utility
  * Captures the entire primary display or a specific region
  */
-class ScreenCapture {
+class ScreenCapture : public FrameSource {
 public:
     ScreenCapture();
-    ~ScreenCapture();
+    ~ScreenCapture() override;
 
     /**
      * Initialize the screen capture system
      * @return true if successful, false otherwise
      */
-    bool init();
+    bool init() override;
 
     /**
      * Capture the entire primary screen
@@ -34,6 +46,41 @@ public:
      */
     std::vector<uint8_t> captureScreen(int& width, int& height);
 
+    // FrameSource: l'écran entier, ou le moniteur choisi par setMonitor()
+    std::vector<uint8_t> captureFrame(int& width, int& height) override;
+
+    /**
+     * Enumerate the monitors of the X screen (XRandR when built with
+     * HAVE_XRANDR, otherwise the whole screen as a single monitor)
+     * @return Monitors, primary first; empty if not initialized
+     */
+    std::vector<MonitorInfo> getMonitors();
+
+    /**
+     * Restrict captureFrame() to one monitor. Each capture thread needs its
+     * own ScreenCapture (one X connection per thread).
+     */
+    void setMonitor(const MonitorInfo& monitor);
+
+    /**
+     * Capture a single window instead of the screen (call before init()).
+     * With HAVE_XCOMPOSITE the window is redirected off-screen and read
+     * from its backing pixmap, so it is captured even when covered by
+     * other windows; without it, only its visible part is valid.
+     * @param xid X window id
+     */
+    void setWindow(unsigned long xid);
+
+    /**
+     * Same as setWindow(), the window being the first viewable one whose
+     * title (_NET_WM_NAME or WM_NAME) contains the given text; resolved
+     * by init()
+     */
+    void setWindowTitle(const std::string& title);
+
+    // XID de la fenêtre capturée (résolu par init()), 0 pour l'écran
+    unsigned long getWindowId() const { return has_window_ ? window_id_ : 0; }
+
     /**
      * Capture a specific region of the screen
      * @param x X coordinate of top-left corner
@@ -46,33 +93,91 @@ public:
     std::vector<uint8_t> captureRegion(int x, int y, int width, int height);
 
     /**
-     * Get the primary screen dimensions
+     * Get the screen dimensions (the monitor's after setMonitor())
      * @param width Output parameter for screen width
      * @param height Output parameter for screen height
      * @return true if successful, false otherwise
      */
-    bool getScreenDimensions(int& width, int& height);
+    bool getScreenDimensions(int& width, int& height) override;
 
     /**
      * Check if the capture system is initialized
      * @return true if initialized, false otherwise
      */
-    bool isInitialized() const { return initialized_; }
+    bool isInitialized() const override { return initialized_; }
 
     /**
      * Get the last error message
      * @return Error message string
      */
-    std::string getLastError() const { return last_error_; }
+    std::string getLastError() const override { return last_error_; }
+
+    std::string name() const override;
 
 private:
+    // Taille de l'écran X entier, quel que soit le moniteur choisi
+    bool getRootDimensions(int& width, int& height);
+
+    // Implémentation de captureRegion, encadrée par les sondes USDT
+    std::vector<uint8_t> captureRegionImpl(int x, int y, int width, int height);
+
     bool initialized_;
     std::string last_error_;
+    bool has_monitor_;
+    MonitorInfo monitor_;
+    bool monitor_lost_;           // moniteur choisi absent des moniteurs RandR
+    bool has_window_;
+    unsigned long window_id_;     // 0 tant que le titre n'est pas résolu
+    std::string window_title_;
 
 #ifdef __linux__
+    // Met à jour la géométrie à partir des ConfigureNotify en attente
+    // (aucun aller-retour serveur, sauf la relecture des moniteurs RandR
+    // après un changement quand un moniteur est choisi)
+    void processPendingEvents();
+
+    // Moniteurs logiques RandR 1.5 (false si l'extension manque)
+    bool queryRandrMonitors(std::vector<MonitorInfo>& monitors);
+
+    // Relit la géométrie du moniteur choisi (retrouvé par son nom)
+    void refreshMonitor();
+
+    // Capture de fenêtre (setWindow / setWindowTitle)
+    bool initWindow();
+    Window findWindowByTitle(Window parent, const std::string& title);
+    std::string getWindowTitle(Window window);
+    void processWindowEvents();
+    void releaseWindowPixmap();
+    bool ensureWindowPixmap();
+    std::vector<uint8_t> captureWindow(int& width, int& height);
+
+    // XGetImage sous piège d'erreurs X, puis conversion en ARGB8888
+    XImage* grabImage(Drawable drawable, int x, int y, int width, int height);
+    std::vector<uint8_t> convertImage(XImage* image, int width, int height);
+
+    // Convertisseur choisi une fois d'après le visual de la racine ou de la
+    // fenêtre capturée; XGetPixel guidé par les masques pour les autres visuals
+    void selectConverter(Visual* visual, int depth);
+    std::vector<uint8_t> convertImageGeneric(XImage* image, int width, int height);
+
     Display* display_;
     Window root_window_;
     int screen_number_;
+    int screen_width_;   // géométrie de la fenêtre racine, en cache
+    int screen_height_;
+    int randr_event_base_;  // -1: pas d'événements RandR sélectionnés
+    int window_width_;   // fenêtre capturée, suivie par ConfigureNotify
+    int window_height_;
+    int window_border_;
+    bool window_destroyed_;
+    bool window_redirected_;
+    Pixmap window_pixmap_;  // pixmap Composite, renommée après chaque redimensionnement
+    int frame_round_trips_;  // allers-retours X11 depuis la dernière frame enregistrée
+    PixelConvertFn convert_fn_;  // nullptr: conversion générique
+    int convert_bpp_;
+    unsigned long red_mask_;
+    unsigned long green_mask_;
+    unsigned long blue_mask_;
 #elif defined(_WIN32)
     void* hdc_screen_;  // HDC for screen
     void* hdc_mem_;     // HDC for memory
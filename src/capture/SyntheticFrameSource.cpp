@@ -0,0 +1,228 @@
+#include "SyntheticFrameSource.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+
+namespace {
+    // Hachage entier (finaliseur murmur3): même entrée, même sortie partout
+    inline uint32_t mix32(uint32_t h) {
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+    inline uint32_t hash3(uint32_t seed, uint32_t a, uint32_t b) {
+        return mix32(seed ^ mix32(a * 0x9E3779B1u + mix32(b + 0x7F4A7C15u)));
+    }
+
+    inline void putPixel(uint8_t* p, uint8_t r, uint8_t g, uint8_t b) {
+        p[0] = 0xFF;  // A
+        p[1] = r;
+        p[2] = g;
+        p[3] = b;
+    }
+
+    const int kCellWidth = 8;
+    const int kCellHeight = 16;
+    const int kMargin = 16;
+
+    const uint8_t kInk = 0x20;
+
+    // Une ligne de pixels d'une page de texte infinie: cellules 8x16, lignes
+    // de longueur variable, glyphes en blocs 2x2 tirés du hachage. Le fond
+    // doit déjà être rempli; seule l'encre est écrite.
+    void drawTextRow(uint8_t* row, int width, uint32_t seed, uint64_t page_y) {
+        uint32_t line = static_cast<uint32_t>(page_y / kCellHeight);
+        int ry = static_cast<int>(page_y % kCellHeight);
+        if (ry < 3 || ry >= 13) {
+            return;  // interligne
+        }
+        uint32_t line_hash = hash3(seed, line, 0xFFFFFFFFu);
+        if (line_hash % 7 == 0) {
+            return;  // ligne vide (paragraphe)
+        }
+        int columns = (width - 2 * kMargin) / kCellWidth;
+        int length = static_cast<int>(line_hash % static_cast<uint32_t>(std::max(1, columns)));
+        int glyph_row = ((ry - 3) / 2) * 3;  // 5x3 blocs
+
+        for (int column = 0; column < length; ++column) {
+            uint32_t glyph = hash3(seed, line, static_cast<uint32_t>(column));
+            if (glyph % 6 == 0) {
+                continue;  // espace
+            }
+            uint8_t* cell = row + (kMargin + column * kCellWidth) * 4;
+            for (int rx = 1; rx < 7; ++rx) {
+                if ((glyph >> (glyph_row + (rx - 1) / 2)) & 1u) {
+                    putPixel(cell + rx * 4, kInk, kInk, kInk);
+                }
+            }
+        }
+    }
+
+    void fillRow(uint8_t* row, int width, uint8_t r, uint8_t g, uint8_t b) {
+        for (int x = 0; x < width; ++x) {
+            putPixel(row + x * 4, r, g, b);
+        }
+    }
+}
+
+SyntheticFrameSource::SyntheticFrameSource(Pattern pattern, int width, int height, uint32_t seed)
+    : pattern_(pattern)
+    , width_(width)
+    , height_(height)
+    , seed_(seed)
+    , scroll_step_(4)
+    , frame_index_(0)
+    , initialized_(false)
+    , last_error_("Not initialized") {
+}
+
+bool SyntheticFrameSource::init() {
+    if (width_ <= 0 || height_ <= 0 || width_ > 16384 || height_ > 16384) {
+        last_error_ = "Invalid synthetic frame size: " + std::to_string(width_) + "x" + std::to_string(height_);
+        LOG_ERROR(last_error_);
+        return false;
+    }
+
+    gradient_x_.resize(width_);
+    for (int x = 0; x < width_; ++x) {
+        gradient_x_[x] = static_cast<uint32_t>(x) * 256u / static_cast<uint32_t>(width_);
+    }
+
+    if (pattern_ == Pattern::STATIC_DESKTOP) {
+        desktop_.resize(static_cast<size_t>(width_) * height_ * 4);
+        renderDesktop(desktop_.data());
+    }
+
+    LOG_INFO("Synthetic frame source initialized: {} {}x{} seed={}", patternName(pattern_), width_, height_, seed_);
+    initialized_ = true;
+    return true;
+}
+
+std::vector<uint8_t> SyntheticFrameSource::captureFrame(int& width, int& height) {
+    if (!initialized_) {
+        last_error_ = "Synthetic frame source not initialized";
+        return std::vector<uint8_t>();
+    }
+
+    width = width_;
+    height = height_;
+    uint64_t frame = frame_index_++;
+
+    if (pattern_ == Pattern::STATIC_DESKTOP) {
+        return desktop_;
+    }
+
+    std::vector<uint8_t> pixels(static_cast<size_t>(width_) * height_ * 4);
+    if (pattern_ == Pattern::SCROLLING_TEXT) {
+        renderText(pixels.data(), frame);
+    } else {
+        renderNoise(pixels.data(), frame);
+    }
+    return pixels;
+}
+
+bool SyntheticFrameSource::getScreenDimensions(int& width, int& height) {
+    width = width_;
+    height = height_;
+    return true;
+}
+
+std::string SyntheticFrameSource::name() const {
+    return std::string("synthetic:") + patternName(pattern_);
+}
+
+bool SyntheticFrameSource::parsePattern(const std::string& text, Pattern& pattern) {
+    if (text == "static" || text == "desktop") {
+        pattern = Pattern::STATIC_DESKTOP;
+    } else if (text == "scroll" || text == "text") {
+        pattern = Pattern::SCROLLING_TEXT;
+    } else if (text == "noise" || text == "video") {
+        pattern = Pattern::VIDEO_NOISE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* SyntheticFrameSource::patternName(Pattern pattern) {
+    switch (pattern) {
+        case Pattern::STATIC_DESKTOP: return "static";
+        case Pattern::SCROLLING_TEXT: return "scroll";
+        case Pattern::VIDEO_NOISE: return "noise";
+    }
+    return "unknown";
+}
+
+void SyntheticFrameSource::renderDesktop(uint8_t* pixels) const {
+    // Fond dégradé dont les teintes dépendent de la graine
+    uint32_t tint = mix32(seed_);
+    uint8_t base_r = 0x20 + (tint & 0x3F);
+    uint8_t base_g = 0x30 + ((tint >> 8) & 0x3F);
+    uint8_t base_b = 0x60 + ((tint >> 16) & 0x3F);
+    for (int y = 0; y < height_; ++y) {
+        uint8_t shade = static_cast<uint8_t>(y * 64 / height_);
+        fillRow(pixels + static_cast<size_t>(y) * width_ * 4, width_, base_r + shade / 2, base_g + shade / 2, base_b + shade);
+    }
+
+    // Quelques fenêtres: barre de titre, contenu texte
+    const int kWindows = 4;
+    for (int i = 0; i < kWindows; ++i) {
+        uint32_t h = hash3(seed_, 0x57494E44u, static_cast<uint32_t>(i));
+        int w = std::max(32, width_ * static_cast<int>(30 + h % 30) / 100);
+        int ht = std::max(32, height_ * static_cast<int>(30 + (h >> 8) % 30) / 100);
+        int x0 = static_cast<int>((h >> 16) % static_cast<uint32_t>(std::max(1, width_ - w)));
+        int y0 = static_cast<int>((h >> 4) % static_cast<uint32_t>(std::max(1, height_ - ht)));
+        int x1 = std::min(width_, x0 + w);
+        int y1 = std::min(height_, y0 + ht);
+        int title = std::min(24, ht / 4);
+
+        // Le contenu est rendu sur une ligne temporaire à la largeur de la fenêtre
+        std::vector<uint8_t> line(static_cast<size_t>(w) * 4);
+        for (int y = y0; y < y1; ++y) {
+            uint8_t* row = pixels + (static_cast<size_t>(y) * width_ + x0) * 4;
+            if (y - y0 < title) {
+                fillRow(row, x1 - x0, 0x3C, 0x5A, 0x8C);
+                continue;
+            }
+            fillRow(line.data(), w, 0xF0, 0xF0, 0xF0);
+            drawTextRow(line.data(), w, seed_ + i, static_cast<uint64_t>(y - y0 - title));
+            std::copy(line.begin(), line.begin() + (x1 - x0) * 4, row);
+        }
+    }
+}
+
+void SyntheticFrameSource::renderText(uint8_t* pixels, uint64_t frame) const {
+    uint64_t offset = frame * static_cast<uint64_t>(std::max(0, scroll_step_));
+    for (int y = 0; y < height_; ++y) {
+        uint8_t* row = pixels + static_cast<size_t>(y) * width_ * 4;
+        fillRow(row, width_, 0xFF, 0xFF, 0xFF);
+        drawTextRow(row, width_, seed_, offset + static_cast<uint64_t>(y));
+    }
+}
+
+void SyntheticFrameSource::renderNoise(uint8_t* pixels, uint64_t frame) const {
+    uint32_t t = static_cast<uint32_t>(frame);
+    for (int y = 0; y < height_; ++y) {
+        uint8_t* row = pixels + static_cast<size_t>(y) * width_ * 4;
+        // xorshift32 par ligne: reproductible quel que soit l'ordre de rendu
+        uint32_t state = hash3(seed_, t, static_cast<uint32_t>(y)) | 1u;
+        uint32_t gy = static_cast<uint32_t>(y) * 256u / static_cast<uint32_t>(height_);
+        for (int x = 0; x < width_; ++x) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            uint32_t gx = gradient_x_[x];
+            int noise = static_cast<int>(state & 31u) - 16;
+            int r = static_cast<int>((gx + t * 2) & 0xFF) + noise;
+            int g = static_cast<int>((gy + t * 3) & 0xFF) + noise;
+            int b = static_cast<int>(((gx + gy) / 2 + t * 5) & 0xFF) + noise;
+            putPixel(row + x * 4,
+                     static_cast<uint8_t>(std::min(255, std::max(0, r))),
+                     static_cast<uint8_t>(std::min(255, std::max(0, g))),
+                     static_cast<uint8_t>(std::min(255, std::max(0, b))));
+        }
+    }
+}
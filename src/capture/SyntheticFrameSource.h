@@ -0,0 +1,63 @@
+#ifndef SYNTHETICFRAMESOURCE_H
+#define SYNTHETICFRAMESOURCE_H
+
+#include "FrameSource.h"
+
+/**
+ * Deterministic frame generator
+ *
+ * The same (pattern, size, seed) always yields the same sequence of
+ * frames, so benchmark runs are comparable across machines:
+ *   STATIC_DESKTOP  wallpaper and a few windows, identical every frame
+ *   SCROLLING_TEXT  page of text lines moving up by scroll_step rows per frame
+ *   VIDEO_NOISE     moving gradients plus per-pixel noise (worst case)
+ */
+class SyntheticFrameSource : public FrameSource {
+public:
+    enum class Pattern {
+        STATIC_DESKTOP,
+        SCROLLING_TEXT,
+        VIDEO_NOISE
+    };
+
+    SyntheticFrameSource(Pattern pattern, int width, int height, uint32_t seed = 1);
+
+    bool init() override;
+    std::vector<uint8_t> captureFrame(int& width, int& height) override;
+    bool getScreenDimensions(int& width, int& height) override;
+    bool isInitialized() const override { return initialized_; }
+    std::string getLastError() const override { return last_error_; }
+    std::string name() const override;
+
+    /**
+     * Parse a pattern name ("static", "scroll", "noise")
+     * @return false if the name is unknown
+     */
+    static bool parsePattern(const std::string& text, Pattern& pattern);
+    static const char* patternName(Pattern pattern);
+
+    // Lignes de défilement par frame (SCROLLING_TEXT)
+    void setScrollStep(int rows) { scroll_step_ = rows; }
+
+    // Index de la prochaine frame; le remettre à 0 rejoue la même séquence
+    uint64_t frameIndex() const { return frame_index_; }
+    void setFrameIndex(uint64_t index) { frame_index_ = index; }
+
+private:
+    void renderDesktop(uint8_t* pixels) const;
+    void renderText(uint8_t* pixels, uint64_t frame) const;
+    void renderNoise(uint8_t* pixels, uint64_t frame) const;
+
+    Pattern pattern_;
+    int width_;
+    int height_;
+    uint32_t seed_;
+    int scroll_step_;
+    uint64_t frame_index_;
+    bool initialized_;
+    std::string last_error_;
+    std::vector<uint8_t> desktop_;  // STATIC_DESKTOP: rendu une seule fois
+    std::vector<uint32_t> gradient_x_;  // x * 256 / width
+};
+
+#endif // SYNTHETICFRAMESOURCE_H
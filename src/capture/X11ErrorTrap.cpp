@@ -0,0 +1,58 @@
+#include "X11ErrorTrap.h"
+
+#ifdef __linux__
+#include <mutex>
+
+namespace {
+    struct X11ErrorState {
+        bool trapping = false;       // une requête de capture est en cours
+        unsigned long first_serial = 0;
+        bool triggered = false;
+        int code = 0;
+        char message[256] = {0};
+    };
+
+    thread_local X11ErrorState g_x11_error_state;
+    XErrorHandler g_previous_error_handler = nullptr;
+    std::once_flag g_error_handler_once;
+
+    int CaptureXErrorHandler(Display* display, XErrorEvent* error_event) {
+        X11ErrorState& state = g_x11_error_state;
+        if (!state.trapping || error_event->serial < state.first_serial) {
+            return g_previous_error_handler ? g_previous_error_handler(display, error_event) : 0;
+        }
+        state.triggered = true;
+        state.code = error_event->error_code;
+        if (display) {
+            XGetErrorText(display, error_event->error_code, state.message, sizeof(state.message));
+        }
+        return 0;
+    }
+}
+
+void X11ErrorTrap::install() {
+    std::call_once(g_error_handler_once, [] {
+        g_previous_error_handler = XSetErrorHandler(CaptureXErrorHandler);
+    });
+}
+
+void X11ErrorTrap::begin(Display* display) {
+    X11ErrorState& state = g_x11_error_state;
+    state = X11ErrorState{};
+    state.trapping = true;
+    state.first_serial = NextRequest(display);
+}
+
+bool X11ErrorTrap::end() {
+    g_x11_error_state.trapping = false;
+    return !g_x11_error_state.triggered;
+}
+
+int X11ErrorTrap::errorCode() {
+    return g_x11_error_state.code;
+}
+
+const char* X11ErrorTrap::errorMessage() {
+    return g_x11_error_state.message;
+}
+#endif
@@ -0,0 +1,31 @@
+#ifndef X11ERRORTRAP_H
+#define X11ERRORTRAP_H
+
+#ifdef __linux__
+#include <X11/Xlib.h>
+
+/**
+ * Non-fatal X protocol errors for capture requests
+ *
+ * Xlib's default handler exits the process on any error, yet a capture
+ * request can fail for ordinary reasons (window destroyed, compositor
+ * refusing XGetImage...). install() sets a process-wide handler once;
+ * errors of the requests issued between begin() and end() on the calling
+ * thread are recorded, all others go to the previous handler. The errors
+ * must have arrived before end(): last request with a reply, or XSync.
+ */
+class X11ErrorTrap {
+public:
+    static void install();
+
+    static void begin(Display* display);
+    // @return false if an error was recorded since begin()
+    static bool end();
+
+    // Dernière erreur piégée par ce thread
+    static int errorCode();
+    static const char* errorMessage();
+};
+#endif
+
+#endif // X11ERRORTRAP_H
@@ -1,99 +1,199 @@
 #include "Application.h"
 #include "../utils/Logger.h"
+#include "../utils/Metrics.h"
+#include "../utils/FrameTracer.h"
 #include "../display/SDLRenderer.h"
 #include "../network/StreamServer.h"
+#include "../network/TileCache.h"
+#include "../network/MetricsHttpServer.h"
 #include "../audio/MicrophoneCapture.h"
 #include "../threading/ThreadPool.h"
 #include "../capture/ScreenCapture.h"
+#include "../capture/SyntheticFrameSource.h"
+#include "../capture/FileReplaySource.h"
+#include "../capture/CursorCapture.h"
+#include "../capture/FocusTracker.h"
 #include "common.h"
 #include <SDL2/SDL.h>
 #include <iostream>
 #include <memory>
 #include <cstring>                 
+#include <cstdlib>
+#include <cstdio>
 #include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <csignal>
 
-Application::Application() 
+namespace {
+    // Mode headless: SIGINT/SIGTERM demandent l'arrêt (SDL ne les gère plus)
+    volatile std::sig_atomic_t g_stop_requested = 0;
+
+    void onStopSignal(int) {
+        g_stop_requested = 1;
+    }
+
+    // Lecture de la position du curseur; un paquet CURSOR seulement s'il a bougé
+    constexpr int kCursorPollHz = 60;
+    // Fenêtre active: change rarement, trois allers-retours X par lecture
+    constexpr int kFocusPollHz = 4;
+}
+
+Application::Application(bool headless) 
     : window(nullptr)
     , renderer(nullptr)
     , isRunning(false)
     , streaming(false)
     , enableAudio(true)
     , audioFrameCounter(0)
+    , headless(headless)
     , enableStreaming(true)
     , streamPort(9999)
+    , metricsPort(0)
     , streamFps(30)
     , frameCounter(0) {
-    Logger::log(Logger::LogLevel::INFO, "Application created");
+    LOG_INFO("Application created");
 }
 
 Application::~Application() {
     shutdown();
-    Logger::log(Logger::LogLevel::INFO, "Application destroyed");
+    LOG_INFO("Application destroyed");
 }
 
 void Application::init() {
     Logger::init("app.log");
-    Logger::log(Logger::LogLevel::INFO, "Multimedia Streaming Application Starting");
 
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        Logger::log(Logger::LogLevel::WARN, "Failed to initialize SDL");
-        throw std::runtime_error("SDL initialization failed");
+    // Journal binaire des événements (capture, diffusion, envoi); désactivable
+    // avec SCREEN_SHARE_TRACE=off
+    const char* trace_path = getenv("SCREEN_SHARE_TRACE");
+    if (!trace_path || std::string(trace_path) != "off") {
+        Logger::openTrace(trace_path && trace_path[0] != '\0' ? trace_path : "app.trace");
     }
+    LOG_INFO("Multimedia Streaming Application Starting{}", headless ? " (headless)" : "");
+
+    // Headless: ni vidéo SDL ni renderer (MicrophoneCapture initialise
+    // lui-même le sous-système audio)
+    if (!headless) {
+        if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+            LOG_WARN("Failed to initialize SDL");
+            throw std::runtime_error("SDL initialization failed");
+        }
 
-    window = SDL_CreateWindow(
-        "Screen Share",
-        SDL_WINDOWPOS_CENTERED,
-        SDL_WINDOWPOS_CENTERED,
-        1280,
-        720,
-        SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
-    );
+        window = SDL_CreateWindow(
+            "Screen Share",
+            SDL_WINDOWPOS_CENTERED,
+            SDL_WINDOWPOS_CENTERED,
+            1280,
+            720,
+            SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
+        );
 
-    if (!window) {
-        Logger::log(Logger::LogLevel::WARN, "Failed to create window");
-        SDL_Quit();
-        throw std::runtime_error("Window creation failed");
+        if (!window) {
+            LOG_WARN("Failed to create window");
+            SDL_Quit();
+            throw std::runtime_error("Window creation failed");
+        }
+
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+        if (!renderer) {
+            LOG_WARN("Failed to create renderer");
+            SDL_DestroyWindow(window);
+            SDL_Quit();
+            throw std::runtime_error("Renderer creation failed");
+        }
     }
 
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-    if (!renderer) {
-        Logger::log(Logger::LogLevel::WARN, "Failed to create renderer");
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-        throw std::runtime_error("Renderer creation failed");
+    // Endpoint Prometheus optionnel: SCREEN_SHARE_METRICS_PORT=9100
+    const char* metrics_port = getenv("SCREEN_SHARE_METRICS_PORT");
+    if (metrics_port) {
+        metricsPort = std::atoi(metrics_port);
+    }
+    if (metricsPort > 0) {
+        metricsServer = std::make_unique<MetricsHttpServer>(metricsPort);
+        if (!metricsServer->start()) {
+            metricsServer.reset();
+        }
     }
 
     // Initialize streaming server
     if (enableStreaming) {
         streamServer = std::make_unique<StreamServer>("0.0.0.0", streamPort);
         if (streamServer->start()) {
-            Logger::log(Logger::LogLevel::INFO, "StreamServer started on port " + std::to_string(streamPort));
+            LOG_INFO("StreamServer started on port {}", streamPort);
             streaming = true;
             
+            // Source des frames: écran par défaut, ou contenu reproductible
+            // avec SCREEN_SHARE_SOURCE=synthetic:scroll:1920x1080 /
+            // replay:capture.raw:1280x720
+            const char* source_spec = getenv("SCREEN_SHARE_SOURCE");
+            std::string spec = source_spec && source_spec[0] != '\0' ? source_spec : "screen";
+
             // Check if we're running under Wayland
             const char* wayland_display = getenv("WAYLAND_DISPLAY");
             const char* xdg_session_type = getenv("XDG_SESSION_TYPE");
             bool is_wayland = (wayland_display && wayland_display[0] != '\0') || 
                              (xdg_session_type && std::string(xdg_session_type) == "wayland");
             
-            if (is_wayland) {
-                Logger::log(Logger::LogLevel::WARN, 
+            if (spec == "screen" && is_wayland) {
+                LOG_WARN(
                     "Wayland session detected. System-wide screen capture is not available. "
                     "Will capture SDL window content only. For full screen capture, please run under X11 session.");
             } else {
-                screenCapture = std::make_unique<ScreenCapture>();
-                if (screenCapture->init()) {
-                    Logger::log(Logger::LogLevel::INFO, "Screen capture initialized");
+                std::unique_ptr<FrameSource> frameSource = createFrameSource(spec);
+                if (frameSource && frameSource->init()) {
+                    LOG_INFO("Frame source initialized: {}", frameSource->name());
+                    frameSources.push_back(std::move(frameSource));
                 } else {
-                    Logger::log(Logger::LogLevel::WARN, "Failed to initialize screen capture: " + screenCapture->getLastError());
-                    Logger::log(Logger::LogLevel::WARN, "Will capture SDL window content only");
-                    screenCapture.reset();
+                    if (frameSource) {
+                        LOG_WARN("Failed to initialize frame source: {}", frameSource->getLastError());
+                    }
+                    LOG_WARN("Will capture SDL window content only");
                 }
             }
+
+            // Un flux par moniteur plutôt que leur rectangle englobant
+            const char* monitors_mode = getenv("SCREEN_SHARE_MONITORS");
+            if (spec == "screen" && !frameSources.empty() &&
+                monitors_mode && std::string(monitors_mode) == "each") {
+                setupMonitorStreams();
+            }
+
+            // Curseur en flux séparé quand les frames viennent de l'écran X
+            bool live_capture = spec == "screen" || spec.compare(0, 7, "window:") == 0;
+            if (live_capture && !frameSources.empty()) {
+                cursorCapture = std::make_unique<CursorCapture>();
+                focusTracker = std::make_unique<FocusTracker>();
+                // Capture de fenêtre: positions relatives à la fenêtre
+                if (auto* screen = dynamic_cast<ScreenCapture*>(frameSources.front().get())) {
+                    if (screen->getWindowId() != 0) {
+                        cursorCapture->setWindow(screen->getWindowId());
+                        focusTracker->setWindow(screen->getWindowId());
+                    }
+                }
+                if (!cursorCapture->init()) {
+                    LOG_INFO("Cursor not streamed: {}", cursorCapture->getLastError());
+                    cursorCapture.reset();
+                }
+                if (!focusTracker->init()) {
+                    LOG_INFO("Focused window not tracked: {}", focusTracker->getLastError());
+                    focusTracker.reset();
+                }
+            }
+
+            if (headless && frameSources.empty()) {
+                // Pas de fenêtre SDL à capturer en repli
+                streamServer->stop();
+                throw std::runtime_error("No frame source available in headless mode");
+            }
             
             // Thread will be started in run() after isRunning is set
         } else {
-            Logger::log(Logger::LogLevel::ERROR_LEVEL, "Failed to start StreamServer");
+            LOG_ERROR("Failed to start StreamServer");
+            if (headless) {
+                // Ni fenêtre ni flux: run() attendrait un signal sans rien faire
+                throw std::runtime_error("Failed to start StreamServer on port " +
+                                         std::to_string(streamPort) + " in headless mode");
+            }
         }
     }
     
@@ -127,31 +227,44 @@ void Application::init() {
         };
         
         if (microphone->startCapture(audioCallback)) {
-            Logger::log(Logger::LogLevel::INFO, "Microphone capture started");
+            LOG_INFO("Microphone capture started");
         } else {
-            Logger::log(Logger::LogLevel::WARN, "Failed to start microphone capture (device may not be available)");
+            LOG_WARN("Failed to start microphone capture (device may not be available)");
             microphone.reset();
         }
     }
 
-    Logger::log(Logger::LogLevel::INFO, "Application initialized successfully");
+    LOG_INFO("Application initialized successfully");
 }
 
 void Application::run() {
     if (isRunning) {
-        Logger::log(Logger::LogLevel::WARN, "Application already running");
+        LOG_WARN("Application already running");
         return;
     }
 
     isRunning = true;
-    Logger::log(Logger::LogLevel::INFO, "Application running...");
+    LOG_INFO("Application running...");
 
     // Start capture and stream thread now that isRunning is true
-    if (streaming && streamServer && !streamThread.joinable()) {
-        streamThread = std::thread(&Application::captureAndStream, this);
+    if (streaming && streamServer && streamThreads.empty()) {
+        if (frameSources.empty()) {
+            streamThreads.emplace_back(&Application::captureAndStream, this, nullptr, 0);
+        }
+        for (size_t i = 0; i < frameSources.size(); ++i) {
+            streamThreads.emplace_back(&Application::captureAndStream, this,
+                                       frameSources[i].get(), static_cast<uint8_t>(i));
+        }
+        if (cursorCapture || focusTracker) {
+            cursorThread = std::thread(&Application::streamCursor, this);
+        }
     }
 
-    mainLoop();
+    if (headless) {
+        waitForShutdownSignal();
+    } else {
+        mainLoop();
+    }
 }
 
 void Application::shutdown() {
@@ -160,7 +273,7 @@ void Application::shutdown() {
     }
 
     isRunning = false;
-    Logger::log(Logger::LogLevel::INFO, "Application shutting down...");
+    LOG_INFO("Application shutting down...");
 
     // Stop audio capture
     if (microphone) {
@@ -171,9 +284,17 @@ void Application::shutdown() {
     // Stop streaming
     if (streaming) {
         streaming = false;
-        if (streamThread.joinable()) {
-            streamThread.join();
+        for (std::thread& thread : streamThreads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+        streamThreads.clear();
+        if (cursorThread.joinable()) {
+            cursorThread.join();
         }
+        cursorCapture.reset();
+        focusTracker.reset();
     }
     
     if (streamServer) {
@@ -181,6 +302,11 @@ void Application::shutdown() {
         streamServer.reset();
     }
 
+    if (metricsServer) {
+        metricsServer->stop();
+        metricsServer.reset();
+    }
+
     if (renderer) {
         SDL_DestroyRenderer(renderer);
         renderer = nullptr;
@@ -191,6 +317,17 @@ void Application::shutdown() {
     }
     SDL_Quit();
 
+    LOG_INFO("Metrics at shutdown:\n{}", Metrics::dumpText());
+
+    // Spans par frame pour chrome://tracing / Perfetto
+    const char* frame_trace_path = getenv("SCREEN_SHARE_FRAME_TRACE");
+    if (frame_trace_path && frame_trace_path[0] != '\0') {
+        if (FrameTracer::dumpToFile(frame_trace_path)) {
+            LOG_INFO("Frame trace written to {}", frame_trace_path);
+        } else {
+            LOG_WARN("Cannot write frame trace to {}", frame_trace_path);
+        }
+    }
     Logger::shutdown();
 }
 
@@ -198,17 +335,17 @@ void Application::mainLoop() {
     SDL_Event event;
     bool quit = false;
 
-    Logger::log(Logger::LogLevel::INFO, "Entering main loop");
+    LOG_INFO("Entering main loop");
 
     while (!quit && isRunning) {
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 quit = true;
-                Logger::log(Logger::LogLevel::INFO, "Quit event received");
+                LOG_INFO("Quit event received");
             } else if (event.type == SDL_KEYDOWN) {
                 if (event.key.keysym.sym == SDLK_ESCAPE) {
                     quit = true;
-                    Logger::log(Logger::LogLevel::INFO, "Escape key pressed, quitting");
+                    LOG_INFO("Escape key pressed, quitting");
                 }
             }
         }
@@ -219,9 +356,24 @@ void Application::mainLoop() {
         SDL_Delay(16);
     }
 
-    Logger::log(Logger::LogLevel::INFO, "Exiting main loop - quit=" + std::string(quit ? "true" : "false") + 
-                ", isRunning=" + std::string(isRunning ? "true" : "false"));
-    isRunning = false;
+    // isRunning reste vrai: shutdown() s'en sert pour arrêter et joindre
+    // le thread de diffusion
+    LOG_INFO("Exiting main loop - quit={}, isRunning={}", quit, isRunning.load());
+}
+
+void Application::waitForShutdownSignal() {
+    g_stop_requested = 0;
+    auto previous_int = std::signal(SIGINT, onStopSignal);
+    auto previous_term = std::signal(SIGTERM, onStopSignal);
+
+    LOG_INFO("Running headless, waiting for SIGINT/SIGTERM");
+    while (isRunning && !g_stop_requested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    LOG_INFO("Stop requested, leaving headless wait");
+
+    std::signal(SIGINT, previous_int);
+    std::signal(SIGTERM, previous_term);
 }
 
 void Application::handleEvents() {
@@ -269,16 +421,110 @@ void Application::render() {
     SDL_RenderPresent(renderer);
 }
 
-std::vector<uint8_t> Application::captureFrame() {
-    // Use ScreenCapture if available, otherwise fallback to SDL renderer capture
-    if (screenCapture && screenCapture->isInitialized()) {
-        int width, height;
-        std::vector<uint8_t> pixels = screenCapture->captureScreen(width, height);
+void Application::setupMonitorStreams() {
+    ScreenCapture* screen = dynamic_cast<ScreenCapture*>(frameSources.front().get());
+    std::vector<MonitorInfo> monitors = screen ? screen->getMonitors() : std::vector<MonitorInfo>();
+    if (monitors.size() < 2) {
+        LOG_INFO("Single monitor, streaming the whole screen");
+        return;
+    }
+
+    // Une connexion X par moniteur: chaque thread capture et convertit
+    // sa sortie en parallèle des autres
+    std::vector<std::unique_ptr<FrameSource>> sources;
+    std::vector<StreamInfo> streams;
+    for (const MonitorInfo& monitor : monitors) {
+        if (sources.size() >= MAX_VIDEO_STREAMS) {
+            break;
+        }
+        auto capture = std::make_unique<ScreenCapture>();
+        capture->setMonitor(monitor);
+        if (!capture->init()) {
+            LOG_WARN("Cannot capture monitor {}: {}", monitor.name, capture->getLastError());
+            continue;
+        }
+
+        StreamInfo info = {};
+        info.stream_id = static_cast<uint8_t>(sources.size());
+        info.primary = monitor.primary ? 1 : 0;
+        info.x = static_cast<int16_t>(monitor.x);
+        info.y = static_cast<int16_t>(monitor.y);
+        info.width = static_cast<uint16_t>(monitor.width);
+        info.height = static_cast<uint16_t>(monitor.height);
+        snprintf(info.name, sizeof(info.name), "%s", monitor.name.c_str());
+        streams.push_back(info);
+
+        LOG_INFO("Stream {}: monitor {} {}x{}+{}+{}{}", (int)info.stream_id, monitor.name,
+                 monitor.width, monitor.height, monitor.x, monitor.y, monitor.primary ? " (primary)" : "");
+        sources.push_back(std::move(capture));
+    }
+
+    if (!sources.empty()) {
+        frameSources = std::move(sources);
+        streamServer->setVideoStreams(streams);
+    }
+}
+
+std::unique_ptr<FrameSource> Application::createFrameSource(const std::string& spec) {
+    if (spec == "screen") {
+        return std::make_unique<ScreenCapture>();
+    }
+
+    // window:<xid> (0x... ou décimal) ou window:<partie du titre>; traité
+    // avant le suffixe de taille, le titre pouvant contenir ':'
+    const std::string window_prefix = "window:";
+    if (spec.compare(0, window_prefix.size(), window_prefix) == 0 && spec.size() > window_prefix.size()) {
+        std::string target = spec.substr(window_prefix.size());
+        auto capture = std::make_unique<ScreenCapture>();
+        char* end = nullptr;
+        unsigned long xid = strtoul(target.c_str(), &end, 0);
+        if (xid != 0 && end && *end == '\0') {
+            capture->setWindow(xid);
+        } else {
+            capture->setWindowTitle(target);
+        }
+        return capture;
+    }
+
+    // <kind>:<argument>[:<width>x<height>]
+    std::string kind = spec.substr(0, spec.find(':'));
+    std::string rest = spec.size() > kind.size() ? spec.substr(kind.size() + 1) : "";
+    int width = 1280;
+    int height = 720;
+    size_t size_sep = rest.rfind(':');
+    if (size_sep != std::string::npos &&
+        sscanf(rest.c_str() + size_sep + 1, "%dx%d", &width, &height) == 2) {
+        rest.resize(size_sep);
+    }
+
+    if (kind == "synthetic") {
+        SyntheticFrameSource::Pattern pattern = SyntheticFrameSource::Pattern::STATIC_DESKTOP;
+        if (!rest.empty() && !SyntheticFrameSource::parsePattern(rest, pattern)) {
+            LOG_ERROR("Unknown synthetic pattern '{}' (expected static, scroll or noise)", rest);
+            return nullptr;
+        }
+        return std::make_unique<SyntheticFrameSource>(pattern, width, height);
+    }
+    if (kind == "replay" && !rest.empty()) {
+        return std::make_unique<FileReplaySource>(rest, width, height);
+    }
+
+    LOG_ERROR("Invalid SCREEN_SHARE_SOURCE '{}'", spec);
+    return nullptr;
+}
+
+std::vector<uint8_t> Application::captureFrame(FrameSource* source, int& width, int& height) {
+    // Use the frame source if available, otherwise fallback to SDL renderer capture
+    if (source && source->isInitialized()) {
+        std::vector<uint8_t> pixels = source->captureFrame(width, height);
         
         if (!pixels.empty()) {
             return pixels;
         } else {
-            Logger::log(Logger::LogLevel::WARN, "Screen capture failed: " + screenCapture->getLastError());
+            LOG_WARN("Frame capture failed ({}): {}", source->name(), source->getLastError());
+            if (frameSources.size() > 1) {
+                return pixels;  // un moniteur parmi d'autres: pas de repli sur la fenêtre
+            }
         }
     }
     
@@ -288,7 +534,6 @@ std::vector<uint8_t> Application::captureFrame() {
         return std::vector<uint8_t>();
     }
     
-    int width, height;
     SDL_GetWindowSize(window, &width, &height);
     
     // Create surface to read pixels
@@ -298,14 +543,14 @@ std::vector<uint8_t> Application::captureFrame() {
                                                   0x000000FF,
                                                   0xFF000000);
     if (!surface) {
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, "Failed to create surface for capture");
+        LOG_ERROR("Failed to create surface for capture");
         return std::vector<uint8_t>();
     }
     
-    // Read pixels from renderer
-    if (SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB8888,
+    // Read pixels from renderer, as A, R, G, B bytes like ScreenCapture
+    if (SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB32,
                             surface->pixels, surface->pitch) != 0) {
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, "Failed to read pixels: " + std::string(SDL_GetError()));
+        LOG_ERROR("Failed to read pixels: {}", SDL_GetError());
         SDL_FreeSurface(surface);
         return std::vector<uint8_t>();
     }
@@ -319,53 +564,185 @@ std::vector<uint8_t> Application::captureFrame() {
     return pixels;
 }
 
-void Application::captureAndStream() {
-    Logger::log(Logger::LogLevel::INFO, "Capture and stream thread started");
+void Application::streamCursor() {
+    LOG_INFO("Cursor stream thread started");
+
+    using Clock = std::chrono::steady_clock;
+    const std::chrono::microseconds interval(1000000 / kCursorPollHz);
+    Counter& cursor_updates = Metrics::counter("cursor_updates_total");
+    Counter& cursor_shapes = Metrics::counter("cursor_shapes_total");
+    CursorPosition last = {};
+    bool has_last = false;
+    bool failing = false;
+    int focus_countdown = 0;
+    int focus[4] = {0, 0, 0, 0};
+    Clock::time_point next = Clock::now();
+
+    while (streaming && isRunning) {
+        next += interval;
+        if (next < Clock::now()) {
+            next = Clock::now();
+        }
+        std::this_thread::sleep_until(next);
+
+        if (!streamServer || streamServer->getClientCount() == 0) {
+            continue;
+        }
+
+        // Fenêtre active, quelques fois par seconde; aucune: zone vide
+        if (focusTracker && --focus_countdown <= 0) {
+            focus_countdown = kCursorPollHz / kFocusPollHz;
+            int rect[4] = {0, 0, 0, 0};
+            if (!focusTracker->poll(rect[0], rect[1], rect[2], rect[3])) {
+                std::fill(rect, rect + 4, 0);
+            }
+            if (!std::equal(rect, rect + 4, focus)) {
+                std::copy(rect, rect + 4, focus);
+                streamServer->setFocusWindow(rect[0], rect[1], rect[2], rect[3]);
+            }
+        }
+        if (!cursorCapture) {
+            continue;
+        }
+
+        CursorPosition position;
+        std::shared_ptr<const CursorImage> shape;
+        if (!cursorCapture->poll(position, shape)) {
+            if (!failing) {
+                LOG_WARN("Cursor capture failed: {}", cursorCapture->getLastError());
+            }
+            failing = true;
+            continue;
+        }
+        failing = false;
+        if (shape) {
+            streamServer->setCursorShape(shape);
+            cursor_shapes.inc();
+        }
+
+        // Pointeur immobile: rien à envoyer
+        if (has_last && position.x == last.x && position.y == last.y &&
+            position.shape_serial == last.shape_serial && position.visible == last.visible) {
+            continue;
+        }
+        streamServer->broadcastCursor(position);
+        cursor_updates.inc();
+        last = position;
+        has_last = true;
+    }
+
+    LOG_INFO("Cursor stream thread ended");
+}
+
+void Application::captureAndStream(FrameSource* source, uint8_t streamId) {
+    LOG_INFO("Capture and stream thread started (stream {}: {})", (int)streamId,
+             source ? source->name() : "SDL window");
     
-    const int targetFrameTime = 1000 / streamFps; // ms per frame
-    uint32_t lastFrameTime = SDL_GetTicks();
+    // Horloge monotone: ne dépend plus de SDL (mode headless)
+    using Clock = std::chrono::steady_clock;
+    const std::chrono::microseconds targetFrameTime(1000000 / streamFps);
+    Clock::time_point lastFrameTime = Clock::now();
     uint32_t localFrameCounter = 0;
+
+    Histogram& capture_time = Metrics::histogram("frame_capture_us");
+    Histogram& broadcast_time = Metrics::histogram("frame_broadcast_us");
+    Counter& frames_captured = Metrics::counter("frames_captured_total");
+    Counter& dropped_late = Metrics::counter("frames_dropped_total", "reason=\"late\"");
+    Counter& dropped_capture = Metrics::counter("frames_dropped_total", "reason=\"capture_failed\"");
+    Histogram& fingerprint_time = Metrics::histogram("frame_fingerprint_us");
+    Counter& frames_repeated = Metrics::counter("frames_repeated_total");
+    uint64_t lastFingerprint = 0;
+    bool hasFingerprint = false;
     
     while (streaming && isRunning) {
-        uint32_t currentTime = SDL_GetTicks();
-        uint32_t elapsed = currentTime - lastFrameTime;
+        Clock::time_point currentTime = Clock::now();
+        auto elapsed = currentTime - lastFrameTime;
         
         if (elapsed >= targetFrameTime) {
             lastFrameTime = currentTime;
+
+            // Aucun client abonné à ce flux: ni capture ni conversion
+            if (streamServer && streamServer->getSubscriberCount(streamId) == 0) {
+                std::this_thread::sleep_until(lastFrameTime + targetFrameTime);
+                continue;
+            }
+
+            // Échéances manquées depuis la dernière capture
+            if (elapsed >= 2u * targetFrameTime) {
+                dropped_late.inc(static_cast<uint64_t>(elapsed / targetFrameTime - 1));
+            }
             
+            // Span racine: les étapes suivantes héritent du numéro de frame
+            FrameSpan frame_span("frame", localFrameCounter);
+
             // Capture frame
-            std::vector<uint8_t> frameData = captureFrame();
+            Logger::trace(TraceEvent::CAPTURE_BEGIN, localFrameCounter);
+            uint64_t captureStartUs = get_monotonic_us();
+            std::vector<uint8_t> frameData;
+            int width = 0;
+            int height = 0;
+            {
+                ScopedTimer timer(capture_time);
+                FrameSpan span("capture");
+                frameData = captureFrame(source, width, height);
+            }
+            Logger::trace(TraceEvent::CAPTURE_END, localFrameCounter, 0, frameData.size());
+
+            if (frameData.empty()) {
+                dropped_capture.inc();
+            } else {
+                frames_captured.inc();
+            }
+
+            // Empreinte de la frame entière (4 voies de 64 bits, comme les
+            // tuiles): une frame identique à la précédente n'est ni
+            // convertie ni envoyée, seulement annoncée (FRAME_REPEAT)
+            bool unchanged = false;
+            if (!frameData.empty() && frameData.size() == static_cast<size_t>(width) * height * 4) {
+                ScopedTimer timer(fingerprint_time);
+                uint64_t fingerprint = TileCache::hashTile(frameData.data(), static_cast<size_t>(width) * 4,
+                                                           width, height);
+                unchanged = hasFingerprint && fingerprint == lastFingerprint;
+                lastFingerprint = fingerprint;
+                hasFingerprint = true;
+            } else {
+                hasFingerprint = false;
+            }
             
             if (!frameData.empty() && streamServer) {
-                int width, height;
-                SDL_GetWindowSize(window, &width, &height);
-                
                 // Create VideoFrame
                 VideoFrame frame;
                 frame.frame_number = localFrameCounter++;
                 frame.width = width;
                 frame.height = height;
                 frame.quality = 80;
-                frame.timestamp = get_timestamp_us();
+                frame.timestamp = captureStartUs;
+                frame.stream_id = streamId;
                 frame.data = std::move(frameData);
                 
                 // Broadcast to all clients
-                streamServer->broadcastVideoFrame(frame);
+                {
+                    ScopedTimer timer(broadcast_time);
+                    FrameSpan span("broadcast");
+                    // Un abonné sans la frame précédente: diffusion normale
+                    if (unchanged && streamServer->repeatVideoFrame(frame)) {
+                        frames_repeated.inc();
+                    } else {
+                        streamServer->broadcastVideoFrame(frame);
+                    }
+                }
                 
                 // Log every 30 frames
                 if (localFrameCounter % 30 == 0) {
-                    size_t clientCount = streamServer->getClientCount();
-                    std::string audioStatus = microphone ? " (audio: ON)" : " (audio: OFF)";
-                    Logger::log(Logger::LogLevel::INFO, 
-                        "Streamed video frame " + std::to_string(localFrameCounter) + 
-                        " to " + std::to_string(clientCount) + " client(s)" + audioStatus);
+                    LOG_DEBUG("Streamed video frame {} to {} client(s) (audio: {})",
+                              localFrameCounter, streamServer->getClientCount(), microphone ? "ON" : "OFF");
                 }
             }
         }
         
-        // Sleep to avoid busy waiting
-        SDL_Delay(5);
+        // Sleep until the next deadline instead of polling
+        std::this_thread::sleep_until(lastFrameTime + targetFrameTime);
     }
     
-    Logger::log(Logger::LogLevel::INFO, "Capture and stream thread ended");
+    LOG_INFO("Capture and stream thread ended");
 }
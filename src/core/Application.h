@@ -8,14 +8,20 @@
 #include <memory>
 #include <vector>
 #include <mutex>
+#include <string>
 
 class StreamServer;
+class MetricsHttpServer;
 class MicrophoneCapture;
-class ScreenCapture;
+class FrameSource;
+class CursorCapture;
+class FocusTracker;
 
 class Application {
 public:
-    Application();
+    // headless: pas de fenêtre SDL ni de boucle de rendu, seulement
+    // capture, audio et StreamServer
+    explicit Application(bool headless = false);
     ~Application();
 
     void init();
@@ -24,10 +30,14 @@ public:
 
 private:
     void mainLoop();
+    void waitForShutdownSignal();
     void handleEvents();
     void render();
-    void captureAndStream();
-    std::vector<uint8_t> captureFrame();
+    void captureAndStream(FrameSource* source, uint8_t streamId);
+    void streamCursor();
+    std::vector<uint8_t> captureFrame(FrameSource* source, int& width, int& height);
+    void setupMonitorStreams();
+    std::unique_ptr<FrameSource> createFrameSource(const std::string& spec);
     
     SDL_Window* window;
     SDL_Renderer* renderer;
@@ -37,8 +47,16 @@ private:
     
     // Streaming components
     std::unique_ptr<StreamServer> streamServer;
-    std::unique_ptr<ScreenCapture> screenCapture;
-    std::thread streamThread;
+    std::unique_ptr<MetricsHttpServer> metricsServer;
+    // Une source et un thread de capture par flux vidéo (un par moniteur
+    // avec SCREEN_SHARE_MONITORS=each); aucune source: fenêtre SDL
+    std::vector<std::unique_ptr<FrameSource>> frameSources;
+    std::vector<std::thread> streamThreads;
+    // Position et forme du curseur hors frames (XFixes), écran X seulement
+    std::unique_ptr<CursorCapture> cursorCapture;
+    // Fenêtre active, zone d'intérêt des tuiles; lue par le thread du curseur
+    std::unique_ptr<FocusTracker> focusTracker;
+    std::thread cursorThread;
     std::atomic<bool> streaming;
     
     // Audio components
@@ -47,8 +65,10 @@ private:
     uint32_t audioFrameCounter;
     
     // Configuration
+    bool headless;
     bool enableStreaming;
     int streamPort;
+    int metricsPort;    // 0 = pas d'endpoint /metrics
     int streamFps;
     uint32_t frameCounter;
 };
@@ -18,8 +18,7 @@ SDLRenderer::~SDLRenderer() {
 
 bool SDLRenderer::init(int width, int height) {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        std::string msg = "Failed to initialize SDL: " + std::string(SDL_GetError());
-        Logger::log(Logger::LogLevel::WARN, msg);
+        LOG_WARN("Failed to initialize SDL: {}", SDL_GetError());
         return false;
     }
 
@@ -33,23 +32,20 @@ bool SDLRenderer::init(int width, int height) {
     );
 
     if (!window) {
-        std::string msg = "Failed to create window: " + std::string(SDL_GetError());
-        Logger::log(Logger::LogLevel::WARN, msg);
+        LOG_WARN("Failed to create window: {}", SDL_GetError());
         SDL_Quit();
         return false;
     }
 
     renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     if (!renderer) {
-        std::string msg = "Failed to create renderer: " + std::string(SDL_GetError());
-        Logger::log(Logger::LogLevel::WARN, msg);
+        LOG_WARN("Failed to create renderer: {}", SDL_GetError());
         SDL_DestroyWindow(window);
         SDL_Quit();
         return false;
     }
 
-    std::string msg = "SDLRenderer initialized: " + std::to_string(width) + "x" + std::to_string(height);
-    Logger::log(Logger::LogLevel::INFO, msg);
+    LOG_INFO("SDLRenderer initialized: {}x{}", width, height);
     return true;
 }
 
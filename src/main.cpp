@@ -1,18 +1,32 @@
 #include <iostream>
 #include <exception>
+#include <string>
 #include "core/Application.h"
 #include "utils/Logger.h"
 
 int main(int argc, char* argv[]) {
+    // --headless: serveur de capture sans fenêtre (arrêt par SIGINT/SIGTERM)
+    bool headless = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            headless = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n"
+                      << "Usage: " << argv[0] << " [--headless]" << std::endl;
+            return 1;
+        }
+    }
+
     try {
-        Application app;
+        Application app(headless);
         app.init();
         app.run();
         app.shutdown();
         return 0;
     } catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << std::endl;
-        LOG_ERROR(std::string("Fatal error: ") + e.what());
+        LOG_ERROR("Fatal error: {}", e.what());
         return -1;
     }
 }
\ No newline at end of file
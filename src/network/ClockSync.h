@@ -0,0 +1,78 @@
+#ifndef CLOCKSYNC_H
+#define CLOCKSYNC_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * NTP-style clock offset estimator
+ *
+ * Each HEARTBEAT/ACK round trip gives four timestamps: t0 (client send),
+ * t1 (server receive), t2 (server send), t3 (client receive). The offset
+ * estimate ((t1 - t0) + (t2 - t3)) / 2 is exact when both directions take
+ * the same time, so among the last kWindow samples the one with the
+ * smallest round trip (least queuing) is kept.
+ *
+ * addSample() is called from a single thread; the getters are safe from
+ * any thread.
+ */
+class ClockSync {
+public:
+    static constexpr size_t kWindow = 8;
+
+    ClockSync() : count_(0), next_(0), valid_(false), offset_us_(0), rtt_us_(0) {}
+
+    void addSample(uint64_t t0, uint64_t t1, uint64_t t2, uint64_t t3) {
+        if (t3 < t0 || t2 < t1) {
+            return;
+        }
+        int64_t rtt = static_cast<int64_t>(t3 - t0) - static_cast<int64_t>(t2 - t1);
+        Sample sample;
+        sample.rtt_us = static_cast<uint64_t>(rtt > 0 ? rtt : 0);
+        sample.offset_us = (static_cast<int64_t>(t1 - t0) + (static_cast<int64_t>(t2) - static_cast<int64_t>(t3))) / 2;
+
+        samples_[next_] = sample;
+        next_ = (next_ + 1) % kWindow;
+        if (count_ < kWindow) {
+            count_++;
+        }
+
+        const Sample* best = &samples_[0];
+        for (size_t i = 1; i < count_; ++i) {
+            if (samples_[i].rtt_us < best->rtt_us) {
+                best = &samples_[i];
+            }
+        }
+        offset_us_.store(best->offset_us, std::memory_order_relaxed);
+        rtt_us_.store(best->rtt_us, std::memory_order_relaxed);
+        valid_.store(true, std::memory_order_release);
+    }
+
+    bool hasEstimate() const { return valid_.load(std::memory_order_acquire); }
+
+    // Horloge serveur - horloge client
+    int64_t offsetUs() const { return offset_us_.load(std::memory_order_relaxed); }
+    uint64_t rttUs() const { return rtt_us_.load(std::memory_order_relaxed); }
+
+    // Convertit un horodatage monotone serveur en horloge client
+    uint64_t serverToLocal(uint64_t server_us) const {
+        return static_cast<uint64_t>(static_cast<int64_t>(server_us) - offsetUs());
+    }
+
+private:
+    struct Sample {
+        int64_t offset_us = 0;
+        uint64_t rtt_us = 0;
+    };
+
+    std::array<Sample, kWindow> samples_;
+    size_t count_;
+    size_t next_;
+    std::atomic<bool> valid_;
+    std::atomic<int64_t> offset_us_;
+    std::atomic<uint64_t> rtt_us_;
+};
+
+#endif // CLOCKSYNC_H
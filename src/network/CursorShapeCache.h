@@ -0,0 +1,72 @@
+#ifndef CURSORSHAPECACHE_H
+#define CURSORSHAPECACHE_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "common.h"
+
+/**
+ * Cursor shapes indexed by XFixes serial, least recently used evicted first
+ *
+ * The server only sends CURSOR_SHAPE for a serial missing from its cache;
+ * the client caches what it receives and marks a shape used on every
+ * CURSOR packet naming it. Both see the same sequence of uses, so with a
+ * client capacity at least as large as the server's, a shape the server
+ * considers sent is still known by the client.
+ *
+ * Not thread-safe: the owner serializes access.
+ */
+class CursorShapeCache {
+public:
+    static constexpr size_t kServerCapacity = 16;
+    static constexpr size_t kClientCapacity = 32;
+
+    explicit CursorShapeCache(size_t capacity) : capacity_(capacity) {}
+
+    // Forme de ce numéro, marquée la plus récente; nullptr si absente
+    std::shared_ptr<const CursorImage> find(uint32_t serial) {
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            if (entries_[i]->serial == serial) {
+                std::shared_ptr<const CursorImage> image = entries_[i];
+                entries_.erase(entries_.begin() + static_cast<std::ptrdiff_t>(i));
+                entries_.push_back(image);
+                return image;
+            }
+        }
+        return nullptr;
+    }
+
+    // Sans toucher à l'ordre LRU (aucun paquet ne le signale au client)
+    bool contains(uint32_t serial) const {
+        for (const auto& entry : entries_) {
+            if (entry->serial == serial) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void insert(std::shared_ptr<const CursorImage> image) {
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            if (entries_[i]->serial == image->serial) {
+                entries_.erase(entries_.begin() + static_cast<std::ptrdiff_t>(i));
+                break;
+            }
+        }
+        if (entries_.size() >= capacity_ && !entries_.empty()) {
+            entries_.erase(entries_.begin());
+        }
+        entries_.push_back(std::move(image));
+    }
+
+    // Du moins au plus récemment utilisé
+    const std::vector<std::shared_ptr<const CursorImage>>& entries() const { return entries_; }
+    size_t size() const { return entries_.size(); }
+
+private:
+    size_t capacity_;
+    std::vector<std::shared_ptr<const CursorImage>> entries_;
+};
+
+#endif // CURSORSHAPECACHE_H
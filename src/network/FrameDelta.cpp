@@ -0,0 +1,381 @@
+#include "FrameDelta.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+    // En dessous (lignes ou colonnes), un changement n'est pas un défilement
+    constexpr int kMinScrollSpan = 8;
+    // Ligne présente plus souvent (p.ex. vide): ne désigne aucun décalage
+    constexpr size_t kMaxHashRepeats = 4;
+    constexpr uint64_t kHashSeed = 0xCBF29CE484222325ull;
+
+    inline uint64_t mixHash(uint64_t hash, uint32_t value) {
+        return (hash ^ value) * 0x100000001B3ull;
+    }
+
+    // Quatre chaînes indépendantes de deux pixels: la latence des
+    // multiplications se recouvre
+    uint64_t hashPixels(const uint8_t* pixels, int count) {
+        uint64_t lanes[4] = {kHashSeed, kHashSeed + 1, kHashSeed + 2, kHashSeed + 3};
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            for (int lane = 0; lane < 4; ++lane) {
+                uint64_t pair;
+                memcpy(&pair, pixels + (i + lane * 2) * 4, 8);
+                lanes[lane] = (lanes[lane] ^ pair) * 0x100000001B3ull;
+            }
+        }
+        uint64_t hash = kHashSeed;
+        for (uint64_t lane : lanes) {
+            hash = (hash ^ lane ^ (lane >> 32)) * 0x100000001B3ull;
+        }
+        for (; i < count; ++i) {
+            uint32_t pixel;
+            memcpy(&pixel, pixels + i * 4, 4);
+            hash = mixHash(hash, pixel);
+        }
+        return hash;
+    }
+
+    inline uint32_t pixelAt(const uint8_t* frame, int width, int x, int y) {
+        uint32_t value;
+        memcpy(&value, frame + (static_cast<size_t>(y) * width + x) * 4, 4);
+        return value;
+    }
+
+    UpdateCommand makeCommand(UpdateCommandType type, int x, int y, int width, int height, int src_x, int src_y) {
+        UpdateCommand command;
+        command.type = static_cast<uint8_t>(type);
+        command.x = static_cast<uint16_t>(x);
+        command.y = static_cast<uint16_t>(y);
+        command.width = static_cast<uint16_t>(width);
+        command.height = static_cast<uint16_t>(height);
+        command.src_x = static_cast<uint16_t>(src_x);
+        command.src_y = static_cast<uint16_t>(src_y);
+        return command;
+    }
+
+    /**
+     * Offset voted by the most lines: current[i] == previous[i + offset].
+     * Hashes repeated more than kMaxHashRepeats times in previous are
+     * ignored, blank lines would otherwise vote for every offset.
+     */
+    int voteOffset(const std::vector<uint64_t>& previous, const std::vector<uint64_t>& current, int& votes) {
+        const int count = static_cast<int>(previous.size());
+        std::vector<std::pair<uint64_t, int>> sorted(previous.size());
+        for (int i = 0; i < count; ++i) {
+            sorted[i] = std::make_pair(previous[i], i);
+        }
+        std::sort(sorted.begin(), sorted.end());
+
+        // counts[offset + count]
+        std::vector<int> counts(2 * static_cast<size_t>(count) + 1, 0);
+        for (int i = 0; i < count; ++i) {
+            auto first = std::lower_bound(sorted.begin(), sorted.end(), std::make_pair(current[i], -1));
+            auto last = first;
+            while (last != sorted.end() && last->first == current[i]) {
+                ++last;
+            }
+            if (static_cast<size_t>(last - first) > kMaxHashRepeats) {
+                continue;
+            }
+            for (auto it = first; it != last; ++it) {
+                counts[it->second - i + count]++;
+            }
+        }
+
+        // À égalité, le plus petit décalage
+        int best = 0;
+        votes = 0;
+        for (int offset = 1; offset < count; ++offset) {
+            for (int candidate : {offset, -offset}) {
+                if (counts[candidate + count] > votes) {
+                    votes = counts[candidate + count];
+                    best = candidate;
+                }
+            }
+        }
+        return best;
+    }
+
+    // Lignes de la destination identiques à leur source dans previous
+    int matchingRows(const uint8_t* previous, const uint8_t* current, int width, const UpdateCommand& copy) {
+        size_t row_bytes = static_cast<size_t>(copy.width) * 4;
+        int matches = 0;
+        for (int row = 0; row < copy.height; ++row) {
+            const uint8_t* src = previous + (static_cast<size_t>(copy.src_y + row) * width + copy.src_x) * 4;
+            const uint8_t* dst = current + (static_cast<size_t>(copy.y + row) * width + copy.x) * 4;
+            if (memcmp(src, dst, row_bytes) == 0) {
+                matches++;
+            }
+        }
+        return matches;
+    }
+
+    // Tuiles entières de la grille dans rect, qui doivent être modifiées;
+    // les marges restent des RAW_RECT
+    void splitTiles(const uint8_t* reference, const uint8_t* current, int width, const UpdateCommand& rect,
+                    int tile_size, std::vector<UpdateCommand>& commands) {
+        const int x_end = rect.x + rect.width;
+        const int y_end = rect.y + rect.height;
+        const int bx0 = (rect.x + tile_size - 1) / tile_size * tile_size;
+        const int by0 = (rect.y + tile_size - 1) / tile_size * tile_size;
+        const int bx1 = x_end / tile_size * tile_size;
+        const int by1 = y_end / tile_size * tile_size;
+        if (bx1 <= bx0 || by1 <= by0) {
+            commands.push_back(rect);
+            return;
+        }
+
+        auto strip = [&](int x, int y, int w, int h) {
+            if (w > 0 && h > 0) {
+                commands.push_back(makeCommand(UpdateCommandType::RAW_RECT, x, y, w, h, 0, 0));
+            }
+        };
+        strip(rect.x, rect.y, rect.width, by0 - rect.y);
+        strip(rect.x, by0, bx0 - rect.x, by1 - by0);
+        strip(bx1, by0, x_end - bx1, by1 - by0);
+        strip(rect.x, by1, rect.width, y_end - by1);
+
+        const size_t stride = static_cast<size_t>(width) * 4;
+        const size_t tile_bytes = static_cast<size_t>(tile_size) * 4;
+        for (int ty = by0; ty < by1; ty += tile_size) {
+            for (int tx = bx0; tx < bx1; tx += tile_size) {
+                bool changed = false;
+                for (int row = ty; row < ty + tile_size && !changed; ++row) {
+                    size_t offset = row * stride + static_cast<size_t>(tx) * 4;
+                    changed = memcmp(reference + offset, current + offset, tile_bytes) != 0;
+                }
+                if (changed) {
+                    commands.push_back(makeCommand(UpdateCommandType::CACHE_TILE, tx, ty, tile_size, tile_size, 0, 0));
+                }
+            }
+        }
+    }
+}
+
+bool FrameDelta::detectScroll(const uint8_t* previous, const uint8_t* current,
+                              int width, int height, UpdateCommand& copy) {
+    const size_t stride = static_cast<size_t>(width) * 4;
+
+    // Lignes modifiées et leur étendue horizontale; coverage[x]: nombre de
+    // ces étendues qui couvrent la colonne x (différences cumulées)
+    std::vector<int> coverage(width + 1, 0);
+    int changed_rows = 0;
+    int y0 = height;
+    int y1 = 0;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* prev_row = previous + y * stride;
+        const uint8_t* cur_row = current + y * stride;
+        if (memcmp(prev_row, cur_row, stride) == 0) {
+            continue;
+        }
+        int first = 0;
+        while (memcmp(prev_row + first * 4, cur_row + first * 4, 4) == 0) {
+            first++;
+        }
+        int last = width;
+        while (memcmp(prev_row + (last - 1) * 4, cur_row + (last - 1) * 4, 4) == 0) {
+            last--;
+        }
+        coverage[first]++;
+        coverage[last]--;
+        changed_rows++;
+        y0 = std::min(y0, y);
+        y1 = y + 1;
+    }
+    if (changed_rows < kMinScrollSpan) {
+        return false;
+    }
+
+    // Bande défilante: plus longue suite de colonnes couvertes par au moins
+    // 1/8 des lignes modifiées (un curseur qui clignote ailleurs ne l'élargit pas)
+    int threshold = std::max(1, changed_rows / 8);
+    int x0 = 0;
+    int x1 = 0;
+    for (int x = 0, covered = 0, start = -1; x <= width; ++x) {
+        covered += x < width ? coverage[x] : 0;
+        bool hot = x < width && covered >= threshold;
+        if (hot && start < 0) {
+            start = x;
+        } else if (!hot && start >= 0) {
+            if (x - start > x1 - x0) {
+                x0 = start;
+                x1 = x;
+            }
+            start = -1;
+        }
+    }
+    const int box_w = x1 - x0;
+    const int box_h = y1 - y0;
+    if (box_w < kMinScrollSpan) {
+        return false;
+    }
+
+    // Défilement vertical: hachage des lignes de la bande
+    int dx = 0;
+    int dy = 0;
+    int votes = 0;
+    {
+        std::vector<uint64_t> prev_hash(box_h);
+        std::vector<uint64_t> cur_hash(box_h);
+        for (int row = 0; row < box_h; ++row) {
+            size_t offset = (y0 + row) * stride + static_cast<size_t>(x0) * 4;
+            prev_hash[row] = hashPixels(previous + offset, box_w);
+            cur_hash[row] = hashPixels(current + offset, box_w);
+        }
+        dy = voteOffset(prev_hash, cur_hash, votes);
+        if (votes < std::max(kMinScrollSpan / 2, box_h / 8)) {
+            dy = 0;
+        }
+    }
+
+    // Sinon horizontal: hachage des colonnes, accumulé ligne par ligne
+    if (dy == 0) {
+        std::vector<uint64_t> prev_hash(box_w, kHashSeed);
+        std::vector<uint64_t> cur_hash(box_w, kHashSeed);
+        for (int y = y0; y < y1; ++y) {
+            for (int col = 0; col < box_w; ++col) {
+                prev_hash[col] = mixHash(prev_hash[col], pixelAt(previous, width, x0 + col, y));
+                cur_hash[col] = mixHash(cur_hash[col], pixelAt(current, width, x0 + col, y));
+            }
+        }
+        dx = voteOffset(prev_hash, cur_hash, votes);
+        if (votes < std::max(kMinScrollSpan / 2, box_w / 8)) {
+            return false;
+        }
+    }
+
+    // Destination: la bande privée de ce qui sort de la source
+    int dst_x0 = x0 + std::max(0, -dx);
+    int dst_x1 = x1 - std::max(0, dx);
+    int dst_y0 = y0 + std::max(0, -dy);
+    int dst_y1 = y1 - std::max(0, dy);
+    if (dst_x1 - dst_x0 < kMinScrollSpan || dst_y1 - dst_y0 < 1) {
+        return false;
+    }
+
+    // Colonnes voisines qui suivent le même défilement (marges unies, texte
+    // court): limites communes à toutes les lignes, parcourues ligne par ligne
+    if (dx == 0) {
+        int left = 0;
+        int right = width;
+        for (int y = dst_y0; y < dst_y1 && (left < dst_x0 || right > dst_x1); ++y) {
+            const uint8_t* cur_row = current + y * stride;
+            const uint8_t* prev_row = previous + (y + dy) * stride;
+            int x = dst_x0;
+            while (x > left && memcmp(cur_row + (x - 1) * 4, prev_row + (x - 1) * 4, 4) == 0) {
+                x--;
+            }
+            left = x;
+            x = dst_x1;
+            while (x < right && memcmp(cur_row + x * 4, prev_row + x * 4, 4) == 0) {
+                x++;
+            }
+            right = x;
+        }
+        dst_x0 = left;
+        dst_x1 = right;
+    }
+
+    copy = makeCommand(UpdateCommandType::COPY_RECT, dst_x0, dst_y0, dst_x1 - dst_x0, dst_y1 - dst_y0,
+                       dst_x0 + dx, dst_y0 + dy);
+
+    // Les hachages ont voté; les pixels confirment pour au moins la moitié des lignes
+    return matchingRows(previous, current, width, copy) * 2 >= copy.height;
+}
+
+std::vector<UpdateCommand> FrameDelta::compute(const uint8_t* previous, const uint8_t* current,
+                                               int width, int height, int tile_size) {
+    std::vector<UpdateCommand> commands;
+    const size_t stride = static_cast<size_t>(width) * 4;
+
+    // Le reste est comparé à la prédiction du client: previous après la copie
+    const uint8_t* reference = previous;
+    std::vector<uint8_t> predicted;
+    UpdateCommand copy;
+    if (detectScroll(previous, current, width, height, copy)) {
+        predicted.assign(previous, previous + stride * height);
+        applyCopy(predicted.data(), width, 4, copy);
+        reference = predicted.data();
+        commands.push_back(copy);
+    }
+
+    // RAW_RECT: suites de lignes modifiées, réduites à leur étendue horizontale
+    int top = -1;
+    int left = 0;
+    int right = 0;
+    for (int y = 0; y <= height; ++y) {
+        const uint8_t* ref_row = reference + y * stride;
+        const uint8_t* cur_row = current + y * stride;
+        if (y == height || memcmp(ref_row, cur_row, stride) == 0) {
+            if (top >= 0) {
+                UpdateCommand rect = makeCommand(UpdateCommandType::RAW_RECT, left, top, right - left, y - top, 0, 0);
+                if (tile_size > 0) {
+                    splitTiles(reference, current, width, rect, tile_size, commands);
+                } else {
+                    commands.push_back(rect);
+                }
+                top = -1;
+            }
+            continue;
+        }
+
+        int first = 0;
+        while (memcmp(ref_row + first * 4, cur_row + first * 4, 4) == 0) {
+            first++;
+        }
+        int last = width;
+        while (memcmp(ref_row + (last - 1) * 4, cur_row + (last - 1) * 4, 4) == 0) {
+            last--;
+        }
+        if (top < 0) {
+            top = y;
+            left = first;
+            right = last;
+        } else {
+            left = std::min(left, first);
+            right = std::max(right, last);
+        }
+    }
+    return commands;
+}
+
+bool FrameDelta::fits(const UpdateCommand& command, int width, int height) {
+    auto inside = [&](int x, int y) {
+        return command.width > 0 && command.height > 0 &&
+               x + command.width <= width && y + command.height <= height;
+    };
+    switch (static_cast<UpdateCommandType>(command.type)) {
+        case UpdateCommandType::COPY_RECT:
+            return inside(command.x, command.y) && inside(command.src_x, command.src_y);
+        case UpdateCommandType::RAW_RECT:
+        case UpdateCommandType::CACHED_TILE:
+        case UpdateCommandType::CACHE_TILE:
+        case UpdateCommandType::LOSSY_RECT:
+        case UpdateCommandType::CACHE_LOSSY_TILE:
+            return inside(command.x, command.y);
+    }
+    return false;
+}
+
+void FrameDelta::applyCopy(uint8_t* pixels, int width, int bytes_per_pixel, const UpdateCommand& copy) {
+    const size_t stride = static_cast<size_t>(width) * bytes_per_pixel;
+    const size_t row_bytes = static_cast<size_t>(copy.width) * bytes_per_pixel;
+    auto copyRow = [&](int row) {
+        memmove(pixels + (copy.y + row) * stride + static_cast<size_t>(copy.x) * bytes_per_pixel,
+                pixels + (copy.src_y + row) * stride + static_cast<size_t>(copy.src_x) * bytes_per_pixel,
+                row_bytes);
+    };
+    // Vers le bas: de la dernière ligne à la première, sinon la source serait écrasée avant d'être lue
+    if (copy.src_y < copy.y) {
+        for (int row = copy.height - 1; row >= 0; --row) {
+            copyRow(row);
+        }
+    } else {
+        for (int row = 0; row < copy.height; ++row) {
+            copyRow(row);
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef FRAMEDELTA_H
+#define FRAMEDELTA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "common.h"
+
+/**
+ * Incremental frame updates (FRAME_UPDATE)
+ *
+ * compute() turns the previous ARGB8888 frame of a stream into the current
+ * one with at most one COPY_RECT followed by RAW_RECTs covering whatever
+ * still differs. The scroll vector is found by hashing the rows (then the
+ * columns) of the changed area in both frames and voting for the offset
+ * that matches the most of them, so scrolling an editor or a web page costs
+ * the newly exposed strip instead of the whole screen. The client applies
+ * the same commands to its own framebuffer, in the transport format it
+ * receives (applyCopy() is format-agnostic).
+ */
+class FrameDelta {
+public:
+    /**
+     * Commands turning previous into current (same size, ARGB8888)
+     * @param tile_size > 0: the whole grid tiles inside each RAW_RECT become
+     *        CACHE_TILE candidates (unchanged tiles dropped), the margins stay
+     *        RAW_RECTs; the server picks CACHED_TILE, CACHE_TILE or RAW_RECT
+     *        for each candidate according to the client's tile cache
+     */
+    static std::vector<UpdateCommand> compute(const uint8_t* previous, const uint8_t* current,
+                                              int width, int height, int tile_size = 0);
+
+    // COPY_RECT expliquant la zone modifiée par un défilement; false sinon
+    static bool detectScroll(const uint8_t* previous, const uint8_t* current,
+                             int width, int height, UpdateCommand& copy);
+
+    // Rectangle (et source d'un COPY_RECT) dans une frame width x height
+    static bool fits(const UpdateCommand& command, int width, int height);
+
+    /**
+     * Apply a COPY_RECT in place; source and destination may overlap
+     * @param bytes_per_pixel 4, 3 or 2 (PixelPacker::packedSize of one pixel)
+     */
+    static void applyCopy(uint8_t* pixels, int width, int bytes_per_pixel, const UpdateCommand& copy);
+};
+
+#endif // FRAMEDELTA_H
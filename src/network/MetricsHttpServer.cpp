@@ -0,0 +1,148 @@
+#include "MetricsHttpServer.h"
+#include "../utils/Logger.h"
+#include "../utils/Metrics.h"
+#include "../utils/FrameTracer.h"
+#include <cstring>
+
+#ifndef PLATFORM_WINDOWS
+    #include <sys/select.h>
+    #include <sys/time.h>
+#endif
+
+namespace {
+    void sendAll(SOCKET sock, const std::string& data) {
+        size_t total = 0;
+        while (total < data.size()) {
+            int sent = send(sock, data.data() + total, static_cast<int>(data.size() - total), SEND_FLAGS);
+            if (sent <= 0) {
+                return;
+            }
+            total += static_cast<size_t>(sent);
+        }
+    }
+
+    std::string response(const char* status, const char* content_type, const std::string& body) {
+        return std::string("HTTP/1.1 ") + status + "\r\n"
+             + "Content-Type: " + content_type + "\r\n"
+             + "Content-Length: " + std::to_string(body.size()) + "\r\n"
+             + "Connection: close\r\n\r\n"
+             + body;
+    }
+}
+
+MetricsHttpServer::MetricsHttpServer(int port, const std::string& address)
+    : address_(address), port_(port), running_(false), listen_socket_(INVALID_SOCKET) {
+}
+
+MetricsHttpServer::~MetricsHttpServer() {
+    stop();
+}
+
+bool MetricsHttpServer::start() {
+    if (running_) {
+        return false;
+    }
+
+    static SocketInitializer sockInit;
+
+    listen_socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listen_socket_ == INVALID_SOCKET) {
+        LOG_WARN("MetricsHttpServer: failed to create socket");
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_socket_, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port_);
+    addr.sin_addr.s_addr = (address_.empty() || address_ == "0.0.0.0") ? INADDR_ANY : inet_addr(address_.c_str());
+
+    if (bind(listen_socket_, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_socket_, 4) < 0) {
+        LOG_WARN("MetricsHttpServer: cannot listen on {}:{}", address_, port_);
+        closesocket(listen_socket_);
+        listen_socket_ = INVALID_SOCKET;
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&MetricsHttpServer::serveLoop, this);
+    LOG_INFO("Metrics endpoint: http://{}:{}/metrics", address_, port_);
+    return true;
+}
+
+void MetricsHttpServer::stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    closesocket(listen_socket_);
+    listen_socket_ = INVALID_SOCKET;
+}
+
+void MetricsHttpServer::serveLoop() {
+    while (running_) {
+        // Attente bornée pour pouvoir observer stop()
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        FD_SET(listen_socket_, &readfds);
+        struct timeval tv;
+        tv.tv_sec = 0;
+        tv.tv_usec = 200000;
+        int ready = select(static_cast<int>(listen_socket_) + 1, &readfds, nullptr, nullptr, &tv);
+        if (ready <= 0) {
+            continue;
+        }
+
+        SOCKET client = accept(listen_socket_, nullptr, nullptr);
+        if (client == INVALID_SOCKET) {
+            continue;
+        }
+        handleConnection(client);
+        closesocket(client);
+    }
+}
+
+void MetricsHttpServer::handleConnection(SOCKET sock) {
+    // Un client lent ne doit pas bloquer le thread indéfiniment
+#ifdef PLATFORM_WINDOWS
+    DWORD timeout_ms = 1000;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout_ms, sizeof(timeout_ms));
+#else
+    struct timeval timeout;
+    timeout.tv_sec = 1;
+    timeout.tv_usec = 0;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#endif
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        int received = recv(sock, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    std::string line = request.substr(0, request.find("\r\n"));
+    if (line.rfind("GET ", 0) != 0) {
+        sendAll(sock, response("405 Method Not Allowed", "text/plain", "GET only\n"));
+        return;
+    }
+
+    size_t path_end = line.find(' ', 4);
+    std::string path = line.substr(4, path_end == std::string::npos ? std::string::npos : path_end - 4);
+    if (path == "/metrics") {
+        sendAll(sock, response("200 OK", "text/plain; version=0.0.4", Metrics::renderPrometheus()));
+    } else if (path == "/trace") {
+        sendAll(sock, response("200 OK", "application/json", FrameTracer::toChromeJson()));
+    } else {
+        sendAll(sock, response("404 Not Found", "text/plain", "Try /metrics or /trace\n"));
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef METRICSHTTPSERVER_H
+#define METRICSHTTPSERVER_H
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include "common.h"
+
+/**
+ * Minimal HTTP listener serving GET /metrics in Prometheus text format and
+ * GET /trace with the recent frame spans as Chrome trace JSON
+ *
+ * Runs on its own thread and handles one short-lived connection at a time,
+ * so scrapes never touch the capture or send threads. Binds to localhost
+ * by default.
+ */
+class MetricsHttpServer {
+public:
+    explicit MetricsHttpServer(int port, const std::string& address = "127.0.0.1");
+    ~MetricsHttpServer();
+
+    bool start();
+    void stop();
+    bool isRunning() const { return running_; }
+
+private:
+    void serveLoop();
+    void handleConnection(SOCKET sock);
+
+    std::string address_;
+    int port_;
+    std::atomic<bool> running_;
+    SOCKET listen_socket_;
+    std::thread thread_;
+};
+
+#endif // METRICSHTTPSERVER_H
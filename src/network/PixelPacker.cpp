@@ -0,0 +1,244 @@
+#include "PixelPacker.h"
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PIXELPACKER_SSSE3 1
+#include <immintrin.h>
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+
+namespace {
+    // Canal 5 ou 6 bits -> 8 bits par réplication des bits de poids fort
+    inline uint8_t expand5(uint32_t v) { return static_cast<uint8_t>((v << 3) | (v >> 2)); }
+    inline uint8_t expand6(uint32_t v) { return static_cast<uint8_t>((v << 2) | (v >> 4)); }
+
+    void packRgb24Scalar(const uint8_t* argb, size_t count, uint8_t* out) {
+        for (size_t i = 0; i < count; ++i, argb += 4, out += 3) {
+            out[0] = argb[1];
+            out[1] = argb[2];
+            out[2] = argb[3];
+        }
+    }
+
+    void packRgb565Scalar(const uint8_t* argb, size_t count, uint8_t* out) {
+        for (size_t i = 0; i < count; ++i, argb += 4, out += 2) {
+            uint16_t v = static_cast<uint16_t>(((argb[1] & 0xF8) << 8) | ((argb[2] & 0xFC) << 3) | (argb[3] >> 3));
+            out[0] = static_cast<uint8_t>(v);
+            out[1] = static_cast<uint8_t>(v >> 8);
+        }
+    }
+
+    void unpackRgb24Scalar(const uint8_t* in, size_t count, uint8_t* argb) {
+        for (size_t i = 0; i < count; ++i, in += 3, argb += 4) {
+            argb[0] = 0xFF;
+            argb[1] = in[0];
+            argb[2] = in[1];
+            argb[3] = in[2];
+        }
+    }
+
+    void unpackRgb565Scalar(const uint8_t* in, size_t count, uint8_t* argb) {
+        for (size_t i = 0; i < count; ++i, in += 2, argb += 4) {
+            uint32_t v = static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8);
+            argb[0] = 0xFF;
+            argb[1] = expand5(v >> 11);
+            argb[2] = expand6((v >> 5) & 0x3F);
+            argb[3] = expand5(v & 0x1F);
+        }
+    }
+
+#ifdef PIXELPACKER_SSSE3
+    // 16 pixels par tour: 4 x 16 octets ARGB -> 3 x 16 octets RGB
+    SSSE3_TARGET void packRgb24Ssse3(const uint8_t* argb, size_t count, uint8_t* out) {
+        const __m128i drop_alpha = _mm_setr_epi8(1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16, argb += 64, out += 48) {
+            __m128i p0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(argb)), drop_alpha);
+            __m128i p1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(argb + 16)), drop_alpha);
+            __m128i p2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(argb + 32)), drop_alpha);
+            __m128i p3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(argb + 48)), drop_alpha);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32), _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+        }
+        packRgb24Scalar(argb, count - i, out);
+    }
+
+    SSSE3_TARGET void unpackRgb24Ssse3(const uint8_t* in, size_t count, uint8_t* argb) {
+        const __m128i add_alpha = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+        const __m128i alpha = _mm_set1_epi32(0xFF);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16, in += 48, argb += 64) {
+            __m128i in0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+            __m128i in1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16));
+            __m128i in2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 32));
+            __m128i p0 = in0;
+            __m128i p1 = _mm_alignr_epi8(in1, in0, 12);
+            __m128i p2 = _mm_alignr_epi8(in2, in1, 8);
+            __m128i p3 = _mm_srli_si128(in2, 4);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(argb), _mm_or_si128(_mm_shuffle_epi8(p0, add_alpha), alpha));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(argb + 16), _mm_or_si128(_mm_shuffle_epi8(p1, add_alpha), alpha));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(argb + 32), _mm_or_si128(_mm_shuffle_epi8(p2, add_alpha), alpha));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(argb + 48), _mm_or_si128(_mm_shuffle_epi8(p3, add_alpha), alpha));
+        }
+        unpackRgb24Scalar(in, count - i, argb);
+    }
+
+    // Mot 32 bits little-endian d'un pixel ARGB: B << 24 | G << 16 | R << 8 | A
+    SSSE3_TARGET inline __m128i toRgb565(__m128i x) {
+        __m128i r = _mm_and_si128(x, _mm_set1_epi32(0xF800));
+        __m128i g = _mm_and_si128(_mm_srli_epi32(x, 13), _mm_set1_epi32(0x07E0));
+        __m128i b = _mm_srli_epi32(x, 27);
+        return _mm_or_si128(_mm_or_si128(r, g), b);
+    }
+
+    SSSE3_TARGET void packRgb565Ssse3(const uint8_t* argb, size_t count, uint8_t* out) {
+        // Octets bas de chaque mot 32 bits (packus_epi32 demanderait SSE4.1)
+        const __m128i low_words = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8, argb += 32, out += 16) {
+            __m128i lo = toRgb565(_mm_loadu_si128(reinterpret_cast<const __m128i*>(argb)));
+            __m128i hi = toRgb565(_mm_loadu_si128(reinterpret_cast<const __m128i*>(argb + 16)));
+            __m128i packed = _mm_unpacklo_epi64(_mm_shuffle_epi8(lo, low_words), _mm_shuffle_epi8(hi, low_words));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+        }
+        packRgb565Scalar(argb, count - i, out);
+    }
+
+    SSSE3_TARGET inline __m128i fromRgb565(__m128i v) {
+        __m128i r5 = _mm_srli_epi32(v, 11);
+        __m128i g6 = _mm_and_si128(_mm_srli_epi32(v, 5), _mm_set1_epi32(0x3F));
+        __m128i b5 = _mm_and_si128(v, _mm_set1_epi32(0x1F));
+        __m128i r = _mm_or_si128(_mm_slli_epi32(r5, 3), _mm_srli_epi32(r5, 2));
+        __m128i g = _mm_or_si128(_mm_slli_epi32(g6, 2), _mm_srli_epi32(g6, 4));
+        __m128i b = _mm_or_si128(_mm_slli_epi32(b5, 3), _mm_srli_epi32(b5, 2));
+        __m128i argb = _mm_or_si128(_mm_slli_epi32(r, 8), _mm_slli_epi32(g, 16));
+        return _mm_or_si128(_mm_or_si128(argb, _mm_slli_epi32(b, 24)), _mm_set1_epi32(0xFF));
+    }
+
+    SSSE3_TARGET void unpackRgb565Ssse3(const uint8_t* in, size_t count, uint8_t* argb) {
+        const __m128i zero = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8, in += 16, argb += 32) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(argb), fromRgb565(_mm_unpacklo_epi16(v, zero)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(argb + 16), fromRgb565(_mm_unpackhi_epi16(v, zero)));
+        }
+        unpackRgb565Scalar(in, count - i, argb);
+    }
+
+    bool detectSsse3() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("ssse3");
+    }
+#endif
+
+    using RowFn = void (*)(const uint8_t*, size_t, uint8_t*);
+
+    struct Kernels {
+        RowFn pack_rgb24;
+        RowFn pack_rgb565;
+        RowFn unpack_rgb24;
+        RowFn unpack_rgb565;
+        bool simd;
+    };
+
+    // Choisi une fois, au premier appel
+    const Kernels& kernels() {
+        static const Kernels selected = [] {
+#ifdef PIXELPACKER_SSSE3
+            if (detectSsse3()) {
+                return Kernels{packRgb24Ssse3, packRgb565Ssse3, unpackRgb24Ssse3, unpackRgb565Ssse3, true};
+            }
+#endif
+            return Kernels{packRgb24Scalar, packRgb565Scalar, unpackRgb24Scalar, unpackRgb565Scalar, false};
+        }();
+        return selected;
+    }
+
+    size_t bytesPerPixel(PixelFormat format) {
+        switch (format) {
+            case PixelFormat::ARGB8888: return 4;
+            case PixelFormat::RGB24:    return 3;
+            case PixelFormat::RGB565:   return 2;
+        }
+        return 4;
+    }
+
+    void unpackRow(PixelFormat format, const uint8_t* packed, size_t count, uint8_t* argb) {
+        switch (format) {
+            case PixelFormat::ARGB8888:
+                std::memcpy(argb, packed, count * 4);
+                break;
+            case PixelFormat::RGB24:
+                kernels().unpack_rgb24(packed, count, argb);
+                break;
+            case PixelFormat::RGB565:
+                kernels().unpack_rgb565(packed, count, argb);
+                break;
+        }
+    }
+}
+
+size_t PixelPacker::packedSize(PixelFormat format, int width, int height) {
+    return static_cast<size_t>(width) * height * bytesPerPixel(format);
+}
+
+void PixelPacker::pack(PixelFormat format, const uint8_t* argb, size_t count, uint8_t* out) {
+    switch (format) {
+        case PixelFormat::ARGB8888:
+            std::memcpy(out, argb, count * 4);
+            break;
+        case PixelFormat::RGB24:
+            kernels().pack_rgb24(argb, count, out);
+            break;
+        case PixelFormat::RGB565:
+            kernels().pack_rgb565(argb, count, out);
+            break;
+    }
+}
+
+void PixelPacker::unpack(PixelFormat format, const uint8_t* packed, int width, int height,
+                         uint8_t* dst, size_t dst_pitch) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    // Lignes contiguës des deux côtés: un seul appel pour toute la frame
+    size_t row_pixels = static_cast<size_t>(width);
+    if (dst_pitch == row_pixels * 4) {
+        unpackRow(format, packed, row_pixels * height, dst);
+        return;
+    }
+
+    size_t row_bytes = row_pixels * bytesPerPixel(format);
+    for (int row = 0; row < height; ++row) {
+        unpackRow(format, packed + row * row_bytes, row_pixels, dst + row * dst_pitch);
+    }
+}
+
+bool PixelPacker::hasSimd() {
+    return kernels().simd;
+}
+
+const char* PixelPacker::name(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::ARGB8888: return "argb";
+        case PixelFormat::RGB24:    return "rgb24";
+        case PixelFormat::RGB565:   return "rgb565";
+    }
+    return "unknown";
+}
+
+bool PixelPacker::parse(const std::string& text, PixelFormat& format) {
+    if (text == "argb" || text == "argb8888") {
+        format = PixelFormat::ARGB8888;
+    } else if (text == "rgb24") {
+        format = PixelFormat::RGB24;
+    } else if (text == "rgb565") {
+        format = PixelFormat::RGB565;
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+#ifndef PIXELPACKER_H
+#define PIXELPACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "common.h"
+
+/**
+ * ARGB8888 frames <-> reduced transport formats (RGB24, RGB565)
+ *
+ * The server packs a raw frame once per format requested by its clients;
+ * the client keeps the packed bytes (VideoFrame::format) and unpacks them
+ * straight into the destination, e.g. a locked SDL texture, so there is no
+ * intermediate ARGB copy. SSSE3 when the CPU has it (checked once), scalar
+ * loops otherwise; both give identical output.
+ */
+class PixelPacker {
+public:
+    static constexpr int kFormatCount = 3;
+
+    // Taille des pixels d'une frame width x height dans ce format
+    static size_t packedSize(PixelFormat format, int width, int height);
+
+    /**
+     * Pack count ARGB8888 pixels (A, R, G, B bytes)
+     * @param out packedSize() bytes for count pixels
+     */
+    static void pack(PixelFormat format, const uint8_t* argb, size_t count, uint8_t* out);
+
+    /**
+     * Unpack a width x height frame to ARGB8888 (A, R, G, B bytes)
+     * @param dst_pitch Bytes between destination rows (SDL_LockTexture pitch)
+     */
+    static void unpack(PixelFormat format, const uint8_t* packed, int width, int height,
+                       uint8_t* dst, size_t dst_pitch);
+
+    // Chemins SSSE3 utilisés sur ce processeur
+    static bool hasSimd();
+
+    static const char* name(PixelFormat format);
+    // "argb", "rgb24", "rgb565"; false si inconnu
+    static bool parse(const std::string& text, PixelFormat& format);
+};
+
+#endif // PIXELPACKER_H
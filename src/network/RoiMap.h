@@ -0,0 +1,53 @@
+#ifndef ROIMAP_H
+#define ROIMAP_H
+
+#include <vector>
+
+/**
+ * Region of interest of a video stream: where the viewer is looking
+ *
+ * The neighbourhood of the pointer and the focused window, in the stream's
+ * coordinates. Tiles touching it are always sent exact (LOSSY_RECT never
+ * used there); outside, text tiles may be lowered to the lossy path down
+ * to the client's StreamConfig::roi_min_quality. Empty when neither the
+ * pointer nor the focus is known: no tile is boosted or lowered.
+ */
+class RoiMap {
+public:
+    // Demi-côté du carré autour du point chaud du pointeur
+    static constexpr int kCursorRadius = 96;
+
+    struct Rect {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    void add(int x, int y, int width, int height) {
+        if (width > 0 && height > 0) {
+            rects_.push_back(Rect{x, y, width, height});
+        }
+    }
+
+    void addCursor(int x, int y) {
+        add(x - kCursorRadius, y - kCursorRadius, 2 * kCursorRadius, 2 * kCursorRadius);
+    }
+
+    bool empty() const { return rects_.empty(); }
+
+    bool intersects(int x, int y, int width, int height) const {
+        for (const Rect& rect : rects_) {
+            if (x < rect.x + rect.width && rect.x < x + width &&
+                y < rect.y + rect.height && rect.y < y + height) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::vector<Rect> rects_;
+};
+
+#endif // ROIMAP_H
@@ -1,7 +1,12 @@
 #include "StreamClient.h"
+#include "FrameDelta.h"
+#include "PixelPacker.h"
 #include "../utils/Logger.h"
+#include "../utils/FrameTracer.h"
+#include "../utils/Probes.h"
 #include <cstring>
 #include <sstream>
+#include <algorithm>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -13,36 +18,66 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <netdb.h>
+#include <netinet/tcp.h>
 #endif
 
+namespace {
+    // Période des heartbeats (et donc des mesures d'horloge)
+    constexpr auto kHeartbeatInterval = std::chrono::seconds(2);
+    // Un rapport de latence tous les kReportEvery heartbeats
+    constexpr int kReportEvery = 5;
+    // Au-delà, l'horodatage ne vient pas de get_monotonic_us() (ancien serveur)
+    constexpr int64_t kMaxPlausibleLatencyUs = 60 * 1000 * 1000;
+
+    uint32_t clampU32(uint64_t value) {
+        return static_cast<uint32_t>(std::min<uint64_t>(value, UINT32_MAX));
+    }
+}
+
 StreamClient::StreamClient(const std::string& server_address, int server_port)
     : server_address_(server_address)
     , server_port_(server_port)
     , socket_(INVALID_SOCKET)
     , connected_(false)
+    , tile_cache_blocks_(TileCache::kDefaultClientBlocks)
+    , tile_cache_capacity_(0)
+    , lossy_tiles_(false)
+    , pixel_format_(PixelFormat::ARGB8888)
+    , roi_min_quality_(Config::DEFAULT_ROI_MIN_QUALITY)
+    , cursor_shapes_(CursorShapeCache::kClientCapacity)
+    , cursor_position_()
+    , has_cursor_(false)
     , video_frames_received_(0)
     , audio_frames_received_(0)
-    , bytes_received_(0) {
+    , bytes_received_(0)
+    , cursor_updates_received_(0)
+    , cursor_shapes_received_(0)
+    , frame_updates_received_(0)
+    , frame_updates_dropped_(0)
+    , tile_cache_hits_(0)
+    , tile_cache_misses_(0)
+    , lossy_tiles_received_(0)
+    , frame_repeats_received_(0) {
     
     static SocketInitializer socket_init;
-    Logger::log(Logger::LogLevel::INFO, "StreamClient created for " + server_address + ":" + std::to_string(server_port));
+    LOG_INFO("StreamClient created for {}:{}", server_address, server_port);
 }
 
 StreamClient::~StreamClient() {
     disconnect();
-    Logger::log(Logger::LogLevel::INFO, "StreamClient destroyed");
+    LOG_INFO("StreamClient destroyed");
 }
 
 bool StreamClient::connect() {
     if (connected_) {
-        Logger::log(Logger::LogLevel::WARN, "Already connected");
+        LOG_WARN("Already connected");
         return true;
     }
     
     // Create socket
     socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (socket_ == INVALID_SOCKET) {
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, "Failed to create socket");
+        LOG_ERROR("Failed to create socket");
         return false;
     }
     
@@ -56,7 +91,7 @@ bool StreamClient::connect() {
         // Try resolving as hostname
         struct hostent* host = gethostbyname(server_address_.c_str());
         if (!host) {
-            Logger::log(Logger::LogLevel::ERROR_LEVEL, "Failed to resolve server address: " + server_address_);
+            LOG_ERROR("Failed to resolve server address: {}", server_address_);
 #ifdef _WIN32
             closesocket(socket_);
 #else
@@ -70,7 +105,7 @@ bool StreamClient::connect() {
     
     // Connect to server
     if (::connect(socket_, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, "Failed to connect to server");
+        LOG_ERROR("Failed to connect to server");
 #ifdef _WIN32
         closesocket(socket_);
 #else
@@ -80,11 +115,15 @@ bool StreamClient::connect() {
         return false;
     }
     
-    Logger::log(Logger::LogLevel::INFO, "Connected to server " + server_address_ + ":" + std::to_string(server_port_));
+    LOG_INFO("Connected to server {}:{}", server_address_, server_port_);
+    
+    // Heartbeats et rapports sont petits: les envoyer sans délai de Nagle
+    int nodelay = 1;
+    setsockopt(socket_, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&nodelay), sizeof(nodelay));
     
     // Send handshake
     if (!sendHandshake()) {
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, "Handshake failed");
+        LOG_ERROR("Handshake failed");
         disconnect();
         return false;
     }
@@ -97,23 +136,27 @@ bool StreamClient::connect() {
     // Start heartbeat thread
     heartbeat_thread_ = std::thread(&StreamClient::heartbeatLoop, this);
     
-    Logger::log(Logger::LogLevel::INFO, "Client threads started");
+    LOG_INFO("Client threads started");
     return true;
 }
 
 void StreamClient::disconnect() {
-    if (!connected_) {
+    // Connexion perdue (receive loop terminée): les threads restent à joindre
+    bool was_connected = connected_.exchange(false);
+    if (!was_connected && socket_ == INVALID_SOCKET && !receive_thread_.joinable() && !heartbeat_thread_.joinable()) {
         return;
     }
     
-    Logger::log(Logger::LogLevel::INFO, "Disconnecting client...");
-    connected_ = false;
+    LOG_INFO("Disconnecting client...");
     
-    // Close socket to unblock receive
+    // Close socket to unblock receive (close() seul ne réveille pas un
+    // recv() bloqué dans un autre thread sous Linux)
     if (socket_ != INVALID_SOCKET) {
 #ifdef _WIN32
+        shutdown(socket_, SD_BOTH);
         closesocket(socket_);
 #else
+        shutdown(socket_, SHUT_RDWR);
         close(socket_);
 #endif
         socket_ = INVALID_SOCKET;
@@ -127,7 +170,7 @@ void StreamClient::disconnect() {
         heartbeat_thread_.join();
     }
     
-    Logger::log(Logger::LogLevel::INFO, "Client disconnected");
+    LOG_INFO("Client disconnected");
     
     if (disconnect_callback_) {
         disconnect_callback_();
@@ -137,7 +180,15 @@ void StreamClient::disconnect() {
 bool StreamClient::sendHandshake() {
     HandshakeRequest request;
     strncpy(request.client_name, "TestClient", sizeof(request.client_name) - 1);
-    request.capabilities = 0x03; // Video + Audio
+    request.capabilities = CAPABILITY_VIDEO | CAPABILITY_AUDIO | CAPABILITY_CURSOR |
+                           CAPABILITY_FRAME_UPDATE | CAPABILITY_FRAME_REPEAT;
+    if (tile_cache_blocks_ > 0) {
+        request.capabilities |= CAPABILITY_TILE_CACHE;
+    }
+    if (lossy_tiles_) {
+        request.capabilities |= CAPABILITY_LOSSY_TILES;
+    }
+    request.tile_cache_blocks = tile_cache_blocks_;
     request.max_width = 1920;
     request.max_height = 1080;
     
@@ -147,19 +198,18 @@ bool StreamClient::sendHandshake() {
     header.packet_type = static_cast<uint8_t>(PacketType::HANDSHAKE);
     header.flags = 0;
     header.sequence_number = 0;
-    header.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now().time_since_epoch()).count();
+    header.timestamp = get_monotonic_us();
     header.payload_size = sizeof(HandshakeRequest);
     
     // Send header
-    if (send(socket_, reinterpret_cast<const char*>(&header), sizeof(header), 0) != sizeof(header)) {
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, "Failed to send handshake header");
+    if (send(socket_, reinterpret_cast<const char*>(&header), sizeof(header), SEND_FLAGS) != sizeof(header)) {
+        LOG_ERROR("Failed to send handshake header");
         return false;
     }
     
     // Send payload
-    if (send(socket_, reinterpret_cast<const char*>(&request), sizeof(request), 0) != sizeof(request)) {
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, "Failed to send handshake payload");
+    if (send(socket_, reinterpret_cast<const char*>(&request), sizeof(request), SEND_FLAGS) != sizeof(request)) {
+        LOG_ERROR("Failed to send handshake payload");
         return false;
     }
     
@@ -168,17 +218,17 @@ bool StreamClient::sendHandshake() {
     std::vector<uint8_t> response_payload;
     
     if (!receivePacket(response_header, response_payload)) {
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, "Failed to receive handshake response");
+        LOG_ERROR("Failed to receive handshake response");
         return false;
     }
     
     if (response_header.packet_type != static_cast<uint8_t>(PacketType::HANDSHAKE)) {
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, "Invalid handshake response type");
+        LOG_ERROR("Invalid handshake response type");
         return false;
     }
     
     if (response_payload.size() != sizeof(HandshakeResponse)) {
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, "Invalid handshake response size");
+        LOG_ERROR("Invalid handshake response size");
         return false;
     }
     
@@ -186,32 +236,216 @@ bool StreamClient::sendHandshake() {
     if (response->accepted == 0) {
         std::stringstream ss;
         ss << "Handshake rejected: " << response->server_info;
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, ss.str());
+        LOG_ERROR(ss.str());
         return false;
     }
     
-    Logger::log(Logger::LogLevel::INFO, "Handshake successful, assigned client ID: " + std::to_string(response->assigned_id));
+    // Un ancien serveur laisse l'octet indéfini: jamais plus que demandé
+    uint8_t tile_blocks = std::min(response->tile_cache_blocks, tile_cache_blocks_);
+    tile_cache_.reset(tile_blocks * TileCache::kBlockTiles);
+    tile_cache_capacity_ = tile_cache_.capacity();
+
+    LOG_INFO("Handshake successful, assigned client ID: {}, tile cache: {} tiles",
+             response->assigned_id, tile_cache_.capacity());
     return true;
 }
 
 bool StreamClient::sendHeartbeat() {
+    ClockSyncRequest request;
+    request.client_send_us = get_monotonic_us();
+    return sendPacket(PacketType::HEARTBEAT, &request, sizeof(request));
+}
+
+bool StreamClient::sendLatencyReport() {
+    HistogramSnapshot current = glass_latency_.snapshot();
+    HistogramSnapshot window = current.since(last_report_);
+    last_report_ = std::move(current);
+    if (window.count == 0) {
+        return true;
+    }
+
+    LatencyReport report;
+    report.sample_count = clampU32(window.count);
+    report.p50_us = clampU32(window.percentile(0.50));
+    report.p90_us = clampU32(window.percentile(0.90));
+    report.p99_us = clampU32(window.percentile(0.99));
+    report.max_us = clampU32(window.max);
+    report.clock_offset_us = clock_sync_.offsetUs();
+    report.rtt_us = clampU32(clock_sync_.rttUs());
+    return sendPacket(PacketType::LATENCY_REPORT, &report, sizeof(report));
+}
+
+bool StreamClient::sendPacket(PacketType type, const void* data, size_t size) {
     PacketHeader header;
     header.magic = MAGIC_NUMBER;
     header.version = PROTOCOL_VERSION;
-    header.packet_type = static_cast<uint8_t>(PacketType::HEARTBEAT);
+    header.packet_type = static_cast<uint8_t>(type);
     header.flags = 0;
     header.sequence_number = 0;
-    header.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now().time_since_epoch()).count();
-    header.payload_size = 0;
+    header.timestamp = get_monotonic_us();
+    header.payload_size = static_cast<uint32_t>(size);
     
-    if (send(socket_, reinterpret_cast<const char*>(&header), sizeof(header), 0) != sizeof(header)) {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (send(socket_, reinterpret_cast<const char*>(&header), sizeof(header), SEND_FLAGS) != sizeof(header)) {
+        return false;
+    }
+    if (size > 0 && send(socket_, reinterpret_cast<const char*>(data), static_cast<int>(size), SEND_FLAGS) != static_cast<int>(size)) {
         return false;
     }
     
     return true;
 }
 
+bool StreamClient::setPixelFormat(PixelFormat format) {
+    if (!connected_) {
+        return false;
+    }
+    pixel_format_ = format;
+    return sendConfig();
+}
+
+bool StreamClient::setRoiMinQuality(uint8_t quality) {
+    if (!connected_) {
+        return false;
+    }
+    roi_min_quality_ = std::min<uint8_t>(quality, 100);
+    return sendConfig();
+}
+
+bool StreamClient::sendConfig() {
+    StreamConfig config;
+    config.fps = Config::DEFAULT_FPS;
+    config.jpeg_quality = Config::DEFAULT_JPEG_QUALITY;
+    config.roi_min_quality = roi_min_quality_;
+    config.audio_sample_rate = Config::DEFAULT_AUDIO_SAMPLE_RATE;
+    config.audio_channels = 1;
+    config.enable_audio = 1;
+    config.enable_video = 1;
+    config.pixel_format = static_cast<uint8_t>(pixel_format_);
+    return sendPacket(PacketType::CONFIG, &config, sizeof(config));
+}
+
+double StreamClient::getTileCacheHitRate() const {
+    uint64_t hits = tile_cache_hits_;
+    uint64_t total = hits + tile_cache_misses_;
+    return total ? static_cast<double>(hits) / static_cast<double>(total) : 0.0;
+}
+
+void StreamClient::requestRefresh() {
+    sendPacket(PacketType::REFRESH, nullptr, 0);
+}
+
+bool StreamClient::subscribe(uint32_t stream_mask) {
+    if (!connected_) {
+        return false;
+    }
+    SubscribeRequest request;
+    request.stream_mask = stream_mask;
+    return sendPacket(PacketType::SUBSCRIBE, &request, sizeof(request));
+}
+
+std::vector<StreamInfo> StreamClient::getStreams() const {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    return streams_;
+}
+
+void StreamClient::handleStreamList(const std::vector<uint8_t>& payload) {
+    if (payload.empty() || payload.size() < 1 + payload[0] * sizeof(StreamInfo)) {
+        LOG_ERROR("Invalid stream list size");
+        return;
+    }
+
+    std::vector<StreamInfo> streams(payload[0]);
+    memcpy(streams.data(), payload.data() + 1, streams.size() * sizeof(StreamInfo));
+    for (StreamInfo& info : streams) {
+        info.name[sizeof(info.name) - 1] = '\0';
+    }
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        streams_ = streams;
+    }
+    LOG_INFO("Server offers {} video stream(s)", streams.size());
+
+    if (stream_list_callback_) {
+        stream_list_callback_(streams);
+    }
+}
+
+bool StreamClient::getCursor(CursorPosition& position, std::shared_ptr<const CursorImage>& shape) const {
+    std::lock_guard<std::mutex> lock(cursor_mutex_);
+    if (!has_cursor_) {
+        return false;
+    }
+    position = cursor_position_;
+    shape = cursor_shape_;
+    return true;
+}
+
+void StreamClient::handleCursor(const std::vector<uint8_t>& payload) {
+    if (payload.size() < sizeof(CursorPosition)) {
+        LOG_ERROR("Invalid cursor packet size");
+        return;
+    }
+
+    CursorPosition position;
+    memcpy(&position, payload.data(), sizeof(position));
+    std::shared_ptr<const CursorImage> shape;
+    {
+        std::lock_guard<std::mutex> lock(cursor_mutex_);
+        // Marque la forme utilisée, comme le serveur
+        shape = cursor_shapes_.find(position.shape_serial);
+        cursor_position_ = position;
+        cursor_shape_ = shape;
+        has_cursor_ = true;
+    }
+    cursor_updates_received_++;
+
+    if (cursor_callback_) {
+        cursor_callback_(position, shape);
+    }
+}
+
+void StreamClient::handleCursorShape(const std::vector<uint8_t>& payload) {
+    if (payload.size() < sizeof(CursorShapeHeader)) {
+        LOG_ERROR("Invalid cursor shape size");
+        return;
+    }
+
+    CursorShapeHeader header;
+    memcpy(&header, payload.data(), sizeof(header));
+    size_t pixel_bytes = static_cast<size_t>(header.width) * header.height * 4;
+    if (header.width > MAX_CURSOR_SIZE || header.height > MAX_CURSOR_SIZE ||
+        payload.size() != sizeof(header) + pixel_bytes) {
+        LOG_ERROR("Invalid cursor shape size");
+        return;
+    }
+
+    auto image = std::make_shared<CursorImage>();
+    image->serial = header.serial;
+    image->width = header.width;
+    image->height = header.height;
+    image->xhot = header.xhot;
+    image->yhot = header.yhot;
+    image->pixels.assign(payload.begin() + sizeof(header), payload.end());
+    {
+        std::lock_guard<std::mutex> lock(cursor_mutex_);
+        cursor_shapes_.insert(image);
+    }
+    cursor_shapes_received_++;
+}
+
+void StreamClient::handleAck(const std::vector<uint8_t>& payload) {
+    uint64_t receive_us = get_monotonic_us();
+    // ACK vide: serveur sans synchronisation d'horloge
+    if (payload.size() < sizeof(ClockSyncResponse)) {
+        return;
+    }
+    ClockSyncResponse response;
+    memcpy(&response, payload.data(), sizeof(response));
+    clock_sync_.addSample(response.client_send_us, response.server_receive_us,
+                          response.server_send_us, receive_us);
+}
+
 bool StreamClient::receivePacket(PacketHeader& header, std::vector<uint8_t>& payload) {
     // Receive header
     int received = recv(socket_, reinterpret_cast<char*>(&header), sizeof(header), MSG_WAITALL);
@@ -221,7 +455,7 @@ bool StreamClient::receivePacket(PacketHeader& header, std::vector<uint8_t>& pay
     
     // Validate header
     if (header.magic != MAGIC_NUMBER) {
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, "Invalid magic number");
+        LOG_ERROR("Invalid magic number");
         return false;
     }
     
@@ -237,11 +471,12 @@ bool StreamClient::receivePacket(PacketHeader& header, std::vector<uint8_t>& pay
     }
     
     bytes_received_ += sizeof(header) + header.payload_size;
+    PROBE3(receive, header.packet_type, header.payload_size, header.sequence_number);
     return true;
 }
 
 void StreamClient::receiveLoop() {
-    Logger::log(Logger::LogLevel::INFO, "Receive loop started");
+    LOG_INFO("Receive loop started");
     
     while (connected_) {
         PacketHeader header;
@@ -249,7 +484,7 @@ void StreamClient::receiveLoop() {
         
         if (!receivePacket(header, payload)) {
             if (connected_) {
-                Logger::log(Logger::LogLevel::ERROR_LEVEL, "Failed to receive packet");
+                LOG_ERROR("Failed to receive packet");
                 connected_ = false;
             }
             break;
@@ -261,13 +496,21 @@ void StreamClient::receiveLoop() {
             case PacketType::VIDEO_FRAME:
                 handleVideoFrame(header, payload);
                 break;
+
+            case PacketType::FRAME_UPDATE:
+                handleFrameUpdate(header, payload);
+                break;
+
+            case PacketType::FRAME_REPEAT:
+                handleFrameRepeat(payload);
+                break;
                 
             case PacketType::AUDIO_FRAME:
                 handleAudioFrame(header, payload);
                 break;
                 
             case PacketType::DISCONNECT:
-                Logger::log(Logger::LogLevel::INFO, "Server requested disconnect");
+                LOG_INFO("Server requested disconnect");
                 connected_ = false;
                 break;
                 
@@ -276,53 +519,81 @@ void StreamClient::receiveLoop() {
                 break;
                 
             case PacketType::ACK:
-                // ACK received, no action needed (could be used for reliability in the future)
+                handleAck(payload);
+                break;
+
+            case PacketType::STREAM_LIST:
+                handleStreamList(payload);
+                break;
+
+            case PacketType::CURSOR:
+                handleCursor(payload);
+                break;
+
+            case PacketType::CURSOR_SHAPE:
+                handleCursorShape(payload);
                 break;
                 
             default:
-                Logger::log(Logger::LogLevel::WARN, "Unknown packet type: " + std::to_string(header.packet_type));
+                LOG_WARN("Unknown packet type: {}", (int)header.packet_type);
                 break;
         }
     }
     
-    Logger::log(Logger::LogLevel::INFO, "Receive loop ended");
+    LOG_INFO("Receive loop ended");
 }
 
 void StreamClient::heartbeatLoop() {
-    Logger::log(Logger::LogLevel::INFO, "Heartbeat loop started");
+    LOG_INFO("Heartbeat loop started");
+    
+    // Premier échange tout de suite pour avoir une estimation d'horloge
+    // avant les premières frames
+    auto next_heartbeat = std::chrono::steady_clock::now();
+    int heartbeats = 0;
     
     while (connected_) {
-        std::this_thread::sleep_for(std::chrono::seconds(10));
+        if (std::chrono::steady_clock::now() < next_heartbeat) {
+            // Tranches courtes pour que disconnect() n'attende pas
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        next_heartbeat += kHeartbeatInterval;
         
-        if (connected_) {
-            if (!sendHeartbeat()) {
-                Logger::log(Logger::LogLevel::ERROR_LEVEL, "Failed to send heartbeat");
+        if (!sendHeartbeat()) {
+            if (connected_) {
+                LOG_ERROR("Failed to send heartbeat");
+                connected_ = false;
+            }
+            break;
+        }
+        if (++heartbeats % kReportEvery == 0 && !sendLatencyReport()) {
+            if (connected_) {
+                LOG_ERROR("Failed to send latency report");
                 connected_ = false;
-                break;
             }
+            break;
         }
     }
     
-    Logger::log(Logger::LogLevel::INFO, "Heartbeat loop ended");
+    LOG_INFO("Heartbeat loop ended");
 }
 
 void StreamClient::handleVideoFrame(const PacketHeader& header, const std::vector<uint8_t>& payload) {
-    // Video frame format: VideoFrameHeader + pixel data
-    struct VideoFrameHeader {
-        uint32_t frame_number;
-        uint16_t width;
-        uint16_t height;
-        uint8_t quality;
-        uint8_t padding;
-        uint64_t timestamp;
-    };
-    
+    // Video frame format: VideoFrameHeader (common.h) + pixel data
     if (payload.size() < sizeof(VideoFrameHeader)) {
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, "Invalid video frame size");
+        LOG_ERROR("Invalid video frame size");
         return;
     }
     
+    // Le format voyage avec chaque frame: pas d'ambiguïté pendant un changement de CONFIG
+    uint16_t format = header.flags & FRAME_FLAG_FORMAT_MASK;
+    if (format > static_cast<uint16_t>(PixelFormat::RGB565)) {
+        LOG_ERROR("Unknown video frame pixel format {}", format);
+        return;
+    }
+
     const VideoFrameHeader* frame_header = reinterpret_cast<const VideoFrameHeader*>(payload.data());
+    FrameSpan receive_span("client_frame", frame_header->frame_number);
     
     // Create VideoFrame
     VideoFrame frame;
@@ -331,21 +602,251 @@ void StreamClient::handleVideoFrame(const PacketHeader& header, const std::vecto
     frame.height = frame_header->height;
     frame.quality = frame_header->quality;
     frame.timestamp = frame_header->timestamp;
+    frame.stream_id = frame_header->stream_id;
+    frame.format = static_cast<PixelFormat>(format);
     
     // Extract pixel data
-    std::vector<uint8_t> frame_data(payload.begin() + sizeof(VideoFrameHeader), payload.end());
-    frame.data = frame_data;
-    
+    frame.data.assign(payload.begin() + sizeof(VideoFrameHeader), payload.end());
+
+    // Comme le serveur pour son miroir: une frame complète vide le cache de tuiles
+    tile_cache_.clear();
+
+    // Frame brute: base des prochains FRAME_UPDATE de ce flux
+    if (frame.stream_id < MAX_VIDEO_STREAMS) {
+        Framebuffer& framebuffer = framebuffers_[frame.stream_id];
+        framebuffer.valid = frame.data.size() == PixelPacker::packedSize(frame.format, frame.width, frame.height);
+        if (framebuffer.valid) {
+            framebuffer.frame_number = frame.frame_number;
+            framebuffer.width = frame.width;
+            framebuffer.height = frame.height;
+            framebuffer.format = frame.format;
+            framebuffer.pixels = frame.data;
+        }
+    }
+
+    deliverVideoFrame(frame, payload.size());
+}
+
+void StreamClient::handleFrameUpdate(const PacketHeader& header, const std::vector<uint8_t>& payload) {
+    if (payload.size() < sizeof(FrameUpdateHeader)) {
+        LOG_ERROR("Invalid frame update size");
+        return;
+    }
+
+    FrameUpdateHeader update;
+    memcpy(&update, payload.data(), sizeof(update));
+    FrameSpan receive_span("client_frame", update.frame_number);
+
+    // Sans la frame de base, dans le même format, les commandes n'ont pas de sens
+    uint16_t format = header.flags & FRAME_FLAG_FORMAT_MASK;
+    Framebuffer* framebuffer = update.stream_id < MAX_VIDEO_STREAMS ? &framebuffers_[update.stream_id] : nullptr;
+    if (!framebuffer || !framebuffer->valid || framebuffer->frame_number != update.base_frame_number ||
+        static_cast<uint16_t>(framebuffer->format) != format ||
+        framebuffer->width != update.width || framebuffer->height != update.height) {
+        frame_updates_dropped_++;
+        LOG_WARN("Frame update {} ignored: base frame {} not available", update.frame_number, update.base_frame_number);
+        // Une seule demande: les mises à jour suivantes trouvent le framebuffer invalide
+        if (framebuffer && framebuffer->valid) {
+            framebuffer->valid = false;
+            requestRefresh();
+        }
+        return;
+    }
+
+    if (!applyFrameUpdate(update, payload, sizeof(FrameUpdateHeader))) {
+        // Framebuffer partiellement modifié: inutilisable jusqu'à la prochaine frame complète
+        framebuffer->valid = false;
+        frame_updates_dropped_++;
+        LOG_ERROR("Malformed frame update {}", update.frame_number);
+        requestRefresh();
+        return;
+    }
+    framebuffer->frame_number = update.frame_number;
+    frame_updates_received_++;
+
+    VideoFrame frame;
+    frame.frame_number = update.frame_number;
+    frame.width = update.width;
+    frame.height = update.height;
+    frame.quality = update.quality;
+    frame.timestamp = update.timestamp;
+    frame.stream_id = update.stream_id;
+    frame.format = framebuffer->format;
+    frame.data = framebuffer->pixels;
+    deliverVideoFrame(frame, payload.size());
+}
+
+void StreamClient::handleFrameRepeat(const std::vector<uint8_t>& payload) {
+    if (payload.size() < sizeof(FrameRepeat)) {
+        LOG_ERROR("Invalid frame repeat size");
+        return;
+    }
+
+    FrameRepeat repeat;
+    memcpy(&repeat, payload.data(), sizeof(repeat));
+    FrameSpan receive_span("client_frame", repeat.frame_number);
+
+    // Le framebuffer doit contenir la frame répétée; sinon, comme pour un FRAME_UPDATE
+    Framebuffer* framebuffer = repeat.stream_id < MAX_VIDEO_STREAMS ? &framebuffers_[repeat.stream_id] : nullptr;
+    if (!framebuffer || !framebuffer->valid || framebuffer->frame_number != repeat.base_frame_number) {
+        LOG_WARN("Frame repeat {} ignored: frame {} not available", repeat.frame_number, repeat.base_frame_number);
+        if (framebuffer && framebuffer->valid) {
+            framebuffer->valid = false;
+            requestRefresh();
+        }
+        return;
+    }
+    frame_repeats_received_++;
+
+    // Numéro et horodatage nouveaux: la latence reste mesurée; la base ne change pas
+    VideoFrame frame;
+    frame.frame_number = repeat.frame_number;
+    frame.width = framebuffer->width;
+    frame.height = framebuffer->height;
+    frame.quality = repeat.quality;
+    frame.timestamp = repeat.timestamp;
+    frame.stream_id = repeat.stream_id;
+    frame.format = framebuffer->format;
+    frame.data = framebuffer->pixels;
+    deliverVideoFrame(frame, payload.size());
+}
+
+bool StreamClient::applyFrameUpdate(const FrameUpdateHeader& update, const std::vector<uint8_t>& payload, size_t offset) {
+    Framebuffer& framebuffer = framebuffers_[update.stream_id];
+    const int bytes_per_pixel = static_cast<int>(PixelPacker::packedSize(framebuffer.format, 1, 1));
+    const size_t stride = static_cast<size_t>(framebuffer.width) * bytes_per_pixel;
+
+    for (uint16_t i = 0; i < update.command_count; ++i) {
+        UpdateCommand command;
+        if (payload.size() - offset < sizeof(command)) {
+            return false;
+        }
+        memcpy(&command, payload.data() + offset, sizeof(command));
+        offset += sizeof(command);
+        if (!FrameDelta::fits(command, framebuffer.width, framebuffer.height)) {
+            return false;
+        }
+
+        if (command.type == static_cast<uint8_t>(UpdateCommandType::COPY_RECT)) {
+            FrameDelta::applyCopy(framebuffer.pixels.data(), framebuffer.width, bytes_per_pixel, command);
+            continue;
+        }
+
+        uint8_t* destination = framebuffer.pixels.data() + command.y * stride +
+                               static_cast<size_t>(command.x) * bytes_per_pixel;
+        bool cache_lossy = command.type == static_cast<uint8_t>(UpdateCommandType::CACHE_LOSSY_TILE);
+        if (cache_lossy || command.type == static_cast<uint8_t>(UpdateCommandType::LOSSY_RECT)) {
+            uint64_t key = 0;
+            if (cache_lossy) {
+                if (payload.size() - offset < sizeof(key)) {
+                    return false;
+                }
+                memcpy(&key, payload.data() + offset, sizeof(key));
+                offset += sizeof(key);
+            }
+            // RGB565 quel que soit le format du framebuffer
+            size_t lossy_bytes = PixelPacker::packedSize(PixelFormat::RGB565, command.width, command.height);
+            if (payload.size() - offset < lossy_bytes) {
+                return false;
+            }
+            const uint8_t* pixels = payload.data() + offset;
+            offset += lossy_bytes;
+            lossy_tiles_received_++;
+            if (framebuffer.format == PixelFormat::ARGB8888) {
+                PixelPacker::unpack(PixelFormat::RGB565, pixels, command.width, command.height, destination, stride);
+            } else if (framebuffer.format == PixelFormat::RGB24) {
+                size_t argb_row = static_cast<size_t>(command.width) * 4;
+                lossy_scratch_.resize(argb_row * command.height);
+                PixelPacker::unpack(PixelFormat::RGB565, pixels, command.width, command.height,
+                                    lossy_scratch_.data(), argb_row);
+                for (int row = 0; row < command.height; ++row) {
+                    PixelPacker::pack(PixelFormat::RGB24, lossy_scratch_.data() + row * argb_row, command.width,
+                                      destination + row * stride);
+                }
+            } else {
+                size_t row_bytes = static_cast<size_t>(command.width) * 2;
+                for (int row = 0; row < command.height; ++row) {
+                    memcpy(destination + row * stride, pixels + row * row_bytes, row_bytes);
+                }
+            }
+            if (cache_lossy) {
+                // Gardée déjà convertie, comme CACHE_TILE
+                size_t row_bytes = static_cast<size_t>(command.width) * bytes_per_pixel;
+                std::vector<uint8_t> converted(row_bytes * command.height);
+                for (int row = 0; row < command.height; ++row) {
+                    memcpy(converted.data() + row * row_bytes, destination + row * stride, row_bytes);
+                }
+                tile_cache_.insert(key, std::move(converted));
+                tile_cache_misses_++;
+            }
+            continue;
+        }
+
+        bool tile = command.type == static_cast<uint8_t>(UpdateCommandType::CACHED_TILE) ||
+                    command.type == static_cast<uint8_t>(UpdateCommandType::CACHE_TILE);
+        uint64_t hash = 0;
+        if (tile) {
+            if (payload.size() - offset < sizeof(hash)) {
+                return false;
+            }
+            memcpy(&hash, payload.data() + offset, sizeof(hash));
+            offset += sizeof(hash);
+        }
+
+        // Pixels ligne par ligne, déjà dans le format du framebuffer: ceux du
+        // paquet (RAW_RECT, CACHE_TILE) ou ceux d'une tuile du cache
+        size_t row_bytes = static_cast<size_t>(command.width) * bytes_per_pixel;
+        size_t rect_bytes = row_bytes * command.height;
+        const uint8_t* pixels = nullptr;
+        if (command.type == static_cast<uint8_t>(UpdateCommandType::CACHED_TILE)) {
+            const std::vector<uint8_t>* cached = tile_cache_.find(hash);
+            if (!cached || cached->size() != rect_bytes) {
+                LOG_ERROR("Tile {} missing from the tile cache", hash);
+                return false;
+            }
+            pixels = cached->data();
+            tile_cache_hits_++;
+        } else {
+            if (payload.size() - offset < rect_bytes) {
+                return false;
+            }
+            pixels = payload.data() + offset;
+            offset += rect_bytes;
+            if (tile) {
+                tile_cache_.insert(hash, std::vector<uint8_t>(pixels, pixels + rect_bytes));
+                tile_cache_misses_++;
+            }
+        }
+        for (int row = 0; row < command.height; ++row) {
+            memcpy(destination + row * stride, pixels + row * row_bytes, row_bytes);
+        }
+    }
+    return offset == payload.size();
+}
+
+void StreamClient::deliverVideoFrame(const VideoFrame& frame, size_t payload_size) {
     video_frames_received_++;
+    Logger::trace(TraceEvent::FRAME_RECEIVED, frame.frame_number, 0, payload_size);
     
     if (video_callback_) {
-        video_callback_(frame, frame_data);
+        FrameSpan span("client_callback");
+        video_callback_(frame, frame.data);
+    }
+    
+    // Latence capture -> affichage, dans l'horloge du client
+    if (clock_sync_.hasEstimate() && frame.timestamp != 0) {
+        int64_t latency = static_cast<int64_t>(get_monotonic_us())
+                        - static_cast<int64_t>(clock_sync_.serverToLocal(frame.timestamp));
+        // Légèrement négatif = erreur d'estimation de l'offset (< RTT/2)
+        if (latency > -kMaxPlausibleLatencyUs && latency < kMaxPlausibleLatencyUs) {
+            glass_latency_.record(static_cast<uint64_t>(std::max<int64_t>(latency, 0)));
+        }
     }
 }
 
 void StreamClient::handleAudioFrame(const PacketHeader& header, const std::vector<uint8_t>& payload) {
     if (payload.size() < sizeof(AudioFrame)) {
-        Logger::log(Logger::LogLevel::ERROR_LEVEL, "Invalid audio frame size");
+        LOG_ERROR("Invalid audio frame size");
         return;
     }
     
@@ -6,13 +6,21 @@
 #include <atomic>
 #include <functional>
 #include <vector>
+#include <mutex>
 #include "common.h"
+#include "ClockSync.h"
+#include "CursorShapeCache.h"
+#include "TileCache.h"
+#include "../utils/Metrics.h"
 
 class StreamClient {
 public:
     using VideoFrameCallback = std::function<void(const VideoFrame&, const std::vector<uint8_t>&)>;
     using AudioFrameCallback = std::function<void(const AudioFrame&, const std::vector<uint8_t>&)>;
     using DisconnectCallback = std::function<void()>;
+    using StreamListCallback = std::function<void(const std::vector<StreamInfo>&)>;
+    // Forme nulle tant que son CURSOR_SHAPE n'est pas arrivé
+    using CursorCallback = std::function<void(const CursorPosition&, std::shared_ptr<const CursorImage>)>;
 
     StreamClient(const std::string& server_address, int server_port);
     ~StreamClient();
@@ -25,25 +33,92 @@ public:
     void setVideoFrameCallback(VideoFrameCallback callback) { video_callback_ = callback; }
     void setAudioFrameCallback(AudioFrameCallback callback) { audio_callback_ = callback; }
     void setDisconnectCallback(DisconnectCallback callback) { disconnect_callback_ = callback; }
+    void setStreamListCallback(StreamListCallback callback) { stream_list_callback_ = callback; }
+    void setCursorCallback(CursorCallback callback) { cursor_callback_ = callback; }
+
+    // Flux vidéo annoncés par le serveur (vide: flux unique 0)
+    std::vector<StreamInfo> getStreams() const;
+
+    // Choisit les flux reçus (bit i = flux i); par défaut seul le flux 0
+    bool subscribe(uint32_t stream_mask);
+
+    // Format des pixels des frames brutes (paquet CONFIG, valeurs par défaut
+    // pour le reste de StreamConfig). Les frames gardent le format reçu dans
+    // VideoFrame::format: PixelPacker::unpack() vers la destination finale.
+    bool setPixelFormat(PixelFormat format);
+
+    // Qualité minimale des tuiles hors zone d'intérêt (pointeur, fenêtre
+    // active), envoyée avec le format dans le paquet CONFIG. À
+    // Config::LOSSY_TILE_QUALITY ou moins, le texte loin du regard passe lui
+    // aussi en LOSSY_RECT (avec setLossyTiles); 100 par défaut
+    bool setRoiMinQuality(uint8_t quality);
+
+    // Cache de tuiles demandé au handshake, en blocs de TileCache::kBlockTiles
+    // tuiles (0: désactivé); à appeler avant connect()
+    void setTileCacheBlocks(uint8_t blocks) { tile_cache_blocks_ = blocks; }
+    // Capacité accordée par le serveur, en tuiles
+    size_t getTileCacheCapacity() const { return tile_cache_capacity_; }
+
+    // Accepte les tuiles image naturelle / vidéo en RGB565 (LOSSY_RECT) dans
+    // un flux ARGB8888 ou RGB24; texte et interface restent exacts. À
+    // appeler avant connect()
+    void setLossyTiles(bool enabled) { lossy_tiles_ = enabled; }
+
+    // Dernière position du curseur et sa forme (cache par numéro de série),
+    // à composer sur la frame (compositeCursor); false avant le premier CURSOR
+    bool getCursor(CursorPosition& position, std::shared_ptr<const CursorImage>& shape) const;
     
     // Statistics
     uint64_t getReceivedVideoFrames() const { return video_frames_received_; }
     uint64_t getReceivedAudioFrames() const { return audio_frames_received_; }
     uint64_t getBytesReceived() const { return bytes_received_; }
+    uint64_t getReceivedCursorUpdates() const { return cursor_updates_received_; }
+    uint64_t getReceivedCursorShapes() const { return cursor_shapes_received_; }
+    // FRAME_UPDATE appliqués (comptés aussi dans getReceivedVideoFrames) et
+    // ignorés faute de la frame de base
+    uint64_t getReceivedFrameUpdates() const { return frame_updates_received_; }
+    uint64_t getDroppedFrameUpdates() const { return frame_updates_dropped_; }
+    // Tuiles reprises du cache (CACHED_TILE) ou reçues et gardées (CACHE_TILE)
+    uint64_t getTileCacheHits() const { return tile_cache_hits_; }
+    uint64_t getTileCacheMisses() const { return tile_cache_misses_; }
+    double getTileCacheHitRate() const;
+    // Tuiles reçues en LOSSY_RECT
+    uint64_t getReceivedLossyTiles() const { return lossy_tiles_received_; }
+    // FRAME_REPEAT réaffichés (comptés aussi dans getReceivedVideoFrames)
+    uint64_t getReceivedFrameRepeats() const { return frame_repeats_received_; }
+
+    // Synchronisation d'horloge (HEARTBEAT/ACK) et latence capture -> affichage
+    bool hasClockEstimate() const { return clock_sync_.hasEstimate(); }
+    int64_t getClockOffsetUs() const { return clock_sync_.offsetUs(); }
+    uint64_t getRttUs() const { return clock_sync_.rttUs(); }
+    HistogramSnapshot getGlassLatency() const { return glass_latency_.snapshot(); }
 
 private:
     void receiveLoop();
     void heartbeatLoop();
     bool sendHandshake();
     bool sendHeartbeat();
+    bool sendLatencyReport();
+    bool sendPacket(PacketType type, const void* data, size_t size);
+    void handleAck(const std::vector<uint8_t>& payload);
     bool receivePacket(PacketHeader& header, std::vector<uint8_t>& payload);
     void handleVideoFrame(const PacketHeader& header, const std::vector<uint8_t>& payload);
+    void handleFrameUpdate(const PacketHeader& header, const std::vector<uint8_t>& payload);
+    void handleFrameRepeat(const std::vector<uint8_t>& payload);
+    bool applyFrameUpdate(const FrameUpdateHeader& update, const std::vector<uint8_t>& payload, size_t offset);
+    void deliverVideoFrame(const VideoFrame& frame, size_t payload_size);
+    void requestRefresh();
+    bool sendConfig();
     void handleAudioFrame(const PacketHeader& header, const std::vector<uint8_t>& payload);
+    void handleStreamList(const std::vector<uint8_t>& payload);
+    void handleCursor(const std::vector<uint8_t>& payload);
+    void handleCursorShape(const std::vector<uint8_t>& payload);
     
     std::string server_address_;
     int server_port_;
     SOCKET socket_;
     std::atomic<bool> connected_;
+    std::mutex send_mutex_;     // heartbeat et subscribe() écrivent sur le même socket
     
     std::thread receive_thread_;
     std::thread heartbeat_thread_;
@@ -51,10 +126,60 @@ private:
     VideoFrameCallback video_callback_;
     AudioFrameCallback audio_callback_;
     DisconnectCallback disconnect_callback_;
+    StreamListCallback stream_list_callback_;
+    CursorCallback cursor_callback_;
+
+    // Dernière frame brute de chaque flux, dans le format reçu: base des
+    // FRAME_UPDATE. Thread de réception uniquement.
+    struct Framebuffer {
+        bool valid = false;
+        uint32_t frame_number = 0;
+        uint16_t width = 0;
+        uint16_t height = 0;
+        PixelFormat format = PixelFormat::ARGB8888;
+        std::vector<uint8_t> pixels;
+    };
+    Framebuffer framebuffers_[MAX_VIDEO_STREAMS];
+    // Tuiles dans le format des frames, vidé à chaque VIDEO_FRAME (comme le
+    // miroir du serveur). Thread de réception uniquement.
+    TileCache tile_cache_;
+    uint8_t tile_cache_blocks_;
+    std::atomic<size_t> tile_cache_capacity_;
+    bool lossy_tiles_;
+    // Derniers choix envoyés en CONFIG (thread appelant)
+    PixelFormat pixel_format_;
+    uint8_t roi_min_quality_;
+    std::vector<uint8_t> lossy_scratch_;    // LOSSY_RECT en ARGB8888 avant un framebuffer RGB24
+
+    std::vector<StreamInfo> streams_;
+    mutable std::mutex streams_mutex_;
+
+    CursorShapeCache cursor_shapes_;
+    CursorPosition cursor_position_;
+    std::shared_ptr<const CursorImage> cursor_shape_;
+    bool has_cursor_;
+    mutable std::mutex cursor_mutex_;
     
     std::atomic<uint64_t> video_frames_received_;
     std::atomic<uint64_t> audio_frames_received_;
     std::atomic<uint64_t> bytes_received_;
+    std::atomic<uint64_t> cursor_updates_received_;
+    std::atomic<uint64_t> cursor_shapes_received_;
+    std::atomic<uint64_t> frame_updates_received_;
+    std::atomic<uint64_t> frame_updates_dropped_;
+    std::atomic<uint64_t> tile_cache_hits_;
+    std::atomic<uint64_t> tile_cache_misses_;
+    std::atomic<uint64_t> lossy_tiles_received_;
+    std::atomic<uint64_t> frame_repeats_received_;
+
+    // clock_sync_: addSample() sur le thread de réception (handleAck), une
+    // seule écriture à la fois; lecture atomique depuis n'importe quel thread.
+    // glass_latency_: record() sur le thread de réception (deliverVideoFrame),
+    // snapshot() sur le heartbeat et les getters; Histogram est thread-safe.
+    // last_report_: thread heartbeat uniquement.
+    ClockSync clock_sync_;
+    Histogram glass_latency_;
+    HistogramSnapshot last_report_;
 };
 
 #endif // STREAMCLIENT_H
@@ -1,5 +1,10 @@
 #include "StreamServer.h"
+#include "PixelPacker.h"
+#include "FrameDelta.h"
 #include "../utils/Logger.h"
+#include "../utils/Metrics.h"
+#include "../utils/FrameTracer.h"
+#include "../utils/Probes.h"
 #include <cstring>
 #include <algorithm>
 
@@ -13,24 +18,390 @@
     #include <unistd.h>
     #include <fcntl.h>
     #include <errno.h>
+    #include <sys/ioctl.h>
+    #include <netinet/tcp.h>
 #endif
 
+#ifdef __linux__
+    #include <linux/sockios.h>
+#endif
+
+namespace {
+    uint64_t elapsedMicros(std::chrono::steady_clock::time_point start) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::string clientLabels(uint16_t client_id) {
+        return "client=\"" + std::to_string(client_id) + "\"";
+    }
+
+    void acquireClientMetrics(ClientInfo& client) {
+        std::string labels = clientLabels(client.client_id);
+        client.send_time_us = &Metrics::histogram("client_send_time_us", labels);
+        client.bytes_sent = &Metrics::counter("client_bytes_sent_total", labels);
+        client.frames_dropped = &Metrics::counter("client_frames_dropped_total", labels);
+        client.send_queue_bytes = &Metrics::gauge("client_send_queue_bytes", labels);
+        client.rtt_us = &Metrics::gauge("client_rtt_us", labels);
+    }
+
+    // Le client doit déjà être retiré de clients_: plus personne ne publie
+    void releaseClientMetrics(ClientInfo& client) {
+        std::string labels = clientLabels(client.client_id);
+        client.send_time_us = nullptr;
+        client.bytes_sent = nullptr;
+        client.frames_dropped = nullptr;
+        client.send_queue_bytes = nullptr;
+        client.rtt_us = nullptr;
+        Metrics::remove("client_send_time_us", labels);
+        Metrics::remove("client_bytes_sent_total", labels);
+        Metrics::remove("client_frames_dropped_total", labels);
+        Metrics::remove("client_send_queue_bytes", labels);
+        Metrics::remove("client_rtt_us", labels);
+        Metrics::remove("client_glass_latency_p50_us", labels);
+        Metrics::remove("client_glass_latency_p90_us", labels);
+        Metrics::remove("client_glass_latency_p99_us", labels);
+        Metrics::remove("client_glass_latency_max_us", labels);
+        Metrics::remove("client_clock_offset_us", labels);
+    }
+
+    bool isTile(const UpdateCommand& command) {
+        return command.type == static_cast<uint8_t>(UpdateCommandType::CACHE_TILE);
+    }
+
+    // Traitement d'une tuile candidate (valeurs de lossy[i]; lossy vide: tout exact)
+    constexpr uint8_t kExactTile = 0;
+    constexpr uint8_t kLossyTile = 1;       // image naturelle, mouvement: LOSSY_RECT, jamais en cache
+    constexpr uint8_t kLoweredTile = 2;     // texte hors zone d'intérêt: RGB565 gardé en cache
+
+    uint8_t lossLevel(const std::vector<uint8_t>& lossy, size_t index) {
+        return lossy.empty() ? kExactTile : lossy[index];
+    }
+
+    struct UpdateStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t lossy = 0;                 // tuiles en RGB565 (envoyées ou reprises du cache)
+        uint64_t lowered = 0;               // dont texte hors zone d'intérêt
+        std::vector<uint8_t> levels;        // niveau reçu par le client, par commande
+    };
+
+    /**
+     * Command for a tile candidate and the cache key it carries. A copy of
+     * the exact tile in the cache always wins (a hash is cheaper than any
+     * pixels); a lowered tile may also reuse or store its RGB565 version
+     * (TileCache::lossyKey), which an exact tile never does. Only reads the
+     * cache (contains()).
+     */
+    UpdateCommandType routeTile(uint64_t hash, uint8_t level, const TileCache* cache, uint64_t& key) {
+        if (!cache) {
+            return level == kExactTile ? UpdateCommandType::RAW_RECT : UpdateCommandType::LOSSY_RECT;
+        }
+        key = hash;
+        if (cache->contains(hash)) {
+            return UpdateCommandType::CACHED_TILE;
+        }
+        if (level == kLoweredTile) {
+            key = TileCache::lossyKey(hash);
+            return cache->contains(key) ? UpdateCommandType::CACHED_TILE : UpdateCommandType::CACHE_LOSSY_TILE;
+        }
+        return level == kLossyTile ? UpdateCommandType::LOSSY_RECT : UpdateCommandType::CACHE_TILE;
+    }
+
+    // Format des pixels qui suivent une commande (ARGB8888 pour COPY_RECT et CACHED_TILE: aucun)
+    size_t commandPixelBytes(UpdateCommandType type, PixelFormat format, const UpdateCommand& command) {
+        switch (type) {
+            case UpdateCommandType::RAW_RECT:
+            case UpdateCommandType::CACHE_TILE:
+                return PixelPacker::packedSize(format, command.width, command.height);
+            case UpdateCommandType::LOSSY_RECT:
+            case UpdateCommandType::CACHE_LOSSY_TILE:
+                return PixelPacker::packedSize(PixelFormat::RGB565, command.width, command.height);
+            default:
+                return 0;
+        }
+    }
+
+    bool carriesKey(UpdateCommandType type) {
+        return type == UpdateCommandType::CACHED_TILE || type == UpdateCommandType::CACHE_TILE ||
+               type == UpdateCommandType::CACHE_LOSSY_TILE;
+    }
+
+    /**
+     * FRAME_UPDATE payload size against the current state of the client's
+     * tile cache (nullptr: no cache, tile candidates are RAW_RECTs or
+     * LOSSY_RECTs). The LRU order is not touched and evictions within the
+     * update are ignored.
+     */
+    size_t frameUpdateSize(const std::vector<UpdateCommand>& commands, const std::vector<uint64_t>& tile_hashes,
+                           const std::vector<uint8_t>& lossy, PixelFormat format, const TileCache* cache) {
+        size_t size = sizeof(FrameUpdateHeader);
+        for (size_t i = 0; i < commands.size(); ++i) {
+            const UpdateCommand& command = commands[i];
+            size += sizeof(UpdateCommand);
+            UpdateCommandType type = static_cast<UpdateCommandType>(command.type);
+            if (isTile(command)) {
+                uint64_t key = 0;
+                type = routeTile(cache ? tile_hashes[i] : 0, lossLevel(lossy, i), cache, key);
+            }
+            size += (carriesKey(type) ? sizeof(uint64_t) : 0) + commandPixelBytes(type, format, command);
+        }
+        return size;
+    }
+
+    // Majorant: chaque tuile envoyée exacte, avec sa clé si le client a un cache
+    size_t frameUpdateBound(const std::vector<UpdateCommand>& commands, PixelFormat format, bool cached) {
+        size_t size = sizeof(FrameUpdateHeader);
+        for (const UpdateCommand& command : commands) {
+            size += sizeof(UpdateCommand);
+            if (command.type != static_cast<uint8_t>(UpdateCommandType::COPY_RECT)) {
+                size += (cached && isTile(command) ? sizeof(uint64_t) : 0) +
+                        PixelPacker::packedSize(format, command.width, command.height);
+            }
+        }
+        return size;
+    }
+
+    /**
+     * FRAME_UPDATE: header, commands, pixels repacked row by row. Each tile
+     * candidate is routed by routeTile() and the cache updated (find() for
+     * a hit, insert() for a stored tile) in command order, exactly as the
+     * client will replay them.
+     */
+    std::vector<uint8_t> serializeFrameUpdate(const VideoFrame& frame, uint32_t base_frame_number,
+                                              const std::vector<UpdateCommand>& commands,
+                                              const std::vector<uint64_t>& tile_hashes,
+                                              const std::vector<uint8_t>& lossy,
+                                              PixelFormat format, TileCache* cache, UpdateStats& stats) {
+        FrameUpdateHeader header;
+        header.frame_number = frame.frame_number;
+        header.base_frame_number = base_frame_number;
+        header.width = frame.width;
+        header.height = frame.height;
+        header.quality = frame.quality;
+        header.stream_id = frame.stream_id;
+        header.command_count = static_cast<uint16_t>(commands.size());
+        header.timestamp = frame.timestamp;
+
+        std::vector<uint8_t> packet(frameUpdateBound(commands, format, cache != nullptr));
+        stats.levels.assign(commands.size(), kExactTile);
+        uint8_t* out = packet.data();
+        memcpy(out, &header, sizeof(header));
+        out += sizeof(header);
+        for (size_t i = 0; i < commands.size(); ++i) {
+            UpdateCommand command = commands[i];
+            UpdateCommandType type = static_cast<UpdateCommandType>(command.type);
+            uint64_t key = 0;
+            if (isTile(command)) {
+                uint8_t level = lossLevel(lossy, i);
+                type = routeTile(cache ? tile_hashes[i] : 0, level, cache, key);
+                if (type == UpdateCommandType::CACHED_TILE) {
+                    cache->find(key);
+                    stats.hits++;
+                } else if (type == UpdateCommandType::CACHE_TILE || type == UpdateCommandType::CACHE_LOSSY_TILE) {
+                    cache->insert(key);
+                    stats.misses++;
+                }
+                // Seule une copie de la tuile exacte en cache rattrape la perte
+                bool sent_lossy = level != kExactTile &&
+                                  !(type == UpdateCommandType::CACHED_TILE && key == tile_hashes[i]);
+                stats.lossy += sent_lossy ? 1 : 0;
+                stats.lowered += sent_lossy && level == kLoweredTile ? 1 : 0;
+                stats.levels[i] = sent_lossy ? level : kExactTile;
+                command.type = static_cast<uint8_t>(type);
+            }
+
+            memcpy(out, &command, sizeof(command));
+            out += sizeof(command);
+            if (carriesKey(type)) {
+                memcpy(out, &key, sizeof(key));
+                out += sizeof(key);
+            }
+            if (commandPixelBytes(type, format, command) == 0) {
+                continue;
+            }
+            PixelFormat pixel_format = type == UpdateCommandType::LOSSY_RECT ||
+                                       type == UpdateCommandType::CACHE_LOSSY_TILE ? PixelFormat::RGB565 : format;
+            size_t row_bytes = PixelPacker::packedSize(pixel_format, command.width, 1);
+            for (int row = 0; row < command.height; ++row) {
+                const uint8_t* src = frame.data.data() +
+                    ((static_cast<size_t>(command.y) + row) * frame.width + command.x) * 4;
+                PixelPacker::pack(pixel_format, src, command.width, out);
+                out += row_bytes;
+            }
+        }
+        // Taille allouée: toutes les tuiles envoyées exactes
+        packet.resize(out - packet.data());
+        return packet;
+    }
+
+    uint64_t tileHash(const VideoFrame& frame, const UpdateCommand& command) {
+        return TileCache::hashTile(frame.data.data() + (static_cast<size_t>(command.y) * frame.width + command.x) * 4,
+                                   static_cast<size_t>(frame.width) * 4, command.width, command.height);
+    }
+
+    // Grille TileCache::kTileSize d'une frame (ClientInfo::lossy_tiles)
+    struct TileGrid {
+        int width;
+        int height;
+        int columns;
+        int rows;
+
+        TileGrid(int frame_width, int frame_height)
+            : width(frame_width), height(frame_height),
+              columns((frame_width + TileCache::kTileSize - 1) / TileCache::kTileSize),
+              rows((frame_height + TileCache::kTileSize - 1) / TileCache::kTileSize) {}
+
+        size_t size() const { return static_cast<size_t>(columns) * rows; }
+
+        size_t index(int x, int y) const {
+            return static_cast<size_t>(y / TileCache::kTileSize) * columns + x / TileCache::kTileSize;
+        }
+
+        // Tuile candidate couvrant la tuile index; RAW_RECT si rognée au bord
+        UpdateCommand tile(size_t index) const {
+            int x = static_cast<int>(index % columns) * TileCache::kTileSize;
+            int y = static_cast<int>(index / columns) * TileCache::kTileSize;
+            UpdateCommand command{};
+            command.x = static_cast<uint16_t>(x);
+            command.y = static_cast<uint16_t>(y);
+            command.width = static_cast<uint16_t>(std::min(TileCache::kTileSize, width - x));
+            command.height = static_cast<uint16_t>(std::min(TileCache::kTileSize, height - y));
+            bool whole = command.width == TileCache::kTileSize && command.height == TileCache::kTileSize;
+            command.type = static_cast<uint8_t>(whole ? UpdateCommandType::CACHE_TILE : UpdateCommandType::RAW_RECT);
+            return command;
+        }
+    };
+
+    // Une image (renvoyée exacte une fois immobile) l'emporte sur du texte abaissé
+    uint8_t worseLoss(uint8_t a, uint8_t b) {
+        return a == kLossyTile || b == kLossyTile ? kLossyTile : std::max(a, b);
+    }
+
+    /**
+     * A COPY_RECT moves the client's degraded pixels with the others: each
+     * destination tile takes the worst level among the source tiles it
+     * reads, merged with its own level when the copy covers it partly.
+     */
+    void copyLossLevels(std::vector<uint8_t>& held, const TileGrid& grid, const UpdateCommand& copy) {
+        if (copy.width == 0 || copy.height == 0) {
+            return;
+        }
+        const int T = TileCache::kTileSize;
+        const std::vector<uint8_t> source = held;
+        int dx = copy.src_x - copy.x;
+        int dy = copy.src_y - copy.y;
+        for (int row = copy.y / T; row <= (copy.y + copy.height - 1) / T; ++row) {
+            for (int column = copy.x / T; column <= (copy.x + copy.width - 1) / T; ++column) {
+                int left = std::max(column * T, static_cast<int>(copy.x));
+                int right = std::min((column + 1) * T, copy.x + copy.width);
+                int top = std::max(row * T, static_cast<int>(copy.y));
+                int bottom = std::min((row + 1) * T, copy.y + copy.height);
+                uint8_t level = kExactTile;
+                for (int source_row = (top + dy) / T; source_row <= (bottom - 1 + dy) / T; ++source_row) {
+                    for (int source_column = (left + dx) / T; source_column <= (right - 1 + dx) / T; ++source_column) {
+                        level = worseLoss(level, source[static_cast<size_t>(source_row) * grid.columns + source_column]);
+                    }
+                }
+                size_t index = static_cast<size_t>(row) * grid.columns + column;
+                bool covered = left == column * T && top == row * T &&
+                               right == std::min((column + 1) * T, grid.width) &&
+                               bottom == std::min((row + 1) * T, grid.height);
+                held[index] = covered ? level : worseLoss(source[index], level);
+            }
+        }
+    }
+
+    /**
+     * Tile held at level that must be sent exact now, whatever its change
+     * history: it entered the region of interest, or it is lowered text
+     * and the client no longer accepts it (lowering: floor at or below
+     * LOSSY_TILE_QUALITY and a region of interest to favour).
+     */
+    bool refineNow(uint8_t level, const UpdateCommand& tile, const RoiMap& roi, bool lowering) {
+        if (level == kExactTile) {
+            return false;
+        }
+        return roi.intersects(tile.x, tile.y, tile.width, tile.height) || (level == kLoweredTile && !lowering);
+    }
+
+    /**
+     * Tiles the client displays in RGB565 that must now be sent exact,
+     * appended after the frame's commands: refineNow() ones, and natural
+     * or moving content once the classifier sees it settled. updated:
+     * tiles already among the frame's candidates, routed as usual.
+     */
+    std::vector<UpdateCommand> refinements(const std::vector<uint8_t>& held, const std::vector<uint8_t>& updated,
+                                           const TileGrid& grid, const TileClassifier& classifier,
+                                           const RoiMap& roi, bool lowering) {
+        std::vector<UpdateCommand> refined;
+        for (size_t i = 0; i < held.size(); ++i) {
+            if (held[i] == kExactTile || updated[i]) {
+                continue;
+            }
+            UpdateCommand command = grid.tile(i);
+            if (refineNow(held[i], command, roi, lowering) ||
+                (held[i] == kLossyTile && classifier.settled(command.x, command.y))) {
+                refined.push_back(command);
+            }
+        }
+        return refined;
+    }
+
+    // Tuile RGB565 à renvoyer exacte, tout de suite ou une fois immobile
+    bool refinementPending(const std::vector<uint8_t>& held, const TileGrid& grid, const RoiMap& roi, bool lowering) {
+        for (size_t i = 0; i < held.size(); ++i) {
+            if (held[i] == kLossyTile || refineNow(held[i], grid.tile(i), roi, lowering)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Octets encore dans le tampon d'émission du noyau
+    int64_t socketSendQueue(SOCKET sock) {
+#ifdef __linux__
+        int pending = 0;
+        if (ioctl(sock, SIOCOUTQ, &pending) == 0) {
+            return pending;
+        }
+#else
+        (void)sock;
+#endif
+        return -1;
+    }
+
+    // RTT lissé estimé par le noyau (TCP_INFO), en microsecondes
+    int64_t socketRtt(SOCKET sock) {
+#ifdef __linux__
+        struct tcp_info info;
+        socklen_t len = sizeof(info);
+        if (getsockopt(sock, IPPROTO_TCP, TCP_INFO, &info, &len) == 0) {
+            return info.tcpi_rtt;
+        }
+#else
+        (void)sock;
+#endif
+        return -1;
+    }
+}
+
 StreamServer::StreamServer(const std::string& address, int port) 
     : address_(address), port_(port), running_(false), listen_socket_(INVALID_SOCKET),
-      next_client_id_(1), sequence_number_(0) {
+      cursor_shapes_(CursorShapeCache::kServerCapacity), last_cursor_(), has_cursor_(false), focus_window_(),
+      next_client_id_(1), sequence_number_(0), metrics_collector_id_(0) {
     
-    std::string msg = "StreamServer created: " + address + ":" + std::to_string(port);
-    Logger::log(Logger::LogLevel::INFO, msg);
+    LOG_INFO("StreamServer created: {}:{}", address, port);
 }
 
 StreamServer::~StreamServer() {
     stop();
-    Logger::log(Logger::LogLevel::INFO, "StreamServer destroyed");
+    LOG_INFO("StreamServer destroyed");
 }
 
 bool StreamServer::start() {
     if (running_) {
-        Logger::log(Logger::LogLevel::WARN, "StreamServer already running");
+        LOG_WARN("StreamServer already running");
         return false;
     }
 
@@ -40,7 +411,7 @@ bool StreamServer::start() {
     // Create listening socket
     listen_socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (listen_socket_ == INVALID_SOCKET) {
-        Logger::log(Logger::LogLevel::WARN, "Failed to create listen socket");
+        LOG_WARN("Failed to create listen socket");
         return false;
     }
 
@@ -48,7 +419,7 @@ bool StreamServer::start() {
     int reuse = 1;
     if (setsockopt(listen_socket_, SOL_SOCKET, SO_REUSEADDR, 
                    (const char*)&reuse, sizeof(reuse)) < 0) {
-        Logger::log(Logger::LogLevel::WARN, "Failed to set SO_REUSEADDR");
+        LOG_WARN("Failed to set SO_REUSEADDR");
     }
 
     // Bind socket
@@ -64,7 +435,7 @@ bool StreamServer::start() {
     }
 
     if (bind(listen_socket_, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        Logger::log(Logger::LogLevel::WARN, "Failed to bind socket");
+        LOG_WARN("Failed to bind socket");
         closesocket(listen_socket_);
         listen_socket_ = INVALID_SOCKET;
         return false;
@@ -72,7 +443,7 @@ bool StreamServer::start() {
 
     // Listen for connections
     if (listen(listen_socket_, Config::MAX_CLIENTS) < 0) {
-        Logger::log(Logger::LogLevel::WARN, "Failed to listen on socket");
+        LOG_WARN("Failed to listen on socket");
         closesocket(listen_socket_);
         listen_socket_ = INVALID_SOCKET;
         return false;
@@ -86,8 +457,10 @@ bool StreamServer::start() {
     // Start heartbeat monitor thread
     heartbeat_thread_ = std::thread(&StreamServer::heartbeatMonitor, this);
 
-    std::string msg = "StreamServer started on " + address_ + ":" + std::to_string(port_);
-    Logger::log(Logger::LogLevel::INFO, msg);
+    // RTT et file d'émission lus à la demande, hors du chemin d'envoi
+    metrics_collector_id_ = Metrics::addCollector([this] { collectClientMetrics(); });
+
+    LOG_INFO("StreamServer started on {}:{}", address_, port_);
     return true;
 }
 
@@ -97,10 +470,19 @@ void StreamServer::stop() {
     }
 
     running_ = false;
-    Logger::log(Logger::LogLevel::INFO, "StreamServer stopping...");
+    LOG_INFO("StreamServer stopping...");
+
+    Metrics::removeCollector(metrics_collector_id_);
+    metrics_collector_id_ = 0;
 
-    // Close listening socket
+    // Close listening socket (shutdown() d'abord: sous Linux, close() seul
+    // ne réveille pas le accept() bloqué)
     if (listen_socket_ != INVALID_SOCKET) {
+#ifdef PLATFORM_WINDOWS
+        shutdown(listen_socket_, SD_BOTH);
+#else
+        shutdown(listen_socket_, SHUT_RDWR);
+#endif
         closesocket(listen_socket_);
         listen_socket_ = INVALID_SOCKET;
     }
@@ -135,11 +517,11 @@ void StreamServer::stop() {
     }
     client_threads_.clear();
 
-    Logger::log(Logger::LogLevel::INFO, "StreamServer stopped");
+    LOG_INFO("StreamServer stopped");
 }
 
 void StreamServer::acceptConnections() {
-    Logger::log(Logger::LogLevel::INFO, "Accept thread started");
+    LOG_INFO("Accept thread started");
 
     while (running_) {
         struct sockaddr_in client_addr;
@@ -151,11 +533,16 @@ void StreamServer::acceptConnections() {
         
         if (client_socket == INVALID_SOCKET) {
             if (running_) {
-                Logger::log(Logger::LogLevel::WARN, "Accept failed");
+                LOG_WARN("Accept failed");
             }
             continue;
         }
 
+        // Pas de Nagle: un ACK de quelques octets suit l'en-tête sans
+        // attendre l'ACK TCP retardé du pair (fausserait la mesure du RTT)
+        int nodelay = 1;
+        setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&nodelay, sizeof(nodelay));
+
         // Create client info
         auto client = std::make_shared<ClientInfo>();
         client->socket = client_socket;
@@ -163,25 +550,27 @@ void StreamServer::acceptConnections() {
         client->address = inet_ntoa(client_addr.sin_addr);
         client->port = ntohs(client_addr.sin_port);
         client->active = true;
-        client->last_heartbeat = get_timestamp_us();
+        client->last_heartbeat = get_monotonic_us();
         
         // Default config
         client->config.fps = Config::DEFAULT_FPS;
         client->config.jpeg_quality = Config::DEFAULT_JPEG_QUALITY;
+        client->config.roi_min_quality = Config::DEFAULT_ROI_MIN_QUALITY;
         client->config.audio_sample_rate = Config::DEFAULT_AUDIO_SAMPLE_RATE;
         client->config.audio_channels = 1;
         client->config.enable_audio = 1;
         client->config.enable_video = 1;
+        client->config.pixel_format = static_cast<uint8_t>(PixelFormat::ARGB8888);
 
-        std::string msg = "New client connected: " + client->address + ":" + 
-                         std::to_string(client->port) + " (ID: " + 
-                         std::to_string(client->client_id) + ")";
-        Logger::log(Logger::LogLevel::INFO, msg);
+        LOG_INFO("New client connected: {}:{} (ID: {})", client->address, client->port, client->client_id);
+        Logger::trace(TraceEvent::CLIENT_CONNECTED, 0, client->client_id);
+        acquireClientMetrics(*client);
 
         // Add to client list
         {
             std::lock_guard<std::mutex> lock(clients_mutex_);
             clients_[client->client_id] = client;
+            Metrics::gauge("stream_clients").set(static_cast<int64_t>(clients_.size()));
         }
 
         // Start client handler thread
@@ -190,21 +579,24 @@ void StreamServer::acceptConnections() {
         );
     }
 
-    Logger::log(Logger::LogLevel::INFO, "Accept thread ended");
+    LOG_INFO("Accept thread ended");
 }
 
 void StreamServer::handleClient(std::shared_ptr<ClientInfo> client) {
-    std::string msg = "Handling client " + std::to_string(client->client_id);
-    Logger::log(Logger::LogLevel::INFO, msg);
+    LOG_INFO("Handling client {}", client->client_id);
 
     // Process handshake
     if (!processHandshake(client)) {
-        Logger::log(Logger::LogLevel::WARN, "Handshake failed");
+        LOG_WARN("Handshake failed");
         client->active = false;
         closesocket(client->socket);
         
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        clients_.erase(client->client_id);
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex_);
+            clients_.erase(client->client_id);
+            Metrics::gauge("stream_clients").set(static_cast<int64_t>(clients_.size()));
+        }
+        releaseClientMetrics(*client);
         return;
     }
 
@@ -224,6 +616,7 @@ void StreamServer::handleClient(std::shared_ptr<ClientInfo> client) {
         
         // Try to receive packet (non-blocking)
         int received = recv(client->socket, (char*)&header, sizeof(header), 0);
+        uint64_t receive_us = get_monotonic_us();
         
         if (received == sizeof(header)) {
             // Validate and receive full packet
@@ -237,7 +630,7 @@ void StreamServer::handleClient(std::shared_ptr<ClientInfo> client) {
                         if (n > 0) {
                             payload_received += n;
                         } else if (n == 0) {
-                            Logger::log(Logger::LogLevel::INFO, "Client disconnected");
+                            LOG_INFO("Client disconnected");
                             client->active = false;
                             break;
                         } else {
@@ -248,7 +641,7 @@ void StreamServer::handleClient(std::shared_ptr<ClientInfo> client) {
                             int err = errno;
                             if (err != EWOULDBLOCK && err != EAGAIN) {
 #endif
-                                Logger::log(Logger::LogLevel::INFO, "Client recv error: " + std::to_string(err));
+                                LOG_INFO("Client recv error: {}", err);
                                 client->active = false;
                                 break;
                             }
@@ -258,34 +651,42 @@ void StreamServer::handleClient(std::shared_ptr<ClientInfo> client) {
                 }
                 
                 // Update heartbeat
-                client->last_heartbeat = get_timestamp_us();
+                client->last_heartbeat = get_monotonic_us();
 
                 // Process packet type
                 switch ((PacketType)header.packet_type) {
                     case PacketType::HEARTBEAT:
-                        // Send ACK
-                        sendPacket(client->socket, PacketType::ACK, nullptr, 0);
+                        handleHeartbeat(*client, payload, receive_us);
+                        break;
+
+                    case PacketType::LATENCY_REPORT:
+                        handleLatencyReport(*client, payload);
+                        break;
+
+                    case PacketType::SUBSCRIBE:
+                        handleSubscribe(*client, payload);
                         break;
                         
                     case PacketType::CONFIG:
-                        if (payload.size() >= sizeof(StreamConfig)) {
-                            memcpy(&client->config, payload.data(), sizeof(StreamConfig));
-                            Logger::log(Logger::LogLevel::INFO, "Client config updated");
-                        }
+                        handleConfig(*client, payload);
+                        break;
+
+                    case PacketType::REFRESH:
+                        handleRefresh(*client);
                         break;
                         
                     case PacketType::DISCONNECT:
-                        Logger::log(Logger::LogLevel::INFO, "Client requested disconnect");
+                        LOG_INFO("Client requested disconnect");
                         client->active = false;
                         break;
                         
                     default:
-                        Logger::log(Logger::LogLevel::WARN, "Unknown packet type");
+                        LOG_WARN("Unknown packet type");
                         break;
                 }
             }
         } else if (received == 0) {
-            Logger::log(Logger::LogLevel::INFO, "Client disconnected");
+            LOG_INFO("Client disconnected");
             break;
         } else {
             // Check if it's just WOULDBLOCK (no data available)
@@ -296,7 +697,7 @@ void StreamServer::handleClient(std::shared_ptr<ClientInfo> client) {
             int err = errno;
             if (err != EWOULDBLOCK && err != EAGAIN) {
 #endif
-                Logger::log(Logger::LogLevel::INFO, "Client recv error: " + std::to_string(err));
+                LOG_INFO("Client recv error: {}", err);
                 break;
             }
         }
@@ -313,10 +714,12 @@ void StreamServer::handleClient(std::shared_ptr<ClientInfo> client) {
     {
         std::lock_guard<std::mutex> lock(clients_mutex_);
         clients_.erase(client->client_id);
+        Metrics::gauge("stream_clients").set(static_cast<int64_t>(clients_.size()));
     }
+    releaseClientMetrics(*client);
 
-    msg = "Client " + std::to_string(client->client_id) + " handler ended";
-    Logger::log(Logger::LogLevel::INFO, msg);
+    Logger::trace(TraceEvent::CLIENT_DISCONNECTED, 0, client->client_id);
+    LOG_INFO("Client {} handler ended", client->client_id);
 }
 
 bool StreamServer::processHandshake(std::shared_ptr<ClientInfo> client) {
@@ -329,12 +732,12 @@ bool StreamServer::processHandshake(std::shared_ptr<ClientInfo> client) {
     }
 
     if ((PacketType)header.packet_type != PacketType::HANDSHAKE) {
-        Logger::log(Logger::LogLevel::WARN, "Expected handshake packet");
+        LOG_WARN("Expected handshake packet");
         return false;
     }
 
     if (payload.size() < sizeof(HandshakeRequest)) {
-        Logger::log(Logger::LogLevel::WARN, "Invalid handshake size");
+        LOG_WARN("Invalid handshake size");
         return false;
     }
 
@@ -348,36 +751,282 @@ bool StreamServer::processHandshake(std::shared_ptr<ClientInfo> client) {
     client->config.jpeg_quality = 80;
     client->config.audio_sample_rate = 44100;
     client->config.audio_channels = 1;
+    client->wants_updates = (request.capabilities & CAPABILITY_FRAME_UPDATE) != 0;
+    client->wants_lossy = client->wants_updates && (request.capabilities & CAPABILITY_LOSSY_TILES) != 0;
+    client->wants_repeat = (request.capabilities & CAPABILITY_FRAME_REPEAT) != 0;
+
+    // Cache de tuiles: au plus kMaxServerBlocks, seulement avec FRAME_UPDATE
+    uint8_t tile_blocks = 0;
+    if ((request.capabilities & CAPABILITY_TILE_CACHE) && client->wants_updates) {
+        tile_blocks = std::min(request.tile_cache_blocks, TileCache::kMaxServerBlocks);
+    }
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        client->tile_cache.reset(tile_blocks * TileCache::kBlockTiles);
+    }
 
     // Send handshake response
     HandshakeResponse response;
     response.accepted = 1;
+    response.tile_cache_blocks = tile_blocks;
     response.assigned_id = client->client_id;
     snprintf(response.server_info, sizeof(response.server_info), 
              "StreamServer v%d", PROTOCOL_VERSION);
 
-    sendPacket(client->socket, PacketType::HANDSHAKE, &response, sizeof(response));
+    sendToClient(*client, PacketType::HANDSHAKE, &response, sizeof(response));
+    sendStreamList(*client);
+    if (request.capabilities & CAPABILITY_CURSOR) {
+        sendCursorState(*client);
+    }
 
-    Logger::log(Logger::LogLevel::INFO, "Handshake completed - Video:" + 
-        std::to_string(client->config.enable_video) + " Audio:" + 
-        std::to_string(client->config.enable_audio));
+    LOG_INFO("Handshake completed - Video:{} Audio:{} Tile cache:{} Lossy tiles:{}",
+        (int)client->config.enable_video, (int)client->config.enable_audio,
+        tile_blocks * TileCache::kBlockTiles, (int)client->wants_lossy.load());
     return true;
 }
 
-void StreamServer::sendPacket(SOCKET sock, PacketType type, const void* data, size_t size) {
+void StreamServer::handleHeartbeat(ClientInfo& client, const std::vector<uint8_t>& payload, uint64_t receive_us) {
+    // Ancien client sans horodatage: ACK vide
+    if (payload.size() < sizeof(ClockSyncRequest)) {
+        sendToClient(client, PacketType::ACK, nullptr, 0);
+        return;
+    }
+
+    ClockSyncRequest request;
+    memcpy(&request, payload.data(), sizeof(request));
+
+    ClockSyncResponse response;
+    response.client_send_us = request.client_send_us;
+    response.server_receive_us = receive_us;
+
+    // t2 au plus près de l'envoi, donc une fois le socket à nous
+    std::lock_guard<std::mutex> lock(client.send_mutex);
+    response.server_send_us = get_monotonic_us();
+    sendPacket(client.socket, PacketType::ACK, &response, sizeof(response));
+}
+
+void StreamServer::handleLatencyReport(ClientInfo& client, const std::vector<uint8_t>& payload) {
+    if (payload.size() < sizeof(LatencyReport)) {
+        LOG_WARN("Invalid latency report size");
+        return;
+    }
+
+    LatencyReport report;
+    memcpy(&report, payload.data(), sizeof(report));
+    if (report.sample_count == 0) {
+        return;
+    }
+
+    std::string labels = clientLabels(client.client_id);
+    Metrics::gauge("client_glass_latency_p50_us", labels).set(report.p50_us);
+    Metrics::gauge("client_glass_latency_p90_us", labels).set(report.p90_us);
+    Metrics::gauge("client_glass_latency_p99_us", labels).set(report.p99_us);
+    Metrics::gauge("client_glass_latency_max_us", labels).set(report.max_us);
+    Metrics::gauge("client_clock_offset_us", labels).set(report.clock_offset_us);
+    LOG_DEBUG("Client {} glass-to-glass latency p50={}us p99={}us ({} frames, rtt {}us)",
+        client.client_id, report.p50_us, report.p99_us, report.sample_count, report.rtt_us);
+}
+
+void StreamServer::handleSubscribe(ClientInfo& client, const std::vector<uint8_t>& payload) {
+    if (payload.size() < sizeof(SubscribeRequest)) {
+        LOG_WARN("Invalid subscribe size");
+        return;
+    }
+
+    SubscribeRequest request;
+    memcpy(&request, payload.data(), sizeof(request));
+    client.stream_mask = request.stream_mask;
+    LOG_INFO("Client {} subscribed to stream mask {}", client.client_id, request.stream_mask);
+}
+
+void StreamServer::handleConfig(ClientInfo& client, const std::vector<uint8_t>& payload) {
+    if (payload.size() < sizeof(StreamConfig)) {
+        LOG_WARN("Invalid config size");
+        return;
+    }
+
+    memcpy(&client.config, payload.data(), sizeof(StreamConfig));
+    if (client.config.pixel_format >= PixelPacker::kFormatCount) {
+        LOG_WARN("Client {} asked for unknown pixel format {}, using argb", client.client_id,
+                 (int)client.config.pixel_format);
+        client.config.pixel_format = static_cast<uint8_t>(PixelFormat::ARGB8888);
+    }
+    client.pixel_format = client.config.pixel_format;
+    client.roi_min_quality = client.config.roi_min_quality;
+    LOG_INFO("Client {} config updated (pixels {}, min quality outside ROI {})", client.client_id,
+             PixelPacker::name(static_cast<PixelFormat>(client.config.pixel_format)),
+             (int)client.config.roi_min_quality);
+}
+
+void StreamServer::handleRefresh(ClientInfo& client) {
+    // Le client a perdu sa frame de base: frames complètes pour tous ses flux
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    client.delivered_mask = 0;
+    LOG_INFO("Client {} requested a full frame", client.client_id);
+}
+
+void StreamServer::setVideoStreams(const std::vector<StreamInfo>& streams) {
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        video_streams_ = streams;
+        if (video_streams_.size() > MAX_VIDEO_STREAMS) {
+            video_streams_.resize(MAX_VIDEO_STREAMS);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    for (auto& pair : clients_) {
+        if (pair.second->active) {
+            sendStreamList(*pair.second);
+        }
+    }
+}
+
+std::vector<StreamInfo> StreamServer::getVideoStreams() const {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    return video_streams_;
+}
+
+bool StreamServer::sendStreamList(ClientInfo& client) {
+    std::vector<StreamInfo> streams = getVideoStreams();
+    if (streams.empty()) {
+        return true;  // flux unique implicite: rien à annoncer
+    }
+
+    std::vector<uint8_t> packet(1 + streams.size() * sizeof(StreamInfo));
+    packet[0] = static_cast<uint8_t>(streams.size());
+    memcpy(packet.data() + 1, streams.data(), streams.size() * sizeof(StreamInfo));
+    return sendToClient(client, PacketType::STREAM_LIST, packet.data(), packet.size());
+}
+
+void StreamServer::setCursorShape(std::shared_ptr<const CursorImage> shape) {
+    if (!shape || shape->pixels.size() != static_cast<size_t>(shape->width) * shape->height * 4) {
+        LOG_WARN("Invalid cursor shape");
+        return;
+    }
+
+    std::lock_guard<std::mutex> cursor_lock(cursor_mutex_);
+    if (cursor_shapes_.contains(shape->serial)) {
+        return;  // déjà connue des clients
+    }
+    cursor_shapes_.insert(shape);
+
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    for (auto& pair : clients_) {
+        if (pair.second->active && pair.second->wants_cursor) {
+            sendCursorShape(*pair.second, *shape);
+        }
+    }
+}
+
+void StreamServer::broadcastCursor(const CursorPosition& position) {
+    if (!running_) return;
+
+    std::lock_guard<std::mutex> cursor_lock(cursor_mutex_);
+    // Même suite d'utilisations que le cache des clients
+    cursor_shapes_.find(position.shape_serial);
+    last_cursor_ = position;
+    has_cursor_ = true;
+
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    for (auto& pair : clients_) {
+        if (pair.second->active && pair.second->wants_cursor) {
+            if (sendToClient(*pair.second, PacketType::CURSOR, &position, sizeof(position))) {
+                pair.second->bytes_sent->inc(sizeof(PacketHeader) + sizeof(position));
+            }
+        }
+    }
+}
+
+void StreamServer::setFocusWindow(int x, int y, int width, int height) {
+    std::lock_guard<std::mutex> lock(cursor_mutex_);
+    focus_window_ = RoiMap::Rect{x, y, width, height};
+}
+
+RoiMap StreamServer::regionOfInterest(uint8_t stream_id) {
+    // Moniteur d'un flux SCREEN_SHARE_MONITORS=each: son origine dans l'écran X
+    int origin_x = 0;
+    int origin_y = 0;
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        for (const StreamInfo& stream : video_streams_) {
+            if (stream.stream_id == stream_id) {
+                origin_x = stream.x;
+                origin_y = stream.y;
+                break;
+            }
+        }
+    }
+
+    RoiMap roi;
+    std::lock_guard<std::mutex> lock(cursor_mutex_);
+    if (has_cursor_ && last_cursor_.visible) {
+        roi.addCursor(last_cursor_.x - origin_x, last_cursor_.y - origin_y);
+    }
+    roi.add(focus_window_.x - origin_x, focus_window_.y - origin_y, focus_window_.width, focus_window_.height);
+    return roi;
+}
+
+bool StreamServer::sendCursorShape(ClientInfo& client, const CursorImage& shape) {
+    CursorShapeHeader header;
+    header.serial = shape.serial;
+    header.width = shape.width;
+    header.height = shape.height;
+    header.xhot = shape.xhot;
+    header.yhot = shape.yhot;
+
+    std::vector<uint8_t> packet(sizeof(header) + shape.pixels.size());
+    memcpy(packet.data(), &header, sizeof(header));
+    memcpy(packet.data() + sizeof(header), shape.pixels.data(), shape.pixels.size());
+    bool sent = sendToClient(client, PacketType::CURSOR_SHAPE, packet.data(), packet.size());
+    if (sent) {
+        client.bytes_sent->inc(sizeof(PacketHeader) + packet.size());
+    }
+    return sent;
+}
+
+void StreamServer::sendCursorState(ClientInfo& client) {
+    // Sous cursor_mutex_: aucune forme ne peut être diffusée entre l'envoi
+    // du cache et l'inscription du client
+    std::lock_guard<std::mutex> cursor_lock(cursor_mutex_);
+    for (const auto& shape : cursor_shapes_.entries()) {
+        sendCursorShape(client, *shape);
+    }
+    if (has_cursor_) {
+        sendToClient(client, PacketType::CURSOR, &last_cursor_, sizeof(last_cursor_));
+    }
+    client.wants_cursor = true;
+}
+
+bool StreamServer::sendToClient(ClientInfo& client, PacketType type, const void* data, size_t size, uint16_t flags) {
+    std::lock_guard<std::mutex> lock(client.send_mutex);
+    return sendPacket(client.socket, type, data, size, flags);
+}
+
+bool StreamServer::sendPacket(SOCKET sock, PacketType type, const void* data, size_t size, uint16_t flags) {
+    PROBE3(send__start, sock, static_cast<int>(type), size);
+    bool ok = writePacket(sock, type, data, size, flags);
+    PROBE3(send__end, sock, static_cast<int>(type), ok ? 1 : 0);
+    return ok;
+}
+
+bool StreamServer::writePacket(SOCKET sock, PacketType type, const void* data, size_t size, uint16_t flags) {
     PacketHeader header;
     header.magic = MAGIC_NUMBER;
     header.version = PROTOCOL_VERSION;
     header.packet_type = (uint8_t)type;
-    header.flags = 0;
+    header.flags = flags;
     header.payload_size = (uint32_t)size;
     header.sequence_number = sequence_number_++;
-    header.timestamp = get_timestamp_us();
+    header.timestamp = get_monotonic_us();
+
+    // Temps passé à attendre le socket (EWOULDBLOCK) pour la frame en cours
+    FrameSpan span("socket_write");
 
     // Send header (retry on WOULDBLOCK)
     size_t total_sent = 0;
     while (total_sent < sizeof(header)) {
-        int sent = send(sock, (const char*)&header + total_sent, sizeof(header) - total_sent, 0);
+        int sent = send(sock, (const char*)&header + total_sent, sizeof(header) - total_sent, SEND_FLAGS);
         if (sent > 0) {
             total_sent += sent;
         } else if (sent == SOCKET_ERROR) {
@@ -391,10 +1040,10 @@ void StreamServer::sendPacket(SOCKET sock, PacketType type, const void* data, si
                 std::this_thread::sleep_for(std::chrono::milliseconds(1));
                 continue;
             } else {
-                return; // Connection error
+                return false; // Connection error
             }
         } else {
-            return; // Connection closed
+            return false; // Connection closed
         }
     }
 
@@ -402,7 +1051,7 @@ void StreamServer::sendPacket(SOCKET sock, PacketType type, const void* data, si
     if (size > 0 && data) {
         total_sent = 0;
         while (total_sent < size) {
-            int sent = send(sock, (const char*)data + total_sent, size - total_sent, 0);
+            int sent = send(sock, (const char*)data + total_sent, size - total_sent, SEND_FLAGS);
             if (sent > 0) {
                 total_sent += sent;
             } else if (sent == SOCKET_ERROR) {
@@ -416,13 +1065,14 @@ void StreamServer::sendPacket(SOCKET sock, PacketType type, const void* data, si
                     std::this_thread::sleep_for(std::chrono::milliseconds(1));
                     continue;
                 } else {
-                    return; // Connection error
+                    return false; // Connection error
                 }
             } else {
-                return; // Connection closed
+                return false; // Connection closed
             }
         }
     }
+    return true;
 }
 
 bool StreamServer::receivePacket(SOCKET sock, PacketHeader& header, std::vector<uint8_t>& payload) {
@@ -434,14 +1084,14 @@ bool StreamServer::receivePacket(SOCKET sock, PacketHeader& header, std::vector<
 
     // Validate header
     if (header.magic != MAGIC_NUMBER) {
-        Logger::log(Logger::LogLevel::WARN, "Invalid magic number");
+        LOG_WARN("Invalid magic number");
         return false;
     }
 
     // Receive payload
     if (header.payload_size > 0) {
         if (header.payload_size > Config::MAX_PACKET_SIZE) {
-            Logger::log(Logger::LogLevel::WARN, "Payload too large");
+            LOG_WARN("Payload too large");
             return false;
         }
 
@@ -460,46 +1110,353 @@ bool StreamServer::receivePacket(SOCKET sock, PacketHeader& header, std::vector<
 void StreamServer::broadcastVideoFrame(const VideoFrame& frame) {
     if (!running_) return;
 
+    static Histogram& serialize_time = Metrics::histogram("frame_serialize_us");
+    static Histogram& delta_time = Metrics::histogram("frame_delta_us");
+    static Counter& updates_sent = Metrics::counter("frame_updates_total");
+    static Counter& scrolls = Metrics::counter("frame_update_scrolls_total");
+    static Counter& tile_hits = Metrics::counter("tile_cache_hits_total");
+    static Counter& tile_misses = Metrics::counter("tile_cache_misses_total");
+    static Histogram& classify_time = Metrics::histogram("tile_classify_us");
+    static Counter& lossy_tiles_sent = Metrics::counter("lossy_tiles_total");
+    static Counter& roi_boosted = Metrics::counter("roi_boosted_tiles_total");
+    static Counter& roi_lowered = Metrics::counter("roi_lowered_tiles_total");
+    static Counter& lossy_refined = Metrics::counter("lossy_tiles_refined_total");
+
+    // Avant clients_mutex_ (ordre des verrous de broadcastCursor)
+    RoiMap roi = regionOfInterest(frame.stream_id);
+
     std::lock_guard<std::mutex> lock(clients_mutex_);
     
     static uint32_t log_counter = 0;
     if (++log_counter % 30 == 0) {
-        std::string msg = "Broadcasting frame " + std::to_string(frame.frame_number) +
-                         " to " + std::to_string(clients_.size()) + " client(s)";
-        Logger::log(Logger::LogLevel::INFO, msg);
+        LOG_DEBUG("Broadcasting frame {} to {} client(s)", frame.frame_number, clients_.size());
     }
+    Logger::trace(TraceEvent::BROADCAST_BEGIN, frame.frame_number, 0, clients_.size());
     
+    // Un paquet par format demandé, sérialisé une fois pour tous les clients.
+    // Seules les frames brutes (ARGB8888 complet) sont repaquetées.
+    std::vector<uint8_t> packets[PixelPacker::kFormatCount];
+    bool raw = frame.data.size() == PixelPacker::packedSize(PixelFormat::ARGB8888, frame.width, frame.height);
+    uint32_t stream_bit = frame.stream_id < 32 ? (1u << frame.stream_id) : 0;
+
+    // FRAME_UPDATE par rapport à la frame précédente du flux, calculé au
+    // premier client qui l'a reçue puis sérialisé une fois par format (par
+    // client s'il a un cache de tuiles: le paquet dépend de son miroir)
+    DeltaReference* reference = stream_bit ? &delta_refs_[frame.stream_id] : nullptr;
+    bool has_delta = reference && raw && reference->valid &&
+                     reference->width == frame.width && reference->height == frame.height;
+    bool delta_computed = false;
+    std::vector<UpdateCommand> commands;
+    // Partagées par format et par niveau de perte (LossLevel)
+    std::vector<uint8_t> updates[PixelPacker::kFormatCount][3];
+    UpdateStats update_stats[PixelPacker::kFormatCount][3];
+    std::vector<uint64_t> tile_hashes;
+    // Tuiles candidates envoyées en LOSSY_RECT, calculées au premier client
+    // qui accepte LOSSY_RECT dans un format plus fin que RGB565: image
+    // naturelle ou mouvement hors zone d'intérêt (CONTENT), plus le texte hors
+    // zone d'intérêt pour les clients dont le plancher le permet (LOWERED)
+    enum LossLevel { EXACT = 0, CONTENT = 1, LOWERED = 2 };
+    bool classified = false;
+    std::vector<uint8_t> lossy_tiles[3];
+    // Tuiles de la grille parmi les candidates de la frame (1), calculé au
+    // premier client qui affiche des tuiles RGB565 à renvoyer exactes
+    const TileGrid grid(frame.width, frame.height);
+    std::vector<uint8_t> updated_tiles;
+    bool keep_reference = false;
+
     for (auto& pair : clients_) {
-        if (pair.second->active && pair.second->config.enable_video) {
-            // Create serialized packet: header + pixel data
-            struct VideoFrameHeader {
-                uint32_t frame_number;
-                uint16_t width;
-                uint16_t height;
-                uint8_t quality;
-                uint8_t padding;
-                uint64_t timestamp;
-            };
-            
-            VideoFrameHeader header;
-            header.frame_number = frame.frame_number;
-            header.width = frame.width;
-            header.height = frame.height;
-            header.quality = frame.quality;
-            header.padding = 0;
-            header.timestamp = frame.timestamp;
-            
-            // Combine header + data
-            std::vector<uint8_t> packet;
-            packet.resize(sizeof(VideoFrameHeader) + frame.data.size());
-            memcpy(packet.data(), &header, sizeof(VideoFrameHeader));
-            memcpy(packet.data() + sizeof(VideoFrameHeader), frame.data.data(), frame.data.size());
+        ClientInfo& client = *pair.second;
+        if (client.active && client.config.enable_video && (client.stream_mask.load() & stream_bit)) {
+            PixelFormat format = raw ? static_cast<PixelFormat>(client.pixel_format.load())
+                                     : PixelFormat::ARGB8888;
+            int format_index = static_cast<int>(format);
+            size_t full_size = sizeof(VideoFrameHeader) +
+                (raw ? PixelPacker::packedSize(format, frame.width, frame.height) : frame.data.size());
+            keep_reference = keep_reference || client.wants_updates;
+
+            bool cached = client.tile_cache.capacity() > 0;
+            bool lossy = client.wants_lossy && format != PixelFormat::RGB565;
+            int loss_level = !lossy ? EXACT
+                : client.roi_min_quality <= Config::LOSSY_TILE_QUALITY ? LOWERED : CONTENT;
+            std::vector<uint8_t> client_update;
+            // Commandes de la frame suivies des tuiles RGB565 renvoyées exactes
+            std::vector<UpdateCommand> client_commands;
+            std::vector<uint8_t> client_levels;
+            UpdateStats client_stats;
+            const UpdateStats* delivered = nullptr;
+            bool own_update = cached;
+            std::vector<uint8_t>& held = client.lossy_tiles[frame.stream_id];
+            bool update = has_delta && client.wants_updates && (client.delivered_mask & stream_bit) &&
+                          client.delivered_frame[frame.stream_id] == reference->frame_number &&
+                          client.delivered_format[frame.stream_id] == format_index;
+            if (update) {
+                if (!delta_computed) {
+                    auto delta_start = std::chrono::steady_clock::now();
+                    commands = FrameDelta::compute(reference->pixels.data(), frame.data.data(),
+                                                   frame.width, frame.height, TileCache::kTileSize);
+                    delta_time.record(elapsedMicros(delta_start));
+                    if (!commands.empty() &&
+                        commands.front().type == static_cast<uint8_t>(UpdateCommandType::COPY_RECT)) {
+                        scrolls.inc();
+                    }
+                    delta_computed = true;
+                }
+                if (lossy && !classified) {
+                    auto classify_start = std::chrono::steady_clock::now();
+                    reference->classifier.update(frame.data.data(), frame.width, frame.height, commands);
+                    lossy_tiles[CONTENT].assign(commands.size(), 0);
+                    lossy_tiles[LOWERED].assign(commands.size(), 0);
+                    for (size_t i = 0; i < commands.size(); ++i) {
+                        const UpdateCommand& command = commands[i];
+                        if (!isTile(command)) {
+                            continue;
+                        }
+                        bool natural = reference->classifier.lossy(command.x, command.y);
+                        if (roi.intersects(command.x, command.y, command.width, command.height)) {
+                            if (natural) {
+                                roi_boosted.inc();
+                            }
+                            continue;
+                        }
+                        lossy_tiles[CONTENT][i] = natural ? kLossyTile : kExactTile;
+                        lossy_tiles[LOWERED][i] = natural ? kLossyTile : !roi.empty() ? kLoweredTile : kExactTile;
+                    }
+                    classify_time.record(elapsedMicros(classify_start));
+                    classified = true;
+                }
+                const std::vector<uint8_t>& client_lossy = lossy_tiles[loss_level];
+                // Les tuiles RGB565 du client suivent le COPY_RECT; celles
+                // entrées dans la zone d'intérêt, le texte que son plancher
+                // n'accepte plus et les images devenues immobiles sont
+                // renvoyés exacts à la suite
+                std::vector<UpdateCommand> refined;
+                if (lossy && held.size() == grid.size()) {
+                    for (const UpdateCommand& command : commands) {
+                        if (command.type == static_cast<uint8_t>(UpdateCommandType::COPY_RECT)) {
+                            copyLossLevels(held, grid, command);
+                        }
+                    }
+                    if (updated_tiles.empty()) {
+                        updated_tiles.assign(grid.size(), 0);
+                        for (const UpdateCommand& command : commands) {
+                            if (isTile(command)) {
+                                updated_tiles[grid.index(command.x, command.y)] = 1;
+                            }
+                        }
+                    }
+                    refined = refinements(held, updated_tiles, grid, reference->classifier, roi,
+                                          loss_level == LOWERED && !roi.empty());
+                }
+                if (!refined.empty()) {
+                    client_commands = commands;
+                    client_commands.insert(client_commands.end(), refined.begin(), refined.end());
+                    client_levels = client_lossy;
+                    client_levels.resize(client_commands.size(), kExactTile);
+                    own_update = true;
+                }
+                const std::vector<UpdateCommand>& update_commands = refined.empty() ? commands : client_commands;
+                const std::vector<uint8_t>& update_lossy = refined.empty() ? client_lossy : client_levels;
+                if (cached) {
+                    if (tile_hashes.empty()) {
+                        tile_hashes.resize(commands.size(), 0);
+                        for (size_t i = 0; i < commands.size(); ++i) {
+                            if (isTile(commands[i])) {
+                                tile_hashes[i] = tileHash(frame, commands[i]);
+                            }
+                        }
+                    }
+                    std::vector<uint64_t> refined_hashes;
+                    if (!refined.empty()) {
+                        refined_hashes = tile_hashes;
+                        for (const UpdateCommand& command : refined) {
+                            refined_hashes.push_back(isTile(command) ? tileHash(frame, command) : 0);
+                        }
+                    }
+                    const std::vector<uint64_t>& hashes = refined.empty() ? tile_hashes : refined_hashes;
+                    // Un peu plus qu'une frame complète reste rentable: les
+                    // tuiles envoyées remplissent le cache du client
+                    size_t estimate = frameUpdateSize(update_commands, hashes, update_lossy, format,
+                                                      &client.tile_cache);
+                    update = estimate <= full_size + full_size / 32;
+                    if (update) {
+                        client_update = serializeFrameUpdate(frame, reference->frame_number, update_commands, hashes,
+                                                             update_lossy, format, &client.tile_cache, client_stats);
+                        tile_hits.inc(client_stats.hits);
+                        tile_misses.inc(client_stats.misses);
+                        delivered = &client_stats;
+                    }
+                } else if (own_update) {
+                    client_update = serializeFrameUpdate(frame, reference->frame_number, update_commands, tile_hashes,
+                                                         update_lossy, format, nullptr, client_stats);
+                    update = client_update.size() < full_size;
+                    delivered = &client_stats;
+                } else {
+                    std::vector<uint8_t>& shared = updates[format_index][loss_level];
+                    UpdateStats& stats = update_stats[format_index][loss_level];
+                    if (shared.empty()) {
+                        shared = serializeFrameUpdate(frame, reference->frame_number, commands, tile_hashes,
+                                                      client_lossy, format, nullptr, stats);
+                    }
+                    // Tout a changé (vidéo): la frame complète est aussi petite
+                    update = shared.size() < full_size;
+                    delivered = &stats;
+                }
+                if (update) {
+                    lossy_tiles_sent.inc(delivered->lossy);
+                    roi_lowered.inc(delivered->lowered);
+                    lossy_refined.inc(refined.size());
+                } else {
+                    delivered = nullptr;
+                }
+            }
+            if (!update) {
+                // Une VIDEO_FRAME vide le cache de tuiles des deux côtés
+                client.tile_cache.clear();
+            }
+
+            std::vector<uint8_t>& packet = update ? (own_update ? client_update : updates[format_index][loss_level])
+                                                  : packets[format_index];
+            if (packet.empty()) {
+                // Create serialized packet: header + pixel data
+                auto serialize_start = std::chrono::steady_clock::now();
+                FrameSpan serialize_span("serialize", frame.frame_number, client.client_id);
+                VideoFrameHeader header;
+                header.frame_number = frame.frame_number;
+                header.width = frame.width;
+                header.height = frame.height;
+                header.quality = frame.quality;
+                header.stream_id = frame.stream_id;
+                header.timestamp = frame.timestamp;
+
+                packet.resize(full_size);
+                memcpy(packet.data(), &header, sizeof(VideoFrameHeader));
+                if (raw) {
+                    PixelPacker::pack(format, frame.data.data(), static_cast<size_t>(frame.width) * frame.height,
+                                      packet.data() + sizeof(VideoFrameHeader));
+                } else {
+                    memcpy(packet.data() + sizeof(VideoFrameHeader), frame.data.data(), frame.data.size());
+                }
+                serialize_time.record(elapsedMicros(serialize_start));
+                serialize_span.end();
+            }
             
             // Send combined packet
-            sendPacket(pair.second->socket, PacketType::VIDEO_FRAME, 
-                      packet.data(), packet.size());
+            PacketType type = update ? PacketType::FRAME_UPDATE : PacketType::VIDEO_FRAME;
+            Logger::trace(TraceEvent::SEND_BEGIN, frame.frame_number, client.client_id,
+                          packet.size(), static_cast<uint64_t>(type));
+            auto send_start = std::chrono::steady_clock::now();
+            FrameSpan send_span("send", frame.frame_number, client.client_id);
+            bool sent = sendToClient(client, type, packet.data(), packet.size(), static_cast<uint16_t>(format));
+            send_span.end();
+            client.send_time_us->record(elapsedMicros(send_start));
+            Logger::trace(TraceEvent::SEND_END, frame.frame_number, client.client_id,
+                          packet.size(), sent ? 1 : 0);
+            if (sent) {
+                client.bytes_sent->inc(sizeof(PacketHeader) + packet.size());
+                if (update) {
+                    updates_sent.inc();
+                }
+            } else {
+                client.frames_dropped->inc();
+            }
+
+            // Niveau reçu pour chaque tuile: celles envoyées dans la mise à
+            // jour, les autres gardent le leur; une VIDEO_FRAME est exacte
+            if (sent && delivered && lossy) {
+                const std::vector<UpdateCommand>& sent_commands = client_commands.empty() ? commands : client_commands;
+                if (held.size() != grid.size()) {
+                    held.assign(grid.size(), kExactTile);
+                }
+                for (size_t i = 0; i < sent_commands.size(); ++i) {
+                    if (i >= commands.size() || isTile(sent_commands[i])) {
+                        held[grid.index(sent_commands[i].x, sent_commands[i].y)] = delivered->levels[i];
+                    }
+                }
+                if (std::all_of(held.begin(), held.end(), [](uint8_t level) { return level == kExactTile; })) {
+                    held.clear();
+                }
+            } else {
+                held.clear();
+            }
+
+            // Une frame non brute ne peut pas servir de base à une mise à jour
+            if (sent && raw) {
+                client.delivered_mask |= stream_bit;
+                client.delivered_frame[frame.stream_id] = frame.frame_number;
+                client.delivered_format[frame.stream_id] = static_cast<uint8_t>(format_index);
+            } else {
+                client.delivered_mask &= ~stream_bit;
+            }
+        }
+    }
+
+    // Base de la prochaine mise à jour, seulement si un client peut l'utiliser
+    if (reference) {
+        reference->broadcast_frame = frame.frame_number;
+        if (raw && keep_reference) {
+            reference->pixels = frame.data;
+            reference->frame_number = frame.frame_number;
+            reference->width = frame.width;
+            reference->height = frame.height;
+            reference->valid = true;
+        } else if (reference->valid) {
+            reference->valid = false;
+            std::vector<uint8_t>().swap(reference->pixels);
+        }
+    }
+    Logger::trace(TraceEvent::BROADCAST_END, frame.frame_number);
+}
+
+bool StreamServer::repeatVideoFrame(const VideoFrame& frame) {
+    if (!running_) return false;
+    if (frame.stream_id >= MAX_VIDEO_STREAMS) return false;
+
+    static Counter& repeats_sent = Metrics::counter("frame_repeats_total");
+
+    // Avant clients_mutex_ (ordre des verrous de broadcastCursor)
+    RoiMap roi = regionOfInterest(frame.stream_id);
+
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    const uint32_t stream_bit = 1u << frame.stream_id;
+    const DeltaReference& reference = delta_refs_[frame.stream_id];
+    const TileGrid grid(frame.width, frame.height);
+
+    // Tous les abonnés doivent déjà afficher la dernière frame diffusée, sans
+    // tuile RGB565 à renvoyer exacte (la diffusion fait avancer l'historique)
+    for (const auto& pair : clients_) {
+        const ClientInfo& client = *pair.second;
+        bool lowering = client.roi_min_quality <= Config::LOSSY_TILE_QUALITY && !roi.empty();
+        if (client.active && client.config.enable_video && (client.stream_mask.load() & stream_bit) &&
+            (!(client.delivered_mask & stream_bit) ||
+             client.delivered_frame[frame.stream_id] != reference.broadcast_frame ||
+             client.delivered_format[frame.stream_id] != client.pixel_format.load() ||
+             refinementPending(client.lossy_tiles[frame.stream_id], grid, roi, lowering))) {
+            return false;
+        }
+    }
+
+    FrameRepeat repeat;
+    repeat.frame_number = frame.frame_number;
+    repeat.base_frame_number = reference.broadcast_frame;
+    repeat.timestamp = frame.timestamp;
+    repeat.quality = frame.quality;
+    repeat.stream_id = frame.stream_id;
+    for (auto& pair : clients_) {
+        ClientInfo& client = *pair.second;
+        if (!client.active || !client.config.enable_video || !(client.stream_mask.load() & stream_bit) ||
+            !client.wants_repeat) {
+            continue;
+        }
+        if (sendToClient(client, PacketType::FRAME_REPEAT, &repeat, sizeof(repeat))) {
+            client.bytes_sent->inc(sizeof(PacketHeader) + sizeof(repeat));
+            repeats_sent.inc();
+        } else {
+            // Paquet perdu: la prochaine frame lui arrivera complète
+            client.frames_dropped->inc();
+            client.delivered_mask &= ~stream_bit;
         }
     }
+    return true;
 }
 
 void StreamServer::broadcastAudioFrame(const AudioFrame& frame) {
@@ -507,40 +1464,51 @@ void StreamServer::broadcastAudioFrame(const AudioFrame& frame) {
 
     std::lock_guard<std::mutex> lock(clients_mutex_);
     
+    Logger::trace(TraceEvent::AUDIO_BROADCAST, 0, 0, frame.samples.size());
     for (auto& pair : clients_) {
         if (pair.second->active && pair.second->config.enable_audio) {
             // Send frame data
-            sendPacket(pair.second->socket, PacketType::AUDIO_FRAME,
-                      frame.samples.data(), 
-                      frame.samples.size() * sizeof(float));
+            size_t size = frame.samples.size() * sizeof(float);
+            if (sendToClient(*pair.second, PacketType::AUDIO_FRAME, frame.samples.data(), size)) {
+                pair.second->bytes_sent->inc(sizeof(PacketHeader) + size);
+            }
         }
     }
 }
 
 void StreamServer::heartbeatMonitor() {
-    Logger::log(Logger::LogLevel::INFO, "Heartbeat monitor started");
+    LOG_INFO("Heartbeat monitor started");
 
     while (running_) {
         std::this_thread::sleep_for(std::chrono::seconds(5));
 
-        uint64_t now = get_timestamp_us();
-        uint64_t timeout = 30 * 1000000; // 30 seconds
-
+        // Une diffusion vers un client lent peut garder le verrou longtemps:
+        // lire l'heure après l'avoir obtenu
         std::lock_guard<std::mutex> lock(clients_mutex_);
+        uint64_t now = get_monotonic_us();
         
         for (auto& pair : clients_) {
             if (pair.second->active) {
-                if (now - pair.second->last_heartbeat > timeout) {
-                    std::string msg = "Client " + std::to_string(pair.second->client_id) + 
-                                     " timeout - disconnecting";
-                    Logger::log(Logger::LogLevel::WARN, msg);
+                if (heartbeatExpired(now, pair.second->last_heartbeat.load())) {
+                    LOG_WARN("Client {} timeout - disconnecting", pair.second->client_id);
                     pair.second->active = false;
                 }
             }
         }
     }
 
-    Logger::log(Logger::LogLevel::INFO, "Heartbeat monitor ended");
+    LOG_INFO("Heartbeat monitor ended");
+}
+
+void StreamServer::collectClientMetrics() {
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    for (auto& pair : clients_) {
+        ClientInfo& client = *pair.second;
+        if (client.socket != INVALID_SOCKET && client.rtt_us) {
+            client.send_queue_bytes->set(socketSendQueue(client.socket));
+            client.rtt_us->set(socketRtt(client.socket));
+        }
+    }
 }
 
 size_t StreamServer::getClientCount() const {
@@ -548,6 +1516,19 @@ size_t StreamServer::getClientCount() const {
     return clients_.size();
 }
 
+size_t StreamServer::getSubscriberCount(uint8_t stream_id) const {
+    uint32_t stream_bit = stream_id < 32 ? (1u << stream_id) : 0;
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    size_t count = 0;
+    for (const auto& pair : clients_) {
+        if (pair.second->active && pair.second->config.enable_video &&
+            (pair.second->stream_mask.load() & stream_bit)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
 void StreamServer::disconnectClient(uint16_t client_id) {
     std::lock_guard<std::mutex> lock(clients_mutex_);
     
@@ -555,7 +1536,7 @@ void StreamServer::disconnectClient(uint16_t client_id) {
     if (it != clients_.end()) {
         it->second->active = false;
         if (it->second->socket != INVALID_SOCKET) {
-            sendPacket(it->second->socket, PacketType::DISCONNECT, nullptr, 0);
+            sendToClient(*it->second, PacketType::DISCONNECT, nullptr, 0);
             closesocket(it->second->socket);
         }
     }
@@ -9,9 +9,16 @@
 #include <map>
 #include <mutex>
 #include "common.h"
+#include "CursorShapeCache.h"
+#include "TileCache.h"
+#include "TileClassifier.h"
+#include "RoiMap.h"
 
 // Forward declaration to avoid including TLSConnection.h when TLS is disabled
 class TLSConnection;
+class Counter;
+class Gauge;
+class Histogram;
 
 struct ClientInfo {
     SOCKET socket;
@@ -19,8 +26,39 @@ struct ClientInfo {
     std::string address;
     uint16_t port;
     std::atomic<bool> active;
-    uint64_t last_heartbeat;
+    std::atomic<uint64_t> last_heartbeat;     // get_monotonic_us()
     StreamConfig config;
+    std::atomic<uint32_t> stream_mask{1};      // flux vidéo abonnés (SUBSCRIBE)
+    std::atomic<bool> wants_cursor{false};     // CAPABILITY_CURSOR, formes déjà reçues
+    std::atomic<uint8_t> pixel_format{0};      // config.pixel_format, lu par la diffusion
+    std::atomic<bool> wants_updates{false};    // CAPABILITY_FRAME_UPDATE
+    std::atomic<bool> wants_lossy{false};      // CAPABILITY_LOSSY_TILES
+    std::atomic<bool> wants_repeat{false};     // CAPABILITY_FRAME_REPEAT
+    std::atomic<uint8_t> roi_min_quality{Config::DEFAULT_ROI_MIN_QUALITY};  // config.roi_min_quality
+
+    // Dernière frame brute reçue par flux (bit i de delivered_mask) et son
+    // format: référence possible d'un FRAME_UPDATE. Sous clients_mutex_.
+    uint32_t delivered_mask = 0;
+    uint32_t delivered_frame[MAX_VIDEO_STREAMS] = {};
+    uint8_t delivered_format[MAX_VIDEO_STREAMS] = {};
+    // Miroir du cache de tuiles du client (hachages seulement, capacité
+    // accordée au handshake; 0: pas de cache). Sous clients_mutex_.
+    TileCache tile_cache;
+    // Tuiles que le client affiche en RGB565, par flux: niveau de perte de
+    // chaque tuile de la grille TileCache::kTileSize (vide: tout est exact),
+    // pour les renvoyer exactes plus tard. Sous clients_mutex_.
+    std::vector<uint8_t> lossy_tiles[MAX_VIDEO_STREAMS];
+
+    // Séries de métriques du client, retirées à la déconnexion
+    Histogram* send_time_us = nullptr;
+    Counter* bytes_sent = nullptr;
+    Counter* frames_dropped = nullptr;
+    Gauge* send_queue_bytes = nullptr;
+    Gauge* rtt_us = nullptr;
+
+    // Le thread du client (ACK) et le thread de diffusion écrivent sur le
+    // même socket: un paquet doit partir en entier avant le suivant
+    std::mutex send_mutex;
 };
 
 class StreamServer {
@@ -35,18 +73,69 @@ public:
     // Broadcast frames to all clients
     void broadcastVideoFrame(const VideoFrame& frame);
     void broadcastAudioFrame(const AudioFrame& frame);
+
+    /**
+     * Frame identical to the last one broadcast on its stream (frame.data is
+     * not read): FRAME_REPEAT to the clients that announced it, nothing to
+     * the others.
+     * @return false, without sending anything, if a subscriber does not hold
+     *         the last frame (new client, REFRESH, dropped frame, format
+     *         change) or still shows lossy tiles to refine: broadcast the
+     *         frame instead
+     */
+    bool repeatVideoFrame(const VideoFrame& frame);
     
+    // Flux vidéo proposés (un par moniteur); envoyés aux clients après le
+    // handshake et à chaque changement
+    void setVideoStreams(const std::vector<StreamInfo>& streams);
+    std::vector<StreamInfo> getVideoStreams() const;
+
+    // Curseur, hors frames vidéo. setCursorShape() n'envoie CURSOR_SHAPE
+    // que pour un numéro de série absent du cache; broadcastCursor() envoie
+    // la position (forme déjà enregistrée). Les nouveaux clients reçoivent
+    // les formes en cache puis la dernière position.
+    void setCursorShape(std::shared_ptr<const CursorImage> shape);
+    void broadcastCursor(const CursorPosition& position);
+
+    // Fenêtre active, dans le repère des positions du curseur (écran X ou
+    // fenêtre capturée); avec le voisinage du pointeur, zone d'intérêt des
+    // tuiles (RoiMap). width ou height 0: aucune
+    void setFocusWindow(int x, int y, int width, int height);
+
+    // Délai sans paquet avant déconnexion. last_heartbeat peut être plus
+    // récent que now (mis à jour par le thread du client entre-temps):
+    // jamais expiré dans ce cas, la différence non signée bouclerait
+    static constexpr uint64_t kHeartbeatTimeoutUs = 30 * 1000000ULL;
+    static bool heartbeatExpired(uint64_t now_us, uint64_t last_heartbeat_us) {
+        return now_us > last_heartbeat_us && now_us - last_heartbeat_us > kHeartbeatTimeoutUs;
+    }
+
     // Client management
     size_t getClientCount() const;
+    size_t getSubscriberCount(uint8_t stream_id) const;
     void disconnectClient(uint16_t client_id);
 
 private:
     void acceptConnections();
     void handleClient(std::shared_ptr<ClientInfo> client);
     bool processHandshake(std::shared_ptr<ClientInfo> client);
-    void sendPacket(SOCKET sock, PacketType type, const void* data, size_t size);
+    // flags: PacketHeader::flags (format des pixels d'une VIDEO_FRAME)
+    bool sendPacket(SOCKET sock, PacketType type, const void* data, size_t size, uint16_t flags = 0);
+    bool sendToClient(ClientInfo& client, PacketType type, const void* data, size_t size, uint16_t flags = 0);
+    bool writePacket(SOCKET sock, PacketType type, const void* data, size_t size, uint16_t flags = 0);
     bool receivePacket(SOCKET sock, PacketHeader& header, std::vector<uint8_t>& payload);
     void heartbeatMonitor();
+    void collectClientMetrics();
+    void handleHeartbeat(ClientInfo& client, const std::vector<uint8_t>& payload, uint64_t receive_us);
+    void handleLatencyReport(ClientInfo& client, const std::vector<uint8_t>& payload);
+    void handleSubscribe(ClientInfo& client, const std::vector<uint8_t>& payload);
+    void handleConfig(ClientInfo& client, const std::vector<uint8_t>& payload);
+    void handleRefresh(ClientInfo& client);
+    bool sendStreamList(ClientInfo& client);
+    bool sendCursorShape(ClientInfo& client, const CursorImage& shape);
+    void sendCursorState(ClientInfo& client);
+    // Pointeur et fenêtre active dans le repère du flux (origine du moniteur)
+    RoiMap regionOfInterest(uint8_t stream_id);
     
     std::string address_;
     int port_;
@@ -59,9 +148,35 @@ private:
     
     std::map<uint16_t, std::shared_ptr<ClientInfo>> clients_;
     mutable std::mutex clients_mutex_;
+
+    // Dernière frame brute de chaque flux, base des FRAME_UPDATE (sous clients_mutex_)
+    struct DeltaReference {
+        bool valid = false;
+        uint32_t frame_number = 0;
+        uint16_t width = 0;
+        uint16_t height = 0;
+        std::vector<uint8_t> pixels;
+        // Dernière frame diffusée, même sans client FRAME_UPDATE (FRAME_REPEAT)
+        uint32_t broadcast_frame = 0;
+        // Classes des tuiles du flux, mises à jour aux frames où un client
+        // accepte LOSSY_RECT
+        TileClassifier classifier{TileCache::kTileSize};
+    };
+    DeltaReference delta_refs_[MAX_VIDEO_STREAMS];
+
+    std::vector<StreamInfo> video_streams_;
+    mutable std::mutex streams_mutex_;
+
+    // Pris avant clients_mutex_ quand les deux sont nécessaires
+    CursorShapeCache cursor_shapes_;
+    CursorPosition last_cursor_;
+    bool has_cursor_;
+    RoiMap::Rect focus_window_;
+    std::mutex cursor_mutex_;
     
     std::atomic<uint16_t> next_client_id_;
     std::atomic<uint32_t> sequence_number_;
+    int metrics_collector_id_;
 };
 
 #endif // STREAMSERVER_H
\ No newline at end of file
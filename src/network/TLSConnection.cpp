@@ -19,13 +19,13 @@ TLSConnection::TLSConnection() : ctx(nullptr), ssl(nullptr), socket(-1) {
     SSL_library_init();
     SSL_load_error_strings();
     OpenSSL_add_all_algorithms();
-    Logger::log(Logger::LogLevel::INFO, "TLSConnection created");
+    LOG_INFO("TLSConnection created");
 }
 
 TLSConnection::~TLSConnection() {
     disconnect();
     cleanup();
-    Logger::log(Logger::LogLevel::INFO, "TLSConnection destroyed");
+    LOG_INFO("TLSConnection destroyed");
 }
 
 bool TLSConnection::init(const std::string& certFile, const std::string& keyFile) {
@@ -33,7 +33,7 @@ bool TLSConnection::init(const std::string& certFile, const std::string& keyFile
     ctx = SSL_CTX_new(method);
     
     if (!ctx) {
-        Logger::log(Logger::LogLevel::WARN, "Failed to create SSL context");
+        LOG_WARN("Failed to create SSL context");
         ERR_print_errors_fp(stderr);
         return false;
     }
@@ -41,24 +41,24 @@ bool TLSConnection::init(const std::string& certFile, const std::string& keyFile
     // Load certificates if provided (for server mode)
     if (!certFile.empty() && !keyFile.empty()) {
         if (SSL_CTX_use_certificate_file(ctx, certFile.c_str(), SSL_FILETYPE_PEM) <= 0) {
-            Logger::log(Logger::LogLevel::WARN, "Failed to load certificate file");
+            LOG_WARN("Failed to load certificate file");
             ERR_print_errors_fp(stderr);
             return false;
         }
 
         if (SSL_CTX_use_PrivateKey_file(ctx, keyFile.c_str(), SSL_FILETYPE_PEM) <= 0) {
-            Logger::log(Logger::LogLevel::WARN, "Failed to load private key file");
+            LOG_WARN("Failed to load private key file");
             ERR_print_errors_fp(stderr);
             return false;
         }
 
         if (!SSL_CTX_check_private_key(ctx)) {
-            Logger::log(Logger::LogLevel::WARN, "Private key does not match certificate");
+            LOG_WARN("Private key does not match certificate");
             return false;
         }
     }
 
-    Logger::log(Logger::LogLevel::INFO, "TLS context initialized");
+    LOG_INFO("TLS context initialized");
     return true;
 }
 
@@ -66,14 +66,14 @@ bool TLSConnection::connect(const std::string& hostname, int port) {
     // Create socket
     socket = ::socket(AF_INET, SOCK_STREAM, 0);
     if (socket < 0) {
-        Logger::log(Logger::LogLevel::WARN, "Failed to create socket");
+        LOG_WARN("Failed to create socket");
         return false;
     }
 
     // Resolve hostname
     struct hostent* host = gethostbyname(hostname.c_str());
     if (!host) {
-        Logger::log(Logger::LogLevel::WARN, "Failed to resolve hostname");
+        LOG_WARN("Failed to resolve hostname");
 #ifdef PLATFORM_WINDOWS
         closesocket(socket);
 #else
@@ -91,8 +91,7 @@ bool TLSConnection::connect(const std::string& hostname, int port) {
     memcpy(&server_addr.sin_addr.s_addr, host->h_addr, host->h_length);
 
     if (::connect(socket, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        std::string msg = "Failed to connect to " + hostname + ":" + std::to_string(port);
-        Logger::log(Logger::LogLevel::WARN, msg);
+        LOG_WARN("Failed to connect to {}:{}", hostname, port);
 #ifdef PLATFORM_WINDOWS
         closesocket(socket);
 #else
@@ -105,7 +104,7 @@ bool TLSConnection::connect(const std::string& hostname, int port) {
     // Create SSL connection
     ssl = SSL_new(ctx);
     if (!ssl) {
-        Logger::log(Logger::LogLevel::WARN, "Failed to create SSL structure");
+        LOG_WARN("Failed to create SSL structure");
         return false;
     }
 
@@ -113,13 +112,12 @@ bool TLSConnection::connect(const std::string& hostname, int port) {
 
     // Perform SSL handshake
     if (SSL_connect(ssl) <= 0) {
-        Logger::log(Logger::LogLevel::WARN, "SSL handshake failed");
+        LOG_WARN("SSL handshake failed");
         ERR_print_errors_fp(stderr);
         return false;
     }
 
-    std::string msg = "TLS connection established to " + hostname + ":" + std::to_string(port);
-    Logger::log(Logger::LogLevel::INFO, msg);
+    LOG_INFO("TLS connection established to {}:{}", hostname, port);
     return true;
 }
 
@@ -139,18 +137,18 @@ void TLSConnection::disconnect() {
         socket = -1;
     }
 
-    Logger::log(Logger::LogLevel::INFO, "TLS connection closed");
+    LOG_INFO("TLS connection closed");
 }
 
 bool TLSConnection::send(const std::string& data) {
     if (!ssl) {
-        Logger::log(Logger::LogLevel::WARN, "Cannot send: SSL not connected");
+        LOG_WARN("Cannot send: SSL not connected");
         return false;
     }
 
     int bytes_sent = SSL_write(ssl, data.c_str(), data.length());
     if (bytes_sent <= 0) {
-        Logger::log(Logger::LogLevel::WARN, "SSL write failed");
+        LOG_WARN("SSL write failed");
         ERR_print_errors_fp(stderr);
         return false;
     }
@@ -160,7 +158,7 @@ bool TLSConnection::send(const std::string& data) {
 
 std::string TLSConnection::receive() {
     if (!ssl) {
-        Logger::log(Logger::LogLevel::WARN, "Cannot receive: SSL not connected");
+        LOG_WARN("Cannot receive: SSL not connected");
         return "";
     }
 
@@ -170,7 +168,7 @@ std::string TLSConnection::receive() {
     if (bytes_received <= 0) {
         int error = SSL_get_error(ssl, bytes_received);
         if (error != SSL_ERROR_WANT_READ && error != SSL_ERROR_WANT_WRITE) {
-            Logger::log(Logger::LogLevel::WARN, "SSL read failed");
+            LOG_WARN("SSL read failed");
             ERR_print_errors_fp(stderr);
         }
         return "";
@@ -0,0 +1,89 @@
+#include "TileCache.h"
+#include <cstring>
+
+namespace {
+    // Constantes et tour de xxHash64: bon brassage, quatre chaînes indépendantes
+    constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+
+    inline uint64_t rotl(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    inline uint64_t mixRound(uint64_t acc, uint64_t input) {
+        return rotl(acc + input * kPrime2, 31) * kPrime1;
+    }
+
+    inline uint64_t load64(const uint8_t* p) {
+        uint64_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+}
+
+void TileCache::reset(size_t capacity) {
+    clear();
+    capacity_ = capacity;
+}
+
+void TileCache::clear() {
+    entries_.clear();
+    index_.clear();
+}
+
+const std::vector<uint8_t>* TileCache::find(uint64_t hash) {
+    auto it = index_.find(hash);
+    if (it == index_.end()) {
+        return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return &it->second->pixels;
+}
+
+void TileCache::insert(uint64_t hash, std::vector<uint8_t> pixels) {
+    if (capacity_ == 0) {
+        return;
+    }
+    auto it = index_.find(hash);
+    if (it != index_.end()) {
+        it->second->pixels = std::move(pixels);
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return;
+    }
+    if (entries_.size() >= capacity_) {
+        index_.erase(entries_.back().hash);
+        entries_.pop_back();
+    }
+    entries_.push_front(Entry{hash, std::move(pixels)});
+    index_[hash] = entries_.begin();
+}
+
+uint64_t TileCache::hashTile(const uint8_t* argb, size_t stride, int width, int height) {
+    uint64_t lanes[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+    const size_t row_bytes = static_cast<size_t>(width) * 4;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = argb + y * stride;
+        size_t i = 0;
+        for (; i + 32 <= row_bytes; i += 32) {
+            for (int lane = 0; lane < 4; ++lane) {
+                lanes[lane] = mixRound(lanes[lane], load64(row + i + lane * 8));
+            }
+        }
+        // Largeur non multiple de 8 pixels: fin de ligne par pixel
+        for (; i < row_bytes; i += 4) {
+            uint32_t pixel;
+            memcpy(&pixel, row + i, 4);
+            lanes[0] = mixRound(lanes[0], pixel);
+        }
+    }
+
+    uint64_t hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+    hash ^= static_cast<uint64_t>(width) << 32 | static_cast<uint32_t>(height);
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
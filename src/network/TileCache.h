@@ -0,0 +1,68 @@
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "common.h"
+
+/**
+ * Tiles indexed by content hash, least recently used evicted first
+ *
+ * The client keeps the pixels of the tiles it received in CACHE_TILE
+ * commands (in its transport format); the server keeps a mirror of the
+ * hashes only, per client, and sends CACHED_TILE (13 + 8 bytes) for a tile
+ * the mirror holds. Both sides apply the same inserts and lookups in the
+ * same order, and both empty the cache on every full VIDEO_FRAME, so with
+ * the capacity agreed at handshake a hash the server considers cached is
+ * still in the client's cache.
+ *
+ * Not thread-safe: the owner serializes access.
+ */
+class TileCache {
+public:
+    // Tuiles alignées sur une grille de kTileSize pixels
+    static constexpr int kTileSize = 64;
+    // Capacité négociée par blocs de kBlockTiles tuiles (un octet au handshake)
+    static constexpr size_t kBlockTiles = 64;
+    static constexpr uint8_t kDefaultClientBlocks = 32;     // 2048 tuiles, 32 Mo en ARGB
+    static constexpr uint8_t kMaxServerBlocks = 128;
+
+    explicit TileCache(size_t capacity = 0) : capacity_(capacity) {}
+
+    // Vide le cache et change sa capacité (0: désactivé)
+    void reset(size_t capacity);
+    void clear();
+
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return entries_.size(); }
+
+    // Sans toucher à l'ordre LRU (estimation côté serveur)
+    bool contains(uint64_t hash) const { return index_.count(hash) != 0; }
+
+    // Pixels de la tuile, marquée la plus récente; nullptr si absente
+    const std::vector<uint8_t>* find(uint64_t hash);
+
+    // Ajoute (ou remplace) la tuile en évinçant la moins récemment utilisée
+    void insert(uint64_t hash, std::vector<uint8_t> pixels = std::vector<uint8_t>());
+
+    // Hachage 64 bits d'une tuile ARGB8888 (lignes espacées de stride octets)
+    static uint64_t hashTile(const uint8_t* argb, size_t stride, int width, int height);
+
+    // Clé de la version RGB565 d'une tuile (CACHE_LOSSY_TILE), distincte de la tuile exacte
+    static uint64_t lossyKey(uint64_t hash) { return hash ^ 0x9e3779b97f4a7c15ULL; }
+
+private:
+    struct Entry {
+        uint64_t hash;
+        std::vector<uint8_t> pixels;
+    };
+
+    size_t capacity_;
+    std::list<Entry> entries_;      // du plus au moins récemment utilisé
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+};
+
+#endif // TILECACHE_H
@@ -0,0 +1,148 @@
+#include "TileClassifier.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    // Écart de luminance (0-255) au-delà duquel deux pixels voisins forment un bord franc
+    constexpr int kEdgeThreshold = 48;
+    // Table de couleurs à adressage ouvert, deux fois kColorCap
+    constexpr int kColorSlots = 128;
+
+    inline int luma(const uint8_t* pixel) {
+        // A, R, G, B: 0.25 R + 0.625 G + 0.125 B
+        return (pixel[1] * 2 + pixel[2] * 5 + pixel[3]) >> 3;
+    }
+
+    inline int popcount8(uint8_t value) {
+        int count = 0;
+        for (; value; value &= value - 1) {
+            count++;
+        }
+        return count;
+    }
+}
+
+TileClassifier::TileClassifier(int tile_size)
+    : tile_size_(tile_size), width_(0), height_(0), columns_(0), rows_(0), frame_(0), measures_(0) {
+}
+
+void TileClassifier::update(const uint8_t* current, int width, int height, const std::vector<UpdateCommand>& commands) {
+    if (width != width_ || height != height_) {
+        width_ = width;
+        height_ = height;
+        columns_ = (width + tile_size_ - 1) / tile_size_;
+        rows_ = (height + tile_size_ - 1) / tile_size_;
+        tiles_.assign(static_cast<size_t>(columns_) * rows_, Tile());
+    }
+    frame_++;
+
+    // Tuiles dont des pixels ont été renvoyés; un COPY_RECT (défilement)
+    // déplace du contenu sans en faire du mouvement
+    changed_.assign(tiles_.size(), 0);
+    for (const UpdateCommand& command : commands) {
+        if (command.type == static_cast<uint8_t>(UpdateCommandType::COPY_RECT) ||
+            command.width == 0 || command.height == 0) {
+            continue;
+        }
+        int last_column = std::min(columns_ - 1, (command.x + command.width - 1) / tile_size_);
+        int last_row = std::min(rows_ - 1, (command.y + command.height - 1) / tile_size_);
+        for (int row = command.y / tile_size_; row <= last_row; ++row) {
+            for (int column = command.x / tile_size_; column <= last_column; ++column) {
+                changed_[static_cast<size_t>(row) * columns_ + column] = 1;
+            }
+        }
+    }
+
+    size_t stride = static_cast<size_t>(width) * 4;
+    for (int row = 0; row < rows_; ++row) {
+        for (int column = 0; column < columns_; ++column) {
+            size_t index = static_cast<size_t>(row) * columns_ + column;
+            Tile& tile = tiles_[index];
+            bool changed = changed_[index] != 0;
+            tile.history = static_cast<uint8_t>((tile.history << 1) | (changed ? 1 : 0));
+            if (changed && (!tile.measured || frame_ - tile.measured_at >= kRemeasureFrames)) {
+                int x = column * tile_size_;
+                int y = row * tile_size_;
+                tile.features = measure(current + y * stride + static_cast<size_t>(x) * 4, stride,
+                                        std::min(tile_size_, width - x), std::min(tile_size_, height - y));
+                tile.measured = true;
+                tile.measured_at = frame_;
+                measures_++;
+            }
+            if (tile.measured) {
+                tile.cls = classify(tile.features, tile.history);
+            }
+        }
+    }
+}
+
+TileClassifier::TileClass TileClassifier::classAt(int x, int y) const {
+    if (x < 0 || y < 0 || x >= width_ || y >= height_ || tiles_.empty()) {
+        return TileClass::TEXT;
+    }
+    return tiles_[static_cast<size_t>(y / tile_size_) * columns_ + x / tile_size_].cls;
+}
+
+bool TileClassifier::settled(int x, int y) const {
+    if (x < 0 || y < 0 || x >= width_ || y >= height_ || tiles_.empty()) {
+        return true;
+    }
+    uint8_t recent = static_cast<uint8_t>((1u << kSettledFrames) - 1);
+    return (tiles_[static_cast<size_t>(y / tile_size_) * columns_ + x / tile_size_].history & recent) == 0;
+}
+
+TileClassifier::Features TileClassifier::measure(const uint8_t* argb, size_t stride, int width, int height) {
+    Features features;
+    uint32_t slots[kColorSlots];
+    bool used[kColorSlots] = {};
+    int pairs = 0;
+    int edges = 0;
+
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = argb + y * stride;
+        uint32_t previous = 0;
+        int previous_luma = 0;
+        for (int x = 0; x < width; ++x) {
+            uint32_t pixel;
+            memcpy(&pixel, row + x * 4, 4);
+            int pixel_luma = luma(row + x * 4);
+            if (x > 0) {
+                pairs++;
+                if (std::abs(pixel_luma - previous_luma) > kEdgeThreshold) {
+                    edges++;
+                }
+            }
+            // Plages unies (texte, interface): une seule recherche
+            if ((x == 0 || pixel != previous) && features.colors < kColorCap) {
+                uint32_t slot = (pixel * 0x9E3779B1u) >> 25;
+                while (used[slot] && slots[slot] != pixel) {
+                    slot = (slot + 1) & (kColorSlots - 1);
+                }
+                if (!used[slot]) {
+                    used[slot] = true;
+                    slots[slot] = pixel;
+                    features.colors++;
+                }
+            }
+            previous = pixel;
+            previous_luma = pixel_luma;
+        }
+    }
+    features.edges = pairs ? edges * 256 / pairs : 0;
+    return features;
+}
+
+TileClassifier::TileClass TileClassifier::classify(const Features& features, uint8_t history) {
+    if (features.colors <= kMaxTextColors) {
+        return TileClass::TEXT;
+    }
+    if (popcount8(history) >= kMotionFrames) {
+        return TileClass::MOTION;
+    }
+    if (features.edges <= kMaxNaturalEdges) {
+        return TileClass::NATURAL;
+    }
+    // Beaucoup de couleurs et de bords, immobile: texte lissé sur une image
+    return TileClass::TEXT;
+}
@@ -0,0 +1,92 @@
+#ifndef TILECLASSIFIER_H
+#define TILECLASSIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "common.h"
+
+/**
+ * Per-tile content classification for mixed desktops
+ *
+ * Each tile of the TileCache grid is labelled TEXT (text, UI: few colors,
+ * must stay exact), NATURAL (photos, gradients: many colors, few sharp
+ * edges) or MOTION (many colors and changed in most of the last frames,
+ * e.g. a video playing in a browser). The server sends NATURAL and MOTION
+ * tiles through the lossy path (LOSSY_RECT) to the clients that accept it,
+ * and resends them exact once they are settled() (a paused video).
+ *
+ * The content measures (color count, edge density) are kept per tile and
+ * only recomputed for a tile that changed and was measured more than
+ * kRemeasureFrames frames ago; the change history is one bit per frame.
+ * A stream of N tiles costs N bit shifts per frame plus a few measures.
+ *
+ * Not thread-safe: the owner serializes access.
+ */
+class TileClassifier {
+public:
+    enum class TileClass : uint8_t {
+        TEXT,
+        NATURAL,
+        MOTION
+    };
+
+    struct Features {
+        int colors = 0;             // couleurs distinctes, plafonné à kColorCap
+        int edges = 0;              // paires voisines très contrastées, pour 256
+    };
+
+    static constexpr int kColorCap = 64;
+    // En dessous: texte ou interface, quel que soit le reste
+    static constexpr int kMaxTextColors = 48;
+    // Image naturelle: moins de kMaxNaturalEdges/256 transitions franches
+    static constexpr int kMaxNaturalEdges = 24;
+    // Mouvement: modifiée dans au moins kMotionFrames des 8 dernières frames
+    static constexpr int kMotionFrames = 5;
+    static constexpr uint32_t kRemeasureFrames = 8;
+    // Immobile: inchangée pendant les kSettledFrames dernières frames
+    static constexpr int kSettledFrames = 4;
+
+    explicit TileClassifier(int tile_size);
+
+    /**
+     * Account for one frame: commands are the FRAME_UPDATE from the previous
+     * frame (FrameDelta::compute), current the new ARGB8888 frame. A size
+     * change resets every tile.
+     */
+    void update(const uint8_t* current, int width, int height, const std::vector<UpdateCommand>& commands);
+
+    // Classe de la tuile contenant le pixel (x, y); TEXT hors de la grille
+    TileClass classAt(int x, int y) const;
+    bool lossy(int x, int y) const { return classAt(x, y) != TileClass::TEXT; }
+    // Tuile contenant (x, y) inchangée depuis kSettledFrames frames (hors de
+    // la grille: toujours): une version RGB565 peut être renvoyée exacte
+    bool settled(int x, int y) const;
+
+    // Mesures effectuées depuis la création (coût du classement)
+    uint64_t measureCount() const { return measures_; }
+
+    static Features measure(const uint8_t* argb, size_t stride, int width, int height);
+    static TileClass classify(const Features& features, uint8_t history);
+
+private:
+    struct Tile {
+        uint8_t history = 0;                // bit 0: modifiée à la dernière frame
+        TileClass cls = TileClass::TEXT;
+        bool measured = false;
+        uint32_t measured_at = 0;
+        Features features;
+    };
+
+    int tile_size_;
+    int width_;
+    int height_;
+    int columns_;
+    int rows_;
+    uint32_t frame_;
+    uint64_t measures_;
+    std::vector<Tile> tiles_;
+    std::vector<uint8_t> changed_;
+};
+
+#endif // TILECLASSIFIER_H
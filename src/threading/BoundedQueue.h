@@ -0,0 +1,348 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Behaviour of push() when the queue is full
+ */
+enum class OverflowPolicy {
+    Block,          // push() waits for room, try_push() fails
+    Reject,         // push() and try_push() fail immediately
+    DropOldest,     // evict the oldest pending item to make room
+    ReplaceLatest   // overwrite the most recently pushed item (coalescing)
+};
+
+/**
+ * Bounded multi-producer/multi-consumer queue
+ *
+ * Lock-free ring buffer in the style of Dmitry Vyukov's bounded MPMC queue:
+ * each cell carries a sequence number that tells producers and consumers
+ * whether it is free, published or being accessed. The fast path is a single
+ * CAS per operation; the mutex and condition variables are only touched when
+ * a thread actually has to sleep (blocking pop, or push under Block policy).
+ *
+ * close() wakes every waiter. After close, pushes fail and pops drain what is
+ * left before returning std::nullopt.
+ */
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity, OverflowPolicy policy = OverflowPolicy::Block)
+        : mask_(round_up_pow2(capacity) - 1),
+          cells_(new Cell[mask_ + 1]),
+          policy_(policy),
+          enqueue_pos_(0),
+          dequeue_pos_(0),
+          closed_(false),
+          dropped_(0),
+          waiting_consumers_(0),
+          waiting_producers_(0) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~BoundedQueue() {
+        while (try_dequeue()) {}
+        delete[] cells_;
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // Push non bloquant, applique la politique de débordement
+    bool try_push(const T& item) { return push_impl(item, false); }
+    bool try_push(T&& item) { return push_impl(std::move(item), false); }
+
+    // Push bloquant (seulement avec OverflowPolicy::Block), false si fermée
+    bool push(const T& item) { return push_impl(item, true); }
+    bool push(T&& item) { return push_impl(std::move(item), true); }
+
+    // Push avec délai maximum (OverflowPolicy::Block)
+    template<class Rep, class Period>
+    bool push_for(T item, const std::chrono::duration<Rep, Period>& timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        return push_impl(std::move(item), false, &deadline);
+    }
+
+    // Pop non bloquant
+    std::optional<T> try_pop() {
+        std::optional<T> item = try_dequeue();
+        if (item) {
+            notify_producer();
+        }
+        return item;
+    }
+
+    // Pop bloquant, retourne nullopt une fois fermée et vide
+    std::optional<T> pop() {
+        return pop_until(nullptr);
+    }
+
+    // Pop avec délai maximum
+    template<class Rep, class Period>
+    std::optional<T> pop_for(const std::chrono::duration<Rep, Period>& timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        return pop_until(&deadline);
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        closed_.store(true, std::memory_order_seq_cst);
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    // Approximate: exact only when no operation is in flight
+    size_t size() const {
+        size_t tail = enqueue_pos_.load(std::memory_order_acquire);
+        size_t head = dequeue_pos_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return mask_ + 1; }
+    OverflowPolicy policy() const { return policy_; }
+
+    // Items discarded by DropOldest / ReplaceLatest
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    // Sequence value marking a cell held exclusively by one thread
+    static constexpr size_t kBusy = ~size_t(0);
+    static constexpr size_t kCacheLine = 64;
+
+    struct alignas(kCacheLine) Cell {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        T* item() { return std::launder(reinterpret_cast<T*>(&storage)); }
+    };
+
+    static size_t round_up_pow2(size_t value) {
+        if (value < 2) {
+            throw std::invalid_argument("BoundedQueue capacity must be at least 2");
+        }
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    enum class EnqueueResult { Ok, Full };
+
+    template<typename U>
+    EnqueueResult try_enqueue(U&& item) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            if (seq == kBusy) {
+                // A consumer or a replacing producer holds the cell
+                std::this_thread::yield();
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    new (&cell.storage) T(std::forward<U>(item));
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return EnqueueResult::Ok;
+                }
+            } else if (diff < 0) {
+                return EnqueueResult::Full;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::optional<T> try_dequeue() {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            if (seq == kBusy) {
+                std::this_thread::yield();
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                // Claim the cell itself rather than the index, so that a
+                // ReplaceLatest producer can never write into a cell being read
+                if (cell.sequence.compare_exchange_weak(seq, kBusy, std::memory_order_acquire)) {
+                    // Only the holder of cell `pos` can advance the head past it
+                    dequeue_pos_.store(pos + 1, std::memory_order_release);
+                    std::optional<T> result(std::move(*cell.item()));
+                    cell.item()->~T();
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return result;
+                }
+            } else if (diff < 0) {
+                return std::nullopt;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Overwrite the most recently published item. Fails if it was consumed
+    // in the meantime, in which case the caller retries a normal enqueue.
+    template<typename U>
+    bool try_replace_latest(U&& item) {
+        size_t tail = enqueue_pos_.load(std::memory_order_acquire);
+        if (tail == 0) {
+            return false;
+        }
+        size_t last = tail - 1;
+        Cell& cell = cells_[last & mask_];
+        size_t expected = last + 1;
+        if (!cell.sequence.compare_exchange_strong(expected, kBusy, std::memory_order_acquire)) {
+            return false;
+        }
+        *cell.item() = T(std::forward<U>(item));
+        cell.sequence.store(last + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename U>
+    bool push_impl(U&& item, bool blocking,
+                   const std::chrono::steady_clock::time_point* deadline = nullptr) {
+        for (;;) {
+            if (closed_.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            if (try_enqueue(std::forward<U>(item)) == EnqueueResult::Ok) {
+                notify_consumer();
+                return true;
+            }
+
+            switch (policy_) {
+                case OverflowPolicy::Reject:
+                    return false;
+
+                case OverflowPolicy::DropOldest:
+                    if (try_dequeue()) {
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                        notify_producer();
+                    }
+                    continue;
+
+                case OverflowPolicy::ReplaceLatest:
+                    if (try_replace_latest(std::forward<U>(item))) {
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                        notify_consumer();
+                        return true;
+                    }
+                    continue;
+
+                case OverflowPolicy::Block:
+                    if (!blocking && !deadline) {
+                        return false;
+                    }
+                    if (!wait_not_full(deadline)) {
+                        return false;
+                    }
+                    continue;
+            }
+        }
+    }
+
+    std::optional<T> pop_until(const std::chrono::steady_clock::time_point* deadline) {
+        std::optional<T> item = try_dequeue();
+        if (!item) {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            waiting_consumers_.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            for (;;) {
+                item = try_dequeue();
+                if (item || closed_.load(std::memory_order_acquire)) {
+                    break;
+                }
+                if (!deadline) {
+                    not_empty_.wait(lock);
+                } else if (not_empty_.wait_until(lock, *deadline) == std::cv_status::timeout) {
+                    item = try_dequeue();
+                    break;
+                }
+            }
+            waiting_consumers_.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        if (item) {
+            notify_producer();
+        }
+        return item;
+    }
+
+    // Returns false on timeout or close
+    bool wait_not_full(const std::chrono::steady_clock::time_point* deadline) {
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        waiting_producers_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool ok = true;
+        while (size() > mask_ && !closed_.load(std::memory_order_acquire)) {
+            if (deadline) {
+                if (not_full_.wait_until(lock, *deadline) == std::cv_status::timeout) {
+                    ok = size() <= mask_;
+                    break;
+                }
+            } else {
+                not_full_.wait(lock);
+            }
+        }
+        waiting_producers_.fetch_sub(1, std::memory_order_relaxed);
+        return ok && !closed_.load(std::memory_order_acquire);
+    }
+
+    void notify_consumer() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_consumers_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            not_empty_.notify_one();
+        }
+    }
+
+    void notify_producer() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_producers_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            not_full_.notify_one();
+        }
+    }
+
+    const size_t mask_;
+    Cell* const cells_;
+    const OverflowPolicy policy_;
+
+    alignas(kCacheLine) std::atomic<size_t> enqueue_pos_;
+    alignas(kCacheLine) std::atomic<size_t> dequeue_pos_;
+    alignas(kCacheLine) std::atomic<bool> closed_;
+    std::atomic<uint64_t> dropped_;
+
+    std::mutex wait_mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::atomic<int> waiting_consumers_;
+    std::atomic<int> waiting_producers_;
+};
+
+#endif // BOUNDEDQUEUE_H
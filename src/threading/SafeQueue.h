@@ -5,6 +5,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <optional>
+#include "../utils/Probes.h"
 
 template<typename T>
 class SafeQueue {
@@ -15,6 +16,7 @@ public:
     void push(const T& item) {
         std::lock_guard<std::mutex> lock(mutex_);
         queue_.push(item);
+        PROBE2(queue__push, this, queue_.size());
         cond_var_.notify_one();
     }
     
@@ -22,6 +24,7 @@ public:
     void push(T&& item) {
         std::lock_guard<std::mutex> lock(mutex_);
         queue_.push(std::move(item));
+        PROBE2(queue__push, this, queue_.size());
         cond_var_.notify_one();
     }
 
@@ -38,6 +41,7 @@ public:
         }
         item = queue_.front();
         queue_.pop();
+        PROBE2(queue__pop, this, queue_.size());
         return true;
     }
     
@@ -49,6 +53,7 @@ public:
         }
         T item = std::move(queue_.front());
         queue_.pop();
+        PROBE2(queue__pop, this, queue_.size());
         return item;
     }
     
@@ -63,15 +68,21 @@ public:
         
         T item = std::move(queue_.front());
         queue_.pop();
+        PROBE2(queue__pop, this, queue_.size());
         return item;
     }
 
-    // Wait and dequeue (style ancien)
-    void wait_and_dequeue(T& item) {
+    // Wait and dequeue (style ancien), false si la queue est fermée et vide
+    bool wait_and_dequeue(T& item) {
         std::unique_lock<std::mutex> lock(mutex_);
-        cond_var_.wait(lock, [this] { return !queue_.empty(); });
-        item = queue_.front();
+        cond_var_.wait(lock, [this] { return !queue_.empty() || closed_; });
+        if (queue_.empty()) {
+            return false;
+        }
+        item = std::move(queue_.front());
         queue_.pop();
+        PROBE2(queue__pop, this, queue_.size());
+        return true;
     }
     
     // Empty check
@@ -1,43 +1,209 @@
 #include "ThreadPool.h"
-#include <iostream>
+#include "../utils/Logger.h"
+#include "../utils/Metrics.h"
 
-ThreadPool::ThreadPool(size_t numThreads) : stop(false) {
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace {
+    thread_local ThreadPool* t_current_pool = nullptr;
+    thread_local int t_worker_index = -1;
+}
+
+ThreadPool::ThreadPool(size_t numThreads, const ThreadPoolOptions& opts)
+    : options(opts),
+      injection_queue(std::max<size_t>(2, opts.queue_capacity), OverflowPolicy::Block),
+      pending(0),
+      busy(0),
+      stop(false),
+      sleepers(0),
+      metrics_collector_id(0) {
     for (size_t i = 0; i < numThreads; ++i) {
-        workers.emplace_back([this] {
-            for (;;) {
-                std::function<void()> task;
-
-                {
-                    std::unique_lock<std::mutex> lock(this->mutex);
-                    this->condition.wait(lock, [this] { 
-                        return this->stop || !this->tasks.empty(); 
-                    });
-                    
-                    if (this->stop && this->tasks.empty()) {
-                        return;
-                    }
-                    
-                    auto opt_task = this->tasks.try_pop();
-                    if (!opt_task) continue;
-                    task = std::move(*opt_task);
-                }
-
-                task();
-            }
-        });
+        local_queues.push_back(std::make_unique<WorkStealingDeque<Task*>>());
     }
+    for (size_t i = 0; i < numThreads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+    metrics_collector_id = Metrics::addCollector([this] { publishMetrics(); });
 }
 
 ThreadPool::~ThreadPool() {
+    Metrics::removeCollector(metrics_collector_id);
+    std::string labels = "pool=\"" + options.name + "\"";
+    Metrics::remove("threadpool_workers", labels);
+    Metrics::remove("threadpool_busy_workers", labels);
+    Metrics::remove("threadpool_pending_tasks", labels);
+
     {
-        std::unique_lock<std::mutex> lock(mutex);
+        std::lock_guard<std::mutex> lock(sleep_mutex);
         stop = true;
     }
-    condition.notify_all();
-    
+    sleep_cv.notify_all();
+
     for (std::thread &worker : workers) {
         if (worker.joinable()) {
             worker.join();
         }
     }
-}
\ No newline at end of file
+
+    // Sans worker, les tâches restantes sont exécutées ici
+    while (auto task = injection_queue.try_pop()) {
+        runTask(*task);
+    }
+}
+
+void ThreadPool::publishMetrics() {
+    std::string labels = "pool=\"" + options.name + "\"";
+    Metrics::gauge("threadpool_workers", labels).set(static_cast<int64_t>(workers.size()));
+    Metrics::gauge("threadpool_busy_workers", labels).set(static_cast<int64_t>(busy.load(std::memory_order_relaxed)));
+    Metrics::gauge("threadpool_pending_tasks", labels).set(static_cast<int64_t>(pending.load(std::memory_order_relaxed)));
+}
+
+int ThreadPool::current_worker_index() {
+    return t_worker_index;
+}
+
+bool ThreadPool::schedule(Task* task, bool blocking) {
+    // Compté avant publication: un worker peut la prendre (fetch_sub) aussitôt
+    pending.fetch_add(1, std::memory_order_seq_cst);
+    if (t_current_pool == this) {
+        local_queues[t_worker_index]->push(task);
+    } else {
+        bool queued = blocking ? injection_queue.push(task) : injection_queue.try_push(task);
+        if (!queued) {
+            pending.fetch_sub(1, std::memory_order_seq_cst);
+            delete task;
+            return false;
+        }
+    }
+    wakeWorkers(1);
+    return true;
+}
+
+void ThreadPool::scheduleBulk(const std::vector<Task*>& batch) {
+    if (batch.empty()) {
+        return;
+    }
+    // Comptées avant publication, comme dans schedule()
+    pending.fetch_add(batch.size(), std::memory_order_seq_cst);
+    for (Task* task : batch) {
+        if (t_current_pool == this) {
+            local_queues[t_worker_index]->push(task);
+        } else if (!injection_queue.try_push(task)) {
+            // File pleine: réveiller les workers avant de bloquer
+            wakeWorkers(batch.size());
+            if (!injection_queue.push(task)) {
+                pending.fetch_sub(1, std::memory_order_seq_cst);
+                delete task;
+            }
+        }
+    }
+    wakeWorkers(batch.size());
+}
+
+void ThreadPool::wakeWorkers(size_t count) {
+    // Pairs with the fence in workerLoop: either the worker sees the new
+    // pending count, or we see it registered as a sleeper
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(sleep_mutex);
+    if (count == 1) {
+        sleep_cv.notify_one();
+    } else {
+        sleep_cv.notify_all();
+    }
+}
+
+ThreadPool::Task* ThreadPool::findTask(size_t index) {
+    if (auto task = local_queues[index]->pop()) {
+        return *task;
+    }
+    if (auto task = injection_queue.try_pop()) {
+        return *task;
+    }
+    // Vol: on commence par le voisin pour répartir les voleurs
+    size_t count = local_queues.size();
+    for (size_t i = 1; i < count; ++i) {
+        if (auto task = local_queues[(index + i) % count]->steal()) {
+            return *task;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadPool::runTask(Task* task) {
+    try {
+        (*task)();
+    } catch (const std::exception& e) {
+        LOG_ERROR("ThreadPool {}: task threw: {}", options.name, e.what());
+    } catch (...) {
+        LOG_ERROR("ThreadPool {}: task threw unknown exception", options.name);
+    }
+    delete task;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    t_current_pool = this;
+    t_worker_index = static_cast<int>(index);
+    configureCurrentThread(index);
+
+    for (;;) {
+        if (Task* task = findTask(index)) {
+            pending.fetch_sub(1, std::memory_order_relaxed);
+            busy.fetch_add(1, std::memory_order_relaxed);
+            runTask(task);
+            busy.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleepers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (pending.load(std::memory_order_relaxed) == 0 && !stop) {
+            sleep_cv.wait(lock);
+        }
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+
+        if (stop && pending.load(std::memory_order_relaxed) == 0) {
+            break;
+        }
+    }
+
+    t_current_pool = nullptr;
+    t_worker_index = -1;
+}
+
+void ThreadPool::configureCurrentThread(size_t index) {
+    unsigned int cpus = std::thread::hardware_concurrency();
+
+#ifdef __linux__
+    // Linux limite les noms de thread à 15 caractères
+    std::string name = options.name + "-" + std::to_string(index);
+    if (name.size() > 15) {
+        name = name.substr(name.size() - 15);
+    }
+    pthread_setname_np(pthread_self(), name.c_str());
+
+    if (options.pin_threads && cpus > 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index % cpus, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+            LOG_WARN("ThreadPool {}: failed to pin worker {} to CPU {}", options.name, index, index % cpus);
+        }
+    }
+#elif defined(_WIN32)
+    if (options.pin_threads && cpus > 0) {
+        SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << (index % cpus));
+    }
+#else
+    (void)index;
+    (void)cpus;
+#endif
+}
@@ -4,33 +4,195 @@
 #include <vector>
 #include <thread>
 #include <functional>
-#include <queue>
+#include <future>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
-#include "SafeQueue.h"
+#include <string>
+#include <tuple>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <exception>
+#include "BoundedQueue.h"
+#include "WorkStealingDeque.h"
 
+struct ThreadPoolOptions {
+    std::string name = "pool";      // Thread names: "<name>-<index>" (Linux, 15 chars max)
+    bool pin_threads = false;       // Pin worker i to CPU i % hardware_concurrency
+    size_t queue_capacity = 1024;   // Capacity of the external submission queue
+};
+
+/**
+ * Work-stealing thread pool
+ *
+ * Each worker owns a Chase-Lev deque: tasks submitted from inside a worker go
+ * to its own deque without locking, idle workers steal from the others.
+ * Submissions from outside the pool go through a bounded MPMC queue, which
+ * gives backpressure when the pool falls behind. The sleep mutex is only
+ * taken when a worker actually runs out of work.
+ */
 class ThreadPool {
 public:
-    ThreadPool(size_t numThreads);
+    explicit ThreadPool(size_t numThreads, const ThreadPoolOptions& options = ThreadPoolOptions());
     ~ThreadPool();
 
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Fire and forget. Bloque si la file externe est pleine.
     template<class F>
     void enqueue(F&& f) {
-        tasks.push(std::forward<F>(f));
-        condition.notify_one();
+        schedule(new Task(std::forward<F>(f)), true);
+    }
+
+    // Non bloquant: false si la file externe est pleine
+    template<class F>
+    bool try_enqueue(F&& f) {
+        return schedule(new Task(std::forward<F>(f)), false);
+    }
+
+    // Retourne un future sur le résultat (ou l'exception) de la tâche.
+    // f et les arguments sont déplacés dans la tâche: les types move-only
+    // (std::unique_ptr, std::packaged_task...) sont acceptés.
+    template<class F, class... Args>
+    auto submit(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+        using R = std::invoke_result_t<F, Args...>;
+        auto task = std::make_shared<std::packaged_task<R()>>(
+            [f = std::forward<F>(f), args = std::make_tuple(std::forward<Args>(args)...)]() mutable -> R {
+                return std::apply(std::move(f), std::move(args));
+            });
+        std::future<R> result = task->get_future();
+        schedule(new Task([task] { (*task)(); }), true);
+        return result;
     }
-    
+
+    // Soumission groupée: un seul réveil des workers pour tout le lot
+    template<class It>
+    void enqueue_bulk(It first, It last) {
+        std::vector<Task*> batch;
+        for (; first != last; ++first) {
+            batch.push_back(new Task(*first));
+        }
+        scheduleBulk(batch);
+    }
+
+    /**
+     * Run body(chunk_begin, chunk_end) over [begin, end) split in chunks of
+     * `grain` indices (0 = automatic). The calling thread takes part in the
+     * work, so this is safe to call from inside a pool task. Rethrows the
+     * first exception raised by a chunk.
+     */
+    template<class F>
+    void parallel_for(size_t begin, size_t end, F&& body, size_t grain = 0) {
+        if (end <= begin) {
+            return;
+        }
+        size_t count = end - begin;
+        if (grain == 0) {
+            grain = std::max<size_t>(1, count / (4 * (workers.size() + 1)));
+        }
+        size_t chunks = (count + grain - 1) / grain;
+        if (chunks == 1 || workers.empty()) {
+            body(begin, end);
+            return;
+        }
+
+        auto state = std::make_shared<ParallelForState>();
+        state->chunks = chunks;
+
+        // Helpers only touch `body` after claiming a chunk, and the caller does
+        // not return before every claimed chunk is done, so a reference is safe
+        auto runChunks = [state, begin, end, grain, &body] {
+            for (;;) {
+                size_t chunk = state->next.fetch_add(1, std::memory_order_relaxed);
+                if (chunk >= state->chunks) {
+                    return;
+                }
+                size_t chunkBegin = begin + chunk * grain;
+                size_t chunkEnd = std::min(end, chunkBegin + grain);
+                try {
+                    body(chunkBegin, chunkEnd);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (!state->error) {
+                        state->error = std::current_exception();
+                    }
+                }
+                if (state->done.fetch_add(1, std::memory_order_acq_rel) + 1 == state->chunks) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->finished.notify_all();
+                }
+            }
+        };
+
+        std::vector<Task*> helpers;
+        size_t helperCount = std::min(chunks - 1, workers.size());
+        for (size_t i = 0; i < helperCount; ++i) {
+            helpers.push_back(new Task(runChunks));
+        }
+        scheduleBulk(helpers);
+
+        runChunks();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&] {
+            return state->done.load(std::memory_order_acquire) == state->chunks;
+        });
+        if (state->error) {
+            std::rethrow_exception(state->error);
+        }
+    }
+
     size_t pending_tasks() const {
-        return tasks.size();
+        return pending.load(std::memory_order_relaxed);
+    }
+
+    size_t size() const { return workers.size(); }
+
+    size_t busy_workers() const {
+        return busy.load(std::memory_order_relaxed);
     }
 
+    // Index of the calling worker in its pool, -1 outside any pool
+    static int current_worker_index();
+
 private:
+    using Task = std::function<void()>;
+
+    struct ParallelForState {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        size_t chunks = 0;
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+
+    bool schedule(Task* task, bool blocking);
+    void scheduleBulk(const std::vector<Task*>& batch);
+    void workerLoop(size_t index);
+    Task* findTask(size_t index);
+    void runTask(Task* task);
+    void wakeWorkers(size_t count);
+    void configureCurrentThread(size_t index);
+    void publishMetrics();
+
+    ThreadPoolOptions options;
     std::vector<std::thread> workers;
-    SafeQueue<std::function<void()>> tasks;
-    std::mutex mutex;
-    std::condition_variable condition;
+    std::vector<std::unique_ptr<WorkStealingDeque<Task*>>> local_queues;
+    BoundedQueue<Task*> injection_queue;
+
+    std::atomic<size_t> pending;
+    std::atomic<size_t> busy;
     std::atomic<bool> stop;
+
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cv;
+    std::atomic<int> sleepers;
+
+    int metrics_collector_id;
 };
 
-#endif // THREADPOOL_H
\ No newline at end of file
+#endif // THREADPOOL_H
@@ -0,0 +1,163 @@
+#include "FrameTracer.h"
+#include "TraceLog.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+    #include <process.h>
+    #define getpid _getpid
+#else
+    #include <unistd.h>
+#endif
+
+std::atomic<bool> FrameTracer::enabled_{true};
+
+namespace {
+    // Champs atomiques relâchés: un lecteur peut copier un slot en cours
+    // d'écriture, la séquence relue après la copie le détecte
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> start_ns{0};
+        std::atomic<uint64_t> end_ns{0};
+        std::atomic<uint32_t> frame_number{0};
+        std::atomic<uint32_t> thread_id{0};
+        std::atomic<uint16_t> client_id{0};
+    };
+
+    struct Span {
+        const char* name;
+        uint64_t start_ns;
+        uint64_t end_ns;
+        uint32_t frame_number;
+        uint32_t thread_id;
+        uint16_t client_id;
+    };
+
+    Slot g_slots[FrameTracer::kCapacity];
+    std::atomic<uint64_t> g_write_index{0};
+
+    struct FrameContext {
+        bool has_frame = false;
+        uint32_t frame_number = 0;
+        uint16_t client_id = 0;
+    };
+    thread_local FrameContext t_context;
+}
+
+void FrameTracer::record(const char* name, uint32_t frame_number, uint16_t client_id,
+                         uint64_t start_ns, uint64_t end_ns) {
+    uint64_t index = g_write_index.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = g_slots[index & (kCapacity - 1)];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.end_ns.store(end_ns, std::memory_order_relaxed);
+    slot.frame_number.store(frame_number, std::memory_order_relaxed);
+    slot.thread_id.store(TraceLog::currentThreadId(), std::memory_order_relaxed);
+    slot.client_id.store(client_id, std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+void FrameTracer::clear() {
+    for (Slot& slot : g_slots) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::string FrameTracer::toChromeJson() {
+    std::vector<Span> spans;
+    spans.reserve(kCapacity);
+    for (Slot& slot : g_slots) {
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before == 0) {
+            continue;
+        }
+        Span span;
+        span.name = slot.name.load(std::memory_order_relaxed);
+        span.start_ns = slot.start_ns.load(std::memory_order_relaxed);
+        span.end_ns = slot.end_ns.load(std::memory_order_relaxed);
+        span.frame_number = slot.frame_number.load(std::memory_order_relaxed);
+        span.thread_id = slot.thread_id.load(std::memory_order_relaxed);
+        span.client_id = slot.client_id.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before && span.name) {
+            spans.push_back(span);
+        }
+    }
+    std::sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) {
+        return a.start_ns < b.start_ns;
+    });
+
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    char line[256];
+    int pid = static_cast<int>(getpid());
+    for (size_t i = 0; i < spans.size(); ++i) {
+        const Span& s = spans[i];
+        uint64_t duration_ns = s.end_ns > s.start_ns ? s.end_ns - s.start_ns : 0;
+        std::snprintf(line, sizeof(line),
+                      "%s{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                      "\"pid\":%d,\"tid\":%u,\"args\":{\"frame\":%u,\"client\":%u}}",
+                      i ? ",\n" : "", s.name, s.start_ns / 1000.0, duration_ns / 1000.0,
+                      pid, s.thread_id, s.frame_number, s.client_id);
+        out += line;
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+bool FrameTracer::dumpToFile(const std::string& path) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file << toChromeJson();
+    return static_cast<bool>(file);
+}
+
+FrameSpan::FrameSpan(const char* name, uint32_t frame_number, uint16_t client_id)
+    : name_(name),
+      frame_number_(frame_number),
+      client_id_(client_id),
+      active_(FrameTracer::isEnabled()),
+      sets_frame_(true),
+      parent_had_frame_(t_context.has_frame),
+      parent_frame_(t_context.frame_number),
+      parent_client_(t_context.client_id),
+      start_ns_(active_ ? FrameTracer::nowNs() : 0) {
+    t_context.has_frame = true;
+    t_context.frame_number = frame_number;
+    t_context.client_id = client_id;
+}
+
+FrameSpan::FrameSpan(const char* name)
+    : name_(name),
+      frame_number_(t_context.frame_number),
+      client_id_(t_context.client_id),
+      active_(t_context.has_frame && FrameTracer::isEnabled()),
+      sets_frame_(false),
+      parent_had_frame_(false),
+      parent_frame_(0),
+      parent_client_(0),
+      start_ns_(active_ ? FrameTracer::nowNs() : 0) {
+}
+
+FrameSpan::~FrameSpan() {
+    end();
+}
+
+void FrameSpan::end() {
+    if (active_) {
+        FrameTracer::record(name_, frame_number_, client_id_, start_ns_, FrameTracer::nowNs());
+        active_ = false;
+    }
+    if (sets_frame_) {
+        t_context.has_frame = parent_had_frame_;
+        t_context.frame_number = parent_frame_;
+        t_context.client_id = parent_client_;
+        sets_frame_ = false;
+    }
+}
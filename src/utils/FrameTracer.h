@@ -0,0 +1,76 @@
+#ifndef FRAMETRACER_H
+#define FRAMETRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * Frame-scoped tracing spans
+ *
+ * Each span records a stage of one video frame (capture, conversion,
+ * serialization, send, client callback) into a fixed in-memory ring. The
+ * ring can be exported at any time as Chrome trace JSON, loadable in
+ * chrome://tracing or Perfetto, with the frame number on every slice.
+ *
+ * A span created without a frame number inherits the frame and client of
+ * the enclosing span on the same thread (and is skipped outside any frame), so helpers
+ * such as ScreenCapture::captureRegion need not know which frame they work
+ * for:
+ *
+ *     FrameSpan span("capture", frame_number);
+ *     ...
+ *     FrameSpan inner("convert");     // same frame
+ *
+ * Span names must be string literals (only the pointer is stored).
+ */
+class FrameTracer {
+public:
+    static constexpr size_t kCapacity = 1 << 15;
+
+    static void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    static bool isEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    static void record(const char* name, uint32_t frame_number, uint16_t client_id,
+                       uint64_t start_ns, uint64_t end_ns);
+
+    // Spans encore présents dans l'anneau, triés par début
+    static std::string toChromeJson();
+    static bool dumpToFile(const std::string& path);
+    static void clear();
+
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+private:
+    static std::atomic<bool> enabled_;
+};
+
+class FrameSpan {
+public:
+    FrameSpan(const char* name, uint32_t frame_number, uint16_t client_id = 0);
+    explicit FrameSpan(const char* name);
+    ~FrameSpan();
+
+    // Termine le span avant la fin de la portée
+    void end();
+
+    FrameSpan(const FrameSpan&) = delete;
+    FrameSpan& operator=(const FrameSpan&) = delete;
+
+private:
+    const char* name_;
+    uint32_t frame_number_;
+    uint16_t client_id_;
+    bool active_;
+    bool sets_frame_;           // span racine: restaure le contexte du thread
+    bool parent_had_frame_;
+    uint32_t parent_frame_;
+    uint16_t parent_client_;
+    uint64_t start_ns_;
+};
+
+#endif // FRAMETRACER_H
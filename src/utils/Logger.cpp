@@ -1,71 +1,462 @@
 #include "Logger.h"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <iomanip>
-#include <sstream>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <thread>
+#include <vector>
 
-std::mutex Logger::mutex_;
-std::ofstream Logger::file_;
-Logger::LogLevel Logger::min_level_ = Logger::LogLevel::INFO;
+std::atomic<Logger::LogLevel> Logger::min_level_{Logger::LogLevel::INFO};
 
-void Logger::init(const std::string& filename, LogLevel min_level) {
-    min_level_ = min_level;
-    
-    if (file_.is_open()) {
-        file_.close();
+namespace {
+    /**
+     * Single-producer/single-consumer byte ring holding variable-length
+     * records. Each record is a RecordHeader followed by the formatted line,
+     * padded to 16 bytes. A header with size 0 marks a wrap to offset 0.
+     */
+    class LogRing {
+    public:
+        static constexpr size_t kCapacity = 32 * 1024;
+        static constexpr size_t kMaxText = kCapacity / 8;
+
+        struct RecordHeader {
+            uint32_t size;          // header + text, unpadded
+            uint8_t level;
+            uint8_t reserved[3];
+            uint64_t timestamp_ns;
+        };
+        static_assert(sizeof(RecordHeader) == 16, "RecordHeader must stay 16 bytes");
+
+        LogRing() : head_(0), tail_(0), cached_tail_(0), retired(false) {}
+
+        // Producer side. Returns false (record dropped) when the ring is full.
+        bool write(uint8_t level, uint64_t timestamp_ns,
+                   const char* prefix, size_t prefix_len,
+                   const char* message, size_t message_len) {
+            if (prefix_len + message_len > kMaxText) {
+                message_len = kMaxText - prefix_len;
+            }
+            size_t size = sizeof(RecordHeader) + prefix_len + message_len;
+            size_t needed = align(size);
+
+            size_t head = head_.load(std::memory_order_relaxed);
+            size_t offset = head & (kCapacity - 1);
+            size_t contiguous = kCapacity - offset;
+            size_t total = needed > contiguous ? contiguous + needed : needed;
+
+            if (kCapacity - (head - cached_tail_) < total) {
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+                if (kCapacity - (head - cached_tail_) < total) {
+                    return false;
+                }
+            }
+
+            if (needed > contiguous) {
+                RecordHeader wrap{};
+                std::memcpy(buffer_ + offset, &wrap, sizeof(wrap));
+                offset = 0;
+            }
+
+            RecordHeader header{};
+            header.size = static_cast<uint32_t>(size);
+            header.level = level;
+            header.timestamp_ns = timestamp_ns;
+            std::memcpy(buffer_ + offset, &header, sizeof(header));
+            std::memcpy(buffer_ + offset + sizeof(header), prefix, prefix_len);
+            std::memcpy(buffer_ + offset + sizeof(header) + prefix_len, message, message_len);
+
+            head_.store(head + total, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side
+        template<typename Sink>
+        void drain(Sink&& sink) {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            size_t head = head_.load(std::memory_order_acquire);
+            while (tail != head) {
+                size_t offset = tail & (kCapacity - 1);
+                RecordHeader header;
+                std::memcpy(&header, buffer_ + offset, sizeof(header));
+                if (header.size == 0) {
+                    tail += kCapacity - offset;
+                    continue;
+                }
+                sink(header, buffer_ + offset + sizeof(header), header.size - sizeof(header));
+                tail += align(header.size);
+            }
+            tail_.store(tail, std::memory_order_release);
+        }
+
+        bool empty() const {
+            return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+        }
+
+    private:
+        static size_t align(size_t size) { return (size + 15) & ~size_t(15); }
+
+        alignas(64) std::atomic<size_t> head_;
+        alignas(64) std::atomic<size_t> tail_;
+        alignas(64) size_t cached_tail_;    // producer only
+
+    public:
+        std::atomic<bool> retired;          // owning thread has exited
+
+    private:
+        alignas(64) char buffer_[kCapacity];
+    };
+
+    const char* level_name(uint8_t level) {
+        switch (static_cast<Logger::LogLevel>(level)) {
+            case Logger::LogLevel::DEBUG: return "DEBUG";
+            case Logger::LogLevel::INFO: return "INFO";
+            case Logger::LogLevel::WARN: return "WARN";
+            case Logger::LogLevel::ERROR_LEVEL: return "ERROR";
+            default: return "UNKNOWN";
+        }
+    }
+
+    std::atomic<bool> g_backend_alive{false};
+
+    /**
+     * Background writer: owns the file, the ring registry and the drain thread
+     */
+    class Backend {
+    public:
+        Backend() : running_(true), wake_requested_(false), sleeping_(false), dropped_(0), reported_dropped_(0) {
+            g_backend_alive = true;
+            thread_ = std::thread(&Backend::run, this);
+        }
+
+        ~Backend() {
+            {
+                std::lock_guard<std::mutex> lock(wake_mutex_);
+                running_ = false;
+            }
+            wake_cv_.notify_one();
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+            flush();
+            g_backend_alive = false;
+        }
+
+        std::shared_ptr<LogRing> registerRing() {
+            auto ring = std::make_shared<LogRing>();
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            rings_.push_back(ring);
+            return ring;
+        }
+
+        void wake() {
+            {
+                // Sous le verrou: sinon le réveil peut tomber entre le test du
+                // prédicat et l'endormissement, et être perdu
+                std::lock_guard<std::mutex> lock(wake_mutex_);
+                wake_requested_.store(true, std::memory_order_relaxed);
+            }
+            wake_cv_.notify_one();
+        }
+
+        // Producer side, after each record: only wakes a sleeping writer, so a
+        // busy writer costs a fence and a shared read
+        void recordWritten() {
+            // Paired with the fence in run(): either the writer sees the new
+            // record before sleeping, or the producer sees it asleep
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping_.load(std::memory_order_relaxed)) {
+                wake();
+            }
+        }
+
+        void countDrop() { dropped_.fetch_add(1, std::memory_order_relaxed); }
+        uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+        void openFile(const std::string& filename) {
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            if (file_.is_open()) {
+                file_.close();
+            }
+            file_.open(filename, std::ios::out | std::ios::app);
+            if (file_.is_open()) {
+                file_ << "Logger initialized\n";
+                file_.flush();
+            }
+        }
+
+        void closeFile() {
+            flush();
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            if (file_.is_open()) {
+                file_ << "Logger shutdown\n";
+                file_.close();
+            }
+        }
+
+        // Drain now and report pending drop counts immediately
+        void flush() {
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            force_report_ = true;
+            drainLocked();
+            force_report_ = false;
+        }
+
+        void drainAll() {
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            drainLocked();
+        }
+
+    private:
+        struct Entry {
+            uint64_t timestamp_ns;
+            uint8_t level;
+            size_t offset;
+            size_t length;
+        };
+
+        void drainLocked() {
+            std::vector<std::shared_ptr<LogRing>> rings;
+            {
+                std::lock_guard<std::mutex> registry_lock(registry_mutex_);
+                rings = rings_;
+            }
+
+            batch_.clear();
+            arena_.clear();
+            for (auto& ring : rings) {
+                ring->drain([this](const LogRing::RecordHeader& header, const char* text, size_t length) {
+                    batch_.push_back({header.timestamp_ns, header.level, arena_.size(), length});
+                    arena_.append(text, length);
+                });
+            }
+
+            // Pertes signalées au plus une fois par seconde
+            uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+            auto now = std::chrono::steady_clock::now();
+            bool report_drops = dropped != reported_dropped_ &&
+                                (force_report_ || now - last_drop_report_ >= std::chrono::seconds(1));
+            if (batch_.empty() && !report_drops) {
+                pruneRetired();
+                return;
+            }
+
+            // Les rings sont drainés l'un après l'autre: on rétablit l'ordre chronologique
+            std::stable_sort(batch_.begin(), batch_.end(), [](const Entry& a, const Entry& b) {
+                return a.timestamp_ns < b.timestamp_ns;
+            });
+
+            out_.clear();
+            err_.clear();
+            file_out_.clear();
+            for (const Entry& entry : batch_) {
+                std::string& console = entry.level >= static_cast<uint8_t>(Logger::LogLevel::WARN) ? err_ : out_;
+                console.append(arena_, entry.offset, entry.length);
+                console.push_back('\n');
+                file_out_.append(arena_, entry.offset, entry.length);
+                file_out_.push_back('\n');
+            }
+            if (report_drops) {
+                last_drop_report_ = now;
+                std::string warning = "[WARN] Logger dropped " + std::to_string(dropped - reported_dropped_) +
+                                      " record(s): ring full\n";
+                err_ += warning;
+                file_out_ += warning;
+                reported_dropped_ = dropped;
+            }
+
+            if (!out_.empty()) {
+                std::cout.write(out_.data(), out_.size());
+                std::cout.flush();
+            }
+            if (!err_.empty()) {
+                std::cerr.write(err_.data(), err_.size());
+                std::cerr.flush();
+            }
+            if (file_.is_open() && !file_out_.empty()) {
+                file_.write(file_out_.data(), file_out_.size());
+                file_.flush();
+            }
+
+            pruneRetired();
+        }
+
+        void run() {
+            while (true) {
+                drainAll();
+                bool drops_pending = dropsPending();
+
+                std::unique_lock<std::mutex> lock(wake_mutex_);
+                sleeping_.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (running_ && !wake_requested_.load(std::memory_order_relaxed) && !recordsPending()) {
+                    // Rings vides: pas de réveil avant le prochain enregistrement.
+                    // Délai seulement pour signaler des pertes encore en attente.
+                    auto woken = [this] {
+                        return !running_ || wake_requested_.load(std::memory_order_relaxed);
+                    };
+                    if (drops_pending) {
+                        wake_cv_.wait_for(lock, std::chrono::seconds(1), woken);
+                    } else {
+                        wake_cv_.wait(lock, woken);
+                    }
+                }
+                sleeping_.store(false, std::memory_order_relaxed);
+                wake_requested_.store(false, std::memory_order_relaxed);
+                if (!running_) {
+                    break;
+                }
+            }
+        }
+
+        bool recordsPending() {
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            return std::any_of(rings_.begin(), rings_.end(), [](const std::shared_ptr<LogRing>& ring) {
+                return !ring->empty();
+            });
+        }
+
+        bool dropsPending() {
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            return dropped_.load(std::memory_order_relaxed) != reported_dropped_;
+        }
+
+        // Called with drain_mutex_ held
+        void pruneRetired() {
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [](const std::shared_ptr<LogRing>& ring) {
+                return ring->retired.load(std::memory_order_acquire) && ring->empty();
+            }), rings_.end());
+        }
+
+        std::thread thread_;
+        bool running_;
+        std::mutex wake_mutex_;
+        std::condition_variable wake_cv_;
+        std::atomic<bool> wake_requested_;
+        std::atomic<bool> sleeping_;        // run() is about to wait or waiting
+
+        std::mutex registry_mutex_;
+        std::vector<std::shared_ptr<LogRing>> rings_;
+
+        std::mutex drain_mutex_;
+        std::ofstream file_;
+        std::vector<Entry> batch_;
+        std::string arena_;
+        std::string out_;
+        std::string err_;
+        std::string file_out_;
+
+        std::atomic<uint64_t> dropped_;
+        uint64_t reported_dropped_;
+        bool force_report_ = false;
+        std::chrono::steady_clock::time_point last_drop_report_;
+    };
+
+    Backend& backend() {
+        static Backend instance;
+        return instance;
     }
-    
-    file_.open(filename, std::ios::out | std::ios::app);
-    
-    if (file_.is_open()) {
-        file_ << "Logger initialized" << std::endl;
+
+    // Le ring reste enregistré après la fin du thread jusqu'à ce qu'il soit vidé
+    struct ThreadRing {
+        std::shared_ptr<LogRing> ring;
+
+        ~ThreadRing() {
+            if (ring) {
+                ring->retired.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    // "YYYY-mm-dd HH:MM:SS" recalculé une fois par seconde et par thread
+    struct TimestampCache {
+        int64_t second = -1;
+        char text[24] = {0};
+        size_t length = 0;
+    };
+
+    thread_local ThreadRing t_ring;
+    thread_local TimestampCache t_timestamp;
+
+    size_t format_prefix(char* out, size_t capacity, uint64_t timestamp_ns, Logger::LogLevel level) {
+        int64_t second = static_cast<int64_t>(timestamp_ns / 1000000000ULL);
+        if (second != t_timestamp.second) {
+            std::time_t time = static_cast<std::time_t>(second);
+            std::tm tm_buf;
+#ifdef _WIN32
+            localtime_s(&tm_buf, &time);
+#else
+            localtime_r(&time, &tm_buf);
+#endif
+            t_timestamp.length = std::strftime(t_timestamp.text, sizeof(t_timestamp.text), "%Y-%m-%d %H:%M:%S", &tm_buf);
+            t_timestamp.second = second;
+        }
+        unsigned ms = static_cast<unsigned>((timestamp_ns / 1000000ULL) % 1000);
+        int written = std::snprintf(out, capacity, "%s.%03u [%s] ", t_timestamp.text, ms,
+                                    level_name(static_cast<uint8_t>(level)));
+        return written > 0 ? std::min(static_cast<size_t>(written), capacity - 1) : 0;
     }
 }
 
+void Logger::init(const std::string& filename, LogLevel min_level) {
+    min_level_.store(min_level, std::memory_order_relaxed);
+    backend().openFile(filename);
+}
+
 void Logger::shutdown() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (file_.is_open()) {
-        file_ << "Logger shutdown" << std::endl;
-        file_.close();
+    TraceLog::close();
+    if (g_backend_alive) {
+        backend().closeFile();
     }
 }
 
+void Logger::flush() {
+    if (g_backend_alive) {
+        backend().flush();
+    }
+}
+
+uint64_t Logger::droppedRecords() {
+    return g_backend_alive ? backend().dropped() : 0;
+}
+
 void Logger::log(LogLevel level, const std::string& message) {
-    if (level < min_level_) return;
-    
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
-    
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    ss << " [" << level_to_string(level) << "] " << message;
-    
-    std::string log_line = ss.str();
-    
-    if (level >= LogLevel::WARN) {
-        std::cerr << log_line << std::endl;
-    } else {
-        std::cout << log_line << std::endl;
+    if (!isEnabled(level)) return;
+
+    uint64_t timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    char prefix[64];
+    size_t prefix_len = format_prefix(prefix, sizeof(prefix), timestamp_ns, level);
+
+    Backend& writer = backend();
+    if (!g_backend_alive) {
+        // Après la destruction du backend (destructeurs statiques): écriture directe
+        std::ostream& console = level >= LogLevel::WARN ? std::cerr : std::cout;
+        console.write(prefix, prefix_len);
+        console << message << '\n';
+        return;
+    }
+
+    if (!t_ring.ring) {
+        t_ring.ring = writer.registerRing();
     }
-    
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (file_.is_open()) {
-        file_ << log_line << std::endl;
-        file_.flush();
+
+    if (!t_ring.ring->write(static_cast<uint8_t>(level), timestamp_ns, prefix, prefix_len,
+                            message.data(), message.size())) {
+        writer.countDrop();
+        writer.wake();
+        return;
     }
+
+    writer.recordWritten();
 }
 
 const char* Logger::level_to_string(LogLevel level) {
-    switch (level) {
-        case LogLevel::DEBUG: return "DEBUG";
-        case LogLevel::INFO: return "INFO";
-        case LogLevel::WARN: return "WARN";
-        case LogLevel::ERROR_LEVEL: return "ERROR";
-        default: return "UNKNOWN";
-    }
+    return level_name(static_cast<uint8_t>(level));
 }
 
 Logger::Logger(const std::string& filename) : logFileName(filename) {
@@ -80,11 +471,11 @@ Logger::~Logger() {
 
 void Logger::log(const std::string& message, LogLevel level) {
     std::lock_guard<std::mutex> lock(logMutex);
-    
+
     if (logFile.is_open()) {
         logFile << message << std::endl;
     }
-    
+
     std::cout << message << std::endl;
 }
 
@@ -5,7 +5,41 @@
 #include <iostream>
 #include <fstream>
 #include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <charconv>
+#include <sstream>
+#include <string_view>
+#include <type_traits>
+#include "TraceLog.h"
 
+/**
+ * Niveau minimum compilé: 0=DEBUG, 1=INFO, 2=WARN, 3=ERROR.
+ * Les macros LOG_* en dessous de ce niveau ne génèrent aucun code et
+ * n'évaluent pas leurs arguments. Par défaut DEBUG est retiré des builds
+ * Release (NDEBUG); surchargeable via -DLOG_COMPILE_MIN_LEVEL=n.
+ */
+#ifndef LOG_COMPILE_MIN_LEVEL
+    #ifdef NDEBUG
+        #define LOG_COMPILE_MIN_LEVEL 1
+    #else
+        #define LOG_COMPILE_MIN_LEVEL 0
+    #endif
+#endif
+
+/**
+ * Asynchronous logger
+ *
+ * The static API never blocks the caller: each thread formats its line into
+ * its own lock-free ring, and a background thread drains all rings, orders
+ * the records by time and writes them to the console and the log file in
+ * batches. When a ring is full the record is dropped and counted.
+ *
+ * Prefer the LOG_* macros: they check the level before evaluating the
+ * arguments and format lazily with "{}" placeholders, e.g.
+ *     LOG_DEBUG("Broadcasting frame {} to {} client(s)", n, count);
+ */
 class Logger {
 public:
     enum class LogLevel {
@@ -20,15 +54,135 @@ public:
     static void shutdown();
     static void log(LogLevel level, const std::string& message);
     
+    // Vérification bon marché à faire avant de construire le message
+    static bool isEnabled(LogLevel level) {
+        return level >= min_level_.load(std::memory_order_relaxed);
+    }
+
+    static void setMinLevel(LogLevel level) {
+        min_level_.store(level, std::memory_order_relaxed);
+    }
+
+    /**
+     * Minimal fmt-style formatting: each "{}" is replaced by the next
+     * argument, "{:.N}" sets the precision of a floating point argument,
+     * "{{" and "}}" are literal braces. With no arguments the text is
+     * returned unchanged.
+     */
+    static std::string format(std::string_view fmt) {
+        return std::string(fmt);
+    }
+
+    template<typename... Args>
+    static std::string format(std::string_view fmt, const Args&... args) {
+        std::string out;
+        out.reserve(fmt.size() + 16 * sizeof...(Args));
+        size_t pos = 0;
+        (formatNext(out, fmt, pos, args), ...);
+        appendLiteral(out, fmt.substr(pos));
+        return out;
+    }
+
+    /**
+     * Binary event log (see TraceLog): fixed-size records in a memory-mapped
+     * ring, decoded offline by tools/trace_decode. Closed by shutdown().
+     */
+    static bool openTrace(const std::string& path, uint64_t capacity = 1 << 18) {
+        return TraceLog::open(path, capacity);
+    }
+
+    // Quelques dizaines de ns: pas de formatage, pas de verrou
+    static void trace(TraceEvent event, uint32_t frame_number = 0, uint16_t client_id = 0,
+                      uint64_t arg0 = 0, uint64_t arg1 = 0) {
+        TraceLog::record(event, frame_number, client_id, arg0, arg1);
+    }
+
+    // Bloque jusqu'à ce que les enregistrements en attente soient écrits
+    static void flush();
+
+    // Nombre d'enregistrements perdus parce qu'un ring était plein
+    static uint64_t droppedRecords();
+
     // Méthodes d'instance (ancien style)
     Logger(const std::string& filename);
     ~Logger();
     void log(const std::string& message, LogLevel level = LogLevel::INFO);
 
 private:
-    static std::mutex mutex_;
-    static std::ofstream file_;
-    static LogLevel min_level_;
+    static std::atomic<LogLevel> min_level_;
+
+    // Copie `text` en remplaçant "{{" / "}}" par une accolade
+    static void appendLiteral(std::string& out, std::string_view text) {
+        for (size_t i = 0; i < text.size(); ++i) {
+            out.push_back(text[i]);
+            if ((text[i] == '{' || text[i] == '}') && i + 1 < text.size() && text[i + 1] == text[i]) {
+                ++i;
+            }
+        }
+    }
+
+    // Copie le texte jusqu'au prochain "{...}" puis y insère `value`
+    template<typename T>
+    static void formatNext(std::string& out, std::string_view fmt, size_t& pos, const T& value) {
+        while (pos < fmt.size()) {
+            size_t open = fmt.find('{', pos);
+            if (open == std::string_view::npos) {
+                break;
+            }
+            if (open + 1 < fmt.size() && fmt[open + 1] == '{') {
+                appendLiteral(out, fmt.substr(pos, open + 2 - pos));
+                pos = open + 2;
+                continue;
+            }
+            size_t close = fmt.find('}', open);
+            if (close == std::string_view::npos) {
+                break;
+            }
+            appendLiteral(out, fmt.substr(pos, open - pos));
+            int precision = -1;
+            std::string_view spec = fmt.substr(open + 1, close - open - 1);
+            if (spec.size() > 2 && spec[0] == ':' && spec[1] == '.') {
+                precision = 0;
+                for (size_t i = 2; i < spec.size() && spec[i] >= '0' && spec[i] <= '9'; ++i) {
+                    precision = precision * 10 + (spec[i] - '0');
+                }
+            }
+            appendValue(out, value, precision);
+            pos = close + 1;
+            return;
+        }
+        // Plus de "{}": l'argument est ajouté à la fin
+        appendLiteral(out, fmt.substr(pos));
+        pos = fmt.size();
+        out.push_back(' ');
+        appendValue(out, value, -1);
+    }
+
+    template<typename T>
+    static void appendValue(std::string& out, const T& value, int precision) {
+        if constexpr (std::is_same_v<T, bool>) {
+            out += value ? "true" : "false";
+        } else if constexpr (std::is_same_v<T, char>) {
+            out.push_back(value);
+        } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+            using U = std::conditional_t<std::is_enum_v<T>, long long, T>;
+            char buffer[24];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), static_cast<U>(value));
+            out.append(buffer, result.ptr);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            char buffer[64];
+            int n = precision >= 0
+                ? std::snprintf(buffer, sizeof(buffer), "%.*f", precision, static_cast<double>(value))
+                : std::snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(value));
+            out.append(buffer, n > 0 ? std::min<size_t>(n, sizeof(buffer) - 1) : 0);
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            out += std::string_view(value);
+        } else {
+            std::ostringstream ss;
+            ss << value;
+            out += ss.str();
+        }
+    }
     
     std::ofstream logFile;
     std::mutex logMutex;
@@ -38,10 +192,40 @@ private:
     std::string logLevelToString(LogLevel level);
 };
 
-// Macros pour faciliter l'usage
-#define LOG_DEBUG(msg) Logger::log(Logger::LogLevel::DEBUG, msg)
-#define LOG_INFO(msg) Logger::log(Logger::LogLevel::INFO, msg)
-#define LOG_WARN(msg) Logger::log(Logger::LogLevel::WARN, msg)
-#define LOG_ERROR(msg) Logger::log(Logger::LogLevel::ERROR_LEVEL, msg)
+// Macros pour faciliter l'usage: niveau vérifié avant d'évaluer les arguments
+#define LOG_AT_LEVEL(level, ...) \
+    do { \
+        if (Logger::isEnabled(level)) { \
+            Logger::log(level, Logger::format(__VA_ARGS__)); \
+        } \
+    } while (0)
+
+// Niveau retiré à la compilation: arguments vérifiés par le compilateur mais jamais évalués
+#define LOG_COMPILED_OUT(...) \
+    do { \
+        if (false) { \
+            (void)Logger::format(__VA_ARGS__); \
+        } \
+    } while (0)
+
+#if LOG_COMPILE_MIN_LEVEL <= 0
+    #define LOG_DEBUG(...) LOG_AT_LEVEL(Logger::LogLevel::DEBUG, __VA_ARGS__)
+#else
+    #define LOG_DEBUG(...) LOG_COMPILED_OUT(__VA_ARGS__)
+#endif
+
+#if LOG_COMPILE_MIN_LEVEL <= 1
+    #define LOG_INFO(...) LOG_AT_LEVEL(Logger::LogLevel::INFO, __VA_ARGS__)
+#else
+    #define LOG_INFO(...) LOG_COMPILED_OUT(__VA_ARGS__)
+#endif
+
+#if LOG_COMPILE_MIN_LEVEL <= 2
+    #define LOG_WARN(...) LOG_AT_LEVEL(Logger::LogLevel::WARN, __VA_ARGS__)
+#else
+    #define LOG_WARN(...) LOG_COMPILED_OUT(__VA_ARGS__)
+#endif
+
+#define LOG_ERROR(...) LOG_AT_LEVEL(Logger::LogLevel::ERROR_LEVEL, __VA_ARGS__)
 
-#endif // LOGGER_H
\ No newline at end of file
+#endif // LOGGER_H
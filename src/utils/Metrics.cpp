@@ -0,0 +1,268 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace MetricsDetail {
+    size_t shardIndex() {
+        static std::atomic<size_t> next{0};
+        thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+        return index;
+    }
+}
+
+namespace {
+    struct Entry {
+        MetricType type;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    using Key = std::pair<std::string, std::string>;
+
+    struct Registry {
+        std::mutex mutex;
+        std::map<Key, Entry> entries;
+
+        // Verrou distinct: un collecteur crée ou met à jour des métriques
+        std::mutex collectors_mutex;
+        std::map<int, std::function<void()>> collectors;
+        int next_collector_id = 1;
+    };
+
+    // Jamais détruit: des threads peuvent encore publier pendant la sortie
+    Registry& registry() {
+        static Registry* instance = new Registry();
+        return *instance;
+    }
+
+    Entry& findOrCreate(const std::string& name, const std::string& labels, MetricType type) {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        auto it = reg.entries.find(Key(name, labels));
+        if (it == reg.entries.end()) {
+            Entry entry;
+            entry.type = type;
+            switch (type) {
+                case MetricType::COUNTER: entry.counter = std::make_unique<Counter>(); break;
+                case MetricType::GAUGE: entry.gauge = std::make_unique<Gauge>(); break;
+                case MetricType::HISTOGRAM: entry.histogram = std::make_unique<Histogram>(); break;
+            }
+            it = reg.entries.emplace(Key(name, labels), std::move(entry)).first;
+        }
+        return it->second;
+    }
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const Shard& shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t Histogram::bucketUpperBound(size_t index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    unsigned shift = static_cast<unsigned>(index / kSubBuckets) - 1;
+    uint64_t lower = static_cast<uint64_t>(kSubBuckets + index % kSubBuckets) << shift;
+    return lower + ((uint64_t(1) << shift) - 1);
+}
+
+Histogram::Histogram() {
+    for (auto& shard : shards_) {
+        shard = std::make_unique<Shard>();
+    }
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+    HistogramSnapshot snap;
+    snap.buckets.assign(kBucketCount, 0);
+    uint64_t min = UINT64_MAX;
+    for (const auto& shard : shards_) {
+        snap.count += shard->count.load(std::memory_order_relaxed);
+        snap.sum += shard->sum.load(std::memory_order_relaxed);
+        min = std::min(min, shard->min.load(std::memory_order_relaxed));
+        snap.max = std::max(snap.max, shard->max.load(std::memory_order_relaxed));
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            snap.buckets[i] += shard->buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+    snap.min = snap.count ? min : 0;
+    return snap;
+}
+
+uint64_t HistogramSnapshot::percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    q = std::min(1.0, std::max(0.0, q));
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count) + 0.5);
+    rank = std::max<uint64_t>(1, std::min(rank, count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(Histogram::bucketUpperBound(i), max);
+        }
+    }
+    return max;
+}
+
+HistogramSnapshot HistogramSnapshot::since(const HistogramSnapshot& earlier) const {
+    HistogramSnapshot delta;
+    delta.buckets.assign(buckets.size(), 0);
+    bool first = true;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        uint64_t before = i < earlier.buckets.size() ? earlier.buckets[i] : 0;
+        uint64_t n = buckets[i] > before ? buckets[i] - before : 0;
+        if (n == 0) {
+            continue;
+        }
+        delta.buckets[i] = n;
+        delta.count += n;
+        if (first) {
+            delta.min = i == 0 ? 0 : Histogram::bucketUpperBound(i - 1) + 1;
+            first = false;
+        }
+        delta.max = std::min(Histogram::bucketUpperBound(i), max);
+    }
+    delta.sum = sum > earlier.sum ? sum - earlier.sum : 0;
+    return delta;
+}
+
+void HistogramSnapshot::merge(const HistogramSnapshot& other) {
+    if (other.count == 0) {
+        return;
+    }
+    if (buckets.size() < other.buckets.size()) {
+        buckets.resize(other.buckets.size(), 0);
+    }
+    for (size_t i = 0; i < other.buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    min = count == 0 ? other.min : std::min(min, other.min);
+    max = std::max(max, other.max);
+    count += other.count;
+    sum += other.sum;
+}
+
+Counter& Metrics::counter(const std::string& name, const std::string& labels) {
+    return *findOrCreate(name, labels, MetricType::COUNTER).counter;
+}
+
+Gauge& Metrics::gauge(const std::string& name, const std::string& labels) {
+    return *findOrCreate(name, labels, MetricType::GAUGE).gauge;
+}
+
+Histogram& Metrics::histogram(const std::string& name, const std::string& labels) {
+    return *findOrCreate(name, labels, MetricType::HISTOGRAM).histogram;
+}
+
+void Metrics::remove(const std::string& name, const std::string& labels) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.entries.erase(Key(name, labels));
+}
+
+int Metrics::addCollector(std::function<void()> collector) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.collectors_mutex);
+    int id = reg.next_collector_id++;
+    reg.collectors.emplace(id, std::move(collector));
+    return id;
+}
+
+void Metrics::removeCollector(int id) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.collectors_mutex);
+    reg.collectors.erase(id);
+}
+
+std::vector<MetricSample> Metrics::collect() {
+    Registry& reg = registry();
+    {
+        std::lock_guard<std::mutex> collectors_lock(reg.collectors_mutex);
+        for (auto& entry : reg.collectors) {
+            entry.second();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    std::vector<MetricSample> samples;
+    samples.reserve(reg.entries.size());
+    for (const auto& [key, entry] : reg.entries) {
+        MetricSample sample;
+        sample.name = key.first;
+        sample.labels = key.second;
+        sample.type = entry.type;
+        sample.value = 0;
+        switch (entry.type) {
+            case MetricType::COUNTER: sample.value = static_cast<int64_t>(entry.counter->value()); break;
+            case MetricType::GAUGE: sample.value = entry.gauge->value(); break;
+            case MetricType::HISTOGRAM: sample.histogram = entry.histogram->snapshot(); break;
+        }
+        samples.push_back(std::move(sample));
+    }
+    return samples;
+}
+
+std::string Metrics::dumpText() {
+    std::string out;
+    char line[256];
+    for (const MetricSample& sample : collect()) {
+        std::string series = sample.labels.empty() ? sample.name : sample.name + "{" + sample.labels + "}";
+        if (sample.type == MetricType::HISTOGRAM) {
+            const HistogramSnapshot& h = sample.histogram;
+            std::snprintf(line, sizeof(line),
+                          "%s count=%llu mean=%.1f p50=%llu p90=%llu p99=%llu max=%llu\n",
+                          series.c_str(), (unsigned long long)h.count, h.mean(),
+                          (unsigned long long)h.percentile(0.50), (unsigned long long)h.percentile(0.90),
+                          (unsigned long long)h.percentile(0.99), (unsigned long long)h.max);
+        } else {
+            std::snprintf(line, sizeof(line), "%s %lld\n", series.c_str(), (long long)sample.value);
+        }
+        out += line;
+    }
+    return out;
+}
+
+std::string Metrics::renderPrometheus() {
+    static const double kQuantiles[] = {0.5, 0.9, 0.99};
+
+    std::string out;
+    std::string last_name;
+    char value[64];
+    for (const MetricSample& sample : collect()) {
+        if (sample.name != last_name) {
+            const char* type = sample.type == MetricType::COUNTER ? "counter"
+                             : sample.type == MetricType::GAUGE ? "gauge" : "summary";
+            out += "# TYPE " + sample.name + " " + type + "\n";
+            last_name = sample.name;
+        }
+
+        std::string labels = sample.labels.empty() ? "" : "{" + sample.labels + "}";
+        if (sample.type != MetricType::HISTOGRAM) {
+            std::snprintf(value, sizeof(value), " %lld\n", (long long)sample.value);
+            out += sample.name + labels + value;
+            continue;
+        }
+
+        const HistogramSnapshot& h = sample.histogram;
+        std::string prefix = sample.labels.empty() ? "{" : "{" + sample.labels + ",";
+        for (double q : kQuantiles) {
+            std::snprintf(value, sizeof(value), "quantile=\"%g\"} %llu\n", q, (unsigned long long)h.percentile(q));
+            out += sample.name + prefix + value;
+        }
+        std::snprintf(value, sizeof(value), " %llu\n", (unsigned long long)h.sum);
+        out += sample.name + "_sum" + labels + value;
+        std::snprintf(value, sizeof(value), " %llu\n", (unsigned long long)h.count);
+        out += sample.name + "_count" + labels + value;
+    }
+    return out;
+}
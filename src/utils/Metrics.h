@@ -0,0 +1,204 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Metrics registry: counters, gauges and latency histograms
+ *
+ * Hot paths write to one of kShards cache-line sized shards chosen per
+ * thread, so concurrent writers rarely share a line; readers merge the
+ * shards on demand. Metric objects live until Metrics::remove() or process
+ * exit, so call sites should look them up once and keep the reference:
+ *
+ *     static Histogram& grab = Metrics::histogram("capture_grab_us");
+ *     ScopedTimer timer(grab);
+ *
+ * Labels use the Prometheus syntax without braces, e.g. "client=\"3\"".
+ */
+namespace MetricsDetail {
+    constexpr size_t kShards = 8;
+
+    // Index de shard du thread courant, attribué au premier appel
+    size_t shardIndex();
+}
+
+class Counter {
+public:
+    void inc(uint64_t n = 1) {
+        shards_[MetricsDetail::shardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Shard, MetricsDetail::kShards> shards_;
+};
+
+// Valeur instantanée: un seul atomique, la dernière écriture gagne
+class Gauge {
+public:
+    void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void add(int64_t delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+struct HistogramSnapshot {
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t min = 0;
+    uint64_t max = 0;
+    std::vector<uint64_t> buckets;
+
+    double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+
+    // Borne haute du bucket contenant le quantile q (0..1), bornée par max
+    uint64_t percentile(double q) const;
+
+    // Échantillons enregistrés depuis `earlier` (même histogramme). min/max
+    // sont approchés par les bornes des buckets extrêmes.
+    HistogramSnapshot since(const HistogramSnapshot& earlier) const;
+
+    // Cumule un autre instantané (ex: plusieurs clients)
+    void merge(const HistogramSnapshot& other);
+};
+
+/**
+ * HDR-style histogram with log-linear buckets: values below 16 are exact,
+ * above that each power of two is split into 16 sub-buckets, which bounds
+ * the relative error to 1/16 over the whole uint64 range.
+ */
+class Histogram {
+public:
+    static constexpr unsigned kSubBucketBits = 4;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static constexpr size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    static size_t bucketIndex(uint64_t value) {
+        if (value < kSubBuckets) {
+            return static_cast<size_t>(value);
+        }
+        unsigned msb = 63u - static_cast<unsigned>(countLeadingZeros(value));
+        unsigned shift = msb - kSubBucketBits;
+        size_t sub = static_cast<size_t>((value >> shift) & (kSubBuckets - 1));
+        return (shift + 1) * kSubBuckets + sub;
+    }
+
+    static uint64_t bucketUpperBound(size_t index);
+
+    Histogram();
+
+    void record(uint64_t value) {
+        Shard& shard = *shards_[MetricsDetail::shardIndex()];
+        shard.buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t current = shard.min.load(std::memory_order_relaxed);
+        while (value < current && !shard.min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+        current = shard.max.load(std::memory_order_relaxed);
+        while (value > current && !shard.max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    HistogramSnapshot snapshot() const;
+
+private:
+    static int countLeadingZeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(value);
+#else
+        int n = 0;
+        for (uint64_t bit = uint64_t(1) << 63; !(value & bit); bit >>= 1) {
+            ++n;
+        }
+        return n;
+#endif
+    }
+
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> min{UINT64_MAX};
+        std::atomic<uint64_t> max{0};
+        std::array<std::atomic<uint64_t>, kBucketCount> buckets{};
+    };
+    std::array<std::unique_ptr<Shard>, MetricsDetail::kShards> shards_;
+};
+
+// Mesure la durée de sa portée en microsecondes
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        histogram_.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_).count()));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+enum class MetricType {
+    COUNTER,
+    GAUGE,
+    HISTOGRAM
+};
+
+struct MetricSample {
+    std::string name;
+    std::string labels;
+    MetricType type;
+    int64_t value;                  // counter / gauge
+    HistogramSnapshot histogram;    // histogram only
+};
+
+class Metrics {
+public:
+    // Crée la métrique au premier appel; un même nom+labels renvoie le même objet
+    static Counter& counter(const std::string& name, const std::string& labels = "");
+    static Gauge& gauge(const std::string& name, const std::string& labels = "");
+    static Histogram& histogram(const std::string& name, const std::string& labels = "");
+
+    // Retire une série (p.ex. client déconnecté); les références deviennent invalides
+    static void remove(const std::string& name, const std::string& labels);
+
+    /**
+     * Collectors run at the start of collect() to refresh values that are
+     * too costly to keep current on the hot path (socket RTT, queue depth).
+     * removeCollector() waits for a running collector to finish.
+     */
+    static int addCollector(std::function<void()> collector);
+    static void removeCollector(int id);
+
+    // Fusionne les shards; trié par nom puis labels
+    static std::vector<MetricSample> collect();
+
+    // Résumé lisible: une ligne par série, histogrammes en p50/p90/p99/max
+    static std::string dumpText();
+
+    // Format d'exposition Prometheus; les histogrammes deviennent des summaries
+    static std::string renderPrometheus();
+};
+
+#endif // METRICS_H
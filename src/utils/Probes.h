@@ -0,0 +1,39 @@
+#ifndef PROBES_H
+#define PROBES_H
+
+/**
+ * USDT static probes (provider "screen_share")
+ *
+ * With ENABLE_USDT and <sys/sdt.h> available (systemtap-sdt-dev), each probe
+ * compiles to a single nop plus an ELF note, so bpftrace / perf can attach
+ * to a running binary; see tools/bpftrace/. Otherwise the macros expand to
+ * nothing and their arguments are not evaluated.
+ *
+ * Probes:
+ *   capture__start(x, y, width, height)
+ *   capture__end(width, height, bytes)        bytes = 0 on failure
+ *   send__start(socket, packet_type, size)
+ *   send__end(socket, packet_type, ok)
+ *   receive(packet_type, payload_size, sequence)
+ *   queue__push(queue, size_after)
+ *   queue__pop(queue, size_after)
+ */
+
+#if defined(ENABLE_USDT) && defined(__has_include)
+    #if __has_include(<sys/sdt.h>)
+        #include <sys/sdt.h>
+        #define SCREEN_SHARE_USDT 1
+    #endif
+#endif
+
+#ifdef SCREEN_SHARE_USDT
+    #define PROBE2(name, a, b) DTRACE_PROBE2(screen_share, name, a, b)
+    #define PROBE3(name, a, b, c) DTRACE_PROBE3(screen_share, name, a, b, c)
+    #define PROBE4(name, a, b, c, d) DTRACE_PROBE4(screen_share, name, a, b, c, d)
+#else
+    #define PROBE2(name, a, b) do { } while (0)
+    #define PROBE3(name, a, b, c) do { } while (0)
+    #define PROBE4(name, a, b, c, d) do { } while (0)
+#endif
+
+#endif // PROBES_H
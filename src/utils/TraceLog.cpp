@@ -0,0 +1,131 @@
+#include "TraceLog.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+std::atomic<TraceRecord*> TraceLog::records_{nullptr};
+std::atomic<uint64_t> TraceLog::write_index_{0};
+TraceFileHeader* TraceLog::header_ = nullptr;
+uint64_t TraceLog::mask_ = 0;
+
+namespace {
+    std::mutex g_trace_mutex;
+    void* g_mapping = nullptr;
+    size_t g_mapping_size = 0;
+    std::string g_path;
+#ifndef __linux__
+    // Sans mmap: tampon en mémoire, écrit dans le fichier à la fermeture
+    std::vector<char> g_heap;
+#endif
+
+    uint64_t nowNs(bool wall) {
+        if (wall) {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+        }
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+}
+
+uint32_t TraceLog::currentThreadId() {
+    thread_local uint32_t id = [] {
+#ifdef __linux__
+        return static_cast<uint32_t>(syscall(SYS_gettid));
+#else
+        return static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#endif
+    }();
+    return id;
+}
+
+bool TraceLog::open(const std::string& path, uint64_t capacity) {
+    std::lock_guard<std::mutex> lock(g_trace_mutex);
+    if (g_mapping) {
+        return true;
+    }
+
+    uint64_t rounded = 1;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    size_t size = sizeof(TraceFileHeader) + rounded * sizeof(TraceRecord);
+
+#ifdef __linux__
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "TraceLog: cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        std::cerr << "TraceLog: cannot size " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "TraceLog: mmap failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+#else
+    g_heap.assign(size, 0);
+    void* mapping = g_heap.data();
+#endif
+
+    g_mapping = mapping;
+    g_mapping_size = size;
+    g_path = path;
+
+    header_ = static_cast<TraceFileHeader*>(mapping);
+    std::memset(header_, 0, sizeof(TraceFileHeader));
+    header_->magic = TRACE_MAGIC;
+    header_->version = TRACE_VERSION;
+    header_->record_size = sizeof(TraceRecord);
+    header_->capacity = rounded;
+    header_->wall_clock_ns = nowNs(true);
+    header_->steady_clock_ns = nowNs(false);
+
+    mask_ = rounded - 1;
+    write_index_.store(0, std::memory_order_relaxed);
+    records_.store(reinterpret_cast<TraceRecord*>(static_cast<char*>(mapping) + sizeof(TraceFileHeader)),
+                   std::memory_order_release);
+    return true;
+}
+
+void TraceLog::close() {
+    std::lock_guard<std::mutex> lock(g_trace_mutex);
+    if (!g_mapping) {
+        return;
+    }
+    // Les threads instrumentés doivent être arrêtés: un écrivain en vol
+    // pourrait encore toucher la projection
+    records_.store(nullptr, std::memory_order_release);
+    header_->records_written = write_index_.load(std::memory_order_relaxed);
+
+#ifdef __linux__
+    msync(g_mapping, g_mapping_size, MS_SYNC);
+    munmap(g_mapping, g_mapping_size);
+#else
+    std::ofstream out(g_path, std::ios::binary | std::ios::trunc);
+    out.write(g_heap.data(), static_cast<std::streamsize>(g_heap.size()));
+    g_heap.clear();
+    g_heap.shrink_to_fit();
+#endif
+
+    header_ = nullptr;
+    g_mapping = nullptr;
+    g_mapping_size = 0;
+}
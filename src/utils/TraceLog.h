@@ -0,0 +1,121 @@
+#ifndef TRACELOG_H
+#define TRACELOG_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * Identifiants des événements binaires. Les valeurs sont écrites dans le
+ * fichier: ne jamais renuméroter, seulement ajouter à la fin.
+ */
+enum class TraceEvent : uint16_t {
+    CAPTURE_BEGIN = 1,
+    CAPTURE_END = 2,
+    BROADCAST_BEGIN = 3,        // arg0 = client count
+    BROADCAST_END = 4,
+    SEND_BEGIN = 5,             // arg0 = payload bytes, arg1 = packet type
+    SEND_END = 6,               // arg0 = payload bytes, arg1 = 1 on success
+    FRAME_RECEIVED = 7,         // arg0 = payload bytes
+    CLIENT_CONNECTED = 8,
+    CLIENT_DISCONNECTED = 9,
+    AUDIO_BROADCAST = 10,       // arg0 = sample count
+    CAPTURE_FAILED = 11,
+};
+
+inline const char* traceEventName(uint16_t event) {
+    switch (static_cast<TraceEvent>(event)) {
+        case TraceEvent::CAPTURE_BEGIN: return "capture_begin";
+        case TraceEvent::CAPTURE_END: return "capture_end";
+        case TraceEvent::BROADCAST_BEGIN: return "broadcast_begin";
+        case TraceEvent::BROADCAST_END: return "broadcast_end";
+        case TraceEvent::SEND_BEGIN: return "send_begin";
+        case TraceEvent::SEND_END: return "send_end";
+        case TraceEvent::FRAME_RECEIVED: return "frame_received";
+        case TraceEvent::CLIENT_CONNECTED: return "client_connected";
+        case TraceEvent::CLIENT_DISCONNECTED: return "client_disconnected";
+        case TraceEvent::AUDIO_BROADCAST: return "audio_broadcast";
+        case TraceEvent::CAPTURE_FAILED: return "capture_failed";
+        default: return "unknown";
+    }
+}
+
+#pragma pack(push, 1)
+// Enregistrement de taille fixe. `sequence` est écrit en dernier: un slot
+// dont la séquence ne correspond pas à sa position est incomplet ou écrasé.
+struct TraceRecord {
+    uint64_t timestamp_ns;      // steady_clock
+    uint32_t sequence;          // low 32 bits of (index + 1)
+    uint16_t event_id;
+    uint16_t client_id;
+    uint32_t frame_number;
+    uint32_t thread_id;
+    uint64_t arg0;
+    uint64_t arg1;
+};
+
+struct TraceFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint64_t capacity;              // records, power of two
+    uint64_t wall_clock_ns;         // system_clock at open
+    uint64_t steady_clock_ns;       // steady_clock at open
+    uint64_t records_written;       // set by close(); 0 after a crash
+    uint8_t reserved[24];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(TraceRecord) == 40, "TraceRecord layout is part of the file format");
+static_assert(sizeof(TraceFileHeader) == 64, "TraceFileHeader layout is part of the file format");
+
+constexpr uint32_t TRACE_MAGIC = 0x43525453;  // "STRC"
+constexpr uint16_t TRACE_VERSION = 1;
+
+/**
+ * Binary event log in a memory-mapped ring file
+ *
+ * record() claims a slot with one atomic increment and writes 40 bytes
+ * straight into the mapping: no lock, no formatting, no syscall. The page
+ * cache owns the data, so the last `capacity` events survive a crash; the
+ * decoder (tools/trace_decode) validates each slot by its sequence number.
+ */
+class TraceLog {
+public:
+    // capacity est arrondi à la puissance de deux supérieure
+    static bool open(const std::string& path, uint64_t capacity = 1 << 18);
+    static void close();
+    static bool isOpen() { return records_.load(std::memory_order_acquire) != nullptr; }
+
+    // Identifiant du thread courant (tid noyau sous Linux), mis en cache
+    static uint32_t currentThreadId();
+
+    static void record(TraceEvent event, uint32_t frame_number = 0, uint16_t client_id = 0,
+                       uint64_t arg0 = 0, uint64_t arg1 = 0) {
+        TraceRecord* records = records_.load(std::memory_order_acquire);
+        if (!records) {
+            return;
+        }
+        uint64_t index = write_index_.fetch_add(1, std::memory_order_relaxed);
+        TraceRecord& slot = records[index & mask_];
+        slot.timestamp_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+        slot.event_id = static_cast<uint16_t>(event);
+        slot.client_id = client_id;
+        slot.frame_number = frame_number;
+        slot.thread_id = currentThreadId();
+        slot.arg0 = arg0;
+        slot.arg1 = arg1;
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.sequence = static_cast<uint32_t>(index + 1);
+    }
+
+private:
+    static std::atomic<TraceRecord*> records_;
+    static std::atomic<uint64_t> write_index_;
+    static TraceFileHeader* header_;
+    static uint64_t mask_;
+};
+
+#endif // TRACELOG_H
@@ -0,0 +1,172 @@
+#include <iostream>
+#include "../src/threading/BoundedQueue.h"
+#include "../src/threading/SafeQueue.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "test_check.h"
+
+int main() {
+    std::cout << "=== Test BoundedQueue ===\n\n";
+
+    // Capacité arrondie à la puissance de deux
+    {
+        BoundedQueue<int> q(5);
+        check(q.capacity() == 8, "Capacité arrondie à 8");
+    }
+
+    // Reject
+    {
+        BoundedQueue<int> q(4, OverflowPolicy::Reject);
+        for (int i = 0; i < 4; ++i) q.try_push(i);
+        check(!q.try_push(99), "Reject: push refusé quand pleine");
+        check(q.try_pop() == 0, "Reject: ordre FIFO conservé");
+    }
+
+    // DropOldest
+    {
+        BoundedQueue<int> q(4, OverflowPolicy::DropOldest);
+        for (int i = 0; i < 6; ++i) q.try_push(i);
+        check(q.try_pop() == 2 && q.dropped() == 2, "DropOldest: les deux plus anciens évincés");
+    }
+
+    // ReplaceLatest
+    {
+        BoundedQueue<int> q(4, OverflowPolicy::ReplaceLatest);
+        for (int i = 0; i < 6; ++i) q.try_push(i);
+        std::vector<int> items;
+        while (auto v = q.try_pop()) items.push_back(*v);
+        check(items == std::vector<int>({0, 1, 2, 5}), "ReplaceLatest: dernier élément remplacé");
+    }
+
+    // Types move-only
+    {
+        BoundedQueue<std::unique_ptr<int>> q(2);
+        q.push(std::make_unique<int>(42));
+        auto v = q.try_pop();
+        check(v && **v == 42, "Type move-only supporté");
+    }
+
+    // Timed push / pop
+    {
+        BoundedQueue<int> q(2);
+        q.push(1);
+        q.push(2);
+        auto start = std::chrono::steady_clock::now();
+        bool pushed = q.push_for(3, std::chrono::milliseconds(50));
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        check(!pushed && elapsed >= std::chrono::milliseconds(50), "push_for expire quand pleine");
+
+        BoundedQueue<int> empty(2);
+        check(!empty.pop_for(std::chrono::milliseconds(20)), "pop_for expire quand vide");
+    }
+
+    // try_pop() réveille les producteurs bloqués (file pleine), sans pop()
+    {
+        BoundedQueue<int> q(4);
+        for (int i = 0; i < 4; ++i) q.push(i);
+        std::atomic<int> pushed{0};
+        std::vector<std::thread> producers;
+        for (int p = 0; p < 2; ++p) {
+            producers.emplace_back([&, p] {
+                if (q.push(4 + p)) pushed++;
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        check(pushed == 0, "push() bloqué quand pleine");
+
+        // Vidage uniquement par try_pop(): chaque retrait doit réveiller un producteur
+        std::vector<int> items;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (items.size() < 6 && std::chrono::steady_clock::now() < deadline) {
+            if (auto v = q.try_pop()) {
+                items.push_back(*v);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        if (items.size() < 6) {
+            q.close();      // ne pas rester bloqué au join() si la régression revient
+        }
+        for (auto& t : producers) t.join();
+        check(pushed == 2 && items.size() == 6, "try_pop() débloque push()");
+    }
+
+    // close() réveille les consommateurs bloqués
+    {
+        BoundedQueue<int> q(4);
+        std::atomic<bool> returned{false};
+        std::thread consumer([&] {
+            auto v = q.pop();
+            returned = !v.has_value();
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        q.close();
+        consumer.join();
+        check(returned, "close() débloque pop()");
+        check(!q.push(1), "push refusé après close()");
+    }
+
+    // close() draine les éléments restants
+    {
+        BoundedQueue<int> q(4);
+        q.push(7);
+        q.close();
+        check(q.pop() == 7 && !q.pop(), "pop() draine puis retourne nullopt");
+    }
+
+    // SafeQueue::wait_and_dequeue respecte close()
+    {
+        SafeQueue<int> q;
+        std::atomic<bool> returned{false};
+        std::thread consumer([&] {
+            int v = 0;
+            returned = !q.wait_and_dequeue(v);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        q.close();
+        consumer.join();
+        check(returned, "SafeQueue::wait_and_dequeue débloqué par close()");
+    }
+
+    // Stress MPMC
+    {
+        const int producers = 4;
+        const int consumers = 4;
+        const int per_producer = 100000;
+        BoundedQueue<int> q(64);
+        std::atomic<long long> sum{0};
+        std::atomic<int> count{0};
+
+        std::vector<std::thread> threads;
+        for (int c = 0; c < consumers; ++c) {
+            threads.emplace_back([&] {
+                while (auto v = q.pop()) {
+                    sum += *v;
+                    count++;
+                }
+            });
+        }
+        std::vector<std::thread> prod;
+        for (int p = 0; p < producers; ++p) {
+            prod.emplace_back([&] {
+                for (int i = 1; i <= per_producer; ++i) q.push(i);
+            });
+        }
+        for (auto& t : prod) t.join();
+        q.close();
+        for (auto& t : threads) t.join();
+
+        long long expected = (long long)producers * per_producer * (per_producer + 1) / 2;
+        check(count == producers * per_producer && sum == expected, "Stress MPMC: aucun élément perdu ni dupliqué");
+    }
+
+    if (failures == 0) {
+        std::cout << "\n✓ Tous les tests réussis!\n";
+        return 0;
+    }
+    std::cout << "\n✗ " << failures << " test(s) échoué(s)\n";
+    return 1;
+}
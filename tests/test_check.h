@@ -0,0 +1,18 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <iostream>
+
+// Vérification des tests autonomes: ✓/✗ par cas, échecs comptés dans failures
+inline int failures = 0;
+
+inline void check(bool condition, const char* what) {
+    if (condition) {
+        std::cout << "✓ " << what << "\n";
+    } else {
+        std::cout << "✗ " << what << "\n";
+        failures++;
+    }
+}
+
+#endif // TEST_CHECK_H
@@ -0,0 +1,58 @@
+#include <iostream>
+#include "../src/network/ClockSync.h"
+#include "test_check.h"
+
+int main() {
+    std::cout << "=== Test ClockSync ===\n\n";
+
+    // Serveur en avance de 1 s, trajets symétriques de 500 us
+    {
+        ClockSync sync;
+        check(!sync.hasEstimate(), "Pas d'estimation avant le premier échange");
+
+        const int64_t offset = 1000000;
+        uint64_t t0 = 10000000;
+        uint64_t t1 = t0 + 500 + offset;
+        uint64_t t2 = t1 + 200;
+        uint64_t t3 = t2 - offset + 500;
+        sync.addSample(t0, t1, t2, t3);
+        check(sync.hasEstimate(), "Estimation après un échange");
+        check(sync.offsetUs() == offset, "Offset exact pour des trajets symétriques");
+        check(sync.rttUs() == 1000, "RTT hors temps de traitement serveur");
+        check(sync.serverToLocal(t1) == t0 + 500, "Conversion horloge serveur -> client");
+    }
+
+    // Un échange retardé (file d'attente) ne doit pas dégrader l'estimation
+    {
+        ClockSync sync;
+        const int64_t offset = -250000;
+        uint64_t t = 50000000;
+        for (int i = 0; i < 20; ++i) {
+            uint64_t up = (i % 3 == 0) ? 300 : 300 + 20000;   // aller retardé
+            uint64_t down = 300;
+            uint64_t t0 = t;
+            uint64_t t1 = t0 + up + offset;
+            uint64_t t2 = t1 + 50;
+            uint64_t t3 = t2 - offset + down;
+            sync.addSample(t0, t1, t2, t3);
+            t += 2000000;
+        }
+        check(sync.offsetUs() == offset, "Échantillon de RTT minimal retenu");
+        check(sync.rttUs() == 600, "RTT minimal sur la fenêtre");
+    }
+
+    // Horodatages incohérents ignorés
+    {
+        ClockSync sync;
+        sync.addSample(1000, 2000, 1500, 3000);
+        sync.addSample(5000, 6000, 6100, 4000);
+        check(!sync.hasEstimate(), "Échantillons invalides rejetés");
+    }
+
+    if (failures == 0) {
+        std::cout << "\n✓ Tous les tests réussis!\n";
+        return 0;
+    }
+    std::cout << "\n✗ " << failures << " test(s) échoué(s)\n";
+    return 1;
+}
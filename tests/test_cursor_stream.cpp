@@ -0,0 +1,128 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
+#include "../src/network/StreamServer.h"
+#include "../src/network/StreamClient.h"
+#include "../src/network/CursorShapeCache.h"
+#include "../src/utils/Logger.h"
+#include "test_check.h"
+
+static bool waitFor(const std::function<bool()>& condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+static std::shared_ptr<const CursorImage> makeShape(uint32_t serial, uint16_t size) {
+    auto shape = std::make_shared<CursorImage>();
+    shape->serial = serial;
+    shape->width = size;
+    shape->height = size;
+    shape->xhot = 1;
+    shape->yhot = 2;
+    shape->pixels.assign(static_cast<size_t>(size) * size * 4, static_cast<uint8_t>(serial));
+    return shape;
+}
+
+static CursorPosition makePosition(int16_t x, int16_t y, uint32_t serial) {
+    CursorPosition position = {};
+    position.x = x;
+    position.y = y;
+    position.shape_serial = serial;
+    position.visible = 1;
+    position.timestamp = get_monotonic_us();
+    return position;
+}
+
+int main() {
+    std::cout << "=== Test curseur (CURSOR / CURSOR_SHAPE) ===\n\n";
+    Logger::init("test_cursor_stream.log", Logger::LogLevel::WARN);
+
+    // Cache LRU: le moins récemment utilisé sort en premier
+    {
+        CursorShapeCache cache(2);
+        cache.insert(makeShape(1, 4));
+        cache.insert(makeShape(2, 4));
+        check(cache.find(1) != nullptr, "Forme trouvée par numéro de série");
+        cache.insert(makeShape(3, 4));
+        check(cache.contains(1) && !cache.contains(2) && cache.contains(3), "Éviction du moins récemment utilisé");
+        check(cache.find(42) == nullptr, "Numéro inconnu");
+    }
+
+    const int kPort = 19321;
+    StreamServer server("127.0.0.1", kPort);
+    if (!server.start()) {
+        std::cout << "✗ Démarrage du serveur\n";
+        Logger::shutdown();
+        return 1;
+    }
+
+    std::atomic<int> callbacks{0};
+    std::atomic<bool> shape_missing{false};
+    StreamClient client("127.0.0.1", kPort);
+    client.setCursorCallback([&](const CursorPosition&, std::shared_ptr<const CursorImage> shape) {
+        if (!shape) {
+            shape_missing = true;
+        }
+        callbacks++;
+    });
+    check(client.connect(), "Connexion du client");
+    check(waitFor([&] { return server.getClientCount() == 1; }), "Client enregistré");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Forme envoyée une fois, puis seulement des positions
+    server.setCursorShape(makeShape(7, 16));
+    server.broadcastCursor(makePosition(100, 50, 7));
+    server.setCursorShape(makeShape(7, 16));
+    server.broadcastCursor(makePosition(101, 51, 7));
+    server.broadcastCursor(makePosition(102, 52, 7));
+    check(waitFor([&] { return client.getReceivedCursorUpdates() == 3; }), "Trois positions reçues");
+    check(client.getReceivedCursorShapes() == 1, "Forme envoyée une seule fois");
+
+    CursorPosition position;
+    std::shared_ptr<const CursorImage> shape;
+    check(client.getCursor(position, shape) && position.x == 102 && position.y == 52, "Dernière position");
+    check(shape && shape->serial == 7 && shape->width == 16 && shape->xhot == 1 &&
+          shape->pixels.size() == 16 * 16 * 4 && shape->pixels[0] == 7, "Forme retrouvée dans le cache du client");
+    check(!shape_missing && callbacks == 3, "Callback avec la forme");
+
+    // Retour à une forme déjà vue: pas de renvoi
+    server.setCursorShape(makeShape(8, 8));
+    server.broadcastCursor(makePosition(10, 10, 8));
+    server.setCursorShape(makeShape(7, 16));
+    server.broadcastCursor(makePosition(11, 11, 7));
+    check(waitFor([&] { return client.getReceivedCursorUpdates() == 5; }), "Changements de forme reçus");
+    check(client.getReceivedCursorShapes() == 2, "Forme déjà connue non renvoyée");
+    check(client.getCursor(position, shape) && shape && shape->serial == 7, "Forme courante après retour");
+
+    // Un nouveau client reçoit les formes en cache et la dernière position
+    StreamClient late("127.0.0.1", kPort);
+    check(late.connect(), "Connexion d'un second client");
+    check(waitFor([&] { return late.getReceivedCursorUpdates() == 1; }), "Dernière position envoyée au nouveau client");
+    check(late.getReceivedCursorShapes() == 2 && late.getCursor(position, shape) && shape &&
+          shape->serial == 7 && position.x == 11, "Formes en cache envoyées au nouveau client");
+
+    // Une frame vidéo n'est pas nécessaire pour déplacer le curseur
+    check(client.getReceivedVideoFrames() == 0, "Aucune frame vidéo envoyée");
+
+    late.disconnect();
+    client.disconnect();
+    server.stop();
+    Logger::shutdown();
+
+    if (failures == 0) {
+        std::cout << "\n✓ Tous les tests réussis!\n";
+        return 0;
+    }
+    std::cout << "\n✗ " << failures << " test(s) échoué(s)\n";
+    return 1;
+}
@@ -100,7 +100,7 @@ int main() {
             video_frame.width = 1280;
             video_frame.height = 720;
             video_frame.quality = 80;
-            video_frame.timestamp = get_timestamp_us();
+            video_frame.timestamp = get_monotonic_us();
             video_frame.data.resize(1280 * 720 * 3 / 10); // Simulated compressed data
             
             server.broadcastVideoFrame(video_frame);
@@ -0,0 +1,163 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../src/network/TileCache.h"
+#include "../src/network/StreamServer.h"
+#include "../src/network/StreamClient.h"
+#include "../src/capture/SyntheticFrameSource.h"
+#include "../src/utils/Logger.h"
+#include "../src/utils/Metrics.h"
+#include "test_check.h"
+
+static bool waitFor(const std::function<bool()>& condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+static std::vector<uint8_t> capture(SyntheticFrameSource& source) {
+    int width = 0;
+    int height = 0;
+    return source.captureFrame(width, height);
+}
+
+const int kStreamWidth = 1280;
+const int kStreamHeight = 720;
+
+static uint64_t fingerprint(const std::vector<uint8_t>& pixels) {
+    return TileCache::hashTile(pixels.data(), static_cast<size_t>(kStreamWidth) * 4, kStreamWidth, kStreamHeight);
+}
+
+// Dernière frame livrée à un client
+struct Received {
+    std::mutex mutex;
+    std::vector<uint8_t> data;
+    uint64_t timestamp = 0;
+    std::atomic<uint32_t> number{UINT32_MAX};
+
+    void record(const VideoFrame& frame) {
+        std::lock_guard<std::mutex> lock(mutex);
+        data = frame.data;
+        timestamp = frame.timestamp;
+        number = frame.frame_number;
+    }
+};
+
+int main() {
+    std::cout << "=== Test frames répétées (FRAME_REPEAT) ===\n\n";
+    Logger::init("test_frame_repeat.log", Logger::LogLevel::WARN);
+
+    SyntheticFrameSource desktop(SyntheticFrameSource::Pattern::STATIC_DESKTOP, kStreamWidth, kStreamHeight, 41);
+    SyntheticFrameSource other(SyntheticFrameSource::Pattern::STATIC_DESKTOP, kStreamWidth, kStreamHeight, 42);
+    desktop.init();
+    other.init();
+    std::vector<uint8_t> still = capture(desktop);
+    std::vector<uint8_t> changed = capture(other);
+
+    // Empreinte: même frame, même valeur; un pixel suffit à la changer
+    {
+        std::vector<uint8_t> copy = still;
+        check(fingerprint(copy) == fingerprint(still), "Empreinte identique pour une frame identique");
+        copy[(static_cast<size_t>(kStreamHeight / 2) * kStreamWidth + kStreamWidth / 2) * 4 + 1] ^= 1;
+        check(fingerprint(copy) != fingerprint(still), "Un pixel modifié change l'empreinte");
+        check(fingerprint(changed) != fingerprint(still), "Autre bureau, autre empreinte");
+    }
+
+    const int kPort = 19381;
+    StreamServer server("127.0.0.1", kPort);
+    if (!server.start()) {
+        std::cout << "✗ Démarrage du serveur\n";
+        Logger::shutdown();
+        return 1;
+    }
+
+    Received first;
+    Received second;
+    StreamClient first_client("127.0.0.1", kPort);
+    first_client.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+        first.record(frame);
+    });
+    StreamClient second_client("127.0.0.1", kPort);
+    second_client.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+        second.record(frame);
+    });
+    check(first_client.connect(), "Connexion du premier client");
+    waitFor([&] { return server.getClientCount() == 1; });
+
+    VideoFrame frame;
+    frame.width = kStreamWidth;
+    frame.height = kStreamHeight;
+    frame.quality = 80;
+    auto next = [&](uint32_t number, const std::vector<uint8_t>& pixels) {
+        frame.frame_number = number;
+        frame.timestamp = get_monotonic_us();
+        frame.data = pixels;
+    };
+
+    // Rien de diffusé: le client n'a aucune frame à réafficher
+    next(0, still);
+    check(!server.repeatVideoFrame(frame), "Pas de répétition avant la première frame");
+    server.broadcastVideoFrame(frame);
+    check(waitFor([&] { return first.number == 0; }), "Frame complète reçue");
+
+    // Frame identique: quelques octets, framebuffer réaffiché sous le nouveau numéro
+    uint64_t bytes = first_client.getBytesReceived();
+    next(1, still);
+    check(server.repeatVideoFrame(frame), "Frame identique répétée");
+    check(waitFor([&] { return first.number == 1; }), "FRAME_REPEAT livré comme une frame");
+    bytes = first_client.getBytesReceived() - bytes;
+    std::cout << "  " << bytes << " octets pour une frame répétée\n";
+    check(bytes == sizeof(PacketHeader) + sizeof(FrameRepeat), "Ni pixels ni commandes");
+    {
+        std::lock_guard<std::mutex> lock(first.mutex);
+        check(first.data == still && first.timestamp == frame.timestamp,
+              "Pixels inchangés, horodatage de la nouvelle capture");
+    }
+    check(first_client.getReceivedFrameRepeats() == 1 && first_client.getReceivedVideoFrames() == 2,
+          "Compté comme frame reçue et comme répétition");
+
+    // Nouveau client sans frame: diffusion normale pour tous
+    check(second_client.connect(), "Connexion du second client");
+    waitFor([&] { return server.getClientCount() == 2; });
+    next(2, still);
+    check(!server.repeatVideoFrame(frame), "Abonné sans la frame précédente: pas de répétition");
+    server.broadcastVideoFrame(frame);
+    check(waitFor([&] { return first.number == 2 && second.number == 2; }), "Frame diffusée aux deux clients");
+    next(3, still);
+    check(server.repeatVideoFrame(frame), "Tous à jour: frame répétée");
+    check(waitFor([&] { return first.number == 3 && second.number == 3; }), "Répétition reçue par les deux");
+
+    // Après une répétition, un FRAME_UPDATE s'applique toujours à la frame de base
+    next(4, changed);
+    server.broadcastVideoFrame(frame);
+    check(waitFor([&] { return first.number == 4 && second.number == 4; }), "Frame modifiée reçue");
+    {
+        std::lock_guard<std::mutex> lock_first(first.mutex);
+        std::lock_guard<std::mutex> lock_second(second.mutex);
+        check(first.data == changed && second.data == changed, "FRAME_UPDATE appliqué sur la frame répétée");
+    }
+    check(first_client.getReceivedFrameUpdates() > 0 && first_client.getDroppedFrameUpdates() == 0 &&
+          second_client.getDroppedFrameUpdates() == 0, "Aucune mise à jour ignorée");
+    check(Metrics::counter("frame_repeats_total").value() == 3, "frame_repeats_total");
+
+    first_client.disconnect();
+    second_client.disconnect();
+    server.stop();
+    Logger::shutdown();
+
+    if (failures == 0) {
+        std::cout << "\n✓ Tous les tests réussis!\n";
+        return 0;
+    }
+    std::cout << "\n✗ " << failures << " test(s) échoué(s)\n";
+    return 1;
+}
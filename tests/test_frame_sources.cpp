@@ -0,0 +1,143 @@
+#include <iostream>
+#include "../src/capture/SyntheticFrameSource.h"
+#include "../src/capture/FileReplaySource.h"
+#include "../src/utils/Logger.h"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include "test_check.h"
+
+int main() {
+    std::cout << "=== Test FrameSource ===\n\n";
+    Logger::init("test_frame_sources.log", Logger::LogLevel::WARN);
+
+    const int kWidth = 320;
+    const int kHeight = 200;
+    const size_t kFrameBytes = static_cast<size_t>(kWidth) * kHeight * 4;
+
+    // Même motif, même graine: mêmes frames
+    {
+        SyntheticFrameSource a(SyntheticFrameSource::Pattern::VIDEO_NOISE, kWidth, kHeight, 42);
+        SyntheticFrameSource b(SyntheticFrameSource::Pattern::VIDEO_NOISE, kWidth, kHeight, 42);
+        SyntheticFrameSource c(SyntheticFrameSource::Pattern::VIDEO_NOISE, kWidth, kHeight, 43);
+        check(a.init() && b.init() && c.init(), "Initialisation des sources synthétiques");
+
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> a0 = a.captureFrame(width, height);
+        check(width == kWidth && height == kHeight && a0.size() == kFrameBytes, "Dimensions et taille ARGB");
+        check(a0 == b.captureFrame(width, height), "Génération déterministe");
+        check(a0 != c.captureFrame(width, height), "La graine change le contenu");
+
+        std::vector<uint8_t> a1 = a.captureFrame(width, height);
+        check(a1 != a0, "Le bruit vidéo change à chaque frame");
+
+        a.setFrameIndex(0);
+        check(a.captureFrame(width, height) == a0, "setFrameIndex(0) rejoue la séquence");
+
+        bool opaque = true;
+        for (size_t i = 0; i < a0.size(); i += 4) {
+            opaque = opaque && a0[i] == 0xFF;
+        }
+        check(opaque, "Alpha opaque");
+    }
+
+    // Bureau statique: frames identiques
+    {
+        SyntheticFrameSource source(SyntheticFrameSource::Pattern::STATIC_DESKTOP, kWidth, kHeight);
+        source.init();
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> first = source.captureFrame(width, height);
+        check(first == source.captureFrame(width, height), "Bureau statique inchangé d'une frame à l'autre");
+    }
+
+    // Texte: la frame N+1 est la frame N décalée de scroll_step lignes
+    {
+        const int kStep = 3;
+        SyntheticFrameSource source(SyntheticFrameSource::Pattern::SCROLLING_TEXT, kWidth, kHeight);
+        source.setScrollStep(kStep);
+        source.init();
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> f0 = source.captureFrame(width, height);
+        std::vector<uint8_t> f1 = source.captureFrame(width, height);
+        size_t row_bytes = static_cast<size_t>(kWidth) * 4;
+        check(std::memcmp(f0.data() + kStep * row_bytes, f1.data(), (kHeight - kStep) * row_bytes) == 0,
+              "Défilement de scroll_step lignes");
+        check(f0 != f1, "Le texte défile");
+    }
+
+    // Taille invalide refusée
+    {
+        SyntheticFrameSource source(SyntheticFrameSource::Pattern::STATIC_DESKTOP, 0, kHeight);
+        check(!source.init() && !source.getLastError().empty(), "Taille invalide refusée");
+
+        SyntheticFrameSource::Pattern pattern;
+        check(SyntheticFrameSource::parsePattern("scroll", pattern) &&
+              pattern == SyntheticFrameSource::Pattern::SCROLLING_TEXT, "parsePattern(\"scroll\")");
+        check(!SyntheticFrameSource::parsePattern("plasma", pattern), "Motif inconnu refusé");
+    }
+
+    // Relecture: frames dans l'ordre, puis en boucle
+    {
+        const char* path = "test_frame_sources.raw";
+        std::remove(path);
+        SyntheticFrameSource generator(SyntheticFrameSource::Pattern::VIDEO_NOISE, kWidth, kHeight, 7);
+        generator.init();
+        int width = 0;
+        int height = 0;
+        std::vector<std::vector<uint8_t>> frames;
+        for (int i = 0; i < 3; ++i) {
+            frames.push_back(generator.captureFrame(width, height));
+            FileReplaySource::appendFrame(path, frames.back());
+        }
+
+        {
+            FileReplaySource replay(path, kWidth, kHeight);
+            check(replay.init() && replay.frameCount() == 3, "Fichier de 3 frames");
+            bool same = true;
+            for (int i = 0; i < 3; ++i) {
+                same = same && replay.captureFrame(width, height) == frames[i];
+            }
+            check(same, "Frames relues dans l'ordre");
+            check(replay.captureFrame(width, height) == frames[0], "Reprise au début en boucle");
+        }
+        {
+            FileReplaySource once(path, kWidth, kHeight, false);
+            once.init();
+            for (int i = 0; i < 3; ++i) {
+                once.captureFrame(width, height);
+            }
+            check(once.captureFrame(width, height).empty(), "Fin de fichier sans boucle");
+        }
+        {
+            FileReplaySource wrong(path, kWidth + 1, kHeight);
+            check(!wrong.init(), "Taille de frame incompatible refusée");
+        }
+        {
+            FileReplaySource missing("does_not_exist.raw", kWidth, kHeight);
+            check(!missing.init(), "Fichier absent refusé");
+        }
+        std::remove(path);
+    }
+
+    // Utilisable derrière l'interface
+    {
+        std::unique_ptr<FrameSource> source =
+            std::make_unique<SyntheticFrameSource>(SyntheticFrameSource::Pattern::SCROLLING_TEXT, 64, 48);
+        int width = 0;
+        int height = 0;
+        check(source->init() && source->name() == "synthetic:scroll" &&
+              source->captureFrame(width, height).size() == 64 * 48 * 4, "Appel via FrameSource");
+    }
+
+    Logger::shutdown();
+
+    if (failures == 0) {
+        std::cout << "\n✓ Tous les tests réussis!\n";
+        return 0;
+    }
+    std::cout << "\n✗ " << failures << " test(s) échoué(s)\n";
+    return 1;
+}
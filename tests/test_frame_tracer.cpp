@@ -0,0 +1,85 @@
+#include <iostream>
+#include "../src/utils/FrameTracer.h"
+#include <string>
+#include <thread>
+#include <vector>
+#include "test_check.h"
+
+static size_t countOf(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+int main() {
+    std::cout << "=== Test FrameTracer ===\n\n";
+
+    // Les spans imbriqués héritent du numéro de frame
+    {
+        FrameTracer::clear();
+        {
+            FrameSpan frame("frame", 42);
+            FrameSpan inner("capture");
+        }
+        std::string json = FrameTracer::toChromeJson();
+        check(countOf(json, "\"name\":\"capture\"") == 1 &&
+              countOf(json, "\"frame\":42") == 2, "Span imbriqué rattaché à la frame 42");
+        check(json.find("\"ph\":\"X\"") != std::string::npos, "Événements complets (ph=X)");
+    }
+
+    // Hors d'une frame, un span sans numéro n'est pas enregistré
+    {
+        FrameTracer::clear();
+        { FrameSpan orphan("socket_write"); }
+        check(countOf(FrameTracer::toChromeJson(), "\"name\"") == 0, "Span orphelin ignoré");
+    }
+
+    // end() termine le span et restaure le contexte
+    {
+        FrameTracer::clear();
+        FrameSpan send("send", 7, 3);
+        send.end();
+        { FrameSpan after("socket_write"); }
+        std::string json = FrameTracer::toChromeJson();
+        check(countOf(json, "\"client\":3") == 1 && countOf(json, "\"name\"") == 1, "end() restaure le contexte");
+    }
+
+    // Désactivation
+    {
+        FrameTracer::clear();
+        FrameTracer::setEnabled(false);
+        { FrameSpan frame("frame", 1); }
+        FrameTracer::setEnabled(true);
+        check(countOf(FrameTracer::toChromeJson(), "\"name\"") == 0, "Aucun span quand désactivé");
+    }
+
+    // Plusieurs threads, anneau plein: export toujours cohérent
+    {
+        FrameTracer::clear();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([t] {
+                for (uint32_t i = 0; i < FrameTracer::kCapacity / 2; ++i) {
+                    FrameSpan span("stress", i, static_cast<uint16_t>(t));
+                }
+            });
+        }
+        std::string json;
+        for (int i = 0; i < 5; ++i) {
+            json = FrameTracer::toChromeJson();
+        }
+        for (auto& th : threads) th.join();
+        json = FrameTracer::toChromeJson();
+        check(countOf(json, "\"name\":\"stress\"") == FrameTracer::kCapacity, "Anneau plein: kCapacity spans exportés");
+        check(FrameTracer::dumpToFile("test_frames.json"), "Écriture du fichier JSON");
+    }
+
+    if (failures == 0) {
+        std::cout << "\n✓ Tous les tests réussis!\n";
+        return 0;
+    }
+    std::cout << "\n✗ " << failures << " test(s) échoué(s)\n";
+    return 1;
+}
@@ -0,0 +1,231 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../src/network/FrameDelta.h"
+#include "../src/network/PixelPacker.h"
+#include "../src/network/StreamServer.h"
+#include "../src/network/StreamClient.h"
+#include "../src/capture/SyntheticFrameSource.h"
+#include "../src/utils/Logger.h"
+#include "test_check.h"
+
+static bool waitFor(const std::function<bool()>& condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+// Applique les commandes à previous comme le client, pixels pris dans current
+static std::vector<uint8_t> replay(const std::vector<uint8_t>& previous, const std::vector<uint8_t>& current,
+                                   int width, const std::vector<UpdateCommand>& commands, size_t& raw_pixels) {
+    std::vector<uint8_t> result = previous;
+    raw_pixels = 0;
+    for (const UpdateCommand& command : commands) {
+        if (command.type == static_cast<uint8_t>(UpdateCommandType::COPY_RECT)) {
+            FrameDelta::applyCopy(result.data(), width, 4, command);
+            continue;
+        }
+        for (int row = 0; row < command.height; ++row) {
+            size_t offset = ((static_cast<size_t>(command.y) + row) * width + command.x) * 4;
+            memcpy(result.data() + offset, current.data() + offset, static_cast<size_t>(command.width) * 4);
+        }
+        raw_pixels += static_cast<size_t>(command.width) * command.height;
+    }
+    return result;
+}
+
+static bool hasCopy(const std::vector<UpdateCommand>& commands, int dx, int dy) {
+    return !commands.empty() && commands.front().type == static_cast<uint8_t>(UpdateCommandType::COPY_RECT) &&
+           commands.front().src_x - commands.front().x == dx && commands.front().src_y - commands.front().y == dy;
+}
+
+static std::vector<uint8_t> capture(SyntheticFrameSource& source) {
+    int width = 0;
+    int height = 0;
+    return source.captureFrame(width, height);
+}
+
+int main() {
+    std::cout << "=== Test mises à jour incrémentales (défilement) ===\n\n";
+    Logger::init("test_frame_update.log", Logger::LogLevel::WARN);
+
+    const int kWidth = 320;
+    const int kHeight = 240;
+    SyntheticFrameSource text(SyntheticFrameSource::Pattern::SCROLLING_TEXT, kWidth, kHeight, 7);
+    text.init();
+    std::vector<uint8_t> frame0 = capture(text);
+    std::vector<uint8_t> frame1 = capture(text);
+
+    // Défilement vers le haut de 4 lignes (scroll_step par défaut)
+    {
+        std::vector<UpdateCommand> commands = FrameDelta::compute(frame0.data(), frame1.data(), kWidth, kHeight);
+        size_t raw_pixels = 0;
+        check(hasCopy(commands, 0, 4), "Défilement vertical détecté (dy = 4)");
+        check(replay(frame0, frame1, kWidth, commands, raw_pixels) == frame1, "Frame reconstruite à l'identique");
+        check(raw_pixels <= static_cast<size_t>(kWidth) * 4, "Seule la bande découverte est envoyée");
+    }
+
+    // Sens inverse: copie vers le bas, source et destination se chevauchent
+    {
+        std::vector<UpdateCommand> commands = FrameDelta::compute(frame1.data(), frame0.data(), kWidth, kHeight);
+        size_t raw_pixels = 0;
+        check(hasCopy(commands, 0, -4), "Défilement vers le bas détecté (dy = -4)");
+        check(replay(frame1, frame0, kWidth, commands, raw_pixels) == frame0, "Copie chevauchante reconstruite");
+    }
+
+    // Défilement horizontal d'une zone de 200 colonnes, le reste immobile
+    {
+        std::vector<uint8_t> shifted = frame0;
+        const int dx = 6;
+        for (int y = 0; y < kHeight; ++y) {
+            uint8_t* row = shifted.data() + static_cast<size_t>(y) * kWidth * 4;
+            memmove(row + 40 * 4, row + (40 + dx) * 4, (200 - dx) * 4);
+            for (int x = 240 - dx; x < 240; ++x) {
+                row[x * 4 + 1] = static_cast<uint8_t>(x * 7 + y);
+            }
+        }
+        std::vector<UpdateCommand> commands = FrameDelta::compute(frame0.data(), shifted.data(), kWidth, kHeight);
+        size_t raw_pixels = 0;
+        check(hasCopy(commands, dx, 0), "Défilement horizontal détecté (dx = 6)");
+        check(replay(frame0, shifted, kWidth, commands, raw_pixels) == shifted, "Zone horizontale reconstruite");
+    }
+
+    // Frame identique: aucune commande; bruit: pas de copie, mais exact
+    {
+        check(FrameDelta::compute(frame0.data(), frame0.data(), kWidth, kHeight).empty(), "Frame inchangée: aucune commande");
+
+        SyntheticFrameSource noise(SyntheticFrameSource::Pattern::VIDEO_NOISE, kWidth, kHeight, 7);
+        noise.init();
+        std::vector<uint8_t> a = capture(noise);
+        std::vector<uint8_t> b = capture(noise);
+        std::vector<UpdateCommand> commands = FrameDelta::compute(a.data(), b.data(), kWidth, kHeight);
+        size_t raw_pixels = 0;
+        check(commands.empty() || commands.front().type != static_cast<uint8_t>(UpdateCommandType::COPY_RECT),
+              "Bruit: aucun défilement inventé");
+        check(replay(a, b, kWidth, commands, raw_pixels) == b, "Bruit: frame reconstruite");
+    }
+
+    // Commandes hors de la frame refusées
+    {
+        UpdateCommand copy = {static_cast<uint8_t>(UpdateCommandType::COPY_RECT), 0, 0, 10, 10, 315, 0};
+        UpdateCommand raw = {static_cast<uint8_t>(UpdateCommandType::RAW_RECT), 310, 230, 10, 10, 0, 0};
+        check(!FrameDelta::fits(copy, kWidth, kHeight) && FrameDelta::fits(raw, kWidth, kHeight),
+              "Validation des rectangles");
+    }
+
+    // Bout en bout: un client ARGB et un client RGB565 reconstruisent chaque frame
+    {
+        const int kPort = 19341;
+        const int kStreamWidth = 1280;
+        const int kStreamHeight = 720;
+        const int kFrames = 20;
+        StreamServer server("127.0.0.1", kPort);
+        if (!server.start()) {
+            std::cout << "✗ Démarrage du serveur\n";
+            Logger::shutdown();
+            return 1;
+        }
+
+        std::mutex mutex;
+        std::vector<uint8_t> expected_argb;
+        std::vector<uint8_t> expected_565;
+        std::atomic<uint32_t> argb_number(UINT32_MAX);
+        std::atomic<uint32_t> low_number(UINT32_MAX);
+        std::atomic<uint32_t> low_565_number(UINT32_MAX);
+        std::atomic<int> mismatches(0);
+
+        auto matches = [&](const VideoFrame& frame) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return frame.data == (frame.format == PixelFormat::RGB565 ? expected_565 : expected_argb);
+        };
+        StreamClient argb_client("127.0.0.1", kPort);
+        argb_client.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+            if (!matches(frame)) mismatches++;
+            argb_number = frame.frame_number;
+        });
+        StreamClient low_client("127.0.0.1", kPort);
+        low_client.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+            if (!matches(frame)) mismatches++;
+            if (frame.format == PixelFormat::RGB565) low_565_number = frame.frame_number;
+            low_number = frame.frame_number;
+        });
+        check(argb_client.connect() && low_client.connect(), "Connexion des deux clients");
+        check(low_client.setPixelFormat(PixelFormat::RGB565), "CONFIG RGB565 envoyé");
+
+        SyntheticFrameSource source(SyntheticFrameSource::Pattern::SCROLLING_TEXT, kStreamWidth, kStreamHeight, 3);
+        source.init();
+        VideoFrame frame;
+        frame.width = kStreamWidth;
+        frame.height = kStreamHeight;
+        frame.quality = 80;
+
+        auto broadcast = [&](uint32_t number) {
+            frame.frame_number = number;
+            frame.timestamp = get_monotonic_us();
+            frame.data = capture(source);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                expected_argb = frame.data;
+                expected_565.resize(PixelPacker::packedSize(PixelFormat::RGB565, kStreamWidth, kStreamHeight));
+                PixelPacker::pack(PixelFormat::RGB565, frame.data.data(),
+                                  static_cast<size_t>(kStreamWidth) * kStreamHeight, expected_565.data());
+            }
+            server.broadcastVideoFrame(frame);
+            return waitFor([&] { return argb_number == number && low_number == number; });
+        };
+
+        // Le CONFIG est traité par le thread du client côté serveur
+        uint32_t number = 0;
+        check(waitFor([&] {
+            uint32_t sent = number++;
+            return broadcast(sent) && low_565_number == sent;
+        }), "Première frame reçue dans chaque format");
+
+        uint64_t argb_bytes = argb_client.getBytesReceived();
+        uint64_t low_bytes = low_client.getBytesReceived();
+        bool all_received = true;
+        for (int i = 0; i < kFrames; ++i) {
+            all_received = all_received && broadcast(number++);
+        }
+        argb_bytes = argb_client.getBytesReceived() - argb_bytes;
+        low_bytes = low_client.getBytesReceived() - low_bytes;
+
+        check(all_received, "Toutes les frames défilées reçues");
+        check(mismatches == 0, "Chaque frame reconstruite à l'identique (ARGB et RGB565)");
+        check(argb_client.getReceivedFrameUpdates() >= static_cast<uint64_t>(kFrames) &&
+              low_client.getReceivedFrameUpdates() >= static_cast<uint64_t>(kFrames),
+              "Frames envoyées en FRAME_UPDATE");
+        check(argb_client.getDroppedFrameUpdates() == 0 && low_client.getDroppedFrameUpdates() == 0,
+              "Aucune mise à jour ignorée");
+
+        uint64_t per_frame = argb_bytes / kFrames;
+        std::cout << "  ARGB: " << per_frame << " octets/frame (frame complète: "
+                  << PixelPacker::packedSize(PixelFormat::ARGB8888, kStreamWidth, kStreamHeight)
+                  << "), RGB565: " << low_bytes / kFrames << " octets/frame\n";
+        check(per_frame < 64 * 1024, "Défilement: quelques kilo-octets par frame");
+        check(low_bytes < argb_bytes, "RGB565: bande découverte deux fois plus petite");
+
+        argb_client.disconnect();
+        low_client.disconnect();
+        server.stop();
+    }
+
+    Logger::shutdown();
+
+    if (failures == 0) {
+        std::cout << "\n✓ Tous les tests réussis!\n";
+        return 0;
+    }
+    std::cout << "\n✗ " << failures << " test(s) échoué(s)\n";
+    return 1;
+}
@@ -1,23 +1,92 @@
-#include <iostream>
-#include "../src/utils/Logger.h"
-
-int main() {
-    std::cout << "=== Test Logger Minimal ===\n";
-    
-    try {
-        Logger::init("test.log");
-        
-        LOG_INFO("Test INFO message");
-        LOG_WARN("Test WARN message");
-        LOG_ERROR("Test ERROR message");
-        
-        std::cout << "✓ Logger fonctionne!\n";
-        
-        Logger::shutdown();
-        return 0;
-        
-    } catch (const std::exception& e) {
-        std::cerr << "✗ Erreur: " << e.what() << std::endl;
-        return 1;
-    }
-}
+#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/utils/Logger.h"
+
+int main() {
+    std::cout << "=== Test Logger Minimal ===\n";
+    
+    try {
+        Logger::init("test.log");
+        
+        LOG_INFO("Test INFO message");
+        LOG_WARN("Test WARN message");
+        LOG_ERROR("Test ERROR message");
+        LOG_INFO("Frame {} envoyée à {} client(s)", 42, 3);
+        
+        std::cout << "✓ Logger fonctionne!\n";
+
+        // Formatage paresseux style fmt
+        if (Logger::format("{}x{} @ {:.1} ms {{ok}}", 1280, 720, 16.67) != "1280x720 @ 16.7 ms {ok}") {
+            std::cerr << "✗ Erreur: formatage incorrect: " << Logger::format("{}x{} @ {:.1} ms {{ok}}", 1280, 720, 16.67) << "\n";
+            Logger::shutdown();
+            return 1;
+        }
+        std::cout << "✓ Formatage {} correct\n";
+
+        // Les arguments ne sont pas évalués sous le niveau minimum
+        int evaluated = 0;
+        auto expensive = [&evaluated]() { evaluated++; return std::string("coûteux"); };
+        LOG_DEBUG("Debug: {}", expensive());
+        if (evaluated != 0) {
+            std::cerr << "✗ Erreur: arguments évalués alors que DEBUG est désactivé\n";
+            Logger::shutdown();
+            return 1;
+        }
+        std::cout << "✓ Arguments non évalués sous le niveau minimum\n";
+
+        // Écrivain inactif: réveillé par le premier enregistrement, sans
+        // attendre un délai ni flush()
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        LOG_INFO("Réveil de l'écrivain");
+        bool written = false;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (!written && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            std::ifstream log("test.log");
+            std::string line;
+            while (std::getline(log, line)) {
+                written = written || line.find("Réveil de l'écrivain") != std::string::npos;
+            }
+        }
+        if (!written) {
+            std::cerr << "✗ Erreur: enregistrement non écrit par l'écrivain inactif\n";
+            Logger::shutdown();
+            return 1;
+        }
+        std::cout << "✓ Écrivain inactif réveillé par un enregistrement\n";
+
+        // Journal binaire: 8 slots, 10 événements -> les 8 derniers restent
+        if (!Logger::openTrace("test.trace", 8)) {
+            std::cerr << "✗ Erreur: ouverture de test.trace impossible\n";
+            Logger::shutdown();
+            return 1;
+        }
+        for (uint32_t i = 0; i < 10; ++i) {
+            Logger::trace(TraceEvent::SEND_BEGIN, i, 7, i * 100, 2);
+        }
+        Logger::shutdown();
+
+        std::ifstream trace("test.trace", std::ios::binary);
+        TraceFileHeader header{};
+        std::vector<TraceRecord> slots(8);
+        trace.read(reinterpret_cast<char*>(&header), sizeof(header));
+        trace.read(reinterpret_cast<char*>(slots.data()), slots.size() * sizeof(TraceRecord));
+        bool trace_ok = trace && header.magic == TRACE_MAGIC && header.records_written == 10 &&
+                        slots[0].sequence == 9 && slots[0].frame_number == 8 &&
+                        slots[1].sequence == 10 && slots[1].arg0 == 900 && slots[1].client_id == 7;
+        if (!trace_ok) {
+            std::cerr << "✗ Erreur: contenu de test.trace incorrect\n";
+            return 1;
+        }
+        std::cout << "✓ Journal binaire circulaire correct\n";
+        return 0;
+        
+    } catch (const std::exception& e) {
+        std::cerr << "✗ Erreur: " << e.what() << std::endl;
+        return 1;
+    }
+}
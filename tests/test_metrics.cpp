@@ -0,0 +1,142 @@
+#include <iostream>
+#include "../src/utils/Metrics.h"
+#include <thread>
+#include <vector>
+#include "test_check.h"
+
+int main() {
+    std::cout << "=== Test Metrics ===\n\n";
+
+    // Buckets log-linéaires: exacts sous 16, erreur relative <= 1/16 au-delà
+    {
+        bool exact = true;
+        for (uint64_t v = 0; v < 16; ++v) {
+            exact = exact && Histogram::bucketUpperBound(Histogram::bucketIndex(v)) == v;
+        }
+        check(exact, "Valeurs < 16 exactes");
+
+        bool bounded = true;
+        bool monotonic = true;
+        size_t previous = 0;
+        for (uint64_t v = 16; v < 10000000; v = v * 5 / 4 + 1) {
+            size_t index = Histogram::bucketIndex(v);
+            uint64_t upper = Histogram::bucketUpperBound(index);
+            bounded = bounded && upper >= v && (upper - v) * 16 <= v;
+            monotonic = monotonic && index >= previous;
+            previous = index;
+        }
+        check(bounded, "Borne haute du bucket à moins de 1/16 de la valeur");
+        check(monotonic, "Index de bucket croissant");
+        check(Histogram::bucketIndex(UINT64_MAX) == Histogram::kBucketCount - 1, "UINT64_MAX dans le dernier bucket");
+    }
+
+    // Percentiles
+    {
+        Histogram& h = Metrics::histogram("test_latency_us");
+        for (uint64_t v = 1; v <= 1000; ++v) {
+            h.record(v);
+        }
+        HistogramSnapshot snap = h.snapshot();
+        uint64_t p50 = snap.percentile(0.5);
+        uint64_t p99 = snap.percentile(0.99);
+        check(snap.count == 1000 && snap.min == 1 && snap.max == 1000, "count/min/max corrects");
+        check(p50 >= 500 && p50 <= 532, "p50 ~ 500");
+        check(p99 >= 990 && p99 <= 1000, "p99 ~ 990");
+        check(snap.mean() > 500.0 && snap.mean() < 501.0, "Moyenne exacte");
+
+    }
+
+    // Fenêtre depuis un instantané précédent
+    {
+        Histogram h;
+        for (uint64_t v = 1; v <= 1000; ++v) {
+            h.record(v);
+        }
+        HistogramSnapshot before = h.snapshot();
+        for (uint64_t v = 0; v < 100; ++v) {
+            h.record(5000);
+        }
+        HistogramSnapshot window = h.snapshot().since(before);
+        check(window.count == 100 && window.sum == 500000, "since(): count et sum de la fenêtre");
+        check(window.percentile(0.5) >= 5000 && window.percentile(0.5) <= 5120, "since(): p50 de la fenêtre seule");
+        check(window.min <= 5000 && window.max >= 5000, "since(): min/max encadrent les valeurs");
+        check(h.snapshot().since(h.snapshot()).count == 0, "since(): fenêtre vide");
+
+        HistogramSnapshot merged;
+        merged.merge(before);
+        merged.merge(window);
+        HistogramSnapshot all = h.snapshot();
+        check(merged.count == all.count && merged.sum == all.sum && merged.min == 1
+              && merged.percentile(0.99) == all.percentile(0.99), "merge(): cumul des instantanés");
+    }
+
+    // Registre: même nom + labels -> même objet
+    {
+        Counter& a = Metrics::counter("test_bytes_total", "client=\"1\"");
+        Counter& b = Metrics::counter("test_bytes_total", "client=\"1\"");
+        Counter& c = Metrics::counter("test_bytes_total", "client=\"2\"");
+        check(&a == &b && &a != &c, "Séries distinguées par labels");
+
+        Metrics::gauge("test_depth").set(42);
+        bool found = false;
+        for (const MetricSample& sample : Metrics::collect()) {
+            found = found || (sample.name == "test_depth" && sample.value == 42);
+        }
+        check(found, "collect() expose la jauge");
+
+        Metrics::remove("test_bytes_total", "client=\"2\"");
+        bool removed = true;
+        for (const MetricSample& sample : Metrics::collect()) {
+            removed = removed && !(sample.name == "test_bytes_total" && sample.labels == "client=\"2\"");
+        }
+        check(removed, "remove() retire la série");
+    }
+
+    // Écritures concurrentes fusionnées à la lecture
+    {
+        Counter& counter = Metrics::counter("test_concurrent_total");
+        Histogram& histogram = Metrics::histogram("test_concurrent_us");
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < 100000; ++i) {
+                    counter.inc();
+                    histogram.record(static_cast<uint64_t>(i % 100));
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        check(counter.value() == 800000, "Compteur: 8 threads x 100000");
+        check(histogram.snapshot().count == 800000, "Histogramme: 8 threads x 100000");
+    }
+
+    // Collecteurs et format Prometheus
+    {
+        int calls = 0;
+        int id = Metrics::addCollector([&calls] {
+            calls++;
+            Metrics::gauge("test_rtt_us", "client=\"1\"").set(250);
+        });
+        std::string text = Metrics::renderPrometheus();
+        Metrics::removeCollector(id);
+        Metrics::collect();
+
+        check(calls == 1, "Collecteur appelé une fois par collecte");
+        check(text.find("# TYPE test_rtt_us gauge\ntest_rtt_us{client=\"1\"} 250\n") != std::string::npos,
+              "Jauge exposée avec ses labels");
+        check(text.find("# TYPE test_latency_us summary") != std::string::npos &&
+              text.find("test_latency_us{quantile=\"0.99\"} ") != std::string::npos &&
+              text.find("test_latency_us_count 1000\n") != std::string::npos,
+              "Histogramme exposé en summary");
+        check(text.find("test_bytes_total{client=\"1\"} 0\n") != std::string::npos, "Compteur exposé");
+    }
+
+    std::cout << "\n" << Metrics::dumpText();
+
+    if (failures == 0) {
+        std::cout << "\n✓ Tous les tests réussis!\n";
+        return 0;
+    }
+    std::cout << "\n✗ " << failures << " test(s) échoué(s)\n";
+    return 1;
+}
@@ -0,0 +1,150 @@
+#include <iostream>
+#include "../src/capture/PixelConverter.h"
+#include <cstring>
+#include <vector>
+#include "test_check.h"
+
+namespace {
+    struct Color {
+        uint8_t r, g, b;
+    };
+
+    // Couleurs exactes en RGB565 (canaux 5/6 bits répliqués)
+    const Color kColors[] = {
+        {0xFF, 0x00, 0x00}, {0x00, 0xFF, 0x00}, {0x00, 0x00, 0xFF},
+        {0xFF, 0xFF, 0xFF}, {0x00, 0x00, 0x00}, {0x84, 0x82, 0x10},
+    };
+    const int kColorCount = sizeof(kColors) / sizeof(kColors[0]);
+
+    // Pixel encodé tel qu'un XImage LSBFirst le stocke
+    void encode(SourceFormat format, const Color& c, uint8_t* p) {
+        switch (format) {
+            case SourceFormat::XRGB8888: p[0] = c.b; p[1] = c.g; p[2] = c.r; p[3] = 0x5A; break;
+            case SourceFormat::XBGR8888: p[0] = c.r; p[1] = c.g; p[2] = c.b; p[3] = 0x5A; break;
+            case SourceFormat::RGB888:   p[0] = c.b; p[1] = c.g; p[2] = c.r; break;
+            case SourceFormat::BGR888:   p[0] = c.r; p[1] = c.g; p[2] = c.b; break;
+            case SourceFormat::RGB565: {
+                uint16_t v = static_cast<uint16_t>(((c.r >> 3) << 11) | ((c.g >> 2) << 5) | (c.b >> 3));
+                p[0] = static_cast<uint8_t>(v);
+                p[1] = static_cast<uint8_t>(v >> 8);
+                break;
+            }
+            case SourceFormat::UNKNOWN: break;
+        }
+    }
+
+    int bytesPerPixel(SourceFormat format) {
+        switch (format) {
+            case SourceFormat::XRGB8888:
+            case SourceFormat::XBGR8888: return 4;
+            case SourceFormat::RGB888:
+            case SourceFormat::BGR888:   return 3;
+            case SourceFormat::RGB565:   return 2;
+            case SourceFormat::UNKNOWN:  break;
+        }
+        return 0;
+    }
+
+    // Image de width x height couleurs kColors, lignes bourrées comme XGetImage
+    std::vector<uint8_t> makeImage(SourceFormat format, int width, int height, size_t& stride) {
+        stride = (static_cast<size_t>(width) * bytesPerPixel(format) + 7) & ~static_cast<size_t>(7);
+        std::vector<uint8_t> image(stride * height, 0xEE);
+        for (int row = 0; row < height; ++row) {
+            for (int col = 0; col < width; ++col) {
+                encode(format, kColors[(row * width + col) % kColorCount],
+                       image.data() + row * stride + col * bytesPerPixel(format));
+            }
+        }
+        return image;
+    }
+
+    bool convertsExactly(SourceFormat format) {
+        const int width = 5;
+        const int height = 3;
+        size_t stride = 0;
+        std::vector<uint8_t> image = makeImage(format, width, height, stride);
+
+        std::vector<uint8_t> argb(PixelConverter::destinationSize(DestFormat::ARGB8888, width, height));
+        std::vector<uint8_t> bgra(PixelConverter::destinationSize(DestFormat::BGRA8888, width, height));
+        std::vector<uint8_t> rgb(PixelConverter::destinationSize(DestFormat::RGB24, width, height));
+        PixelConverter::select(format, DestFormat::ARGB8888)(image.data(), stride, width, height, argb.data());
+        PixelConverter::select(format, DestFormat::BGRA8888)(image.data(), stride, width, height, bgra.data());
+        PixelConverter::select(format, DestFormat::RGB24)(image.data(), stride, width, height, rgb.data());
+
+        for (int i = 0; i < width * height; ++i) {
+            const Color& c = kColors[i % kColorCount];
+            const uint8_t* a = &argb[i * 4];
+            const uint8_t* b = &bgra[i * 4];
+            const uint8_t* r = &rgb[i * 3];
+            if (a[0] != 0xFF || a[1] != c.r || a[2] != c.g || a[3] != c.b ||
+                b[0] != c.b || b[1] != c.g || b[2] != c.r || b[3] != 0xFF ||
+                r[0] != c.r || r[1] != c.g || r[2] != c.b) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main() {
+    std::cout << "=== Test PixelConverter ===\n\n";
+
+    // Détection d'après les champs d'un XImage
+    check(PixelConverter::detect(32, 0xFF0000, 0xFF00, 0xFF, true) == SourceFormat::XRGB8888, "32 bpp xRGB détecté");
+    check(PixelConverter::detect(32, 0xFF, 0xFF00, 0xFF0000, true) == SourceFormat::XBGR8888, "32 bpp xBGR détecté");
+    check(PixelConverter::detect(24, 0xFF0000, 0xFF00, 0xFF, true) == SourceFormat::RGB888, "24 bpp packé détecté");
+    check(PixelConverter::detect(16, 0xF800, 0x07E0, 0x1F, true) == SourceFormat::RGB565, "16 bpp RGB565 détecté");
+    check(PixelConverter::detect(32, 0x3FF00000, 0xFFC00, 0x3FF, true) == SourceFormat::UNKNOWN, "30 bits non spécialisé");
+    check(PixelConverter::detect(32, 0xFF0000, 0xFF00, 0xFF, false) == SourceFormat::UNKNOWN, "MSBFirst non spécialisé");
+    check(PixelConverter::select(SourceFormat::UNKNOWN, DestFormat::ARGB8888) == nullptr, "Pas de convertisseur pour UNKNOWN");
+
+    // Chaque source vers ARGB, BGRA et RGB24, avec bourrage de ligne
+    check(convertsExactly(SourceFormat::XRGB8888), "XRGB8888 -> ARGB/BGRA/RGB24");
+    check(convertsExactly(SourceFormat::XBGR8888), "XBGR8888 -> ARGB/BGRA/RGB24");
+    check(convertsExactly(SourceFormat::RGB888), "RGB888 -> ARGB/BGRA/RGB24");
+    check(convertsExactly(SourceFormat::BGR888), "BGR888 -> ARGB/BGRA/RGB24");
+    check(convertsExactly(SourceFormat::RGB565), "RGB565 -> ARGB/BGRA/RGB24 (extension 5/6 -> 8 bits)");
+
+    // Conversion sur place (chemin Windows: BGRA -> ARGB)
+    {
+        std::vector<uint8_t> pixels = {0x30, 0x20, 0x10, 0x00, 0x03, 0x02, 0x01, 0x00};
+        PixelConverter::select(SourceFormat::XRGB8888, DestFormat::ARGB8888)(pixels.data(), 8, 2, 1, pixels.data());
+        std::vector<uint8_t> expected = {0xFF, 0x10, 0x20, 0x30, 0xFF, 0x01, 0x02, 0x03};
+        check(pixels == expected, "Conversion sur place");
+    }
+
+    // I420: tailles impaires, plans à demi-résolution arrondie au-dessus
+    {
+        const int width = 5;
+        const int height = 3;
+        check(PixelConverter::destinationSize(DestFormat::I420, width, height) == 15 + 2 * 3 * 2, "Taille I420 (5x3)");
+
+        std::vector<uint8_t> white(static_cast<size_t>(width) * height * 4, 0xFF);
+        std::vector<uint8_t> yuv(PixelConverter::destinationSize(DestFormat::I420, width, height), 0);
+        PixelConverter::select(SourceFormat::XRGB8888, DestFormat::I420)(white.data(), width * 4, width, height, yuv.data());
+        bool ok = true;
+        for (int i = 0; i < width * height; ++i) {
+            ok = ok && yuv[i] == 235;
+        }
+        for (size_t i = width * height; i < yuv.size(); ++i) {
+            ok = ok && yuv[i] == 128;
+        }
+        check(ok, "Blanc -> Y=235, U=V=128");
+
+        std::vector<uint8_t> red(4 * 4 * 4);
+        for (size_t i = 0; i < red.size(); i += 4) {
+            encode(SourceFormat::XRGB8888, {0xFF, 0x00, 0x00}, &red[i]);
+        }
+        std::vector<uint8_t> yuv_red(PixelConverter::destinationSize(DestFormat::I420, 4, 4));
+        PixelConverter::select(SourceFormat::XRGB8888, DestFormat::I420)(red.data(), 16, 4, 4, yuv_red.data());
+        // BT.601 limité: rouge pur -> (82, 90, 240)
+        check(yuv_red[0] == 82 && yuv_red[16] == 90 && yuv_red[20] == 240, "Rouge -> Y=82, U=90, V=240");
+    }
+
+    if (failures == 0) {
+        std::cout << "\n✓ Tous les tests réussis!\n";
+        return 0;
+    }
+    std::cout << "\n✗ " << failures << " test(s) échoué(s)\n";
+    return 1;
+}
@@ -0,0 +1,203 @@
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../src/network/PixelPacker.h"
+#include "../src/network/StreamServer.h"
+#include "../src/network/StreamClient.h"
+#include "../src/utils/Logger.h"
+#include "test_check.h"
+
+static bool waitFor(const std::function<bool()>& condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+// ARGB opaque pseudo-aléatoire
+static std::vector<uint8_t> makeArgb(size_t count) {
+    std::vector<uint8_t> argb(count * 4);
+    uint32_t state = 12345;
+    for (size_t i = 0; i < argb.size(); ++i) {
+        state = state * 1103515245u + 12345u;
+        argb[i] = (i % 4 == 0) ? 0xFF : static_cast<uint8_t>(state >> 16);
+    }
+    return argb;
+}
+
+// Référence RGB565: troncature puis réplication des bits de poids fort
+static bool matches565(const uint8_t* expected, const uint8_t* actual) {
+    auto expand = [](uint8_t v, int bits) {
+        uint8_t top = static_cast<uint8_t>(v >> (8 - bits));
+        return static_cast<uint8_t>((top << (8 - bits)) | (top >> (2 * bits - 8)));
+    };
+    return actual[0] == 0xFF && actual[1] == expand(expected[1], 5) &&
+           actual[2] == expand(expected[2], 6) && actual[3] == expand(expected[3], 5);
+}
+
+int main() {
+    std::cout << "=== Test formats de transport (RGB24 / RGB565) ===\n\n";
+    Logger::init("test_pixel_packer.log", Logger::LogLevel::WARN);
+    std::cout << "SSSE3: " << (PixelPacker::hasSimd() ? "oui" : "non") << "\n\n";
+
+    check(PixelPacker::packedSize(PixelFormat::ARGB8888, 10, 3) == 120, "Taille ARGB8888");
+    check(PixelPacker::packedSize(PixelFormat::RGB24, 10, 3) == 90, "Taille RGB24 (-25%)");
+    check(PixelPacker::packedSize(PixelFormat::RGB565, 10, 3) == 60, "Taille RGB565 (-50%)");
+
+    // Comptes non multiples des blocs SIMD (16 et 8 pixels): queue scalaire
+    {
+        bool rgb24_ok = true;
+        bool rgb565_ok = true;
+        bool layout_ok = true;
+        for (size_t count : {1u, 7u, 8u, 15u, 16u, 17u, 33u, 1000u}) {
+            std::vector<uint8_t> argb = makeArgb(count);
+
+            std::vector<uint8_t> rgb(count * 3);
+            PixelPacker::pack(PixelFormat::RGB24, argb.data(), count, rgb.data());
+            std::vector<uint8_t> back(count * 4);
+            PixelPacker::unpack(PixelFormat::RGB24, rgb.data(), static_cast<int>(count), 1, back.data(), count * 4);
+            rgb24_ok = rgb24_ok && back == argb;
+            layout_ok = layout_ok && rgb[0] == argb[1] && rgb[1] == argb[2] && rgb[2] == argb[3];
+
+            std::vector<uint8_t> rgb565(count * 2);
+            PixelPacker::pack(PixelFormat::RGB565, argb.data(), count, rgb565.data());
+            PixelPacker::unpack(PixelFormat::RGB565, rgb565.data(), static_cast<int>(count), 1, back.data(), count * 4);
+            for (size_t i = 0; i < count; ++i) {
+                rgb565_ok = rgb565_ok && matches565(&argb[i * 4], &back[i * 4]);
+            }
+            uint16_t first = static_cast<uint16_t>(rgb565[0] | (rgb565[1] << 8));
+            layout_ok = layout_ok && first == (((argb[1] >> 3) << 11) | ((argb[2] >> 2) << 5) | (argb[3] >> 3));
+        }
+        check(rgb24_ok, "RGB24: aller-retour exact");
+        check(rgb565_ok, "RGB565: aller-retour à la précision 5/6/5");
+        check(layout_ok, "Octets R, G, B et mot 565 little-endian");
+    }
+
+    // Décodage vers une texture verrouillée: lignes espacées de pitch
+    {
+        const int width = 21;
+        const int height = 5;
+        const size_t pitch = width * 4 + 44;
+        std::vector<uint8_t> argb = makeArgb(static_cast<size_t>(width) * height);
+        std::vector<uint8_t> rgb(PixelPacker::packedSize(PixelFormat::RGB24, width, height));
+        PixelPacker::pack(PixelFormat::RGB24, argb.data(), static_cast<size_t>(width) * height, rgb.data());
+
+        std::vector<uint8_t> texture(pitch * height, 0xEE);
+        PixelPacker::unpack(PixelFormat::RGB24, rgb.data(), width, height, texture.data(), pitch);
+        bool rows_ok = true;
+        bool padding_ok = true;
+        for (int row = 0; row < height; ++row) {
+            rows_ok = rows_ok && std::equal(argb.begin() + row * width * 4, argb.begin() + (row + 1) * width * 4,
+                                            texture.begin() + row * pitch);
+            padding_ok = padding_ok && texture[row * pitch + width * 4] == 0xEE && texture[(row + 1) * pitch - 1] == 0xEE;
+        }
+        check(rows_ok, "Lignes décodées au pitch de la texture");
+        check(padding_ok, "Bourrage de la texture intact");
+    }
+
+    PixelFormat parsed = PixelFormat::ARGB8888;
+    check(PixelPacker::parse("rgb565", parsed) && parsed == PixelFormat::RGB565 &&
+          !PixelPacker::parse("yuv", parsed), "Noms des formats");
+
+    // Négociation par client: chaque client reçoit son format
+    {
+        const int kPort = 19331;
+        const int kWidth = 40;
+        const int kHeight = 20;
+        StreamServer server("127.0.0.1", kPort);
+        if (!server.start()) {
+            std::cout << "✗ Démarrage du serveur\n";
+            Logger::shutdown();
+            return 1;
+        }
+
+        std::mutex mutex;
+        VideoFrame last_argb;
+        std::vector<VideoFrame> low_frames;
+        std::atomic<bool> got_argb(false);
+        std::atomic<bool> got_565(false);
+
+        StreamClient argb_client("127.0.0.1", kPort);
+        argb_client.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            last_argb = frame;
+            got_argb = true;
+        });
+        StreamClient low_client("127.0.0.1", kPort);
+        low_client.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            low_frames.push_back(frame);
+            if (frame.format == PixelFormat::RGB565) {
+                got_565 = true;
+            }
+        });
+
+        check(argb_client.connect() && low_client.connect(), "Connexion des deux clients");
+        check(low_client.setPixelFormat(PixelFormat::RGB565), "CONFIG RGB565 envoyé");
+
+        VideoFrame frame;
+        frame.width = kWidth;
+        frame.height = kHeight;
+        frame.quality = 80;
+        frame.data = makeArgb(static_cast<size_t>(kWidth) * kHeight);
+        uint32_t number = 0;
+        // Le CONFIG est traité par le thread du client côté serveur
+        check(waitFor([&] {
+            frame.frame_number = number++;
+            frame.timestamp = get_monotonic_us();
+            server.broadcastVideoFrame(frame);
+            return got_565.load() && got_argb.load();
+        }), "Frames reçues par les deux clients");
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            const VideoFrame& last_565 = low_frames.back();
+            check(last_argb.format == PixelFormat::ARGB8888 && last_argb.data == frame.data,
+                  "Client par défaut: ARGB8888 inchangé");
+            check(last_565.data.size() == PixelPacker::packedSize(PixelFormat::RGB565, kWidth, kHeight),
+                  "Client RGB565: 2 octets par pixel");
+
+            std::vector<uint8_t> decoded(static_cast<size_t>(kWidth) * kHeight * 4);
+            PixelPacker::unpack(last_565.format, last_565.data.data(), kWidth, kHeight, decoded.data(), kWidth * 4);
+            bool ok = true;
+            for (size_t i = 0; i < decoded.size(); i += 4) {
+                ok = ok && matches565(&frame.data[i], &decoded[i]);
+            }
+            check(ok, "Client RGB565: image décodée");
+        }
+
+        // Données non brutes (taille différente de width * height * 4): envoyées telles quelles
+        VideoFrame opaque = frame;
+        opaque.frame_number = number++;
+        opaque.data.assign(100, 0x42);
+        server.broadcastVideoFrame(opaque);
+        check(waitFor([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            const VideoFrame& received = low_frames.back();
+            return received.frame_number == opaque.frame_number &&
+                   received.format == PixelFormat::ARGB8888 && received.data == opaque.data;
+        }), "Frame non brute transmise sans conversion");
+
+        argb_client.disconnect();
+        low_client.disconnect();
+        server.stop();
+    }
+
+    Logger::shutdown();
+
+    if (failures == 0) {
+        std::cout << "\n✓ Tous les tests réussis!\n";
+        return 0;
+    }
+    std::cout << "\n✗ " << failures << " test(s) échoué(s)\n";
+    return 1;
+}
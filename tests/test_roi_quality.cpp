@@ -0,0 +1,341 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../src/network/RoiMap.h"
+#include "../src/network/TileCache.h"
+#include "../src/network/TileClassifier.h"
+#include "../src/network/PixelPacker.h"
+#include "../src/network/StreamServer.h"
+#include "../src/network/StreamClient.h"
+#include "../src/capture/SyntheticFrameSource.h"
+#include "../src/utils/Logger.h"
+#include "../src/utils/Metrics.h"
+#include "test_check.h"
+
+static bool waitFor(const std::function<bool()>& condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+static std::vector<uint8_t> capture(SyntheticFrameSource& source) {
+    int width = 0;
+    int height = 0;
+    return source.captureFrame(width, height);
+}
+
+const int kStreamWidth = 1280;
+const int kStreamHeight = 720;
+const int kTile = TileCache::kTileSize;
+const int kColumns = kStreamWidth / kTile;
+const int kRows = kStreamHeight / kTile;     // tuiles entières: la marge du bas reste RAW_RECT
+
+// Ce qu'un client a reçu, tuile par tuile
+struct Received {
+    std::vector<uint8_t> allowed;           // tuiles qui peuvent arriver en RGB565
+    std::vector<int> lossy_frames;          // frames où la tuile est arrivée en RGB565
+    int mismatches = 0;
+
+    void reset(const std::function<bool(int, int)>& may_be_lossy) {
+        allowed.assign(kColumns * kRows, 0);
+        lossy_frames.assign(kColumns * kRows, 0);
+        for (int row = 0; row < kRows; ++row) {
+            for (int column = 0; column < kColumns; ++column) {
+                allowed[row * kColumns + column] = may_be_lossy(column, row) ? 1 : 0;
+            }
+        }
+    }
+
+    // Chaque pixel exact, ou passé par RGB565 dans une tuile autorisée
+    void record(const std::vector<uint8_t>& frame, const std::vector<uint8_t>& exact,
+                const std::vector<uint8_t>& quantized) {
+        if (frame.size() != exact.size()) {
+            mismatches++;
+            return;
+        }
+        std::vector<uint8_t> lossy(kColumns * kRows, 0);
+        for (size_t i = 0; i < frame.size(); i += 4) {
+            if (memcmp(&frame[i], &exact[i], 4) == 0) {
+                continue;
+            }
+            int x = static_cast<int>(i / 4 % kStreamWidth);
+            int y = static_cast<int>(i / 4 / kStreamWidth);
+            int tile = y / kTile < kRows ? (y / kTile) * kColumns + x / kTile : -1;
+            if (tile < 0 || !allowed[tile] || memcmp(&frame[i], &quantized[i], 4) != 0) {
+                mismatches++;
+                return;
+            }
+            lossy[tile] = 1;
+        }
+        for (size_t tile = 0; tile < lossy.size(); ++tile) {
+            lossy_frames[tile] += lossy[tile];
+        }
+    }
+
+    bool sawLossy(int column, int row) const { return lossy_frames[row * kColumns + column] > 0; }
+};
+
+int main() {
+    std::cout << "=== Test qualité par zone d'intérêt ===\n\n";
+    Logger::init("test_roi_quality.log", Logger::LogLevel::WARN);
+
+    // RoiMap: voisinage du pointeur et rectangles
+    {
+        RoiMap roi;
+        check(roi.empty() && !roi.intersects(0, 0, kTile, kTile), "Zone vide: aucune tuile");
+        roi.addCursor(100, 100);
+        check(roi.intersects(64, 64, kTile, kTile) && roi.intersects(128, 128, kTile, kTile),
+              "Tuiles autour du pointeur");
+        check(!roi.intersects(100 + RoiMap::kCursorRadius, 0, kTile, kTile), "Tuile hors du voisinage");
+        roi.add(500, 500, 0, 100);
+        roi.add(600, 0, 10, 10);
+        check(!roi.intersects(500, 500, 10, 10) && roi.intersects(576, 0, kTile, kTile),
+              "Rectangle vide ignoré, rectangle ajouté");
+    }
+
+    check(sizeof(StreamConfig) == 10, "StreamConfig: roi_min_quality dans l'ancien bourrage");
+
+    // Bout en bout: bureau qui alterne, vidéo incrustée, pointeur sur la vidéo
+    {
+        const int kPort = 19371;
+        const int kFrames = 12;
+        // Vidéo: tuiles colonnes 10-13, lignes 2-4
+        const int kVideoX = 640;
+        const int kVideoY = 128;
+        const int kVideoWidth = 256;
+        const int kVideoHeight = 192;
+        auto video_tile = [&](int column, int row) {
+            return column >= kVideoX / kTile && column < (kVideoX + kVideoWidth) / kTile &&
+                   row >= kVideoY / kTile && row < (kVideoY + kVideoHeight) / kTile;
+        };
+
+        StreamServer server("127.0.0.1", kPort);
+        if (!server.start()) {
+            std::cout << "✗ Démarrage du serveur\n";
+            Logger::shutdown();
+            return 1;
+        }
+
+        std::mutex mutex;
+        std::vector<uint8_t> expected;
+        std::vector<uint8_t> quantized;
+        std::atomic<uint32_t> content_number(UINT32_MAX);
+        std::atomic<uint32_t> lowered_number(UINT32_MAX);
+        Received content;
+        Received lowered;
+
+        // Plancher par défaut: seule la vidéo hors zone d'intérêt est dégradée
+        StreamClient content_client("127.0.0.1", kPort);
+        content_client.setLossyTiles(true);
+        content_client.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            content.record(frame.data, expected, quantized);
+            content_number = frame.frame_number;
+        });
+        // Plancher 0: tout ce qui est hors zone d'intérêt peut l'être
+        StreamClient lowered_client("127.0.0.1", kPort);
+        lowered_client.setLossyTiles(true);
+        lowered_client.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            lowered.record(frame.data, expected, quantized);
+            lowered_number = frame.frame_number;
+        });
+        check(content_client.connect() && lowered_client.connect(), "Connexion des deux clients");
+        check(lowered_client.setRoiMinQuality(0), "CONFIG avec roi_min_quality = 0 envoyé");
+
+        // Pointeur sur la partie gauche de la vidéo, fenêtre active en haut à gauche
+        CursorPosition cursor = {};
+        cursor.x = 700;
+        cursor.y = 160;
+        cursor.visible = 1;
+        cursor.timestamp = get_monotonic_us();
+        server.broadcastCursor(cursor);
+        server.setFocusWindow(0, 0, 320, 256);
+        RoiMap roi;
+        roi.addCursor(cursor.x, cursor.y);
+        roi.add(0, 0, 320, 256);
+        auto in_roi = [&](int column, int row) {
+            return roi.intersects(column * kTile, row * kTile, kTile, kTile);
+        };
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            content.reset([&](int column, int row) { return video_tile(column, row) && !in_roi(column, row); });
+            lowered.reset([&](int column, int row) { return !in_roi(column, row); });
+        }
+
+        SyntheticFrameSource desktops[2] = {
+            SyntheticFrameSource(SyntheticFrameSource::Pattern::STATIC_DESKTOP, kStreamWidth, kStreamHeight, 31),
+            SyntheticFrameSource(SyntheticFrameSource::Pattern::STATIC_DESKTOP, kStreamWidth, kStreamHeight, 32)
+        };
+        SyntheticFrameSource player(SyntheticFrameSource::Pattern::VIDEO_NOISE, kStreamWidth, kStreamHeight, 33);
+        desktops[0].init();
+        desktops[1].init();
+        player.init();
+        VideoFrame frame;
+        frame.width = kStreamWidth;
+        frame.height = kStreamHeight;
+        frame.quality = 80;
+
+        const size_t pixels = static_cast<size_t>(kStreamWidth) * kStreamHeight;
+        const std::vector<uint8_t>* still = nullptr;   // bureau immobile, sans vidéo
+        auto broadcast = [&](uint32_t number) {
+            frame.frame_number = number;
+            frame.timestamp = get_monotonic_us();
+            if (still) {
+                frame.data = *still;
+            } else {
+                frame.data = capture(desktops[number % 2]);
+                std::vector<uint8_t> video = capture(player);
+                for (int y = kVideoY; y < kVideoY + kVideoHeight; ++y) {
+                    size_t offset = (static_cast<size_t>(y) * kStreamWidth + kVideoX) * 4;
+                    memcpy(frame.data.data() + offset, video.data() + offset, static_cast<size_t>(kVideoWidth) * 4);
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                expected = frame.data;
+                std::vector<uint8_t> rgb565(PixelPacker::packedSize(PixelFormat::RGB565, kStreamWidth, kStreamHeight));
+                PixelPacker::pack(PixelFormat::RGB565, frame.data.data(), pixels, rgb565.data());
+                quantized.resize(frame.data.size());
+                PixelPacker::unpack(PixelFormat::RGB565, rgb565.data(), kStreamWidth, kStreamHeight,
+                                    quantized.data(), static_cast<size_t>(kStreamWidth) * 4);
+            }
+            server.broadcastVideoFrame(frame);
+            return waitFor([&] { return content_number == number && lowered_number == number; });
+        };
+
+        // Octets depuis la première frame: une fois en cache, le texte revient
+        // en CACHED_TILE pour les deux clients, seul son premier envoi diffère
+        uint32_t number = 0;
+        bool all_received = broadcast(number++);
+        uint64_t content_bytes = content_client.getBytesReceived();
+        uint64_t lowered_bytes = lowered_client.getBytesReceived();
+        // Quelques frames pour que la vidéo soit classée en mouvement
+        for (uint32_t i = 0; i < TileClassifier::kMotionFrames + 2; ++i) {
+            all_received = all_received && broadcast(number++);
+        }
+        uint64_t boosted = Metrics::counter("roi_boosted_tiles_total").value();
+        for (int i = 0; i < kFrames; ++i) {
+            all_received = all_received && broadcast(number++);
+        }
+        content_bytes = content_client.getBytesReceived() - content_bytes;
+        lowered_bytes = lowered_client.getBytesReceived() - lowered_bytes;
+        boosted = Metrics::counter("roi_boosted_tiles_total").value() - boosted;
+
+        check(all_received, "Toutes les frames reçues");
+        check(content.mismatches == 0 && lowered.mismatches == 0,
+              "Zone d'intérêt exacte; RGB565 seulement là où le plancher le permet");
+        check(content.sawLossy(13, 3) && lowered.sawLossy(13, 3), "Vidéo loin du pointeur en RGB565");
+        check(boosted > 0, "Vidéo sous le pointeur relevée (roi_boosted_tiles_total)");
+        check(!content.sawLossy(15, 8) && lowered.sawLossy(15, 8),
+              "Texte hors zone d'intérêt en RGB565 seulement avec roi_min_quality = 0");
+        std::cout << "  " << content_bytes << " octets (plancher 100), " << lowered_bytes << " (plancher 0)\n";
+        check(lowered_bytes < content_bytes, "Plancher bas: moins d'octets");
+
+        // Pointeur parti: la vidéo qu'il couvrait redescend
+        cursor.visible = 0;
+        cursor.timestamp = get_monotonic_us();
+        server.broadcastCursor(cursor);
+        roi = RoiMap();
+        roi.add(0, 0, 320, 256);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            content.reset([&](int column, int row) { return video_tile(column, row) && !in_roi(column, row); });
+            lowered.reset([&](int column, int row) { return !in_roi(column, row); });
+        }
+        for (int i = 0; i < 4; ++i) {
+            all_received = all_received && broadcast(number++);
+        }
+        check(all_received && content.mismatches == 0 && content.sawLossy(10, 2),
+              "Pointeur parti: sa tuile vidéo repasse en RGB565");
+
+        // Bureau immobile: le texte abaissé ne change plus, il doit être
+        // renvoyé exact quand le pointeur puis la fenêtre active le rejoignent.
+        // Assez de frames pour que l'ancienne vidéo soit immobile et exacte.
+        std::vector<uint8_t> desktop = capture(desktops[0]);
+        still = &desktop;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            lowered.reset([&](int column, int row) { return !in_roi(column, row); });
+        }
+        for (int i = 0; i < TileClassifier::kSettledFrames + 1; ++i) {
+            all_received = all_received && broadcast(number++);
+        }
+        check(all_received && lowered.mismatches == 0 && lowered.sawLossy(15, 8) && lowered.sawLossy(11, 6),
+              "Bureau immobile: texte hors zone d'intérêt en RGB565");
+        VideoFrame repeat = frame;
+        repeat.frame_number = number++;
+        check(server.repeatVideoFrame(repeat) && waitFor([&] {
+                  return content_number == repeat.frame_number && lowered_number == repeat.frame_number;
+              }), "Rien à renvoyer: FRAME_REPEAT possible");
+
+        cursor.x = 15 * kTile + kTile / 2;
+        cursor.y = 8 * kTile + kTile / 2;
+        cursor.visible = 1;
+        cursor.timestamp = get_monotonic_us();
+        server.broadcastCursor(cursor);
+        roi.addCursor(cursor.x, cursor.y);
+        repeat.frame_number = number++;
+        check(!server.repeatVideoFrame(repeat), "Texte abaissé sous le pointeur: FRAME_REPEAT refusé");
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            lowered.reset([&](int column, int row) { return !in_roi(column, row); });
+        }
+        all_received = all_received && broadcast(number++);
+        check(all_received && lowered.mismatches == 0 && !lowered.sawLossy(15, 8),
+              "Pointeur sur le texte abaissé: pixels exacts");
+
+        server.setFocusWindow(640, 384, 320, 192);
+        roi = RoiMap();
+        roi.addCursor(cursor.x, cursor.y);
+        roi.add(640, 384, 320, 192);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            lowered.reset([&](int column, int row) { return !in_roi(column, row); });
+        }
+        all_received = all_received && broadcast(number++);
+        check(all_received && lowered.mismatches == 0 && !lowered.sawLossy(11, 6) && lowered.sawLossy(4, 9),
+              "Fenêtre active sur le texte abaissé: pixels exacts, le reste en RGB565");
+
+        // Défilement: le COPY_RECT amène du texte abaissé dans la fenêtre
+        // active, il doit y être renvoyé exact
+        const int kScroll = 96;
+        const size_t row_bytes = static_cast<size_t>(kStreamWidth) * 4;
+        std::vector<uint8_t> scrolled(desktop.size());
+        memcpy(scrolled.data(), desktop.data() + kScroll * row_bytes, (kStreamHeight - kScroll) * row_bytes);
+        memcpy(scrolled.data() + (kStreamHeight - kScroll) * row_bytes, desktop.data(), kScroll * row_bytes);
+        still = &scrolled;
+        uint64_t scrolls = Metrics::counter("frame_update_scrolls_total").value();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            lowered.reset([&](int column, int row) { return !in_roi(column, row); });
+        }
+        all_received = all_received && broadcast(number++);
+        check(Metrics::counter("frame_update_scrolls_total").value() > scrolls, "Défilement envoyé en COPY_RECT");
+        check(all_received && lowered.mismatches == 0 && !lowered.sawLossy(12, 7),
+              "Texte abaissé copié dans la fenêtre active: pixels exacts");
+
+        content_client.disconnect();
+        lowered_client.disconnect();
+        server.stop();
+    }
+
+    Logger::shutdown();
+
+    if (failures == 0) {
+        std::cout << "\n✓ Tous les tests réussis!\n";
+        return 0;
+    }
+    std::cout << "\n✗ " << failures << " test(s) échoué(s)\n";
+    return 1;
+}
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <thread>
+#include "../src/network/StreamServer.h"
+#include "../src/network/StreamClient.h"
+#include "../src/utils/Logger.h"
+#include "test_check.h"
+
+#ifndef PLATFORM_WINDOWS
+#include <cerrno>
+#include <csignal>
+
+static std::atomic<int> sigpipes{0};
+
+static void onSigpipe(int) {
+    sigpipes++;
+}
+#endif
+
+// Attente bornée d'une opération qui peut rester bloquée: en cas de
+// régression, le thread ne peut être ni joint ni détruit
+static void finishWithin(const std::function<void()>& operation, int seconds, const char* what) {
+    std::atomic<bool> done{false};
+    std::thread worker([&] {
+        operation();
+        done = true;
+    });
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    while (!done && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (!done) {
+        std::cout << "✗ " << what << std::endl;
+        std::_Exit(1);
+    }
+    worker.join();
+    check(true, what);
+}
+
+int main() {
+    std::cout << "=== Test cycle de vie du serveur ===\n\n";
+    Logger::init("test_server_lifecycle.log", Logger::LogLevel::WARN);
+
+    // stop() sans client: le accept() bloqué doit être réveillé (close()
+    // seul ne le fait pas sous Linux). Le moniteur de heartbeat dort 5 s.
+    {
+        StreamServer server("127.0.0.1", 19391);
+        check(server.start(), "Démarrage du serveur");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        finishWithin([&] { server.stop(); }, 10, "stop() réveille accept() et termine");
+        check(!server.isRunning(), "Serveur arrêté");
+    }
+
+    // Connexion coupée par le serveur: la boucle de réception du client
+    // s'arrête seule, mais disconnect() (et le destructeur) doit encore
+    // joindre ses threads, sinon std::terminate
+    {
+        const int kPort = 19393;
+        StreamServer server("127.0.0.1", kPort);
+        check(server.start(), "Démarrage du serveur");
+        auto client = std::make_unique<StreamClient>("127.0.0.1", kPort);
+        check(client->connect(), "Connexion du client");
+        finishWithin([&] { server.stop(); }, 10, "Arrêt avec un client connecté");
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (client->isConnected() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        check(!client->isConnected(), "Client informé de la coupure");
+        finishWithin([&] { client->disconnect(); }, 10, "disconnect() après la coupure");
+        client.reset();
+        check(true, "Client détruit sans thread joignable");
+    }
+
+    // Heartbeat reçu après la lecture de l'heure: pas de faux timeout
+    // (la différence non signée bouclait vers ~2^64)
+    {
+        const uint64_t now = 100000000;
+        check(!StreamServer::heartbeatExpired(now, now + 1000), "Heartbeat plus récent que now: pas expiré");
+        check(!StreamServer::heartbeatExpired(now, now), "Heartbeat à l'instant: pas expiré");
+        check(!StreamServer::heartbeatExpired(now, now - StreamServer::kHeartbeatTimeoutUs),
+              "Exactement le délai: pas expiré");
+        check(StreamServer::heartbeatExpired(now, now - StreamServer::kHeartbeatTimeoutUs - 1),
+              "Au-delà du délai: expiré");
+    }
+
+#ifndef PLATFORM_WINDOWS
+    // Pair déjà parti: send(SEND_FLAGS), comme tous les envois du serveur et
+    // du client, doit échouer en EPIPE sans SIGPIPE (qui tue le processus).
+    // Le signal est compté au lieu de terminer le test.
+    {
+        signal(SIGPIPE, onSigpipe);
+        int pair[2];
+        check(socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0, "Paire de sockets");
+        closesocket(pair[1]);
+        char byte = 0;
+        errno = 0;
+        ssize_t sent = send(pair[0], &byte, sizeof(byte), SEND_FLAGS);
+        check(sent < 0 && errno == EPIPE, "send() vers un pair fermé: EPIPE");
+        check(sigpipes == 0, "Aucun SIGPIPE");
+        closesocket(pair[0]);
+        signal(SIGPIPE, SIG_DFL);
+    }
+#endif
+
+    Logger::shutdown();
+
+    if (failures == 0) {
+        std::cout << "\n✓ Tous les tests réussis!\n";
+        return 0;
+    }
+    std::cout << "\n✗ " << failures << " test(s) échoué(s)\n";
+    return 1;
+}
@@ -48,7 +48,7 @@ int main() {
         frame.width = WIDTH;
         frame.height = HEIGHT;
         frame.quality = 80;
-        frame.timestamp = get_timestamp_us();
+        frame.timestamp = get_monotonic_us();
         
         // Simulated compressed frame data (much smaller than raw pixels)
         size_t compressed_size = (WIDTH * HEIGHT * 3) / 20; // ~5% of raw size
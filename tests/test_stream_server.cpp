@@ -42,7 +42,7 @@ int main(int argc, char* argv[]) {
     video_frame.height = 720;
     video_frame.quality = 80;
     video_frame.data.resize(1024);  // Dummy data
-    video_frame.timestamp = get_timestamp_us();
+    video_frame.timestamp = get_monotonic_us();
     
     AudioFrame audio_frame;
     audio_frame.frame_number = 1;
@@ -69,7 +69,7 @@ int main(int argc, char* argv[]) {
         
         // Broadcast frames every second
         video_frame.frame_number++;
-        video_frame.timestamp = get_timestamp_us();
+        video_frame.timestamp = get_monotonic_us();
         server.broadcastVideoFrame(video_frame);
         
         audio_frame.frame_number++;
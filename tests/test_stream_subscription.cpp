@@ -0,0 +1,131 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "../src/network/StreamServer.h"
+#include "../src/network/StreamClient.h"
+#include "../src/utils/Logger.h"
+#include "test_check.h"
+
+static bool waitFor(const std::function<bool()>& condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+static StreamInfo makeStream(uint8_t id, const char* name, int16_t x, uint16_t width, uint16_t height) {
+    StreamInfo info = {};
+    info.stream_id = id;
+    info.primary = id == 0 ? 1 : 0;
+    info.x = x;
+    info.width = width;
+    info.height = height;
+    snprintf(info.name, sizeof(info.name), "%s", name);
+    return info;
+}
+
+static VideoFrame makeFrame(uint8_t stream_id, uint32_t number, uint16_t width, uint16_t height) {
+    VideoFrame frame;
+    frame.frame_number = number;
+    frame.width = width;
+    frame.height = height;
+    frame.quality = 80;
+    frame.timestamp = get_monotonic_us();
+    frame.stream_id = stream_id;
+    frame.data.assign(static_cast<size_t>(width) * height * 4, static_cast<uint8_t>(stream_id + 1));
+    return frame;
+}
+
+int main() {
+    std::cout << "=== Test flux vidéo multiples (STREAM_LIST / SUBSCRIBE) ===\n\n";
+    Logger::init("test_stream_subscription.log", Logger::LogLevel::WARN);
+
+    const int kPort = 19311;
+    check(sizeof(VideoFrameHeader) == 24, "En-tête vidéo inchangé (24 octets)");
+
+    StreamServer server("127.0.0.1", kPort);
+    server.setVideoStreams({makeStream(0, "DP-1", 0, 64, 32), makeStream(1, "HDMI-1", 64, 32, 16)});
+    if (!server.start()) {
+        std::cout << "✗ Démarrage du serveur\n";
+        Logger::shutdown();
+        return 1;
+    }
+
+    std::mutex mutex;
+    std::vector<VideoFrame> legacy_frames;
+    std::vector<VideoFrame> second_frames;
+
+    // Client sans abonnement: flux 0 seulement
+    StreamClient legacy("127.0.0.1", kPort);
+    legacy.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        legacy_frames.push_back(frame);
+    });
+
+    StreamClient second("127.0.0.1", kPort);
+    second.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        second_frames.push_back(frame);
+    });
+
+    check(legacy.connect() && second.connect(), "Connexion des deux clients");
+    check(waitFor([&] { return second.getStreams().size() == 2; }), "Liste des flux reçue après le handshake");
+
+    std::vector<StreamInfo> streams = second.getStreams();
+    check(streams.size() == 2 && std::strcmp(streams[1].name, "HDMI-1") == 0 &&
+          streams[1].x == 64 && streams[1].width == 32, "Nom et géométrie des flux");
+
+    check(second.subscribe(1u << 1), "Abonnement au flux 1");
+    check(waitFor([&] { return server.getSubscriberCount(1) == 1; }), "Abonné compté côté serveur");
+    check(server.getSubscriberCount(0) == 1, "Le client sans abonnement reste sur le flux 0");
+
+    for (uint32_t i = 0; i < 3; ++i) {
+        server.broadcastVideoFrame(makeFrame(0, i, 64, 32));
+        server.broadcastVideoFrame(makeFrame(1, i, 32, 16));
+    }
+
+    check(waitFor([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return legacy_frames.size() >= 3 && second_frames.size() >= 3;
+    }), "Frames reçues par les deux clients");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bool legacy_ok = legacy_frames.size() == 3;
+        for (const VideoFrame& frame : legacy_frames) {
+            legacy_ok = legacy_ok && frame.stream_id == 0 && frame.width == 64 && frame.data[0] == 1;
+        }
+        check(legacy_ok, "Client sans abonnement: uniquement le flux 0");
+
+        bool second_ok = second_frames.size() == 3;
+        for (const VideoFrame& frame : second_frames) {
+            second_ok = second_ok && frame.stream_id == 1 && frame.width == 32 && frame.data[0] == 2;
+        }
+        check(second_ok, "Client abonné au flux 1: uniquement le flux 1");
+    }
+
+    // Nouvelle liste diffusée aux clients connectés
+    server.setVideoStreams({makeStream(0, "DP-1", 0, 64, 32)});
+    check(waitFor([&] { return legacy.getStreams().size() == 1; }), "Changement de liste diffusé");
+
+    legacy.disconnect();
+    second.disconnect();
+    server.stop();
+    Logger::shutdown();
+
+    if (failures == 0) {
+        std::cout << "\n✓ Tous les tests réussis!\n";
+        return 0;
+    }
+    std::cout << "\n✗ " << failures << " test(s) échoué(s)\n";
+    return 1;
+}
@@ -2,6 +2,12 @@
 #include "../src/threading/ThreadPool.h"
 #include <chrono>
 #include <atomic>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <thread>
+#include <numeric>
+#include <vector>
 
 int main() {
     std::cout << "=== Test ThreadPool ===\n\n";
@@ -28,13 +34,122 @@ int main() {
         
         std::cout << "\n✓ Compteur final: " << counter << "/10\n";
         
-        if (counter == 10) {
-            std::cout << "✓ Tous les tests réussis!\n";
-            return 0;
-        } else {
+        if (counter != 10) {
             std::cout << "✗ Erreur: toutes les tâches n'ont pas été exécutées\n";
             return 1;
         }
+
+        // submit() avec future
+        auto answer = pool.submit([](int a, int b) { return a * b; }, 6, 7);
+        if (answer.get() != 42) {
+            std::cout << "✗ Erreur: submit() a retourné un mauvais résultat\n";
+            return 1;
+        }
+        std::cout << "✓ submit() retourne le résultat via future\n";
+
+        // Callable et arguments move-only
+        auto owned = std::make_unique<int>(5);
+        auto moved = pool.submit([owned = std::move(owned)](std::unique_ptr<int> extra) { return *owned + *extra; },
+                                 std::make_unique<int>(2));
+        std::packaged_task<int()> packaged([] { return 9; });
+        auto inner = packaged.get_future();
+        pool.submit(std::move(packaged)).get();
+        if (moved.get() != 7 || inner.get() != 9) {
+            std::cout << "✗ Erreur: submit() avec des types move-only\n";
+            return 1;
+        }
+        std::cout << "✓ submit() accepte les callables et arguments move-only\n";
+
+        // Exceptions propagées par le future
+        auto failing = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+        try {
+            failing.get();
+            std::cout << "✗ Erreur: exception non propagée\n";
+            return 1;
+        } catch (const std::runtime_error&) {
+            std::cout << "✓ Exception propagée par le future\n";
+        }
+
+        // Soumission groupée
+        std::atomic<int> bulk_counter{0};
+        std::vector<std::function<void()>> batch(100, [&bulk_counter] { bulk_counter++; });
+        pool.enqueue_bulk(batch.begin(), batch.end());
+        auto bulk_done = pool.submit([] {});
+        bulk_done.get();
+        while (pool.pending_tasks() > 0 || pool.busy_workers() > 0) {
+            std::this_thread::yield();
+        }
+        if (bulk_counter != 100) {
+            std::cout << "✗ Erreur: enqueue_bulk a perdu des tâches\n";
+            return 1;
+        }
+        std::cout << "✓ enqueue_bulk exécute 100 tâches\n";
+
+        // parallel_for
+        std::vector<int> values(100000, 1);
+        std::atomic<long long> sum{0};
+        pool.parallel_for(0, values.size(), [&](size_t begin, size_t end) {
+            sum += std::accumulate(values.begin() + begin, values.begin() + end, 0LL);
+        });
+        if (sum != (long long)values.size()) {
+            std::cout << "✗ Erreur: parallel_for a manqué des indices\n";
+            return 1;
+        }
+        std::cout << "✓ parallel_for couvre tous les indices\n";
+
+        // parallel_for imbriqué depuis un worker (vol de travail, pas d'interblocage)
+        std::atomic<int> nested{0};
+        pool.parallel_for(0, 8, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                pool.parallel_for(0, 64, [&](size_t b, size_t e) { nested += (int)(e - b); }, 4);
+            }
+        }, 1);
+        if (nested != 8 * 64) {
+            std::cout << "✗ Erreur: parallel_for imbriqué incomplet\n";
+            return 1;
+        }
+        std::cout << "✓ parallel_for imbriqué sans interblocage\n";
+
+        // Plus de tâches que la file d'injection: enqueue() bloque puis doit
+        // être réveillé par les workers qui la vident (try_pop)
+        {
+            ThreadPoolOptions small;
+            small.queue_capacity = 8;
+            ThreadPool narrow(1, small);
+            std::atomic<int> done{0};
+            std::atomic<bool> submitted{false};
+            std::thread producer([&] {
+                for (int i = 0; i < 1000; ++i) {
+                    narrow.enqueue([&done] { done++; });
+                }
+                submitted = true;
+            });
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while ((!submitted || done < 1000) && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            if (!submitted || done != 1000) {
+                std::cout << "✗ Erreur: enqueue() bloqué sur la file pleine" << std::endl;
+                std::_Exit(1);      // producteur bloqué: ni join() ni destruction possibles
+            }
+            producer.join();
+            std::cout << "✓ 1000 tâches dans une file de 8\n";
+        }
+
+        // Options: noms et affinité
+        ThreadPoolOptions options;
+        options.name = "capture";
+        options.pin_threads = true;
+        ThreadPool pinned(2, options);
+        auto index = pinned.submit([] { return ThreadPool::current_worker_index(); });
+        if (index.get() < 0) {
+            std::cout << "✗ Erreur: index de worker invalide\n";
+            return 1;
+        }
+        std::cout << "✓ Pool nommé et épinglé opérationnel\n";
+
+        std::cout << "✓ Tous les tests réussis!\n";
+        return 0;
         
     } catch (const std::exception& e) {
         std::cerr << "✗ Erreur: " << e.what() << std::endl;
@@ -0,0 +1,241 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../src/network/FrameDelta.h"
+#include "../src/network/PixelPacker.h"
+#include "../src/network/TileCache.h"
+#include "../src/network/StreamServer.h"
+#include "../src/network/StreamClient.h"
+#include "../src/capture/SyntheticFrameSource.h"
+#include "../src/utils/Logger.h"
+#include "test_check.h"
+
+static bool waitFor(const std::function<bool()>& condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+static std::vector<uint8_t> capture(SyntheticFrameSource& source) {
+    int width = 0;
+    int height = 0;
+    return source.captureFrame(width, height);
+}
+
+int main() {
+    std::cout << "=== Test cache de tuiles ===\n\n";
+    Logger::init("test_tile_cache.log", Logger::LogLevel::WARN);
+
+    // Éviction LRU: find() rafraîchit une entrée, contains() non
+    {
+        TileCache cache(3);
+        cache.insert(1, std::vector<uint8_t>(4, 1));
+        cache.insert(2, std::vector<uint8_t>(4, 2));
+        cache.insert(3, std::vector<uint8_t>(4, 3));
+        check(cache.find(1) != nullptr && cache.contains(2), "Tuiles présentes");
+        cache.insert(4);
+        check(!cache.contains(2) && cache.contains(1) && cache.contains(3) && cache.size() == 3,
+              "La moins récemment utilisée est évincée");
+        const std::vector<uint8_t>* pixels = cache.find(1);
+        check(pixels && pixels->size() == 4 && (*pixels)[0] == 1, "Pixels conservés");
+
+        TileCache disabled(0);
+        disabled.insert(1);
+        check(disabled.size() == 0 && !disabled.contains(1), "Capacité nulle: cache désactivé");
+        cache.reset(2);
+        check(cache.size() == 0 && cache.capacity() == 2, "reset() vide et redimensionne");
+    }
+
+    // Hachage: contenu et stride
+    {
+        const int kSize = 64;
+        std::vector<uint8_t> wide(static_cast<size_t>(kSize) * 2 * kSize * 4);
+        for (size_t i = 0; i < wide.size(); ++i) {
+            wide[i] = static_cast<uint8_t>(i * 31 / 7);
+        }
+        std::vector<uint8_t> tile(static_cast<size_t>(kSize) * kSize * 4);
+        for (int y = 0; y < kSize; ++y) {
+            memcpy(tile.data() + static_cast<size_t>(y) * kSize * 4,
+                   wide.data() + static_cast<size_t>(y) * kSize * 2 * 4, kSize * 4);
+        }
+        uint64_t packed = TileCache::hashTile(tile.data(), kSize * 4, kSize, kSize);
+        check(packed == TileCache::hashTile(wide.data(), kSize * 2 * 4, kSize, kSize), "Même tuile, stride différent");
+        tile[kSize * 4 * 20 + 13] ^= 1;
+        check(packed != TileCache::hashTile(tile.data(), kSize * 4, kSize, kSize), "Un bit modifié change le hachage");
+        check(TileCache::hashTile(wide.data(), kSize * 4, kSize, kSize / 2) !=
+              TileCache::hashTile(wide.data(), kSize * 4, kSize / 2, kSize), "Dimensions prises en compte");
+    }
+
+    // Découpage en tuiles: grille entière en CACHE_TILE, marges en RAW_RECT
+    {
+        const int kWidth = 300;
+        const int kHeight = 200;
+        SyntheticFrameSource a(SyntheticFrameSource::Pattern::STATIC_DESKTOP, kWidth, kHeight, 1);
+        SyntheticFrameSource b(SyntheticFrameSource::Pattern::STATIC_DESKTOP, kWidth, kHeight, 2);
+        a.init();
+        b.init();
+        std::vector<uint8_t> first = capture(a);
+        std::vector<uint8_t> second = capture(b);
+        std::vector<UpdateCommand> commands = FrameDelta::compute(first.data(), second.data(), kWidth, kHeight,
+                                                                  TileCache::kTileSize);
+        int tiles = 0;
+        bool aligned = true;
+        std::vector<uint8_t> result = first;
+        for (const UpdateCommand& command : commands) {
+            if (command.type == static_cast<uint8_t>(UpdateCommandType::CACHE_TILE)) {
+                tiles++;
+                aligned = aligned && command.x % TileCache::kTileSize == 0 && command.y % TileCache::kTileSize == 0 &&
+                          command.width == TileCache::kTileSize && command.height == TileCache::kTileSize;
+            }
+            if (command.type == static_cast<uint8_t>(UpdateCommandType::COPY_RECT)) {
+                FrameDelta::applyCopy(result.data(), kWidth, 4, command);
+                continue;
+            }
+            for (int row = 0; row < command.height; ++row) {
+                size_t offset = ((static_cast<size_t>(command.y) + row) * kWidth + command.x) * 4;
+                memcpy(result.data() + offset, second.data() + offset, static_cast<size_t>(command.width) * 4);
+            }
+        }
+        check(tiles > 0 && aligned, "Tuiles alignées sur la grille de 64 pixels");
+        check(result == second, "Frame reconstruite à l'identique");
+    }
+
+    // Bout en bout: deux bureaux alternés (changement de fenêtre)
+    {
+        const int kPort = 19351;
+        const int kStreamWidth = 1280;
+        const int kStreamHeight = 720;
+        const int kSwitches = 8;
+        StreamServer server("127.0.0.1", kPort);
+        if (!server.start()) {
+            std::cout << "✗ Démarrage du serveur\n";
+            Logger::shutdown();
+            return 1;
+        }
+
+        std::mutex mutex;
+        std::vector<uint8_t> expected_argb;
+        std::vector<uint8_t> expected_565;
+        std::atomic<uint32_t> argb_number(UINT32_MAX);
+        std::atomic<uint32_t> low_number(UINT32_MAX);
+        std::atomic<uint32_t> low_565_number(UINT32_MAX);
+        std::atomic<uint32_t> plain_number(UINT32_MAX);
+        std::atomic<int> mismatches(0);
+
+        auto matches = [&](const VideoFrame& frame) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return frame.data == (frame.format == PixelFormat::RGB565 ? expected_565 : expected_argb);
+        };
+        StreamClient argb_client("127.0.0.1", kPort);
+        argb_client.setTileCacheBlocks(255);
+        argb_client.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+            if (!matches(frame)) mismatches++;
+            argb_number = frame.frame_number;
+        });
+        StreamClient low_client("127.0.0.1", kPort);
+        low_client.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+            if (!matches(frame)) mismatches++;
+            if (frame.format == PixelFormat::RGB565) low_565_number = frame.frame_number;
+            low_number = frame.frame_number;
+        });
+        // Sans cache: les tuiles lui arrivent en RAW_RECT
+        StreamClient plain_client("127.0.0.1", kPort);
+        plain_client.setTileCacheBlocks(0);
+        plain_client.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+            if (!matches(frame)) mismatches++;
+            plain_number = frame.frame_number;
+        });
+        check(argb_client.connect() && low_client.connect() && plain_client.connect(), "Connexion des trois clients");
+        check(argb_client.getTileCacheCapacity() == TileCache::kMaxServerBlocks * TileCache::kBlockTiles,
+              "Capacité demandée bornée par le serveur");
+        check(low_client.getTileCacheCapacity() == TileCache::kDefaultClientBlocks * TileCache::kBlockTiles,
+              "Capacité par défaut accordée");
+        check(plain_client.getTileCacheCapacity() == 0, "Cache désactivé côté client");
+        check(low_client.setPixelFormat(PixelFormat::RGB565), "CONFIG RGB565 envoyé");
+
+        SyntheticFrameSource desktops[2] = {
+            SyntheticFrameSource(SyntheticFrameSource::Pattern::STATIC_DESKTOP, kStreamWidth, kStreamHeight, 11),
+            SyntheticFrameSource(SyntheticFrameSource::Pattern::STATIC_DESKTOP, kStreamWidth, kStreamHeight, 12)
+        };
+        desktops[0].init();
+        desktops[1].init();
+        VideoFrame frame;
+        frame.width = kStreamWidth;
+        frame.height = kStreamHeight;
+        frame.quality = 80;
+
+        auto broadcast = [&](uint32_t number) {
+            frame.frame_number = number;
+            frame.timestamp = get_monotonic_us();
+            frame.data = capture(desktops[number % 2]);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                expected_argb = frame.data;
+                expected_565.resize(PixelPacker::packedSize(PixelFormat::RGB565, kStreamWidth, kStreamHeight));
+                PixelPacker::pack(PixelFormat::RGB565, frame.data.data(),
+                                  static_cast<size_t>(kStreamWidth) * kStreamHeight, expected_565.data());
+            }
+            server.broadcastVideoFrame(frame);
+            return waitFor([&] {
+                return argb_number == number && low_number == number && plain_number == number;
+            });
+        };
+
+        // Le CONFIG est traité par le thread du client côté serveur
+        uint32_t number = 0;
+        check(waitFor([&] {
+            uint32_t sent = number++;
+            return broadcast(sent) && low_565_number == sent;
+        }), "Première frame reçue dans chaque format");
+
+        // Deux changements pour remplir les caches (frame complète puis mises à jour)
+        bool all_received = broadcast(number++) && broadcast(number++);
+        uint64_t argb_bytes = argb_client.getBytesReceived();
+        uint64_t plain_bytes = plain_client.getBytesReceived();
+        for (int i = 0; i < kSwitches; ++i) {
+            all_received = all_received && broadcast(number++);
+        }
+        argb_bytes = argb_client.getBytesReceived() - argb_bytes;
+        plain_bytes = plain_client.getBytesReceived() - plain_bytes;
+
+        check(all_received, "Toutes les frames reçues");
+        check(mismatches == 0, "Chaque frame reconstruite à l'identique (ARGB, RGB565, sans cache)");
+        check(argb_client.getDroppedFrameUpdates() == 0 && low_client.getDroppedFrameUpdates() == 0 &&
+              plain_client.getDroppedFrameUpdates() == 0, "Aucune mise à jour ignorée");
+        check(argb_client.getTileCacheHits() > 0 && low_client.getTileCacheHits() > 0, "Tuiles servies par le cache");
+        check(plain_client.getTileCacheHits() == 0 && plain_client.getTileCacheMisses() == 0,
+              "Client sans cache: aucune tuile");
+
+        uint64_t per_switch = argb_bytes / kSwitches;
+        std::cout << "  ARGB: " << per_switch << " octets/changement avec cache, "
+                  << plain_bytes / kSwitches << " sans (frame complète: "
+                  << PixelPacker::packedSize(PixelFormat::ARGB8888, kStreamWidth, kStreamHeight)
+                  << "), taux de réussite " << static_cast<int>(argb_client.getTileCacheHitRate() * 100) << "%\n";
+        check(per_switch * 8 < plain_bytes / kSwitches, "Retour à une fenêtre déjà vue: moins d'un huitième");
+        check(argb_client.getTileCacheHitRate() > 0.5, "Taux de réussite du cache");
+
+        argb_client.disconnect();
+        low_client.disconnect();
+        plain_client.disconnect();
+        server.stop();
+    }
+
+    Logger::shutdown();
+
+    if (failures == 0) {
+        std::cout << "\n✓ Tous les tests réussis!\n";
+        return 0;
+    }
+    std::cout << "\n✗ " << failures << " test(s) échoué(s)\n";
+    return 1;
+}
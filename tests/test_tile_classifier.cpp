@@ -0,0 +1,312 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../src/network/TileClassifier.h"
+#include "../src/network/PixelPacker.h"
+#include "../src/network/StreamServer.h"
+#include "../src/network/StreamClient.h"
+#include "../src/capture/SyntheticFrameSource.h"
+#include "../src/utils/Logger.h"
+#include "test_check.h"
+
+static bool waitFor(const std::function<bool()>& condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+static std::vector<uint8_t> capture(SyntheticFrameSource& source) {
+    int width = 0;
+    int height = 0;
+    return source.captureFrame(width, height);
+}
+
+// Zone vidéo incrustée dans le bureau, alignée sur la grille de tuiles
+struct Region {
+    int x, y, width, height;
+    bool contains(int px, int py) const { return px >= x && px < x + width && py >= y && py < y + height; }
+};
+
+// Hors de la zone: pixels exacts; dedans: exacts ou passés par RGB565
+static bool matchesRouted(const std::vector<uint8_t>& frame, const std::vector<uint8_t>& exact,
+                          const std::vector<uint8_t>& quantized, int width, int bytes_per_pixel,
+                          const Region& region, bool& saw_lossy) {
+    if (frame.size() != exact.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < frame.size(); i += bytes_per_pixel) {
+        if (memcmp(&frame[i], &exact[i], bytes_per_pixel) == 0) {
+            continue;
+        }
+        size_t pixel = i / bytes_per_pixel;
+        if (!region.contains(static_cast<int>(pixel % width), static_cast<int>(pixel / width)) ||
+            memcmp(&frame[i], &quantized[i], bytes_per_pixel) != 0) {
+            return false;
+        }
+        saw_lossy = true;
+    }
+    return true;
+}
+
+int main() {
+    std::cout << "=== Test classification des tuiles ===\n\n";
+    Logger::init("test_tile_classifier.log", Logger::LogLevel::WARN);
+
+    const int kTile = 64;
+    SyntheticFrameSource desktop(SyntheticFrameSource::Pattern::STATIC_DESKTOP, 640, 384, 5);
+    SyntheticFrameSource noise(SyntheticFrameSource::Pattern::VIDEO_NOISE, 640, 384, 5);
+    desktop.init();
+    noise.init();
+    std::vector<uint8_t> desktop_frame = capture(desktop);
+    std::vector<uint8_t> noise_frame = capture(noise);
+    const size_t stride = 640 * 4;
+
+    // Mesures et règles de décision
+    {
+        bool text = true;
+        for (int ty = 0; ty < 6; ++ty) {
+            for (int tx = 0; tx < 10; ++tx) {
+                TileClassifier::Features features = TileClassifier::measure(
+                    desktop_frame.data() + ty * kTile * stride + tx * kTile * 4, stride, kTile, kTile);
+                text = text && TileClassifier::classify(features, 0xFF) == TileClassifier::TileClass::TEXT;
+            }
+        }
+        check(text, "Bureau (texte, interface): TEXT même modifié à chaque frame");
+
+        TileClassifier::Features video = TileClassifier::measure(noise_frame.data(), stride, kTile, kTile);
+        check(video.colors == TileClassifier::kColorCap, "Vidéo: nombre de couleurs plafonné");
+        check(TileClassifier::classify(video, 0) == TileClassifier::TileClass::NATURAL, "Vidéo immobile: NATURAL");
+        check(TileClassifier::classify(video, 0xFF) == TileClassifier::TileClass::MOTION, "Vidéo modifiée: MOTION");
+        check(TileClassifier::classify(video, 0x03) == TileClassifier::TileClass::NATURAL,
+              "Deux changements récents: pas encore du mouvement");
+
+        // Bruit blanc: beaucoup de couleurs et de bords francs, immobile
+        std::vector<uint8_t> sharp(static_cast<size_t>(kTile) * kTile * 4);
+        uint32_t state = 12345;
+        for (uint8_t& byte : sharp) {
+            state = state * 1664525u + 1013904223u;
+            byte = static_cast<uint8_t>(state >> 24);
+        }
+        TileClassifier::Features features = TileClassifier::measure(sharp.data(), kTile * 4, kTile, kTile);
+        check(features.edges > TileClassifier::kMaxNaturalEdges &&
+              TileClassifier::classify(features, 0) == TileClassifier::TileClass::TEXT,
+              "Contraste élevé immobile: reste sans perte");
+    }
+
+    // Historique et mesures mises en cache d'une frame à l'autre
+    {
+        const int kWidth = 128;
+        const int kHeight = 128;
+        SyntheticFrameSource video(SyntheticFrameSource::Pattern::VIDEO_NOISE, kWidth, kHeight, 9);
+        video.init();
+        TileClassifier classifier(kTile);
+        std::vector<UpdateCommand> all = {
+            {static_cast<uint8_t>(UpdateCommandType::RAW_RECT), 0, 0, kWidth, kHeight, 0, 0}};
+        std::vector<uint8_t> frame;
+        for (uint32_t i = 0; i < TileClassifier::kMotionFrames; ++i) {
+            frame = capture(video);
+            classifier.update(frame.data(), kWidth, kHeight, all);
+        }
+        check(classifier.classAt(0, 0) == TileClassifier::TileClass::MOTION &&
+              classifier.classAt(kWidth - 1, kHeight - 1) == TileClassifier::TileClass::MOTION,
+              "Vidéo détectée en mouvement");
+        check(!classifier.settled(0, 0), "Vidéo en mouvement: pas immobile");
+        for (uint32_t i = TileClassifier::kMotionFrames; i < 2 * TileClassifier::kRemeasureFrames; ++i) {
+            frame = capture(video);
+            classifier.update(frame.data(), kWidth, kHeight, all);
+        }
+        check(classifier.measureCount() == 4 * 2, "Chaque tuile mesurée une fois toutes les kRemeasureFrames frames");
+
+        // Un défilement (COPY_RECT) n'est pas du mouvement
+        std::vector<UpdateCommand> scroll = {
+            {static_cast<uint8_t>(UpdateCommandType::COPY_RECT), 0, 0, kWidth, kHeight - 4, 0, 4}};
+        for (int i = 0; i < 8; ++i) {
+            classifier.update(frame.data(), kWidth, kHeight, scroll);
+        }
+        check(classifier.classAt(10, 10) == TileClassifier::TileClass::NATURAL, "Vidéo arrêtée: NATURAL");
+        check(classifier.settled(10, 10) && classifier.settled(kWidth, 0), "Vidéo arrêtée: immobile");
+        check(classifier.classAt(kWidth, 0) == TileClassifier::TileClass::TEXT, "Hors de la grille: TEXT");
+    }
+
+    // Bout en bout: bureau qui alterne + vidéo incrustée
+    {
+        const int kPort = 19361;
+        const int kStreamWidth = 1280;
+        const int kStreamHeight = 720;
+        const int kFrames = 16;
+        const Region region = {640, 128, 256, 192};
+        StreamServer server("127.0.0.1", kPort);
+        if (!server.start()) {
+            std::cout << "✗ Démarrage du serveur\n";
+            Logger::shutdown();
+            return 1;
+        }
+
+        std::mutex mutex;
+        std::vector<uint8_t> expected_argb;
+        std::vector<uint8_t> quantized_argb;
+        std::vector<uint8_t> expected_rgb24;
+        std::vector<uint8_t> quantized_rgb24;
+        std::atomic<uint32_t> exact_number(UINT32_MAX);
+        std::atomic<uint32_t> lossy_number(UINT32_MAX);
+        std::atomic<uint32_t> rgb24_number(UINT32_MAX);
+        std::atomic<uint32_t> rgb24_format_number(UINT32_MAX);
+        std::atomic<int> mismatches(0);
+        std::atomic<int> lossy_frames(0);
+        std::atomic<bool> lossy_exact(false);
+        std::atomic<bool> rgb24_exact(false);
+
+        StreamClient exact_client("127.0.0.1", kPort);
+        exact_client.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (frame.data != expected_argb) mismatches++;
+            exact_number = frame.frame_number;
+        });
+        StreamClient lossy_client("127.0.0.1", kPort);
+        lossy_client.setLossyTiles(true);
+        lossy_client.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            bool saw_lossy = false;
+            if (!matchesRouted(frame.data, expected_argb, quantized_argb, kStreamWidth, 4, region, saw_lossy)) {
+                mismatches++;
+            }
+            if (saw_lossy) lossy_frames++;
+            lossy_exact = frame.data == expected_argb;
+            lossy_number = frame.frame_number;
+        });
+        StreamClient rgb24_client("127.0.0.1", kPort);
+        rgb24_client.setLossyTiles(true);
+        rgb24_client.setVideoFrameCallback([&](const VideoFrame& frame, const std::vector<uint8_t>&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            bool saw_lossy = false;
+            bool rgb24 = frame.format == PixelFormat::RGB24;
+            if (!matchesRouted(frame.data, rgb24 ? expected_rgb24 : expected_argb,
+                               rgb24 ? quantized_rgb24 : quantized_argb, kStreamWidth, rgb24 ? 3 : 4,
+                               region, saw_lossy)) {
+                mismatches++;
+            }
+            if (rgb24) rgb24_format_number = frame.frame_number;
+            rgb24_exact = rgb24 && frame.data == expected_rgb24;
+            rgb24_number = frame.frame_number;
+        });
+        check(exact_client.connect() && lossy_client.connect() && rgb24_client.connect(), "Connexion des trois clients");
+        check(rgb24_client.setPixelFormat(PixelFormat::RGB24), "CONFIG RGB24 envoyé");
+
+        SyntheticFrameSource desktops[2] = {
+            SyntheticFrameSource(SyntheticFrameSource::Pattern::STATIC_DESKTOP, kStreamWidth, kStreamHeight, 21),
+            SyntheticFrameSource(SyntheticFrameSource::Pattern::STATIC_DESKTOP, kStreamWidth, kStreamHeight, 22)
+        };
+        SyntheticFrameSource player(SyntheticFrameSource::Pattern::VIDEO_NOISE, kStreamWidth, kStreamHeight, 23);
+        desktops[0].init();
+        desktops[1].init();
+        player.init();
+        VideoFrame frame;
+        frame.width = kStreamWidth;
+        frame.height = kStreamHeight;
+        frame.quality = 80;
+
+        const size_t pixels = static_cast<size_t>(kStreamWidth) * kStreamHeight;
+        bool paused = false;                // même image que la frame précédente
+        auto broadcast = [&](uint32_t number) {
+            frame.frame_number = number;
+            frame.timestamp = get_monotonic_us();
+            if (!paused) {
+                frame.data = capture(desktops[number % 2]);
+                std::vector<uint8_t> video = capture(player);
+                for (int y = region.y; y < region.y + region.height; ++y) {
+                    size_t offset = (static_cast<size_t>(y) * kStreamWidth + region.x) * 4;
+                    memcpy(frame.data.data() + offset, video.data() + offset, static_cast<size_t>(region.width) * 4);
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                expected_argb = frame.data;
+                std::vector<uint8_t> rgb565(PixelPacker::packedSize(PixelFormat::RGB565, kStreamWidth, kStreamHeight));
+                PixelPacker::pack(PixelFormat::RGB565, frame.data.data(), pixels, rgb565.data());
+                quantized_argb.resize(frame.data.size());
+                PixelPacker::unpack(PixelFormat::RGB565, rgb565.data(), kStreamWidth, kStreamHeight,
+                                    quantized_argb.data(), static_cast<size_t>(kStreamWidth) * 4);
+                expected_rgb24.resize(PixelPacker::packedSize(PixelFormat::RGB24, kStreamWidth, kStreamHeight));
+                quantized_rgb24.resize(expected_rgb24.size());
+                PixelPacker::pack(PixelFormat::RGB24, expected_argb.data(), pixels, expected_rgb24.data());
+                PixelPacker::pack(PixelFormat::RGB24, quantized_argb.data(), pixels, quantized_rgb24.data());
+            }
+            server.broadcastVideoFrame(frame);
+            return waitFor([&] {
+                return exact_number == number && lossy_number == number && rgb24_number == number;
+            });
+        };
+
+        // Le CONFIG est traité par le thread du client côté serveur
+        uint32_t number = 0;
+        check(waitFor([&] {
+            uint32_t sent = number++;
+            return broadcast(sent) && rgb24_format_number == sent;
+        }), "Première frame reçue dans chaque format");
+
+        // Quelques frames pour que la vidéo soit classée en mouvement
+        bool all_received = true;
+        for (uint32_t i = 0; i < TileClassifier::kMotionFrames + 2; ++i) {
+            all_received = all_received && broadcast(number++);
+        }
+        uint64_t exact_bytes = exact_client.getBytesReceived();
+        uint64_t lossy_bytes = lossy_client.getBytesReceived();
+        int lossy_before = lossy_frames;
+        for (int i = 0; i < kFrames; ++i) {
+            all_received = all_received && broadcast(number++);
+        }
+        exact_bytes = exact_client.getBytesReceived() - exact_bytes;
+        lossy_bytes = lossy_client.getBytesReceived() - lossy_bytes;
+
+        check(all_received, "Toutes les frames reçues");
+        check(mismatches == 0, "Texte exact partout, vidéo exacte ou RGB565 (ARGB et RGB24)");
+        check(lossy_frames - lossy_before == kFrames, "Vidéo envoyée en LOSSY_RECT une fois détectée");
+        check(lossy_client.getReceivedLossyTiles() > 0 && rgb24_client.getReceivedLossyTiles() > 0,
+              "Tuiles LOSSY_RECT reçues");
+        check(exact_client.getReceivedLossyTiles() == 0, "Client sans perte: aucune tuile LOSSY_RECT");
+        check(lossy_client.getDroppedFrameUpdates() == 0 && rgb24_client.getDroppedFrameUpdates() == 0,
+              "Aucune mise à jour ignorée");
+
+        std::cout << "  " << exact_bytes / kFrames << " octets/frame sans perte, "
+                  << lossy_bytes / kFrames << " avec LOSSY_RECT\n";
+        check(lossy_bytes * 10 < exact_bytes * 7, "Moins d'octets par frame avec LOSSY_RECT");
+
+        // Vidéo en pause: la même frame diffusée à nouveau, les tuiles reçues
+        // en RGB565 sont renvoyées exactes une fois immobiles
+        paused = true;
+        bool paused_received = true;
+        for (int i = 0; i < TileClassifier::kSettledFrames - 1; ++i) {
+            paused_received = paused_received && broadcast(number++);
+        }
+        check(!lossy_exact && !rgb24_exact, "Vidéo tout juste en pause: encore en RGB565");
+        paused_received = paused_received && broadcast(number++);
+        check(paused_received, "Frames de la pause reçues");
+        check(lossy_exact && rgb24_exact, "Vidéo en pause: pixels exacts chez les clients LOSSY_RECT");
+        paused_received = paused_received && broadcast(number++);
+        check(paused_received && lossy_exact && rgb24_exact && mismatches == 0, "Pixels exacts conservés ensuite");
+
+        exact_client.disconnect();
+        lossy_client.disconnect();
+        rgb24_client.disconnect();
+        server.stop();
+    }
+
+    Logger::shutdown();
+
+    if (failures == 0) {
+        std::cout << "\n✓ Tous les tests réussis!\n";
+        return 0;
+    }
+    std::cout << "\n✗ " << failures << " test(s) échoué(s)\n";
+    return 1;
+}
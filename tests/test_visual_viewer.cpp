@@ -3,15 +3,20 @@
 #include <thread>
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
+#include <memory>
 #include <SDL.h>
 #include "../src/network/StreamClient.h"
+#include "../src/network/PixelPacker.h"
 #include "../src/utils/Logger.h"
 
 class VisualViewer {
 public:
     VisualViewer() : window_(nullptr), renderer_(nullptr), texture_(nullptr),
                      current_width_(0), current_height_(0),
-                     video_frames_(0), audio_frames_(0), running_(true) {
+                     video_frames_(0), audio_frames_(0), running_(true),
+                     cursor_texture_(nullptr), cursor_serial_(0), cursor_(), has_cursor_(false),
+                     origin_x_(0), origin_y_(0) {
         start_time_ = std::chrono::steady_clock::now();
     }
     
@@ -76,10 +81,11 @@ public:
                 SDL_DestroyTexture(texture_);
             }
             
-            // Try BGRA8888 format which is more compatible with Windows ARGB data
+            // Frames en octets A, R, G, B: format défini par ordre des octets,
+            // identique quel que soit l'endianness de la machine
             texture_ = SDL_CreateTexture(
                 renderer_,
-                SDL_PIXELFORMAT_BGRA8888,
+                SDL_PIXELFORMAT_ARGB32,
                 SDL_TEXTUREACCESS_STREAMING,
                 frame.width,
                 frame.height
@@ -100,7 +106,7 @@ public:
         
         if (texture_ && !frame.data.empty()) {
             // Verify data size
-            size_t expected_size = frame.width * frame.height * 4; // ARGB = 4 bytes per pixel
+            size_t expected_size = PixelPacker::packedSize(frame.format, frame.width, frame.height);
             if (frame.data.size() >= expected_size) {
                 // Debug: Check first few pixels to see if data is valid
                 if (video_frames_ == 1) {
@@ -112,29 +118,20 @@ public:
                     Logger::log(Logger::LogLevel::INFO, ss.str());
                 }
                 
-                // Update texture with frame data
-                int result = SDL_UpdateTexture(texture_, nullptr, frame.data.data(), frame.width * 4);
-                if (result != 0) {
-                    Logger::log(Logger::LogLevel::ERROR_LEVEL, "SDL_UpdateTexture failed: " + std::string(SDL_GetError()));
+                // Décodage directement dans la texture: pas de copie ARGB intermédiaire
+                void* pixels = nullptr;
+                int pitch = 0;
+                if (SDL_LockTexture(texture_, nullptr, &pixels, &pitch) != 0) {
+                    Logger::log(Logger::LogLevel::ERROR_LEVEL, "SDL_LockTexture failed: " + std::string(SDL_GetError()));
                     return;
                 }
+                PixelPacker::unpack(frame.format, frame.data.data(), frame.width, frame.height,
+                                    static_cast<uint8_t*>(pixels), static_cast<size_t>(pitch));
+                SDL_UnlockTexture(texture_);
                 
-                // Clear with a test color to verify rendering works
-                SDL_SetRenderDrawColor(renderer_, 50, 50, 50, 255);
-                SDL_RenderClear(renderer_);
-                
-                // Render the texture
-                int copy_result = SDL_RenderCopy(renderer_, texture_, nullptr, nullptr);
-                if (copy_result != 0) {
-                    Logger::log(Logger::LogLevel::ERROR_LEVEL, "SDL_RenderCopy failed: " + std::string(SDL_GetError()));
-                } else if (video_frames_ == 1) {
+                if (redraw() && video_frames_ == 1) {
                     Logger::log(Logger::LogLevel::INFO, "First frame rendered successfully");
                 }
-                
-                // Draw FPS overlay
-                drawStats();
-                
-                SDL_RenderPresent(renderer_);
             } else {
                 std::stringstream ss;
                 ss << "Frame data size mismatch: got " << frame.data.size() 
@@ -148,6 +145,29 @@ public:
         }
     }
     
+    // Curseur composé localement: un déplacement redessine la dernière
+    // frame sans attendre de nouvelle frame vidéo
+    void onCursor(const CursorPosition& position, std::shared_ptr<const CursorImage> shape) {
+        cursor_ = position;
+        has_cursor_ = true;
+        if (shape && shape->serial != cursor_serial_) {
+            updateCursorTexture(*shape);
+        }
+        if (texture_) {
+            redraw();
+        }
+    }
+    
+    // Origine du flux 0 dans l'écran X (multi-moniteurs)
+    void onStreamList(const std::vector<StreamInfo>& streams) {
+        for (const StreamInfo& info : streams) {
+            if (info.stream_id == 0) {
+                origin_x_ = info.x;
+                origin_y_ = info.y;
+            }
+        }
+    }
+    
     void onAudioFrame(const AudioFrame& frame) {
         audio_frames_++;
     }
@@ -185,6 +205,84 @@ public:
     }
     
 private:
+    bool redraw() {
+        // Clear with a test color to verify rendering works
+        SDL_SetRenderDrawColor(renderer_, 50, 50, 50, 255);
+        SDL_RenderClear(renderer_);
+        
+        // Render the texture
+        int copy_result = SDL_RenderCopy(renderer_, texture_, nullptr, nullptr);
+        if (copy_result != 0) {
+            Logger::log(Logger::LogLevel::ERROR_LEVEL, "SDL_RenderCopy failed: " + std::string(SDL_GetError()));
+        }
+        
+        drawCursor();
+        
+        // Draw FPS overlay
+        drawStats();
+        
+        SDL_RenderPresent(renderer_);
+        return copy_result == 0;
+    }
+    
+    void updateCursorTexture(const CursorImage& shape) {
+        if (cursor_texture_) {
+            SDL_DestroyTexture(cursor_texture_);
+            cursor_texture_ = nullptr;
+        }
+        cursor_serial_ = shape.serial;
+        cursor_width_ = shape.width;
+        cursor_height_ = shape.height;
+        cursor_xhot_ = shape.xhot;
+        cursor_yhot_ = shape.yhot;
+        if (shape.width == 0 || shape.height == 0) {
+            return;
+        }
+        
+        // Alpha prémultiplié -> alpha simple pour SDL_BLENDMODE_BLEND
+        std::vector<uint8_t> pixels(shape.pixels);
+        for (size_t i = 0; i < pixels.size(); i += 4) {
+            uint32_t alpha = pixels[i];
+            if (alpha != 0 && alpha != 255) {
+                for (size_t c = 1; c < 4; ++c) {
+                    pixels[i + c] = static_cast<uint8_t>(std::min<uint32_t>(255, pixels[i + c] * 255 / alpha));
+                }
+            }
+        }
+        
+        cursor_texture_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB32, SDL_TEXTUREACCESS_STATIC,
+                                            shape.width, shape.height);
+        if (!cursor_texture_) {
+            Logger::log(Logger::LogLevel::WARN, "Failed to create cursor texture: " + std::string(SDL_GetError()));
+            return;
+        }
+        SDL_UpdateTexture(cursor_texture_, nullptr, pixels.data(), shape.width * 4);
+        SDL_SetTextureBlendMode(cursor_texture_, SDL_BLENDMODE_BLEND);
+    }
+    
+    void drawCursor() {
+        if (!has_cursor_ || !cursor_.visible || !cursor_texture_ || current_width_ == 0 || current_height_ == 0) {
+            return;
+        }
+        
+        // La frame est étirée sur la fenêtre: même échelle pour le curseur
+        int output_width = 0;
+        int output_height = 0;
+        SDL_GetRendererOutputSize(renderer_, &output_width, &output_height);
+        double scale_x = static_cast<double>(output_width) / current_width_;
+        double scale_y = static_cast<double>(output_height) / current_height_;
+        
+        int x = cursor_.x - origin_x_ - cursor_xhot_;
+        int y = cursor_.y - origin_y_ - cursor_yhot_;
+        SDL_Rect rect = {
+            static_cast<int>(x * scale_x),
+            static_cast<int>(y * scale_y),
+            static_cast<int>(cursor_width_ * scale_x + 0.5),
+            static_cast<int>(cursor_height_ * scale_y + 0.5)
+        };
+        SDL_RenderCopy(renderer_, cursor_texture_, nullptr, &rect);
+    }
+    
     void drawStats() {
         // Calculate FPS
         auto now = std::chrono::steady_clock::now();
@@ -211,6 +309,10 @@ private:
     }
     
     void cleanup() {
+        if (cursor_texture_) {
+            SDL_DestroyTexture(cursor_texture_);
+            cursor_texture_ = nullptr;
+        }
         if (texture_) {
             SDL_DestroyTexture(texture_);
             texture_ = nullptr;
@@ -235,6 +337,18 @@ private:
     uint64_t audio_frames_;
     bool running_;
     std::chrono::steady_clock::time_point start_time_;
+    
+    // Curseur (paquets CURSOR / CURSOR_SHAPE)
+    SDL_Texture* cursor_texture_;
+    uint32_t cursor_serial_;
+    int cursor_width_ = 0;
+    int cursor_height_ = 0;
+    int cursor_xhot_ = 0;
+    int cursor_yhot_ = 0;
+    CursorPosition cursor_;
+    bool has_cursor_;
+    int origin_x_;
+    int origin_y_;
 };
 
 // SDL2 requires main to return int and take argc/argv on Windows
@@ -246,6 +360,7 @@ int main(int argc, char* argv[]) {
     // Parse command line arguments
     std::string server_address = "127.0.0.1";
     int server_port = 9999;
+    PixelFormat pixel_format = PixelFormat::ARGB8888;
     
     if (argc > 1) {
         server_address = argv[1];
@@ -253,6 +368,10 @@ int main(int argc, char* argv[]) {
     if (argc > 2) {
         server_port = std::atoi(argv[2]);
     }
+    if (argc > 3 && !PixelPacker::parse(argv[3], pixel_format)) {
+        std::cerr << "Usage: " << argv[0] << " [address] [port] [argb|rgb24|rgb565]\n";
+        return 1;
+    }
     
     // Create viewer
     VisualViewer viewer;
@@ -279,6 +398,14 @@ int main(int argc, char* argv[]) {
         viewer.onAudioFrame(frame);
     });
     
+    client.setCursorCallback([&viewer](const CursorPosition& position, std::shared_ptr<const CursorImage> shape) {
+        viewer.onCursor(position, shape);
+    });
+    
+    client.setStreamListCallback([&viewer](const std::vector<StreamInfo>& streams) {
+        viewer.onStreamList(streams);
+    });
+    
     client.setDisconnectCallback([&viewer]() {
         viewer.onDisconnect();
     });
@@ -293,6 +420,11 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    if (pixel_format != PixelFormat::ARGB8888) {
+        client.setPixelFormat(pixel_format);
+        std::cout << "Pixel format: " << PixelPacker::name(pixel_format) << "\n";
+    }
+
     std::cout << "✓ Connected successfully! Displaying stream...\n";
     Logger::log(Logger::LogLevel::INFO, "Successfully connected, waiting for frames...");
     std::cout << "Press ESC or close window to exit.\n\n";
@@ -0,0 +1,468 @@
+// Générateur de charge pour StreamServer
+//
+//   load_generator --clients 200 --duration 60
+//   load_generator --clients 300 --ramp 20 --step-seconds 5 --server-pid $(pidof screen_share)
+//   load_generator --clients 50 --slow-fraction 0.2 --throttle-kbps 2000 --json load.json
+//   load_generator --clients 50 --format rgb565
+//
+// Chaque client est un StreamClient complet (handshake, heartbeats, mesure de
+// latence capture -> affichage). Les clients lents limitent leur débit de
+// lecture dans le callback vidéo: le receive thread est bloqué, le tampon TCP
+// se remplit et le serveur voit un lien lent.
+
+#include "network/StreamClient.h"
+#include "network/PixelPacker.h"
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<bool> g_stop(false);
+
+    void onSignal(int) {
+        g_stop = true;
+    }
+
+    struct Options {
+        std::string host = "127.0.0.1";
+        int port = 9999;
+        int clients = 10;
+        int duration_s = 30;
+        int ramp = 0;                   // clients ajoutés par palier (0 = tous d'un coup)
+        int step_seconds = 5;
+        double slow_fraction = 0.0;     // part des clients à débit limité
+        double throttle_kbps = 0.0;     // débit de lecture des clients lents
+        int server_pid = 0;
+        std::string json_path;
+        PixelFormat format = PixelFormat::ARGB8888;
+    };
+
+    struct LoadClient {
+        int index = 0;
+        double throttle_bytes_per_s = 0.0;
+        std::unique_ptr<StreamClient> client;
+        Clock::time_point connected_at;
+        Clock::time_point disconnected_at;
+        bool connect_failed = false;
+        bool lost = false;              // coupé par le serveur avant la fin
+
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> gaps{0};  // numéros de frame sautés (frames non reçues)
+        std::atomic<uint64_t> bytes{0};
+        int64_t last_frame = -1;        // receive thread uniquement
+        Clock::time_point next_read;    // receive thread uniquement
+    };
+
+    // Temps CPU cumulé (utime + stime) d'un processus, en secondes
+    bool processCpuSeconds(int pid, double& seconds) {
+#ifdef __linux__
+        std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+        std::string line;
+        if (!std::getline(stat, line)) {
+            return false;
+        }
+        // Le nom du processus peut contenir des espaces: repartir après ')'
+        size_t end = line.rfind(')');
+        if (end == std::string::npos) {
+            return false;
+        }
+        std::istringstream fields(line.substr(end + 2));
+        std::string field;
+        unsigned long long utime = 0, stime = 0;
+        // Champs 3..13 ignorés, 14 = utime, 15 = stime
+        for (int i = 3; i <= 15 && fields >> field; ++i) {
+            if (i == 14) utime = std::strtoull(field.c_str(), nullptr, 10);
+            if (i == 15) stime = std::strtoull(field.c_str(), nullptr, 10);
+        }
+        seconds = static_cast<double>(utime + stime) / static_cast<double>(sysconf(_SC_CLK_TCK));
+        return true;
+#else
+        (void)pid;
+        (void)seconds;
+        return false;
+#endif
+    }
+
+    void usage(const char* argv0) {
+        std::cerr << "Usage: " << argv0 << " [options]\n"
+                  << "  --host <addr>           server address (127.0.0.1)\n"
+                  << "  --port <port>           server port (9999)\n"
+                  << "  --clients <n>           number of clients (10)\n"
+                  << "  --duration <s>          run time once all clients are started (30)\n"
+                  << "  --ramp <n>              add n clients per step instead of all at once\n"
+                  << "  --step-seconds <s>      time between ramp steps (5)\n"
+                  << "  --slow-fraction <f>     fraction of clients with throttled reads (0)\n"
+                  << "  --throttle-kbps <k>     read rate of slow clients, kilobytes/s\n"
+                  << "  --server-pid <pid>      sample server CPU from /proc/<pid>/stat\n"
+                  << "  --format <f>            pixel format requested: argb, rgb24, rgb565 (argb)\n"
+                  << "  --json <path>           write per-client results as JSON\n";
+    }
+
+    bool parseOptions(int argc, char** argv, Options& opts) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+                return false;
+            }
+            const char* value = argv[++i];
+            if (arg == "--host") opts.host = value;
+            else if (arg == "--port") opts.port = std::atoi(value);
+            else if (arg == "--clients") opts.clients = std::atoi(value);
+            else if (arg == "--duration") opts.duration_s = std::atoi(value);
+            else if (arg == "--ramp") opts.ramp = std::atoi(value);
+            else if (arg == "--step-seconds") opts.step_seconds = std::atoi(value);
+            else if (arg == "--slow-fraction") opts.slow_fraction = std::atof(value);
+            else if (arg == "--throttle-kbps") opts.throttle_kbps = std::atof(value);
+            else if (arg == "--server-pid") opts.server_pid = std::atoi(value);
+            else if (arg == "--json") opts.json_path = value;
+            else if (arg == "--format") {
+                if (!PixelPacker::parse(value, opts.format)) return false;
+            }
+            else return false;
+        }
+        return opts.clients > 0 && opts.duration_s > 0 && opts.step_seconds > 0;
+    }
+
+    bool startClient(LoadClient& lc, const Options& opts) {
+        lc.client = std::make_unique<StreamClient>(opts.host, opts.port);
+        LoadClient* self = &lc;
+        lc.client->setVideoFrameCallback([self](const VideoFrame& frame, const std::vector<uint8_t>& data) {
+            int64_t number = frame.frame_number;
+            if (self->last_frame >= 0 && number > self->last_frame + 1) {
+                self->gaps.fetch_add(static_cast<uint64_t>(number - self->last_frame - 1), std::memory_order_relaxed);
+            }
+            self->last_frame = number;
+            self->frames.fetch_add(1, std::memory_order_relaxed);
+            self->bytes.fetch_add(data.size(), std::memory_order_relaxed);
+
+            // Lien lent: attendre que le "débit" autorise la frame suivante
+            if (self->throttle_bytes_per_s > 0.0) {
+                auto now = Clock::now();
+                self->next_read = std::max(self->next_read, now) + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(static_cast<double>(data.size()) / self->throttle_bytes_per_s));
+                while (!g_stop && Clock::now() < self->next_read) {
+                    std::this_thread::sleep_for(std::min<Clock::duration>(
+                        self->next_read - Clock::now(), std::chrono::milliseconds(50)));
+                }
+            }
+        });
+        lc.next_read = Clock::now();
+        if (!lc.client->connect()) {
+            lc.connect_failed = true;
+            return false;
+        }
+        if (opts.format != PixelFormat::ARGB8888) {
+            lc.client->setPixelFormat(opts.format);
+        }
+        lc.connected_at = Clock::now();
+        return true;
+    }
+
+    double seconds(Clock::duration d) {
+        return std::chrono::duration<double>(d).count();
+    }
+}
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parseOptions(argc, argv, opts)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    Logger::init("load_generator.log", Logger::LogLevel::WARN);
+
+    int slow_clients = static_cast<int>(opts.clients * std::min(1.0, std::max(0.0, opts.slow_fraction)) + 0.5);
+    if (slow_clients > 0 && opts.throttle_kbps <= 0.0) {
+        std::cerr << "--slow-fraction needs --throttle-kbps" << std::endl;
+        Logger::shutdown();
+        return 1;
+    }
+
+    std::cout << "=== Load generator ===\n"
+              << "Target: " << opts.host << ":" << opts.port << ", " << opts.clients << " client(s)";
+    if (slow_clients > 0) {
+        std::cout << ", " << slow_clients << " throttled to " << opts.throttle_kbps << " KB/s";
+    }
+    std::cout << ", pixels " << PixelPacker::name(opts.format) << "\n\n";
+
+    std::vector<std::unique_ptr<LoadClient>> clients;
+    clients.reserve(opts.clients);
+    for (int i = 0; i < opts.clients; ++i) {
+        auto lc = std::make_unique<LoadClient>();
+        lc->index = i;
+        // Clients lents répartis uniformément parmi les autres
+        bool slow = slow_clients > 0 && (i * slow_clients) / opts.clients != ((i + 1) * slow_clients) / opts.clients;
+        lc->throttle_bytes_per_s = slow ? opts.throttle_kbps * 1024.0 : 0.0;
+        clients.push_back(std::move(lc));
+    }
+
+    double cpu_start = 0.0;
+    double cpu_last = 0.0;
+    bool have_cpu = opts.server_pid > 0 && processCpuSeconds(opts.server_pid, cpu_start);
+    if (opts.server_pid > 0 && !have_cpu) {
+        std::cerr << "Cannot read CPU time of pid " << opts.server_pid << std::endl;
+    }
+    cpu_last = cpu_start;
+
+    struct Sample {
+        double t;
+        int clients;
+        double fps;
+        uint64_t gaps;
+        double cpu_percent;
+    };
+    std::vector<Sample> timeline;
+
+    std::printf("%8s %8s %10s %10s %10s %10s\n", "time(s)", "clients", "fps(all)", "fps/client", "gaps", "server%");
+
+    const int step = opts.ramp > 0 ? opts.ramp : opts.clients;
+    int started = 0;
+    auto start = Clock::now();
+    auto next_step = start;
+    auto last_sample = start;
+    uint64_t last_frames = 0;
+    uint64_t last_gaps = 0;
+    Clock::time_point all_started;
+    bool all_running = false;
+
+    while (!g_stop) {
+        auto now = Clock::now();
+
+        if (started < opts.clients && now >= next_step) {
+            int target = std::min(opts.clients, started + step);
+            for (; started < target && !g_stop; ++started) {
+                if (!startClient(*clients[started], opts)) {
+                    std::cerr << "Client " << started << " failed to connect" << std::endl;
+                }
+            }
+            next_step = Clock::now() + std::chrono::seconds(opts.step_seconds);
+            if (started == opts.clients) {
+                all_started = Clock::now();
+                all_running = true;
+            }
+        }
+
+        if (all_running && now - all_started >= std::chrono::seconds(opts.duration_s)) {
+            break;
+        }
+
+        if (now - last_sample >= std::chrono::seconds(1)) {
+            uint64_t frames = 0;
+            uint64_t gaps = 0;
+            int connected = 0;
+            for (int i = 0; i < started; ++i) {
+                LoadClient& lc = *clients[i];
+                frames += lc.frames.load(std::memory_order_relaxed);
+                gaps += lc.gaps.load(std::memory_order_relaxed);
+                if (lc.client && lc.client->isConnected()) {
+                    connected++;
+                } else if (!lc.connect_failed && !lc.lost) {
+                    lc.lost = true;
+                    lc.disconnected_at = now;
+                }
+            }
+
+            double dt = seconds(now - last_sample);
+            Sample sample;
+            sample.t = seconds(now - start);
+            sample.clients = connected;
+            sample.fps = static_cast<double>(frames - last_frames) / dt;
+            sample.gaps = gaps - last_gaps;
+            sample.cpu_percent = -1.0;
+            double cpu_now = 0.0;
+            if (have_cpu && processCpuSeconds(opts.server_pid, cpu_now)) {
+                sample.cpu_percent = (cpu_now - cpu_last) / dt * 100.0;
+                cpu_last = cpu_now;
+            }
+            timeline.push_back(sample);
+
+            char cpu_text[16] = "n/a";
+            if (sample.cpu_percent >= 0.0) {
+                std::snprintf(cpu_text, sizeof(cpu_text), "%.1f", sample.cpu_percent);
+            }
+            std::printf("%8.1f %8d %10.1f %10.2f %10llu %10s\n", sample.t, connected, sample.fps,
+                        connected ? sample.fps / connected : 0.0,
+                        static_cast<unsigned long long>(sample.gaps), cpu_text);
+            std::fflush(stdout);
+
+            last_frames = frames;
+            last_gaps = gaps;
+            last_sample = now;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    auto end = Clock::now();
+    double cpu_end = cpu_last;
+    if (have_cpu) {
+        processCpuSeconds(opts.server_pid, cpu_end);
+    }
+
+    // Résultats figés avant la déconnexion
+    struct ClientResult {
+        int index;
+        bool slow;
+        bool connected;
+        bool lost;
+        uint64_t frames;
+        uint64_t gaps;
+        uint64_t bytes;
+        double fps;
+        HistogramSnapshot latency;
+    };
+    std::vector<ClientResult> results;
+    HistogramSnapshot all_latency;
+    for (int i = 0; i < started; ++i) {
+        LoadClient& lc = *clients[i];
+        ClientResult r;
+        r.index = lc.index;
+        r.slow = lc.throttle_bytes_per_s > 0.0;
+        r.connected = !lc.connect_failed;
+        r.lost = lc.lost || (r.connected && !lc.client->isConnected());
+        r.frames = lc.frames.load();
+        r.gaps = lc.gaps.load();
+        r.bytes = lc.bytes.load();
+        double alive = r.connected ? seconds((lc.lost ? lc.disconnected_at : end) - lc.connected_at) : 0.0;
+        r.fps = alive > 0.0 ? static_cast<double>(r.frames) / alive : 0.0;
+        if (r.connected) {
+            r.latency = lc.client->getGlassLatency();
+            all_latency.merge(r.latency);
+        }
+        results.push_back(r);
+    }
+
+    std::cout << "\nStopping clients..." << std::endl;
+    g_stop = true;
+    for (int i = 0; i < started; ++i) {
+        if (clients[i]->client) {
+            clients[i]->client->disconnect();
+        }
+    }
+
+    // Résumé
+    int connect_failures = 0;
+    int lost = 0;
+    std::vector<double> fps_values;
+    uint64_t total_gaps = 0;
+    uint64_t total_frames = 0;
+    for (const ClientResult& r : results) {
+        connect_failures += r.connected ? 0 : 1;
+        lost += r.lost ? 1 : 0;
+        if (r.connected) {
+            fps_values.push_back(r.fps);
+        }
+        total_gaps += r.gaps;
+        total_frames += r.frames;
+    }
+    std::sort(fps_values.begin(), fps_values.end());
+    auto fpsAt = [&](double q) {
+        return fps_values.empty() ? 0.0 : fps_values[std::min(fps_values.size() - 1, static_cast<size_t>(q * fps_values.size()))];
+    };
+    double elapsed = seconds(end - start);
+    double server_cpu = have_cpu ? (cpu_end - cpu_start) / elapsed * 100.0 : -1.0;
+
+    std::cout << "\n=== Summary ===\n"
+              << "Clients started: " << started << ", connect failures: " << connect_failures
+              << ", dropped by server: " << lost << "\n"
+              << "Frames received: " << total_frames << ", skipped frame numbers: " << total_gaps << "\n";
+    std::printf("Per-client fps: min %.2f, p10 %.2f, median %.2f, max %.2f\n",
+                fpsAt(0.0), fpsAt(0.1), fpsAt(0.5), fps_values.empty() ? 0.0 : fps_values.back());
+    std::printf("Glass-to-glass latency (us): p50 %llu, p90 %llu, p99 %llu, max %llu (%llu frames)\n",
+                static_cast<unsigned long long>(all_latency.percentile(0.5)),
+                static_cast<unsigned long long>(all_latency.percentile(0.9)),
+                static_cast<unsigned long long>(all_latency.percentile(0.99)),
+                static_cast<unsigned long long>(all_latency.max),
+                static_cast<unsigned long long>(all_latency.count));
+    if (server_cpu >= 0.0) {
+        std::printf("Server CPU: %.1f%% average over %.1fs\n", server_cpu, elapsed);
+    }
+
+    // Les 10 clients les plus lents
+    std::vector<const ClientResult*> slowest;
+    for (const ClientResult& r : results) {
+        if (r.connected) {
+            slowest.push_back(&r);
+        }
+    }
+    std::sort(slowest.begin(), slowest.end(), [](const ClientResult* a, const ClientResult* b) { return a->fps < b->fps; });
+    if (!slowest.empty()) {
+        std::printf("\n%6s %6s %8s %8s %10s %10s %6s\n", "client", "slow", "fps", "gaps", "p50(us)", "p99(us)", "lost");
+        for (size_t i = 0; i < std::min<size_t>(10, slowest.size()); ++i) {
+            const ClientResult& r = *slowest[i];
+            std::printf("%6d %6s %8.2f %8llu %10llu %10llu %6s\n", r.index, r.slow ? "yes" : "no", r.fps,
+                        static_cast<unsigned long long>(r.gaps),
+                        static_cast<unsigned long long>(r.latency.percentile(0.5)),
+                        static_cast<unsigned long long>(r.latency.percentile(0.99)),
+                        r.lost ? "yes" : "no");
+        }
+    }
+
+    if (!opts.json_path.empty()) {
+        std::ofstream out(opts.json_path);
+        char buffer[512];
+        out << "{\n  \"config\": {\"host\": \"" << opts.host << "\", \"port\": " << opts.port
+            << ", \"clients\": " << opts.clients << ", \"duration_s\": " << opts.duration_s
+            << ", \"ramp\": " << opts.ramp << ", \"step_seconds\": " << opts.step_seconds
+            << ", \"slow_clients\": " << slow_clients << ", \"throttle_kbps\": " << opts.throttle_kbps << "},\n";
+        std::snprintf(buffer, sizeof(buffer),
+            "  \"summary\": {\"elapsed_s\": %.2f, \"connect_failures\": %d, \"lost\": %d, \"frames\": %llu, "
+            "\"gaps\": %llu, \"fps_min\": %.2f, \"fps_median\": %.2f, \"latency_p50_us\": %llu, "
+            "\"latency_p99_us\": %llu, \"server_cpu_percent\": %.1f},\n",
+            elapsed, connect_failures, lost, static_cast<unsigned long long>(total_frames),
+            static_cast<unsigned long long>(total_gaps), fpsAt(0.0), fpsAt(0.5),
+            static_cast<unsigned long long>(all_latency.percentile(0.5)),
+            static_cast<unsigned long long>(all_latency.percentile(0.99)), server_cpu);
+        out << buffer << "  \"timeline\": [";
+        for (size_t i = 0; i < timeline.size(); ++i) {
+            const Sample& s = timeline[i];
+            std::snprintf(buffer, sizeof(buffer),
+                "%s\n    {\"t\": %.1f, \"clients\": %d, \"fps\": %.1f, \"gaps\": %llu, \"server_cpu_percent\": %.1f}",
+                i ? "," : "", s.t, s.clients, s.fps, static_cast<unsigned long long>(s.gaps), s.cpu_percent);
+            out << buffer;
+        }
+        out << "\n  ],\n  \"clients\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const ClientResult& r = results[i];
+            std::snprintf(buffer, sizeof(buffer),
+                "%s\n    {\"id\": %d, \"slow\": %s, \"connected\": %s, \"lost\": %s, \"frames\": %llu, "
+                "\"fps\": %.2f, \"gaps\": %llu, \"bytes\": %llu, \"latency_p50_us\": %llu, "
+                "\"latency_p90_us\": %llu, \"latency_p99_us\": %llu, \"latency_max_us\": %llu}",
+                i ? "," : "", r.index, r.slow ? "true" : "false", r.connected ? "true" : "false",
+                r.lost ? "true" : "false", static_cast<unsigned long long>(r.frames), r.fps,
+                static_cast<unsigned long long>(r.gaps), static_cast<unsigned long long>(r.bytes),
+                static_cast<unsigned long long>(r.latency.percentile(0.5)),
+                static_cast<unsigned long long>(r.latency.percentile(0.9)),
+                static_cast<unsigned long long>(r.latency.percentile(0.99)),
+                static_cast<unsigned long long>(r.latency.max));
+            out << buffer;
+        }
+        out << "\n  ]\n}\n";
+        std::cout << "\nResults written to " << opts.json_path << std::endl;
+    }
+
+    Logger::shutdown();
+    return 0;
+}
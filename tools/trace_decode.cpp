@@ -0,0 +1,148 @@
+// Décodeur du journal binaire (voir src/utils/TraceLog.h)
+//
+//   trace_decode app.trace            -> une ligne texte par événement
+//   trace_decode --chrome app.trace   -> JSON pour chrome://tracing / Perfetto
+
+#include "utils/TraceLog.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    void usage(const char* argv0) {
+        std::cerr << "Usage: " << argv0 << " [--chrome] <trace file>" << std::endl;
+    }
+
+    // Paires *_BEGIN / *_END rendues comme des tranches dans Chrome
+    char chromePhase(uint16_t event) {
+        switch (static_cast<TraceEvent>(event)) {
+            case TraceEvent::CAPTURE_BEGIN:
+            case TraceEvent::BROADCAST_BEGIN:
+            case TraceEvent::SEND_BEGIN:
+                return 'B';
+            case TraceEvent::CAPTURE_END:
+            case TraceEvent::BROADCAST_END:
+            case TraceEvent::SEND_END:
+                return 'E';
+            default:
+                return 'i';
+        }
+    }
+
+    std::string sliceName(uint16_t event) {
+        std::string name = traceEventName(event);
+        for (const char* suffix : {"_begin", "_end"}) {
+            size_t len = std::strlen(suffix);
+            if (name.size() > len && name.compare(name.size() - len, len, suffix) == 0) {
+                return name.substr(0, name.size() - len);
+            }
+        }
+        return name;
+    }
+
+    void printText(const TraceFileHeader& header, const std::vector<TraceRecord>& records) {
+        for (const TraceRecord& r : records) {
+            uint64_t wall_ns = header.wall_clock_ns + (r.timestamp_ns - header.steady_clock_ns);
+            time_t seconds = static_cast<time_t>(wall_ns / 1000000000ULL);
+            struct tm tm_buf;
+#ifdef _WIN32
+            localtime_s(&tm_buf, &seconds);
+#else
+            localtime_r(&seconds, &tm_buf);
+#endif
+            char when[32];
+            std::strftime(when, sizeof(when), "%H:%M:%S", &tm_buf);
+            std::printf("%s.%06" PRIu64 " seq=%-8u tid=%-7u %-20s frame=%-7u client=%-3u arg0=%" PRIu64
+                        " arg1=%" PRIu64 "\n",
+                        when, (wall_ns / 1000) % 1000000, r.sequence, r.thread_id,
+                        traceEventName(r.event_id), r.frame_number, r.client_id, r.arg0, r.arg1);
+        }
+    }
+
+    void printChrome(const TraceFileHeader& header, const std::vector<TraceRecord>& records) {
+        std::printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        bool first = true;
+        for (const TraceRecord& r : records) {
+            // Microsecondes relatives à l'ouverture du journal
+            double ts = static_cast<double>(static_cast<int64_t>(r.timestamp_ns - header.steady_clock_ns)) / 1000.0;
+            char phase = chromePhase(r.event_id);
+            std::printf("%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u%s,"
+                        "\"args\":{\"frame\":%u,\"client\":%u,\"arg0\":%" PRIu64 ",\"arg1\":%" PRIu64 "}}",
+                        first ? "" : ",\n", sliceName(r.event_id).c_str(), phase, ts, r.thread_id,
+                        phase == 'i' ? ",\"s\":\"t\"" : "",
+                        r.frame_number, r.client_id, r.arg0, r.arg1);
+            first = false;
+        }
+        std::printf("\n]}\n");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bool chrome = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--chrome") == 0) {
+            chrome = true;
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!path) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot open " << path << std::endl;
+        return 1;
+    }
+
+    TraceFileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != TRACE_MAGIC || header.version != TRACE_VERSION ||
+        header.record_size != sizeof(TraceRecord) || header.capacity == 0 ||
+        (header.capacity & (header.capacity - 1)) != 0) {
+        std::cerr << path << ": not a trace file (or unsupported version)" << std::endl;
+        return 1;
+    }
+
+    std::vector<TraceRecord> slots(header.capacity);
+    in.read(reinterpret_cast<char*>(slots.data()), static_cast<std::streamsize>(slots.size() * sizeof(TraceRecord)));
+    slots.resize(static_cast<size_t>(in.gcount()) / sizeof(TraceRecord));
+
+    // Un slot est valide si sa séquence correspond à sa position dans l'anneau
+    uint64_t mask = header.capacity - 1;
+    std::vector<TraceRecord> records;
+    records.reserve(slots.size());
+    for (size_t i = 0; i < slots.size(); ++i) {
+        const TraceRecord& r = slots[i];
+        if (r.sequence != 0 && ((static_cast<uint64_t>(r.sequence) - 1) & mask) == i) {
+            records.push_back(r);
+        }
+    }
+    std::sort(records.begin(), records.end(), [](const TraceRecord& a, const TraceRecord& b) {
+        return a.timestamp_ns != b.timestamp_ns ? a.timestamp_ns < b.timestamp_ns : a.sequence < b.sequence;
+    });
+
+    if (header.records_written > header.capacity) {
+        std::cerr << "note: " << (header.records_written - header.capacity)
+                  << " older event(s) overwritten by the ring" << std::endl;
+    }
+
+    if (chrome) {
+        printChrome(header, records);
+    } else {
+        printText(header, records);
+    }
+    return 0;
+}